@@ -19,6 +19,16 @@
 
 static GObjectClass *parent_class;
 
+#define MAX_UPDATES_PER_FLUSH 2048 // path states asked in one go before returning to the main loop
+
+// file info update waiting for the batched path state request
+typedef struct {
+    NautilusFileInfo *file;
+    GClosure *update_complete;
+    gchar *path;
+    gboolean has_mega_icon;
+} PendingUpdate;
+
 static void mega_ext_class_init(MEGAExtClass *class, G_GNUC_UNUSED gpointer class_data)
 {
     parent_class = g_type_class_peek_parent(class);
@@ -36,6 +46,9 @@ static void mega_ext_instance_init(MEGAExt *mega_ext, G_GNUC_UNUSED gpointer g_c
     mega_ext->string_viewprevious = NULL;
     mega_ext->string_upload = NULL;
     mega_ext->syncs_received = FALSE;
+    mega_ext->batch_support = -1;
+    mega_ext->pending_updates = g_queue_new();
+    mega_ext->pending_updates_source = 0;
 
     // ignore SIGPIPE as we most likely will write to a closed socket in mega_notify_client_read()
     signal(SIGPIPE, SIG_IGN);
@@ -81,7 +94,7 @@ void mega_ext_on_item_changed(MEGAExt *mega_ext, const gchar *path)
         return;
     }
     g_debug("Item changed: %s", path);
-    nautilus_info_provider_update_file_info((NautilusInfoProvider*)mega_ext, file, (void*)1, (void*)1);
+    nautilus_info_provider_update_file_info((NautilusInfoProvider*)mega_ext, file, NULL, NULL);
 }
 
 // user clicked on "Upload to MEGA" menu item
@@ -487,8 +500,88 @@ static GList *mega_ext_get_file_items(NautilusMenuProvider *provider,
     return l_out;
 }
 
+static void mega_ext_apply_file_state(NautilusFileInfo *file, const gchar *path, gboolean has_mega_icon, FileState state)
+{
+    g_debug("mega_ext_update_file_info. File: %s  State: %s", path, file_state_to_str(state));
+
+    // process items located in sync folders
+    if (state == RESPONSE_DEFAULT || state == RESPONSE_IGNORED)
+    {
+        if (has_mega_icon)
+        {
+            GFile *fp = g_file_new_for_path(path);
+            g_file_set_attribute(fp, "metadata::custom-icon", G_FILE_ATTRIBUTE_TYPE_INVALID, NULL, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+            g_object_unref(fp);
+            g_debug("mega_ext_update_file_info. removed mega-icon on %s", path);
+        }
+        return;
+    }
+
+    switch (state)
+    {
+        case RESPONSE_SYNCED:
+            nautilus_file_info_add_emblem(file, "mega-synced");
+            break;
+        case RESPONSE_PENDING:
+            nautilus_file_info_add_emblem(file, "mega-pending");
+            break;
+        case RESPONSE_SYNCING:
+            nautilus_file_info_add_emblem(file, "mega-syncing");
+            break;
+        default:
+            break;
+    }
+}
+
+static void mega_ext_free_pending_update(PendingUpdate *update)
+{
+    g_closure_unref(update->update_complete);
+    g_object_unref(update->file);
+    g_free(update->path);
+    g_free(update);
+}
+
+// Ask the states of the files queued by mega_ext_update_file_info in batches, instead of one
+// blocking request per file (opening a folder queues all its files)
+static gboolean mega_ext_flush_pending_updates(gpointer user_data)
+{
+    MEGAExt *mega_ext = MEGA_EXT(user_data);
+    guint count = MIN(g_queue_get_length(mega_ext->pending_updates), MAX_UPDATES_PER_FLUSH);
+    PendingUpdate **updates = g_new(PendingUpdate *, count);
+    gchar **paths = g_new(gchar *, count);
+    FileState *states = g_new(FileState, count);
+    guint i;
+
+    for (i = 0; i < count; i++)
+    {
+        updates[i] = g_queue_pop_head(mega_ext->pending_updates);
+        paths[i] = updates[i]->path;
+    }
+
+    mega_ext_client_get_path_states(mega_ext, paths, count, 0, states);
+
+    for (i = 0; i < count; i++)
+    {
+        mega_ext_apply_file_state(updates[i]->file, updates[i]->path, updates[i]->has_mega_icon, states[i]);
+        nautilus_info_provider_update_complete_invoke(updates[i]->update_complete, NAUTILUS_INFO_PROVIDER(mega_ext),
+                                                      (NautilusOperationHandle *)updates[i], NAUTILUS_OPERATION_COMPLETE);
+        mega_ext_free_pending_update(updates[i]);
+    }
+
+    g_free(updates);
+    g_free(paths);
+    g_free(states);
+
+    if (g_queue_is_empty(mega_ext->pending_updates))
+    {
+        mega_ext->pending_updates_source = 0;
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
 static NautilusOperationResult mega_ext_update_file_info(NautilusInfoProvider *provider,
-    NautilusFileInfo *file, G_GNUC_UNUSED GClosure *update_complete, G_GNUC_UNUSED NautilusOperationHandle **handle)
+    NautilusFileInfo *file, GClosure *update_complete, NautilusOperationHandle **handle)
 {
     MEGAExt *mega_ext = MEGA_EXT(provider);
     gchar *path;
@@ -528,6 +621,24 @@ static NautilusOperationResult mega_ext_update_file_info(NautilusInfoProvider *p
         g_object_unref(file_info);
     }
 
+    // Nautilus waits for the answer: queue the file for a batched request
+    if (update_complete && handle)
+    {
+        PendingUpdate *update = g_new0(PendingUpdate, 1);
+        update->file = g_object_ref(file);
+        update->update_complete = g_closure_ref(update_complete);
+        update->path = path;
+        update->has_mega_icon = has_mega_icon;
+        *handle = (NautilusOperationHandle *)update;
+
+        g_queue_push_tail(mega_ext->pending_updates, update);
+        if (!mega_ext->pending_updates_source)
+        {
+            mega_ext->pending_updates_source = g_idle_add(mega_ext_flush_pending_updates, mega_ext);
+        }
+        return NAUTILUS_OPERATION_IN_PROGRESS;
+    }
+
     state = mega_ext_client_get_path_state(mega_ext, path, 0);
     if (state == RESPONSE_DEFAULT)
     {
@@ -536,44 +647,22 @@ static NautilusOperationResult mega_ext_update_file_info(NautilusInfoProvider *p
         state = mega_ext_client_get_path_state(mega_ext, canonical, 0);
     }
 
-    g_debug("mega_ext_update_file_info. File: %s  State: %s", path, file_state_to_str(state));
-
-    // process items located in sync folders
-    if (state == RESPONSE_DEFAULT || state == RESPONSE_IGNORED)
-    {
-        if (has_mega_icon)
-        {
-            g_file_set_attribute(fp, "metadata::custom-icon", G_FILE_ATTRIBUTE_TYPE_INVALID, NULL, G_FILE_QUERY_INFO_NONE, NULL, NULL);
-            g_debug("mega_ext_update_file_info. removed mega-icon on %s", path);
-        }
-
-        g_free(path);
-        return NAUTILUS_OPERATION_COMPLETE;
-    }
-
+    mega_ext_apply_file_state(file, path, has_mega_icon, state);
     g_free(path);
 
-    if (state == RESPONSE_ERROR)
-    {
-        return NAUTILUS_OPERATION_COMPLETE;
-    }
+    return NAUTILUS_OPERATION_COMPLETE;
+}
 
-    switch (state)
+static void mega_ext_cancel_update(NautilusInfoProvider *provider, NautilusOperationHandle *handle)
+{
+    MEGAExt *mega_ext = MEGA_EXT(provider);
+    PendingUpdate *update = (PendingUpdate *)handle;
+
+    // only the updates still queued can be cancelled, the others have been completed
+    if (g_queue_remove(mega_ext->pending_updates, update))
     {
-        case RESPONSE_SYNCED:
-            nautilus_file_info_add_emblem(file, "mega-synced");
-            break;
-        case RESPONSE_PENDING:
-            nautilus_file_info_add_emblem(file, "mega-pending");
-            break;
-        case RESPONSE_SYNCING:
-            nautilus_file_info_add_emblem(file, "mega-syncing");
-            break;
-        default:
-            break;
+        mega_ext_free_pending_update(update);
     }
-
-    return NAUTILUS_OPERATION_COMPLETE;
 }
 
 static void mega_ext_menu_provider_iface_init(
@@ -596,6 +685,7 @@ static void mega_ext_info_provider_iface_init(
         G_GNUC_UNUSED gpointer iface_data)
 {
     iface->update_file_info = mega_ext_update_file_info;
+    iface->cancel_update = mega_ext_cancel_update;
 }
 
 static GType mega_ext_type = 0;
@@ -20,6 +20,9 @@ struct _MEGAExt {
     int notify_sock;
     gint num_retries; // reconnection retries
     gboolean syncs_received; // TRUE if the list with sync folders is received
+    gint batch_support; // -1 unknown, 0 or 1 if the server answers batched path state requests
+    GQueue *pending_updates; // file info updates waiting for a batched path state request
+    guint pending_updates_source;
 
     GHashTable *h_syncs; // table of paths of shared folders
     gchar *string_upload; // cached string
@@ -3,6 +3,7 @@
 #include <sys/un.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 const gchar OP_PATH_STATE  = 'P'; //Path state
@@ -15,6 +16,13 @@ const gchar OP_SEND        = 'C'; //Copy to user
 const gchar OP_STRING      = 'T'; //Get Translated String
 const gchar OP_VIEW        = 'V'; //View on MEGA
 const gchar OP_PREVIOUS    = 'R'; //View previous versions
+const gchar OP_PATH_STATES = 'B'; //Batch of path states
+
+const gchar FILE_SEP = 0x1C;
+const gchar PATH_SEP = 0x1E;
+#define BATCH_MAX_PATHS 256
+#define BATCH_MAX_IN_FLIGHT 4
+#define BATCH_PROBE_MAX_SIZE 1000 // a server without batches reads requests in chunks of 1024 bytes
 
 const gchar *RESPONSE_DEFAULT_str = "9";
 
@@ -58,6 +66,7 @@ static gboolean mega_ext_client_reconnect(MEGAExt *mega_ext)
     }
     g_io_channel_set_close_on_unref(mega_ext->chan, TRUE);
     g_io_channel_set_line_term(mega_ext->chan, "\n", -1);
+    mega_ext->batch_support = -1;
 
     return TRUE;
 
@@ -191,6 +200,183 @@ FileState mega_ext_client_get_path_state(MEGAExt *mega_ext, const gchar *path, i
     return st;
 }
 
+// paths that the line based batch requests cannot carry are asked one by one
+static gboolean mega_ext_client_batchable_path(const gchar *path)
+{
+    return !strchr(path, '\n') && !strchr(path, PATH_SEP) && !strchr(path, FILE_SEP);
+}
+
+// format "B:<id>" followed by <RS><path><FS><force> for each path
+static void mega_ext_client_format_batch(GString *request, guint batch_id, gchar **canonicals,
+                                         const guint *indexes, guint count, int forceGetState)
+{
+    guint n;
+
+    g_string_printf(request, "%c:%u", OP_PATH_STATES, batch_id);
+    for (n = 0; n < count; n++) {
+        g_string_append_c(request, PATH_SEP);
+        g_string_append(request, canonicals[indexes[n]]);
+        g_string_append_c(request, FILE_SEP);
+        g_string_append_c(request, forceGetState ? '1' : '0');
+    }
+    g_string_append_c(request, '\n');
+}
+
+// parse "B:<id>:<state>,<state>,..." into states. Return FALSE if it is not the answer to batch_id
+static gboolean mega_ext_client_parse_batch(const gchar *answer, guint batch_id, FileState *states,
+                                            const guint *indexes, guint count)
+{
+    gchar *end;
+    guint n;
+
+    if (answer[0] != OP_PATH_STATES || answer[1] != ':')
+        return FALSE;
+    if (strtoul(answer + 2, &end, 10) != batch_id || *end != ':')
+        return FALSE;
+
+    for (n = 0; n < count; n++) {
+        const gchar *state = end + 1;
+        states[indexes[n]] = strtol(state, &end, 10);
+        if (end == state || (n + 1 < count && *end != ','))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean mega_ext_client_write_request(MEGAExt *mega_ext, const GString *request)
+{
+    gsize bytes_written;
+    GError *error = NULL;
+    GIOStatus status;
+
+    status = g_io_channel_write_chars(mega_ext->chan, request->str, request->len, &bytes_written, &error);
+    if (status == G_IO_STATUS_NORMAL && !error)
+        status = g_io_channel_flush(mega_ext->chan, &error);
+    if (status != G_IO_STATUS_NORMAL || error) {
+        g_warning("Failed to write data!");
+        if (error)
+            g_error_free(error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gchar *mega_ext_client_read_answer(MEGAExt *mega_ext)
+{
+    gchar *out = NULL;
+    GError *error = NULL;
+    GIOStatus status;
+
+    status = g_io_channel_read_line(mega_ext->chan, &out, NULL, NULL, &error);
+    if (status != G_IO_STATUS_NORMAL || error) {
+        g_warning("Failed to read data!");
+        if (error)
+            g_error_free(error);
+        g_free(out);
+        return NULL;
+    }
+    return out;
+}
+
+// Get the state of count paths with batched requests. Up to BATCH_MAX_IN_FLIGHT batches are sent
+// before reading the oldest answer. Paths that cannot be batched, and all of them if the server
+// does not support batches, are asked with one 'P' request each
+void mega_ext_client_get_path_states(MEGAExt *mega_ext, gchar **paths, guint count, int forceGetState, FileState *states)
+{
+    static guint next_batch_id = 0;
+    guint batch_ids[BATCH_MAX_IN_FLIGHT];
+    guint batch_first[BATCH_MAX_IN_FLIGHT];
+    guint batch_count[BATCH_MAX_IN_FLIGHT];
+    guint in_flight = 0, oldest = 0, sent = 0, num_indexes = 0, i;
+    gchar **canonicals;
+    guint *indexes;
+    GString *request;
+
+    if (!count)
+        return;
+
+    canonicals = g_new(gchar *, count);
+    indexes = g_new(guint, count);
+    for (i = 0; i < count; i++) {
+        char canonical[PATH_MAX];
+        g_strlcpy(canonical, paths[i], sizeof(canonical));
+        expanselocalpath(paths[i], canonical);
+        canonicals[i] = g_strdup(canonical);
+
+        states[i] = RESPONSE_ERROR;
+        if (mega_ext_client_batchable_path(canonical))
+            indexes[num_indexes++] = i;
+    }
+
+    if (mega_ext->srv_sock < 0)
+        mega_ext_client_reconnect(mega_ext);
+
+    request = g_string_sized_new(BATCH_MAX_PATHS * 64);
+
+    // a server of unknown version is probed with a batch short enough for its single line reader
+    if (mega_ext->chan && mega_ext->batch_support < 0 && num_indexes) {
+        guint batch_id = ++next_batch_id;
+        mega_ext_client_format_batch(request, batch_id, canonicals, indexes, 1, forceGetState);
+        if (request->len <= BATCH_PROBE_MAX_SIZE) {
+            gchar *out = NULL;
+            if (mega_ext_client_write_request(mega_ext, request))
+                out = mega_ext_client_read_answer(mega_ext);
+
+            if (!out) {
+                mega_ext_client_disconnect(mega_ext);
+            } else {
+                mega_ext->batch_support = mega_ext_client_parse_batch(out, batch_id, states, indexes, 1) ? 1 : 0;
+                if (mega_ext->batch_support)
+                    sent = 1;
+                g_debug("Batched path states %ssupported by the server", mega_ext->batch_support ? "" : "not ");
+                g_free(out);
+            }
+        }
+    }
+
+    while (mega_ext->chan && mega_ext->batch_support > 0 && (sent < num_indexes || in_flight)) {
+        // keep the pipeline full
+        while (in_flight < BATCH_MAX_IN_FLIGHT && sent < num_indexes) {
+            guint slot = (oldest + in_flight) % BATCH_MAX_IN_FLIGHT;
+
+            batch_ids[slot] = ++next_batch_id;
+            batch_first[slot] = sent;
+            batch_count[slot] = MIN(num_indexes - sent, BATCH_MAX_PATHS);
+            mega_ext_client_format_batch(request, batch_ids[slot], canonicals, indexes + sent, batch_count[slot], forceGetState);
+            if (!mega_ext_client_write_request(mega_ext, request)) {
+                mega_ext_client_disconnect(mega_ext);
+                break;
+            }
+            sent += batch_count[slot];
+            in_flight++;
+        }
+
+        if (in_flight && mega_ext->chan) {
+            gchar *out = mega_ext_client_read_answer(mega_ext);
+            if (!out || !mega_ext_client_parse_batch(out, batch_ids[oldest], states,
+                                                     indexes + batch_first[oldest], batch_count[oldest])) {
+                g_free(out);
+                mega_ext_client_disconnect(mega_ext);
+                break;
+            }
+            g_free(out);
+            oldest = (oldest + 1) % BATCH_MAX_IN_FLIGHT;
+            in_flight--;
+        }
+    }
+
+    g_string_free(request, TRUE);
+
+    // the answers still missing are asked one by one
+    for (i = 0; i < count; i++) {
+        if (states[i] == RESPONSE_ERROR)
+            states[i] = mega_ext_client_get_path_state(mega_ext, canonicals[i], forceGetState);
+        g_free(canonicals[i]);
+    }
+    g_free(canonicals);
+    g_free(indexes);
+}
+
 gboolean mega_ext_client_paste_link(MEGAExt *mega_ext, const gchar *path)
 {
     gchar *out;
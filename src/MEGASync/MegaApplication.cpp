@@ -451,6 +451,7 @@ void MegaApplication::initialize()
     QDesktopServices::setUrlHandler(SCHEME_LOCAL_URL, this, "handleLocalPath");
 
     qRegisterMetaTypeStreamOperators<EphemeralCredentials>("EphemeralCredentials");
+    qRegisterMetaType<std::shared_ptr<const NodeChangeBatch>>("std::shared_ptr<const NodeChangeBatch>");
 
     preferences = Preferences::instance();
     connect(preferences.get(), SIGNAL(stateChanged()), this, SLOT(changeState()));
@@ -6193,34 +6194,10 @@ void MegaApplication::onTransferFinish(MegaApi* , MegaTransfer *transfer, MegaEr
         MegaSync::SyncType type (MegaSync::SyncType::TYPE_UNKNOWN);
 
         // Check transfer local path against configured syncs to determine the sync type
-        QString filePath (QString::fromUtf8(transfer->getPath()));
-
-#ifdef WIN32
-        if (filePath.startsWith(QString::fromUtf8("\\\\?\\")))
+        auto syncSetting (model->findSyncForLocalPath(QString::fromUtf8(transfer->getPath())));
+        if (syncSetting)
         {
-            filePath = filePath.mid(4);
-        }
-#endif
-
-        filePath = QDir::fromNativeSeparators(filePath);
-
-        auto typeIt (SyncInfo::AllHandledSyncTypes.constBegin());
-        while (type == MegaSync::SyncType::TYPE_UNKNOWN
-               && typeIt != SyncInfo::AllHandledSyncTypes.constEnd())
-        {
-            const auto syncsPaths (model->getLocalFolders(*typeIt));
-            auto pathIt (syncsPaths.constBegin());
-            while (type == MegaSync::SyncType::TYPE_UNKNOWN
-                   && pathIt != syncsPaths.constEnd())
-            {
-                QString syncDir (QDir::fromNativeSeparators(*pathIt) + QLatin1Char('/'));
-                if (filePath.startsWith(syncDir))
-                {
-                    type = *typeIt;
-                }
-                pathIt++;
-            }
-            typeIt++;
+            type = syncSetting->getType();
         }
 
         // Now emit an event if necessary
@@ -6403,20 +6380,43 @@ void MegaApplication::onNodesUpdate(MegaApi* , MegaNodeList *nodes)
 
     MegaApi::log(MegaApi::LOG_LEVEL_INFO, QString::fromUtf8("%1 updated files/folders").arg(nodes->size()).toUtf8().constData());
 
-    //Check all modified nodes
-    QString localPath;
+    //Group the changes of all modified nodes, so that consumers get them in a single signal
+    auto changes = std::make_shared<NodeChangeBatch>();
     for (int i = 0; i < nodes->size(); i++)
     {
-        localPath.clear();
         MegaNode *node = nodes->get(i);
-        if (node->getChanges() & MegaNode::CHANGE_TYPE_PARENT)
+        const auto nodeChanges = node->getChanges();
+        unsigned int types = 0;
+        if (nodeChanges & MegaNode::CHANGE_TYPE_PARENT)
         {
-            emit nodeMoved(node->getHandle());
+            types |= 1u << NodeChangeBatch::MOVED;
         }
-        if (node->getChanges() & MegaNode::CHANGE_TYPE_ATTRIBUTES)
+        if (nodeChanges & MegaNode::CHANGE_TYPE_ATTRIBUTES)
         {
-            emit nodeAttributesChanged(node->getHandle());
+            types |= 1u << NodeChangeBatch::ATTRIBUTES;
         }
+        if (nodeChanges & MegaNode::CHANGE_TYPE_NAME)
+        {
+            types |= 1u << NodeChangeBatch::NAME;
+        }
+        if (nodeChanges & MegaNode::CHANGE_TYPE_NEW)
+        {
+            types |= 1u << NodeChangeBatch::NEW;
+        }
+        if (nodeChanges & MegaNode::CHANGE_TYPE_REMOVED)
+        {
+            types |= 1u << NodeChangeBatch::REMOVED;
+        }
+        if (types)
+        {
+            changes->add(node->getHandle(), node->getParentHandle(), types);
+        }
+    }
+    changes->finish();
+
+    if (!changes->empty())
+    {
+        emit nodesChanged(changes);
     }
 }
 
@@ -34,6 +34,7 @@
 #include "control/ThreadPool.h"
 #include "control/Utilities.h"
 #include "control/SetManager.h"
+#include "control/NodeChangeBatch.h"
 #include "syncs/control/SyncInfo.h"
 #include "syncs/control/SyncController.h"
 #include "megaapi.h"
@@ -60,6 +61,7 @@ class StalledIssuesModel;
 #endif
 
 Q_DECLARE_METATYPE(QQueue<QString>)
+Q_DECLARE_METATYPE(std::shared_ptr<const NodeChangeBatch>)
 
 class LogoutController;
 class TransferMetadata;
@@ -221,8 +223,8 @@ signals:
     void clearAllFinishedTransfers();
     void fetchNodesAfterBlock();
     void unblocked();
-    void nodeMoved(mega::MegaHandle handle);
-    void nodeAttributesChanged(mega::MegaHandle handle);
+    // Once per SDK node update, with every change it carries
+    void nodesChanged(std::shared_ptr<const NodeChangeBatch> changes);
     void blocked();
     void storageStateChanged(int);
     void pauseStateChanged();
@@ -0,0 +1,475 @@
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace BinaryLog;
+
+namespace
+{
+std::atomic<std::uint64_t> gNextWriterId(1);
+
+bool isValidHeader(const SegmentHeader& header, std::uint64_t fileSize)
+{
+    return !memcmp(header.magic, MAGIC, sizeof(MAGIC))
+            && header.version == VERSION
+            && header.headerSize == sizeof(SegmentHeader)
+            && header.used >= sizeof(SegmentHeader)
+            && header.used <= fileSize;
+}
+}
+
+std::int64_t BinaryLog::steadyMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t BinaryLog::wallClockMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+thread_local BinaryLogWriter::LocalBuffer BinaryLogWriter::mLocalBuffer;
+
+BinaryLogWriter::BinaryLogWriter()
+    : mId(gNextWriterId++),
+      mWallClockBaseMicros(wallClockMicros()),
+      mSteadyBaseMicros(steadyMicros())
+{
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+}
+
+bool BinaryLogWriter::append(int level, const char* message, std::size_t length)
+{
+    return write(MESSAGE, level, &message, &length, 1);
+}
+
+bool BinaryLogWriter::append(int level, const char** messages, const std::size_t* lengths, int count)
+{
+    return write(MESSAGE, level, messages, lengths, count);
+}
+
+bool BinaryLogWriter::appendRawLine(const char* line, std::size_t length)
+{
+    return write(RAW_LINE, 0, &line, &length, 1);
+}
+
+BinaryLogWriter::ThreadBuffer& BinaryLogWriter::threadBuffer()
+{
+    if (mLocalBuffer.writerId != mId || !mLocalBuffer.buffer)
+    {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::ostringstream name;
+        name << std::this_thread::get_id() << " ";
+        buffer->threadName = name.str();
+
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        buffer->threadId = mNextThreadId++;
+        const char* parts[] = {buffer->threadName.c_str()};
+        const std::size_t lengths[] = {buffer->threadName.size()};
+        writeRecord(buffer->records, steadyMicros(), buffer->threadId, THREAD_NAME, 0, parts, lengths, 1);
+        mThreads.push_back(buffer);
+
+        mLocalBuffer.writerId = mId;
+        mLocalBuffer.buffer = buffer;
+    }
+    return *mLocalBuffer.buffer;
+}
+
+bool BinaryLogWriter::write(RecordType type, int level, const char** parts, const std::size_t* lengths, int count)
+{
+    auto& buffer = threadBuffer();
+
+    std::size_t length(0);
+    for (int i = 0; i < count; ++i)
+    {
+        length += lengths[i];
+    }
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.gap && buffer.records.size() + recordSize(0) + recordSize(length) <= MAX_THREAD_BUFFER)
+    {
+        writeRecord(buffer.records, steadyMicros(), buffer.threadId, GAP, level, nullptr, nullptr, 0);
+        buffer.gap = false;
+    }
+
+    if (buffer.gap || buffer.records.size() + recordSize(length) > MAX_THREAD_BUFFER)
+    {
+        // The logging thread is not keeping up: drop the record, the renderer will show the gap
+        buffer.gap = true;
+        return true;
+    }
+
+    writeRecord(buffer.records, steadyMicros(), buffer.threadId, type, level, parts, lengths, count);
+    return buffer.records.size() > NOTIFY_THRESHOLD;
+}
+
+void BinaryLogWriter::writeRecord(std::vector<char>& records, std::int64_t time, std::uint32_t threadId, RecordType type,
+                                  int level, const char** parts, const std::size_t* lengths, int count)
+{
+    std::size_t length(0);
+    for (int i = 0; i < count; ++i)
+    {
+        length += lengths[i];
+    }
+
+    auto offset = records.size();
+    records.resize(offset + recordSize(length));
+
+    RecordHeader header{time, threadId, static_cast<std::uint32_t>(length), type, static_cast<std::uint8_t>(level), 0, 0};
+    memcpy(records.data() + offset, &header, sizeof(header));
+
+    auto output = records.data() + offset + sizeof(header);
+    for (int i = 0; i < count; ++i)
+    {
+        memcpy(output, parts[i], lengths[i]);
+        output += lengths[i];
+    }
+}
+
+void BinaryLogWriter::takeRecords(std::vector<char>& records)
+{
+    records.clear();
+
+    std::vector<std::shared_ptr<ThreadBuffer>> threads;
+    {
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        threads = mThreads;
+    }
+
+    // Each buffer is already in time order, swapping them keeps the threads' lock short
+    mSorted.clear();
+    for (auto& thread : threads)
+    {
+        {
+            std::lock_guard<std::mutex> lock(thread->mutex);
+            thread->taken.clear();
+            std::swap(thread->records, thread->taken);
+        }
+
+        forEachRecord(thread->taken.data(), thread->taken.size(), [this](const RecordHeader& header, const char*)
+        {
+            mSorted.push_back(&header);
+        });
+    }
+
+    std::stable_sort(mSorted.begin(), mSorted.end(), [](const RecordHeader* left, const RecordHeader* right)
+    {
+        return left->steadyMicros < right->steadyMicros;
+    });
+
+    for (auto header : mSorted)
+    {
+        auto begin = reinterpret_cast<const char*>(header);
+        records.insert(records.end(), begin, begin + recordSize(header->length));
+    }
+    mSorted.clear();
+
+    // Forget the threads that have finished (only this and the copy above keep their buffers)
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    mThreads.erase(std::remove_if(mThreads.begin(), mThreads.end(), [](const std::shared_ptr<ThreadBuffer>& thread)
+    {
+        return thread.use_count() == 2 && thread->records.empty();
+    }), mThreads.end());
+}
+
+void BinaryLogWriter::threadNameRecords(std::vector<char>& records)
+{
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    for (auto& thread : mThreads)
+    {
+        const char* parts[] = {thread->threadName.c_str()};
+        const std::size_t lengths[] = {thread->threadName.size()};
+        writeRecord(records, steadyMicros(), thread->threadId, THREAD_NAME, 0, parts, lengths, 1);
+    }
+}
+
+std::int64_t BinaryLogWriter::wallClockBaseMicros() const
+{
+    return mWallClockBaseMicros;
+}
+
+std::int64_t BinaryLogWriter::steadyBaseMicros() const
+{
+    return mSteadyBaseMicros;
+}
+
+BinaryLogSegment::~BinaryLogSegment()
+{
+    close();
+}
+
+bool BinaryLogSegment::open(const BinaryLogPath& path, std::uint64_t capacity,
+                            std::int64_t wallClockBaseMicros, std::int64_t steadyBaseMicros)
+{
+    close();
+
+    SegmentHeader existing;
+    std::uint64_t fileSize(0);
+    bool reuse(false);
+
+#ifdef WIN32
+    mFile = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        mFile = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    DWORD read(0);
+    if (GetFileSizeEx(mFile, &size))
+    {
+        fileSize = static_cast<std::uint64_t>(size.QuadPart);
+        reuse = fileSize >= sizeof(SegmentHeader)
+                && ReadFile(mFile, &existing, sizeof(existing), &read, nullptr)
+                && read == sizeof(existing)
+                && isValidHeader(existing, fileSize);
+    }
+#else
+    mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (mFile < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (!fstat(mFile, &st))
+    {
+        fileSize = static_cast<std::uint64_t>(st.st_size);
+        reuse = fileSize >= sizeof(SegmentHeader)
+                && pread(mFile, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing))
+                && isValidHeader(existing, fileSize);
+    }
+#endif
+
+    // A segment already fuller than the capacity is mapped as it is, so the caller rotates it
+    mMappedSize = std::max<std::uint64_t>(capacity, reuse ? existing.used + recordSize(2 * sizeof(std::int64_t)) : 0);
+    mMappedSize = std::max<std::uint64_t>(mMappedSize, sizeof(SegmentHeader));
+
+#ifdef WIN32
+    mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(mMappedSize >> 32), static_cast<DWORD>(mMappedSize), nullptr);
+    if (mMapping)
+    {
+        mData = static_cast<char*>(MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(mMappedSize)));
+    }
+#else
+    if (!ftruncate(mFile, static_cast<off_t>(mMappedSize)))
+    {
+        void* data = mmap(nullptr, static_cast<std::size_t>(mMappedSize), PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+        mData = (data != MAP_FAILED) ? static_cast<char*>(data) : nullptr;
+    }
+#endif
+
+    if (!mData)
+    {
+        close();
+        return false;
+    }
+
+    auto segmentHeader = header();
+    if (reuse)
+    {
+        segmentHeader->capacity = mMappedSize;
+
+        // Records of this run use other time references
+        std::int64_t timeBase[] = {wallClockBaseMicros, steadyBaseMicros};
+        std::vector<char> record(recordSize(sizeof(timeBase)), 0);
+        RecordHeader recordHeader{steadyBaseMicros, 0, sizeof(timeBase), TIME_BASE, 0, 0, 0};
+        memcpy(record.data(), &recordHeader, sizeof(recordHeader));
+        memcpy(record.data() + sizeof(recordHeader), timeBase, sizeof(timeBase));
+        write(record.data(), record.size());
+    }
+    else
+    {
+        SegmentHeader newHeader;
+        memcpy(newHeader.magic, MAGIC, sizeof(MAGIC));
+        newHeader.version = VERSION;
+        newHeader.headerSize = sizeof(SegmentHeader);
+        newHeader.capacity = mMappedSize;
+        newHeader.used = sizeof(SegmentHeader);
+        newHeader.wallClockBaseMicros = wallClockBaseMicros;
+        newHeader.steadyBaseMicros = steadyBaseMicros;
+        memcpy(mData, &newHeader, sizeof(newHeader));
+    }
+
+    return true;
+}
+
+void BinaryLogSegment::close()
+{
+    std::uint64_t used(mData ? header()->used : 0);
+
+#ifdef WIN32
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+    if (mFile)
+    {
+        if (used)
+        {
+            LARGE_INTEGER position;
+            position.QuadPart = static_cast<LONGLONG>(used);
+            if (SetFilePointerEx(mFile, position, nullptr, FILE_BEGIN))
+            {
+                SetEndOfFile(mFile);
+            }
+        }
+        CloseHandle(mFile);
+        mFile = nullptr;
+    }
+#else
+    if (mData)
+    {
+        munmap(mData, static_cast<std::size_t>(mMappedSize));
+    }
+    if (mFile >= 0)
+    {
+        if (used && ftruncate(mFile, static_cast<off_t>(used)))
+        {
+            // The unused tail is ignored by the reader anyway
+        }
+        ::close(mFile);
+        mFile = -1;
+    }
+#endif
+
+    mData = nullptr;
+    mMappedSize = 0;
+}
+
+void BinaryLogSegment::flush()
+{
+    if (mData)
+    {
+#ifdef WIN32
+        FlushViewOfFile(mData, 0);
+#else
+        msync(mData, static_cast<std::size_t>(mMappedSize), MS_ASYNC);
+#endif
+    }
+}
+
+bool BinaryLogSegment::isOpen() const
+{
+    return mData != nullptr;
+}
+
+std::uint64_t BinaryLogSegment::used() const
+{
+    return mData ? header()->used : 0;
+}
+
+std::size_t BinaryLogSegment::write(const char* records, std::size_t size)
+{
+    if (!mData)
+    {
+        return 0;
+    }
+
+    auto segmentHeader = header();
+    auto available = mMappedSize - segmentHeader->used;
+    auto fits = forEachRecord(records, std::min<std::uint64_t>(size, available), [](const RecordHeader&, const char*){});
+
+    memcpy(mData + segmentHeader->used, records, fits);
+    // The used size is updated after the data, so a crash never exposes half written records
+    segmentHeader->used += fits;
+    return fits;
+}
+
+SegmentHeader* BinaryLogSegment::header() const
+{
+    return reinterpret_cast<SegmentHeader*>(mData);
+}
+
+void BinaryLogRenderer::setTimeBase(std::int64_t wallClockBaseMicros, std::int64_t steadyBaseMicros)
+{
+    mWallClockBaseMicros = wallClockBaseMicros;
+    mSteadyBaseMicros = steadyBaseMicros;
+}
+
+void BinaryLogRenderer::setTimeBase(const char* payload, std::size_t length)
+{
+    std::int64_t timeBase[2];
+    if (length >= sizeof(timeBase))
+    {
+        memcpy(timeBase, payload, sizeof(timeBase));
+        setTimeBase(timeBase[0], timeBase[1]);
+    }
+}
+
+void BinaryLogRenderer::trackThreadNames(const char* data, std::size_t size)
+{
+    forEachRecord(data, size, [this](const RecordHeader& header, const char* payload)
+    {
+        if (header.type == THREAD_NAME)
+        {
+            mThreadNames[header.threadId].assign(payload, header.length);
+        }
+        else if (header.type == TIME_BASE)
+        {
+            setTimeBase(payload, header.length);
+        }
+    });
+}
+
+void BinaryLogRenderer::sortByTime()
+{
+    std::stable_sort(mSorted.begin(), mSorted.end(), [](const RecordHeader* left, const RecordHeader* right)
+    {
+        return left->steadyMicros < right->steadyMicros;
+    });
+}
+
+bool BinaryLogReader::open(const BinaryLogPath& path)
+{
+    mRecords.clear();
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    SegmentHeader header;
+    if (content.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, content.data(), sizeof(header));
+    if (!isValidHeader(header, content.size()))
+    {
+        return false;
+    }
+
+    mRecords.assign(content.begin() + sizeof(header), content.begin() + static_cast<std::ptrdiff_t>(header.used));
+    mWallClockBaseMicros = header.wallClockBaseMicros;
+    mSteadyBaseMicros = header.steadyBaseMicros;
+    return true;
+}
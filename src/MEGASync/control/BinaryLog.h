@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binary log format used by MegaSyncLogger when MEGA_BINARY_LOG is set.
+//
+// Logging threads only copy a fixed-layout record (monotonic timestamp, thread id, level and the
+// message bytes) into a buffer owned by the thread. The logging thread collects those buffers and
+// copies the records into a memory-mapped segment file. Timestamps, thread names and levels are
+// turned into text later, by BinaryLogRenderer, outside the threads that log.
+
+#ifdef WIN32
+using BinaryLogPath = std::wstring;
+#else
+using BinaryLogPath = std::string;
+#endif
+
+namespace BinaryLog
+{
+enum RecordType : std::uint8_t
+{
+    MESSAGE = 0,
+    THREAD_NAME, // Payload is the name of the thread, sent before its first message
+    RAW_LINE,    // Payload is written as is (program start banner)
+    GAP,         // Records were lost because the thread buffer was full
+    TIME_BASE,   // Payload is the wall-clock and steady times of a new run appending to the segment
+};
+
+struct SegmentHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t capacity;
+    std::uint64_t used;
+    std::int64_t wallClockBaseMicros;
+    std::int64_t steadyBaseMicros;
+};
+
+struct RecordHeader
+{
+    std::int64_t steadyMicros;
+    std::uint32_t threadId;
+    std::uint32_t length;
+    RecordType type;
+    std::uint8_t level;
+    std::uint16_t reserved;
+    std::uint32_t reserved2;
+};
+
+constexpr char MAGIC[8] = {'M', 'E', 'G', 'A', 'B', 'L', 'O', 'G'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t ALIGNMENT = 8;
+
+inline std::size_t recordSize(std::size_t length)
+{
+    return (sizeof(RecordHeader) + length + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+std::int64_t steadyMicros();
+std::int64_t wallClockMicros();
+
+// Calls func(const RecordHeader&, const char* payload) for every complete record in data
+template <typename Func>
+std::size_t forEachRecord(const char* data, std::size_t size, Func func)
+{
+    std::size_t offset(0);
+    while (offset + sizeof(RecordHeader) <= size)
+    {
+        auto header = reinterpret_cast<const RecordHeader*>(data + offset);
+        auto length = recordSize(header->length);
+        if (offset + length > size)
+        {
+            break;
+        }
+        func(*header, data + offset + sizeof(RecordHeader));
+        offset += length;
+    }
+    return offset;
+}
+}
+
+class BinaryLogWriter
+{
+public:
+    BinaryLogWriter();
+    ~BinaryLogWriter();
+
+    BinaryLogWriter(const BinaryLogWriter&) = delete;
+    BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+    // Called from any thread. Returns true when the buffer of the thread is getting big and the
+    // logging thread should be woken up
+    bool append(int level, const char* message, std::size_t length);
+    bool append(int level, const char** messages, const std::size_t* lengths, int count);
+    bool appendRawLine(const char* line, std::size_t length);
+
+    // Called from the logging thread. Moves the records of every thread to records, ordered by time
+    void takeRecords(std::vector<char>& records);
+
+    // Name records of the known threads, to start a new segment with them
+    void threadNameRecords(std::vector<char>& records);
+
+    std::int64_t wallClockBaseMicros() const;
+    std::int64_t steadyBaseMicros() const;
+
+private:
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<char> records;
+        std::vector<char> taken; // Only used by the logging thread
+        std::uint32_t threadId = 0;
+        std::string threadName;
+        bool gap = false;
+    };
+
+    static constexpr std::size_t NOTIFY_THRESHOLD = 64 * 1024;
+    static constexpr std::size_t MAX_THREAD_BUFFER = 8 * 1024 * 1024;
+
+    ThreadBuffer& threadBuffer();
+    bool write(BinaryLog::RecordType type, int level, const char** parts, const std::size_t* lengths, int count);
+    static void writeRecord(std::vector<char>& records, std::int64_t time, std::uint32_t threadId, BinaryLog::RecordType type,
+                            int level, const char** parts, const std::size_t* lengths, int count);
+
+    const std::uint64_t mId;
+    const std::int64_t mWallClockBaseMicros;
+    const std::int64_t mSteadyBaseMicros;
+
+    std::mutex mThreadsMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> mThreads;
+    std::uint32_t mNextThreadId = 1;
+    std::vector<const BinaryLog::RecordHeader*> mSorted;
+
+    struct LocalBuffer
+    {
+        std::uint64_t writerId = 0;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    static thread_local LocalBuffer mLocalBuffer;
+};
+
+// Memory-mapped file that stores the records of one log file
+class BinaryLogSegment
+{
+public:
+    BinaryLogSegment() = default;
+    ~BinaryLogSegment();
+
+    BinaryLogSegment(const BinaryLogSegment&) = delete;
+    BinaryLogSegment& operator=(const BinaryLogSegment&) = delete;
+
+    // Appends to the segment if the file is a valid one, otherwise it is created again
+    bool open(const BinaryLogPath& path, std::uint64_t capacity, std::int64_t wallClockBaseMicros, std::int64_t steadyBaseMicros);
+    // Unmaps the file and trims it to the used size
+    void close();
+    // Asks the OS to write the dirty pages (the data is safe from a crash of the app without it)
+    void flush();
+
+    bool isOpen() const;
+    std::uint64_t used() const;
+
+    // Writes whole records while they fit. Returns the number of bytes written
+    std::size_t write(const char* records, std::size_t size);
+
+private:
+    BinaryLog::SegmentHeader* header() const;
+
+    char* mData = nullptr;
+    std::uint64_t mMappedSize = 0;
+#ifdef WIN32
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+#else
+    int mFile = -1;
+#endif
+};
+
+struct BinaryLogEntry
+{
+    BinaryLog::RecordType type;
+    int level;
+    std::int64_t wallClockMicros;
+    const std::string* threadName;
+    const char* message;
+    std::size_t length;
+};
+
+// Turns records back into entries with wall-clock time and thread name
+class BinaryLogRenderer
+{
+public:
+    void setTimeBase(std::int64_t wallClockBaseMicros, std::int64_t steadyBaseMicros);
+
+    // Calls func(const BinaryLogEntry&) for the records of data, sorted by time within each run
+    template <typename Func>
+    void render(const char* data, std::size_t size, Func func)
+    {
+        mSorted.clear();
+        BinaryLog::forEachRecord(data, size, [this, &func](const BinaryLog::RecordHeader& header, const char* payload)
+        {
+            switch (header.type)
+            {
+            case BinaryLog::THREAD_NAME:
+                mThreadNames[header.threadId].assign(payload, header.length);
+                break;
+            case BinaryLog::TIME_BASE:
+                emitSorted(func);
+                setTimeBase(payload, header.length);
+                break;
+            default:
+                mSorted.push_back(&header);
+                break;
+            }
+        });
+        emitSorted(func);
+    }
+
+    // Keeps the thread names of records that are not rendered
+    void trackThreadNames(const char* data, std::size_t size);
+
+private:
+    template <typename Func>
+    void emitSorted(Func& func)
+    {
+        sortByTime();
+
+        static const std::string unknownThread;
+        for (auto header : mSorted)
+        {
+            auto name = mThreadNames.find(header->threadId);
+            func(BinaryLogEntry{header->type, header->level,
+                                mWallClockBaseMicros + (header->steadyMicros - mSteadyBaseMicros),
+                                name != mThreadNames.end() ? &name->second : &unknownThread,
+                                reinterpret_cast<const char*>(header) + sizeof(BinaryLog::RecordHeader),
+                                header->length});
+        }
+        mSorted.clear();
+    }
+
+    void setTimeBase(const char* payload, std::size_t length);
+    void sortByTime();
+
+    std::int64_t mWallClockBaseMicros = 0;
+    std::int64_t mSteadyBaseMicros = 0;
+    std::unordered_map<std::uint32_t, std::string> mThreadNames;
+    std::vector<const BinaryLog::RecordHeader*> mSorted;
+};
+
+// Reads a segment file written by BinaryLogSegment
+class BinaryLogReader
+{
+public:
+    bool open(const BinaryLogPath& path);
+
+    template <typename Func>
+    void forEachEntry(Func func)
+    {
+        BinaryLogRenderer renderer;
+        renderer.setTimeBase(mWallClockBaseMicros, mSteadyBaseMicros);
+        renderer.render(mRecords.data(), mRecords.size(), func);
+    }
+
+private:
+    std::vector<char> mRecords;
+    std::int64_t mWallClockBaseMicros = 0;
+    std::int64_t mSteadyBaseMicros = 0;
+};
@@ -0,0 +1,243 @@
+#include "FileExtensionTable.h"
+
+constexpr std::size_t FileExtensionTable::MAX_EXTENSION_SIZE;
+
+namespace
+{
+using Icon = FileExtensionTable::Icon;
+using Kind = FileExtensionTable::Kind;
+
+struct Entry
+{
+    char extension[FileExtensionTable::MAX_EXTENSION_SIZE + 1];
+    Icon icon;
+};
+
+constexpr Entry ENTRIES[] = {
+    {"3ds", Icon::THREE_D}, {"3dm", Icon::THREE_D}, {"max", Icon::THREE_D}, {"obj", Icon::THREE_D},
+    {"aep", Icon::AFTER_EFFECTS}, {"aet", Icon::AFTER_EFFECTS},
+    {"mp3", Icon::AUDIO}, {"wav", Icon::AUDIO}, {"3ga", Icon::AUDIO}, {"aif", Icon::AUDIO},
+    {"aiff", Icon::AUDIO}, {"flac", Icon::AUDIO}, {"iff", Icon::AUDIO}, {"ogg", Icon::AUDIO},
+    {"m4a", Icon::AUDIO}, {"wma", Icon::AUDIO},
+    {"dxf", Icon::CAD}, {"dwg", Icon::CAD},
+    {"zip", Icon::COMPRESSED}, {"rar", Icon::COMPRESSED}, {"tgz", Icon::COMPRESSED}, {"gz", Icon::COMPRESSED},
+    {"bz2", Icon::COMPRESSED}, {"tbz", Icon::COMPRESSED}, {"tar", Icon::COMPRESSED}, {"7z", Icon::COMPRESSED},
+    {"sitx", Icon::COMPRESSED},
+    {"sql", Icon::WEB_LANG}, {"accdb", Icon::WEB_LANG}, {"db", Icon::WEB_LANG}, {"dbf", Icon::WEB_LANG},
+    {"mdb", Icon::WEB_LANG}, {"pdb", Icon::WEB_LANG}, {"php", Icon::WEB_LANG}, {"php3", Icon::WEB_LANG},
+    {"php4", Icon::WEB_LANG}, {"php5", Icon::WEB_LANG}, {"phtml", Icon::WEB_LANG}, {"inc", Icon::WEB_LANG},
+    {"asp", Icon::WEB_LANG}, {"pl", Icon::WEB_LANG}, {"cgi", Icon::WEB_LANG}, {"py", Icon::WEB_LANG},
+    {"folder", Icon::FOLDER},
+    {"xls", Icon::EXCEL}, {"xlsx", Icon::EXCEL}, {"xlt", Icon::EXCEL}, {"xltm", Icon::EXCEL},
+    {"exe", Icon::EXECUTABLE}, {"com", Icon::EXECUTABLE}, {"bin", Icon::EXECUTABLE},
+    {"apk", Icon::EXECUTABLE}, {"app", Icon::EXECUTABLE}, {"msi", Icon::EXECUTABLE},
+    {"cmd", Icon::EXECUTABLE}, {"gadget", Icon::EXECUTABLE},
+    {"fnt", Icon::FONT}, {"otf", Icon::FONT}, {"ttf", Icon::FONT}, {"fon", Icon::FONT},
+    {"gif", Icon::IMAGE}, {"tiff", Icon::IMAGE}, {"bmp", Icon::IMAGE}, {"png", Icon::IMAGE},
+    {"tga", Icon::IMAGE}, {"jpg", Icon::IMAGE}, {"jpeg", Icon::IMAGE}, {"heic", Icon::IMAGE},
+    {"webp", Icon::IMAGE},
+    {"ai", Icon::ILLUSTRATOR}, {"ait", Icon::ILLUSTRATOR},
+    {"indd", Icon::INDESIGN},
+    {"jar", Icon::WEB_DATA}, {"java", Icon::WEB_DATA}, {"class", Icon::WEB_DATA}, {"html", Icon::WEB_DATA},
+    {"xml", Icon::WEB_DATA}, {"shtml", Icon::WEB_DATA}, {"dhtml", Icon::WEB_DATA}, {"js", Icon::WEB_DATA},
+    {"css", Icon::WEB_DATA},
+    {"pdf", Icon::PDF},
+    {"abr", Icon::PHOTOSHOP}, {"psb", Icon::PHOTOSHOP}, {"psd", Icon::PHOTOSHOP},
+    {"pps", Icon::POWERPOINT}, {"ppt", Icon::POWERPOINT}, {"pptx", Icon::POWERPOINT},
+    {"prproj", Icon::PREMIERE}, {"ppj", Icon::PREMIERE},
+    {"tif", Icon::RAW}, {"3fr", Icon::RAW}, {"arw", Icon::RAW}, {"bay", Icon::RAW}, {"cr2", Icon::RAW},
+    {"dcr", Icon::RAW}, {"dng", Icon::RAW}, {"fff", Icon::RAW}, {"mef", Icon::RAW}, {"mrw", Icon::RAW},
+    {"nef", Icon::RAW}, {"pef", Icon::RAW}, {"rw2", Icon::RAW}, {"srf", Icon::RAW}, {"orf", Icon::RAW},
+    {"rwl", Icon::RAW}, {"ari", Icon::RAW}, {"braw", Icon::RAW}, {"crw", Icon::RAW}, {"cr3", Icon::RAW},
+    {"cap", Icon::RAW}, {"dcs", Icon::RAW}, {"drf", Icon::RAW}, {"eip", Icon::RAW}, {"erf", Icon::RAW},
+    {"gpr", Icon::RAW}, {"iiq", Icon::RAW}, {"k25", Icon::RAW}, {"kdc", Icon::RAW}, {"mdc", Icon::RAW},
+    {"mos", Icon::RAW}, {"nrw", Icon::RAW}, {"obm", Icon::RAW}, {"ptx", Icon::RAW}, {"pxn", Icon::RAW},
+    {"r3d", Icon::RAW}, {"raf", Icon::RAW}, {"raw", Icon::RAW}, {"rwz", Icon::RAW}, {"sr2", Icon::RAW},
+    {"srw", Icon::RAW}, {"x3f", Icon::RAW},
+    {"ots", Icon::SPREADSHEET}, {"gsheet", Icon::SPREADSHEET}, {"nb", Icon::SPREADSHEET},
+    {"xlr", Icon::SPREADSHEET},
+    {"torrent", Icon::TORRENT},
+    {"dmg", Icon::DMG},
+    {"txt", Icon::TEXT}, {"rtf", Icon::TEXT}, {"ans", Icon::TEXT}, {"ascii", Icon::TEXT}, {"log", Icon::TEXT},
+    {"wpd", Icon::TEXT},
+    {"svgz", Icon::VECTOR}, {"svg", Icon::VECTOR}, {"cdr", Icon::VECTOR}, {"eps", Icon::VECTOR},
+    {"mkv", Icon::VIDEO}, {"webm", Icon::VIDEO}, {"avi", Icon::VIDEO}, {"mp4", Icon::VIDEO},
+    {"m4v", Icon::VIDEO}, {"mpg", Icon::VIDEO}, {"mpeg", Icon::VIDEO}, {"mov", Icon::VIDEO},
+    {"3g2", Icon::VIDEO}, {"3gp", Icon::VIDEO}, {"asf", Icon::VIDEO}, {"wmv", Icon::VIDEO},
+    {"flv", Icon::VIDEO}, {"vob", Icon::VIDEO},
+    {"doc", Icon::WORD}, {"docx", Icon::WORD}, {"dotx", Icon::WORD}, {"wps", Icon::WORD},
+    {"ods", Icon::OPENOFFICE}, {"odt", Icon::OPENOFFICE}, {"odp", Icon::OPENOFFICE},
+    {"odb", Icon::OPENOFFICE}, {"odg", Icon::OPENOFFICE},
+    {"sketch", Icon::SKETCH},
+    {"xd", Icon::EXPERIENCE_DESIGN},
+    {"pages", Icon::PAGES},
+    {"numbers", Icon::NUMBERS},
+    {"key", Icon::KEYNOTE},
+};
+constexpr std::size_t ENTRY_COUNT = sizeof(ENTRIES) / sizeof(ENTRIES[0]);
+
+// Hash and displace: the first hash picks a bucket, and the displacement of the bucket seeds the
+// second hash, which gives the slot. The displacements were found by trying values from 1 until
+// every extension of the bucket fell in a free slot, starting with the biggest buckets.
+// If the extensions change and the static_assert below fails, they have to be searched again
+constexpr std::size_t BUCKET_COUNT = 64;
+constexpr std::size_t SLOT_COUNT = 256;
+constexpr uint32_t DISPLACEMENTS[BUCKET_COUNT] = {
+    8, 5, 7, 1, 7, 2, 14, 3, 0, 2, 5, 2, 0, 0, 3, 1,
+    1, 4, 11, 2, 1, 2, 6, 1, 1, 1, 15, 7, 1, 6, 2, 2,
+    0, 28, 6, 1, 1, 1, 3, 1, 17, 5, 14, 4, 2, 3, 5, 0,
+    13, 0, 5, 1, 1, 5, 3, 21, 2, 3, 2, 1, 8, 5, 3, 4,
+};
+
+constexpr const char* ICON_FILE_NAMES[] = {
+    "generic.png",
+    "3D.png",
+    "aftereffects.png",
+    "audio.png",
+    "cad.png",
+    "compressed.png",
+    "web_lang.png",
+    "folder.png",
+    "excel.png",
+    "executable.png",
+    "font.png",
+    "image.png",
+    "illustrator.png",
+    "indesign.png",
+    "web_data.png",
+    "pdf.png",
+    "photoshop.png",
+    "powerpoint.png",
+    "premiere.png",
+    "raw.png",
+    "spreadsheet.png",
+    "torrent.png",
+    "dmg.png",
+    "text.png",
+    "vector.png",
+    "video.png",
+    "word.png",
+    "openoffice.png",
+    "sketch.png",
+    "experiencedesign.png",
+    "pages.png",
+    "numbers.png",
+    "keynote.png",
+};
+static_assert(sizeof(ICON_FILE_NAMES) / sizeof(ICON_FILE_NAMES[0]) == static_cast<std::size_t>(Icon::LAST),
+              "An icon without file name");
+
+constexpr uint32_t hash(const char* extension, std::size_t size, uint32_t seed)
+{
+    uint32_t value = 2166136261u ^ seed;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        value = (value ^ static_cast<unsigned char>(extension[i])) * 16777619u;
+    }
+    return value ^ (value >> 15);
+}
+
+constexpr std::size_t length(const char* text)
+{
+    std::size_t size = 0;
+    while (text[size])
+    {
+        ++size;
+    }
+    return size;
+}
+
+constexpr std::size_t slotOf(const char* extension, std::size_t size)
+{
+    return hash(extension, size, DISPLACEMENTS[hash(extension, size, 0) % BUCKET_COUNT]) % SLOT_COUNT;
+}
+
+struct Table
+{
+    // Index of the entry plus one, 0 for free slots
+    uint8_t slots[SLOT_COUNT];
+    bool perfect;
+};
+
+constexpr Table buildTable()
+{
+    Table table{};
+    table.perfect = true;
+    for (std::size_t i = 0; i < ENTRY_COUNT; ++i)
+    {
+        auto& slot = table.slots[slotOf(ENTRIES[i].extension, length(ENTRIES[i].extension))];
+        table.perfect = table.perfect && !slot;
+        slot = static_cast<uint8_t>(i + 1);
+    }
+    return table;
+}
+
+constexpr Table TABLE = buildTable();
+static_assert(ENTRY_COUNT < 256, "Slots hold the entry index in a byte");
+static_assert(TABLE.perfect, "Two extensions share a slot: search the displacements again");
+}
+
+FileExtensionTable::Icon FileExtensionTable::iconForExtension(const char* extension, std::size_t size)
+{
+    if (!size || size > MAX_EXTENSION_SIZE)
+    {
+        return Icon::GENERIC;
+    }
+
+    const auto index = TABLE.slots[slotOf(extension, size)];
+    if (!index)
+    {
+        return Icon::GENERIC;
+    }
+
+    const Entry& entry = ENTRIES[index - 1];
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (entry.extension[i] != extension[i])
+        {
+            return Icon::GENERIC;
+        }
+    }
+    return entry.extension[size] ? Icon::GENERIC : entry.icon;
+}
+
+const char* FileExtensionTable::iconFileName(Icon icon)
+{
+    return icon < Icon::LAST ? ICON_FILE_NAMES[static_cast<std::size_t>(icon)] : ICON_FILE_NAMES[0];
+}
+
+FileExtensionTable::Kind FileExtensionTable::kind(Icon icon)
+{
+    switch (icon)
+    {
+        case Icon::AUDIO:
+            return Kind::AUDIO;
+        case Icon::VIDEO:
+            return Kind::VIDEO;
+        case Icon::COMPRESSED:
+        case Icon::TORRENT:
+        case Icon::DMG:
+        case Icon::EXPERIENCE_DESIGN:
+        case Icon::SKETCH:
+            return Kind::ARCHIVE;
+        case Icon::TEXT:
+        case Icon::OPENOFFICE:
+        case Icon::PDF:
+        case Icon::WORD:
+        case Icon::POWERPOINT:
+        case Icon::PAGES:
+        case Icon::NUMBERS:
+        case Icon::KEYNOTE:
+        case Icon::WEB_DATA:
+        case Icon::EXCEL:
+            return Kind::DOCUMENT;
+        case Icon::IMAGE:
+        case Icon::ILLUSTRATOR:
+        case Icon::PHOTOSHOP:
+        case Icon::RAW:
+        case Icon::VECTOR:
+            return Kind::IMAGE;
+        default:
+            return Kind::OTHER;
+    }
+}
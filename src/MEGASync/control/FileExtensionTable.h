@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Icon and kind of a file from its extension.
+/// The known extensions are stored in a perfect hash table built at compile time, so a lookup
+/// hashes the extension once and compares it with a single entry, without allocating.
+class FileExtensionTable
+{
+public:
+    enum class Icon : uint8_t
+    {
+        GENERIC = 0,
+        THREE_D,
+        AFTER_EFFECTS,
+        AUDIO,
+        CAD,
+        COMPRESSED,
+        WEB_LANG,
+        FOLDER,
+        EXCEL,
+        EXECUTABLE,
+        FONT,
+        IMAGE,
+        ILLUSTRATOR,
+        INDESIGN,
+        WEB_DATA,
+        PDF,
+        PHOTOSHOP,
+        POWERPOINT,
+        PREMIERE,
+        RAW,
+        SPREADSHEET,
+        TORRENT,
+        DMG,
+        TEXT,
+        VECTOR,
+        VIDEO,
+        WORD,
+        OPENOFFICE,
+        SKETCH,
+        EXPERIENCE_DESIGN,
+        PAGES,
+        NUMBERS,
+        KEYNOTE,
+        LAST
+    };
+
+    enum class Kind : uint8_t
+    {
+        OTHER = 0,
+        AUDIO,
+        VIDEO,
+        ARCHIVE,
+        DOCUMENT,
+        IMAGE
+    };
+
+    static constexpr std::size_t MAX_EXTENSION_SIZE = 7;
+
+    /// Icon of the text after the last dot of the name, case insensitive.
+    /// Char is any type holding UTF-16 code units or ASCII characters
+    template <typename Char>
+    static Icon iconForFileName(const Char* fileName, std::size_t size)
+    {
+        char extension[MAX_EXTENSION_SIZE];
+        std::size_t extensionSize = 0;
+        for (std::size_t i = size; i-- > 0;)
+        {
+            const auto c = static_cast<uint32_t>(fileName[i]);
+            if (c == '.')
+            {
+                // Collected backwards
+                for (std::size_t j = 0; j < extensionSize / 2; ++j)
+                {
+                    const char swapped = extension[j];
+                    extension[j] = extension[extensionSize - 1 - j];
+                    extension[extensionSize - 1 - j] = swapped;
+                }
+                return iconForExtension(extension, extensionSize);
+            }
+
+            if (c == '/' || c == '\\' || c > 0x7f || extensionSize == MAX_EXTENSION_SIZE)
+            {
+                return Icon::GENERIC;
+            }
+            extension[extensionSize++] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+        return Icon::GENERIC;
+    }
+
+    /// extension in lower case, without the dot
+    static Icon iconForExtension(const char* extension, std::size_t size);
+    /// Name of the image of the icon, e.g. "audio.png"
+    static const char* iconFileName(Icon icon);
+    static Kind kind(Icon icon);
+};
@@ -166,16 +166,22 @@ LocalFileFolderAttributes::LocalFileFolderAttributes(const QString &path, QObjec
     : FileFolderAttributes(parent),
       mPath(path)
 {
-    connect(&mModifiedTimeWatcher, &QFutureWatcher<QDateTime>::finished,
-            this, &LocalFileFolderAttributes::onModifiedTimeCalculated);
-
-    connect(&mFolderSizeFuture, &QFutureWatcher<qint64>::finished,
-            this, &LocalFileFolderAttributes::onSizeCalculated);
-
     QDirIterator filesIt(mPath, QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
     mIsEmpty = !filesIt.hasNext();
 }
 
+LocalFileFolderAttributes::~LocalFileFolderAttributes()
+{
+    mScanToken.cancel();
+}
+
+void LocalFileFolderAttributes::cancel()
+{
+    FileFolderAttributes::cancel();
+    mScanToken.cancel();
+    mScanToken = ThreadPool::CancelToken();
+}
+
 void LocalFileFolderAttributes::requestSize(QObject* caller,std::function<void(qint64)> func)
 {
     FileFolderAttributes::requestSize(caller,func);
@@ -191,12 +197,39 @@ void LocalFileFolderAttributes::requestSize(QObject* caller,std::function<void(q
             }
             else
             {
-                if(mSize <= Status::NOT_READY)
+                if(!fileInfo.isReadable())
                 {
-                    auto future = QtConcurrent::run([this]() -> qint64{
-                        return calculateSize();
-                    });
-                    mFolderSizeFuture.setFuture(future);
+                    mSize = Status::NOT_READABLE;
+                }
+                else if(mSize <= Status::NOT_READY)
+                {
+                    QPointer<LocalFileFolderAttributes> thisPtr(this);
+                    FolderSizeScanner scanner(*ThreadPoolSingleton::getInstance(), Utilities::getFolderSizeCache());
+                    scanner.scanAsync({Utilities::toFolderSizePath(mPath)}, mScanToken,
+                        [thisPtr](const FolderSizeScanner::Result& partial)
+                        {//thread pool function, the size found so far
+                            Utilities::queueFunctionInAppThread([thisPtr, partial]()
+                            {//queued function
+                                if(thisPtr)
+                                {
+                                    thisPtr->onSizeProgress(partial.bytes);
+                                }
+                            });
+                        },
+                        [thisPtr](const FolderSizeScanner::Result& result)
+                        {//thread pool function
+                            if(result.complete)
+                            {
+                                Utilities::saveFolderSizeCache();
+                                Utilities::queueFunctionInAppThread([thisPtr, result]()
+                                {//queued function
+                                    if(thisPtr)
+                                    {
+                                        thisPtr->onSizeCalculated(result.bytes);
+                                    }
+                                });
+                            }
+                        });
                 }
             }
         }
@@ -233,10 +266,22 @@ void LocalFileFolderAttributes::requestModifiedTime(QObject* caller,std::functio
                 }
                 else
                 {
-                    auto future = QtConcurrent::run([this]() -> QDateTime{
-                        return calculateModifiedTime();
-                    });
-                    mModifiedTimeWatcher.setFuture(future);
+                    QPointer<LocalFileFolderAttributes> thisPtr(this);
+                    auto path(mPath);
+                    ThreadPoolSingleton::getInstance()->push([thisPtr, path]()
+                    {//thread pool function
+                        auto modifiedTime = calculateModifiedTime(path);
+                        if(!ThreadPool::isThreadInterrupted())
+                        {
+                            Utilities::queueFunctionInAppThread([thisPtr, modifiedTime]()
+                            {//queued function
+                                if(thisPtr)
+                                {
+                                    thisPtr->onModifiedTimeCalculated(modifiedTime);
+                                }
+                            });
+                        }
+                    }, ThreadPool::Priority::BACKGROUND, mScanToken);
                 }
             }
         }
@@ -246,21 +291,30 @@ void LocalFileFolderAttributes::requestModifiedTime(QObject* caller,std::functio
     emit modifiedTimeReady(mModifiedTime);
 }
 
-void LocalFileFolderAttributes::onModifiedTimeCalculated()
+void LocalFileFolderAttributes::onModifiedTimeCalculated(const QDateTime& modifiedTime)
 {
-    mModifiedTime = mModifiedTimeWatcher.result();
+    mModifiedTime = modifiedTime;
     if(mModifiedTime.isValid())
     {
         emit modifiedTimeReady(mModifiedTime);
     }
 }
 
-void LocalFileFolderAttributes::onSizeCalculated()
+void LocalFileFolderAttributes::onSizeCalculated(qint64 size)
 {
-    mSize = mFolderSizeFuture.result();
+    mSize = size;
     emit sizeReady(mSize);
 }
 
+void LocalFileFolderAttributes::onSizeProgress(qint64 partialSize)
+{
+    //The size is not kept until the scan finishes, a cancelled scan starts again on the next request
+    if(mSize <= Status::NOT_READY)
+    {
+        emit sizeReady(partialSize);
+    }
+}
+
 void LocalFileFolderAttributes::requestCreatedTime(QObject* caller,std::function<void(const QDateTime&)> func)
 {
     //Created time not available for LINUX
@@ -314,8 +368,31 @@ void LocalFileFolderAttributes::requestCRC(QObject *caller, std::function<void (
         {
             if(fileInfo.isFile())
             {
-                std::unique_ptr<char[]> crc(MegaSyncApp->getMegaApi()->getCRC(QDir::toNativeSeparators(fileInfo.filePath()).toUtf8().constData()));
-                mFp = QString::fromUtf8(crc.get());
+                QString crc;
+                if(Utilities::findCachedFileDigest(mPath, FileHashCache::Digest::CRC, crc))
+                {
+                    mFp = crc;
+                }
+                else
+                {
+                    QPointer<LocalFileFolderAttributes> thisPtr(this);
+                    auto path(mPath);
+                    ThreadPoolSingleton::getInstance()->push([thisPtr, path]()
+                    {//thread pool function
+                        auto crc = Utilities::getFileCRC(path);
+                        if(!ThreadPool::isThreadInterrupted())
+                        {
+                            Utilities::queueFunctionInAppThread([thisPtr, crc]()
+                            {//queued function
+                                if(thisPtr)
+                                {
+                                    thisPtr->onCRCCalculated(crc);
+                                }
+                            });
+                        }
+                    }, ThreadPool::Priority::INTERACTIVE, mScanToken);
+                    return;
+                }
             }
 
         }
@@ -324,14 +401,20 @@ void LocalFileFolderAttributes::requestCRC(QObject *caller, std::function<void (
     }
 }
 
-QDateTime LocalFileFolderAttributes::calculateModifiedTime()
+void LocalFileFolderAttributes::onCRCCalculated(const QString& crc)
+{
+    mFp = crc;
+    emit CRCReady(mFp);
+}
+
+QDateTime LocalFileFolderAttributes::calculateModifiedTime(const QString& path)
 {
     QDateTime newDate;
-    QDirIterator filesIt(mPath, QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    QDirIterator filesIt(path, QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
 
     while (filesIt.hasNext())
     {
-        if(mCancelled)
+        if(ThreadPool::isThreadInterrupted())
         {
             break;
         }
@@ -346,29 +429,6 @@ QDateTime LocalFileFolderAttributes::calculateModifiedTime()
     return newDate;
 }
 
-qint64 LocalFileFolderAttributes::calculateSize()
-{
-    qint64 newSize(0);
-
-    QFileInfo fileInfo(mPath);
-    if(!fileInfo.isReadable())
-    {
-        newSize = NOT_READABLE;
-    }
-    if(!mPath.isEmpty() && fileInfo.exists())
-    {
-        QDirIterator filesIt(mPath, QDir::Files| QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Hidden, QDirIterator::Subdirectories);
-
-        while (filesIt.hasNext())
-        {
-            filesIt.next();
-            newSize += filesIt.fileInfo().size();
-        }
-    }
-
-    return newSize;
-}
-
 void LocalFileFolderAttributes::setPath(const QString &newPath)
 {
     if(mPath != newPath)
@@ -2,9 +2,9 @@
 #define FILEFOLDERATTRIBUTES_H
 
 #include <QTMegaRequestListener.h>
+#include "ThreadPool.h"
 
 #include <QDateTime>
-#include <QFutureWatcher>
 
 #include <functional>
 #include <memory>
@@ -52,7 +52,7 @@ public:
     virtual void requestCreatedTime(QObject *caller, std::function<void(const QDateTime&)> func);
     virtual void requestCRC(QObject* caller,std::function<void(const QString&)> func);
 
-    void cancel();
+    virtual void cancel();
 
     template <class Type>
     static std::shared_ptr<Type> convert(std::shared_ptr<FileFolderAttributes> attributes)
@@ -116,25 +116,27 @@ class LocalFileFolderAttributes : public FileFolderAttributes
 
 public:
     LocalFileFolderAttributes(const QString& path, QObject* parent);
-    ~LocalFileFolderAttributes() override = default;
+    ~LocalFileFolderAttributes() override;
 
     void requestSize(QObject* caller,std::function<void(qint64)> func) override;
     void requestModifiedTime(QObject* caller,std::function<void(const QDateTime&)> func) override;
     void requestCreatedTime(QObject* caller,std::function<void(const QDateTime&)> func) override;
     void requestCRC(QObject* caller,std::function<void(const QString&)> func) override;
 
+    void cancel() override;
+
     void setPath(const QString &newPath);
 
-private slots:
-    void onModifiedTimeCalculated();
-    void onSizeCalculated();
-    
 private:
-    QDateTime calculateModifiedTime();
-    qint64 calculateSize();
+    void onModifiedTimeCalculated(const QDateTime& modifiedTime);
+    void onSizeCalculated(qint64 size);
+    void onSizeProgress(qint64 partialSize);
+    void onCRCCalculated(const QString& crc);
+
+    //Run in the thread pool as background tasks, they stop when the scan token is cancelled
+    static QDateTime calculateModifiedTime(const QString& path);
 
-    QFutureWatcher<qint64> mFolderSizeFuture;
-    QFutureWatcher<QDateTime> mModifiedTimeWatcher;
+    ThreadPool::CancelToken mScanToken;
     QString mPath;
     bool mIsEmpty;
 };
@@ -0,0 +1,381 @@
+#include "FileHashCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr std::size_t FileHashCache::DEFAULT_SLOTS;
+constexpr std::size_t FileHashCache::MAX_DIGEST_SIZE;
+constexpr std::size_t FileHashCache::DIGESTS;
+constexpr std::size_t FileHashCache::PROBE_LENGTH;
+
+namespace
+{
+constexpr char CACHE_FILE_MAGIC[4] = {'M', 'S', 'H', 'C'};
+constexpr std::uint32_t CACHE_FILE_VERSION = 1;
+constexpr std::uint32_t SLOT_USED = 1;
+
+std::uint64_t mix(std::uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+#ifdef WIN32
+std::int64_t toInt64(const LARGE_INTEGER& value)
+{
+    return static_cast<std::int64_t>(value.QuadPart);
+}
+#endif
+}
+
+bool FileIdentity::operator==(const FileIdentity& other) const
+{
+    return device == other.device && inode == other.inode && size == other.size
+           && modifiedTime == other.modifiedTime && changeTime == other.changeTime;
+}
+
+#ifdef WIN32
+bool FileIdentity::read(const FileHashPath& path, FileIdentity& identity)
+{
+    HANDLE handle = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    BY_HANDLE_FILE_INFORMATION data;
+    FILE_BASIC_INFO basic;
+    bool ok = GetFileInformationByHandle(handle, &data) != 0
+              && GetFileInformationByHandleEx(handle, FileBasicInfo, &basic, sizeof(basic)) != 0;
+    CloseHandle(handle);
+    if (!ok || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        return false;
+    }
+
+    identity.device = data.dwVolumeSerialNumber;
+    identity.inode = (static_cast<std::uint64_t>(data.nFileIndexHigh) << 32) | data.nFileIndexLow;
+    identity.size = (static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    identity.modifiedTime = toInt64(basic.LastWriteTime);
+    identity.changeTime = toInt64(basic.ChangeTime);
+    return true;
+}
+#else
+bool FileIdentity::read(const FileHashPath& path, FileIdentity& identity)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) || !S_ISREG(st.st_mode))
+    {
+        return false;
+    }
+
+    identity.device = static_cast<std::uint64_t>(st.st_dev);
+    identity.inode = static_cast<std::uint64_t>(st.st_ino);
+    identity.size = static_cast<std::uint64_t>(st.st_size);
+#ifdef __APPLE__
+    identity.modifiedTime = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+    identity.changeTime = static_cast<std::int64_t>(st.st_ctimespec.tv_sec) * 1000000000 + st.st_ctimespec.tv_nsec;
+#else
+    identity.modifiedTime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    identity.changeTime = static_cast<std::int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+#endif
+    return true;
+}
+#endif
+
+FileHashCache::FileHashCache(std::size_t slots)
+    : mSlotCount(std::max(slots, PROBE_LENGTH)),
+      mData(nullptr),
+      mDataSize(sizeof(Header) + mSlotCount * sizeof(Slot)),
+      mHeader(nullptr),
+      mSlots(nullptr),
+#ifdef WIN32
+      mFile(INVALID_HANDLE_VALUE),
+      mMapping(nullptr)
+#else
+      mFile(-1)
+#endif
+{
+    static_assert(sizeof(Header) % alignof(Slot) == 0, "Slots must be aligned");
+
+    mMemory.assign(mDataSize, 0);
+    mData = mMemory.data();
+    unmap();
+}
+
+FileHashCache::~FileHashCache()
+{
+    unmap();
+}
+
+bool FileHashCache::open(const FileHashPath& path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    unmap();
+
+    char* data = nullptr;
+#ifdef WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    bool sizeMatches = GetFileSizeEx(file, &fileSize) && static_cast<std::size_t>(fileSize.QuadPart) == mDataSize;
+    if (!sizeMatches)
+    {
+        // Truncated first, so that no old bytes remain
+        LARGE_INTEGER position;
+        position.QuadPart = 0;
+        LARGE_INTEGER newSize;
+        newSize.QuadPart = static_cast<LONGLONG>(mDataSize);
+        if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file)
+            || !SetFilePointerEx(file, newSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+        {
+            CloseHandle(file);
+            return false;
+        }
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (mapping)
+    {
+        data = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, mDataSize));
+    }
+    if (!data)
+    {
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    mFile = file;
+    mMapping = mapping;
+#else
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    bool sizeMatches = !fstat(file, &st) && static_cast<std::size_t>(st.st_size) == mDataSize;
+    if (!sizeMatches && (ftruncate(file, 0) || ftruncate(file, static_cast<off_t>(mDataSize))))
+    {
+        close(file);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, mDataSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (mapped == MAP_FAILED)
+    {
+        close(file);
+        return false;
+    }
+    data = static_cast<char*>(mapped);
+    mFile = file;
+#endif
+
+    mData = data;
+    mHeader = reinterpret_cast<Header*>(mData);
+    mSlots = reinterpret_cast<Slot*>(mData + sizeof(Header));
+    if (memcmp(mHeader->magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) || mHeader->version != CACHE_FILE_VERSION
+        || mHeader->slots != mSlotCount)
+    {
+        initialize();
+    }
+    return true;
+}
+
+bool FileHashCache::isMapped() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mData != mMemory.data();
+}
+
+bool FileHashCache::find(const FileIdentity& identity, Digest digest, std::string& value)
+{
+    const std::size_t index = static_cast<std::size_t>(digest);
+    if (index >= DIGESTS)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (std::size_t probe = 0; probe < PROBE_LENGTH; ++probe)
+    {
+        Slot& slot = mSlots[position(identity, probe)];
+        if (!isValid(slot) || slot.identity.device != identity.device || slot.identity.inode != identity.inode)
+        {
+            continue;
+        }
+
+        // Only one slot per file: another identity means that the file changed
+        if (slot.identity != identity || !slot.lengths[index])
+        {
+            return false;
+        }
+
+        value.assign(slot.digests[index], slot.lengths[index]);
+        slot.lastUse = ++mHeader->clock;
+        seal(slot);
+        return true;
+    }
+    return false;
+}
+
+void FileHashCache::store(const FileIdentity& identity, Digest digest, const std::string& value)
+{
+    const std::size_t index = static_cast<std::size_t>(digest);
+    if (index >= DIGESTS || value.empty() || value.size() > MAX_DIGEST_SIZE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Slot* target = nullptr;
+    Slot* freeSlot = nullptr;
+    Slot* oldest = nullptr;
+    for (std::size_t probe = 0; probe < PROBE_LENGTH; ++probe)
+    {
+        Slot& slot = mSlots[position(identity, probe)];
+        if (!isValid(slot))
+        {
+            freeSlot = freeSlot ? freeSlot : &slot;
+            continue;
+        }
+        if (slot.identity.device == identity.device && slot.identity.inode == identity.inode)
+        {
+            target = &slot;
+            break;
+        }
+        if (!oldest || slot.lastUse < oldest->lastUse)
+        {
+            oldest = &slot;
+        }
+    }
+
+    if (!target || target->identity != identity)
+    {
+        target = target ? target : (freeSlot ? freeSlot : oldest);
+        memset(static_cast<void*>(target), 0, sizeof(Slot));
+        target->identity = identity;
+    }
+
+    // Invalid until sealed again, in case the process dies in between
+    target->used = 0;
+    memcpy(target->digests[index], value.data(), value.size());
+    target->lengths[index] = static_cast<std::uint8_t>(value.size());
+    target->lastUse = ++mHeader->clock;
+    target->used = SLOT_USED;
+    seal(*target);
+}
+
+void FileHashCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    memset(static_cast<void*>(mSlots), 0, mSlotCount * sizeof(Slot));
+    mHeader->clock = 0;
+}
+
+std::size_t FileHashCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < mSlotCount; ++i)
+    {
+        count += isValid(mSlots[i]) ? 1 : 0;
+    }
+    return count;
+}
+
+std::uint32_t FileHashCache::checksum(const Slot& slot)
+{
+    // FNV-1a of everything before the checksum
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&slot);
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < offsetof(Slot, checksum); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool FileHashCache::isValid(const Slot& slot) const
+{
+    if (slot.used != SLOT_USED || slot.checksum != checksum(slot))
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < DIGESTS; ++i)
+    {
+        if (slot.lengths[i] > MAX_DIGEST_SIZE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FileHashCache::seal(Slot& slot)
+{
+    slot.checksum = checksum(slot);
+}
+
+std::size_t FileHashCache::position(const FileIdentity& identity, std::size_t probe) const
+{
+    const std::uint64_t hash = mix(identity.inode ^ mix(identity.device));
+    return static_cast<std::size_t>((hash + probe) % mSlotCount);
+}
+
+void FileHashCache::unmap()
+{
+    if (mData != mMemory.data())
+    {
+#ifdef WIN32
+        UnmapViewOfFile(mData);
+        CloseHandle(mMapping);
+        CloseHandle(mFile);
+        mMapping = nullptr;
+        mFile = INVALID_HANDLE_VALUE;
+#else
+        munmap(mData, mDataSize);
+        close(mFile);
+        mFile = -1;
+#endif
+    }
+
+    mData = mMemory.data();
+    mHeader = reinterpret_cast<Header*>(mData);
+    mSlots = reinterpret_cast<Slot*>(mData + sizeof(Header));
+    initialize();
+}
+
+void FileHashCache::initialize()
+{
+    memset(mData, 0, mDataSize);
+    memcpy(mHeader->magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    mHeader->version = CACHE_FILE_VERSION;
+    mHeader->slots = mSlotCount;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Digests of local files, kept between executions in a memory mapped table.
+//
+// Entries are keyed by the identity of the file version: device, inode (file index on Windows),
+// size, modification time and status change time. The change time is updated by the system on
+// any write or attribute change, including setting the modification time back, so a file cannot
+// be modified without changing its identity. An entry is replaced as soon as the same file is
+// stored with another identity.
+//
+// The table has a fixed number of slots, so the file never grows: a new entry takes a free slot
+// near its hash position or the least recently used one. Every slot has a checksum, so a slot
+// half written when the process died is read as empty. When the file cannot be mapped the table
+// lives in memory only.
+
+#ifdef WIN32
+using FileHashPath = std::wstring;
+#else
+using FileHashPath = std::string;
+#endif
+
+struct FileIdentity
+{
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    std::int64_t modifiedTime = 0; // In the units of the system: ns, or 100 ns on Windows
+    std::int64_t changeTime = 0;
+
+    bool operator==(const FileIdentity& other) const;
+    bool operator!=(const FileIdentity& other) const {return !(*this == other);}
+
+    // False when the path is not a regular file
+    static bool read(const FileHashPath& path, FileIdentity& identity);
+};
+
+class FileHashCache
+{
+public:
+    enum class Digest
+    {
+        SHA256 = 0, // Hexadecimal SHA-256 of the contents
+        CRC,        // Fingerprint CRC of the SDK
+        LAST
+    };
+
+    static constexpr std::size_t DEFAULT_SLOTS = 8192;
+    static constexpr std::size_t MAX_DIGEST_SIZE = 64;
+
+    explicit FileHashCache(std::size_t slots = DEFAULT_SLOTS);
+    ~FileHashCache();
+
+    FileHashCache(const FileHashCache&) = delete;
+    FileHashCache& operator=(const FileHashCache&) = delete;
+
+    // Maps the table stored in path, creating or resetting it when it is missing or has another
+    // format. Entries stored in memory before are discarded. False if the table stays in memory
+    bool open(const FileHashPath& path);
+    bool isMapped() const;
+
+    bool find(const FileIdentity& identity, Digest digest, std::string& value);
+    // Values longer than MAX_DIGEST_SIZE are not stored
+    void store(const FileIdentity& identity, Digest digest, const std::string& value);
+    void clear();
+    std::size_t size() const;
+
+private:
+    static constexpr std::size_t DIGESTS = static_cast<std::size_t>(Digest::LAST);
+    static constexpr std::size_t PROBE_LENGTH = 8;
+
+    struct Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t slots;
+        std::uint64_t clock;
+    };
+
+    struct Slot
+    {
+        FileIdentity identity;
+        std::uint64_t lastUse;
+        std::uint8_t lengths[DIGESTS];
+        char digests[DIGESTS][MAX_DIGEST_SIZE];
+        std::uint32_t used;
+        std::uint32_t checksum;
+    };
+
+    static std::uint32_t checksum(const Slot& slot);
+    bool isValid(const Slot& slot) const;
+    void seal(Slot& slot);
+    std::size_t position(const FileIdentity& identity, std::size_t probe) const;
+    void unmap();
+    void initialize();
+
+    const std::size_t mSlotCount;
+    mutable std::mutex mMutex;
+    std::vector<char> mMemory;
+    char* mData;
+    std::size_t mDataSize;
+    Header* mHeader;
+    Slot* mSlots;
+#ifdef WIN32
+    void* mFile;
+    void* mMapping;
+#else
+    int mFile;
+#endif
+};
@@ -0,0 +1,666 @@
+#include "FolderSizeScanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <unordered_set>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr std::size_t FolderSizeCache::DEFAULT_MAX_FOLDERS;
+constexpr int FolderSizeScanner::PROGRESS_INTERVAL_MS;
+
+namespace
+{
+constexpr std::uint32_t CACHE_FILE_MAGIC = 0x4346534d; // "MSFC"
+constexpr std::uint32_t CACHE_FILE_VERSION = 2;
+
+FILE* openFile(const FolderSizePath& path, bool write)
+{
+#ifdef WIN32
+    FILE* file = nullptr;
+    return _wfopen_s(&file, path.c_str(), write ? L"wb" : L"rb") ? nullptr : file;
+#else
+    return fopen(path.c_str(), write ? "wb" : "rb");
+#endif
+}
+
+bool replaceFile(const FolderSizePath& from, const FolderSizePath& to)
+{
+#ifdef WIN32
+    return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+template <typename T>
+bool writeValue(FILE* file, const T& value)
+{
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+template <typename T>
+bool readValue(FILE* file, T& value)
+{
+    return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+bool writeNames(FILE* file, const std::vector<FolderSizePath>& names)
+{
+    bool ok = writeValue(file, static_cast<std::uint32_t>(names.size()));
+    for (auto name = names.begin(); ok && name != names.end(); ++name)
+    {
+        ok = writeValue(file, static_cast<std::uint32_t>(name->size()))
+             && (name->empty() || fwrite(name->data(), sizeof(FolderSizePath::value_type), name->size(), file) == name->size());
+    }
+    return ok;
+}
+
+bool readNames(FILE* file, std::vector<FolderSizePath>& names)
+{
+    std::uint32_t count = 0;
+    bool ok = readValue(file, count);
+    for (std::uint32_t index = 0; ok && index < count; ++index)
+    {
+        std::uint32_t length = 0;
+        ok = readValue(file, length) && length < 32768;
+        if (ok)
+        {
+            FolderSizePath name(length, FolderSizePath::value_type());
+            ok = !length || fread(&name[0], sizeof(FolderSizePath::value_type), length, file) == length;
+            names.push_back(std::move(name));
+        }
+    }
+    return ok;
+}
+
+std::int64_t steadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct FileIdentity
+{
+    std::uint64_t device;
+    std::uint64_t inode;
+    bool operator==(const FileIdentity& other) const {return device == other.device && inode == other.inode;}
+};
+
+struct FileIdentityHash
+{
+    std::size_t operator()(const FileIdentity& identity) const
+    {
+        return std::hash<std::uint64_t>()(identity.inode * 31 + identity.device);
+    }
+};
+
+enum class EntryKind
+{
+    OTHER,
+    FILE,
+    FOLDER
+};
+
+// What the scan needs to know about a path, without following links
+struct EntryInfo
+{
+    EntryKind kind = EntryKind::OTHER;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::int64_t modifiedTime = 0;
+    long long size = 0;
+    bool hasSeveralLinks = false;
+};
+
+#ifdef WIN32
+const FolderSizePath PATH_SEPARATOR(L"\\");
+const FolderSizePath PART_SUFFIX(L".part");
+
+bool getEntryInfo(const FolderSizePath& path, EntryInfo& info)
+{
+    HANDLE handle = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_REPARSE_POINT, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    BY_HANDLE_FILE_INFORMATION data;
+    bool ok = GetFileInformationByHandle(handle, &data) != 0;
+    CloseHandle(handle);
+    if (!ok)
+    {
+        return false;
+    }
+
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+    {
+        info.kind = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? EntryKind::FOLDER : EntryKind::FILE;
+    }
+    info.device = data.dwVolumeSerialNumber;
+    info.inode = (static_cast<std::uint64_t>(data.nFileIndexHigh) << 32) | data.nFileIndexLow;
+    info.modifiedTime = static_cast<std::int64_t>((static_cast<std::uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32)
+                                                  | data.ftLastWriteTime.dwLowDateTime);
+    info.size = static_cast<long long>((static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow);
+    info.hasSeveralLinks = data.nNumberOfLinks > 1;
+    return true;
+}
+
+// Hard links are not detected while listing: that would need opening every file
+bool readFolder(const FolderSizePath& path, FolderSizeCache::Folder& folder)
+{
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileExW((path + L"\\*").c_str(), FindExInfoBasic, &data,
+                                   FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    do
+    {
+        const FolderSizePath name(data.cFileName);
+        if (name == L"." || name == L".." || (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        {
+            continue;
+        }
+
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            folder.subfolders.push_back(name);
+        }
+        else
+        {
+            folder.bytes += static_cast<long long>((static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow);
+            ++folder.files;
+            folder.fileNames.push_back(name);
+        }
+    } while (FindNextFileW(find, &data));
+
+    FindClose(find);
+    return true;
+}
+
+// FindFirstFileEx returns the sizes with the names: listing the folder again is cheaper than
+// opening its files one by one
+bool refreshFiles(const FolderSizePath& path, FolderSizeCache::Folder& folder)
+{
+    FolderSizeCache::Folder listed;
+    if (!readFolder(path, listed))
+    {
+        return false;
+    }
+    listed.modifiedTime = folder.modifiedTime;
+    folder = std::move(listed);
+    return true;
+}
+#else
+const FolderSizePath PATH_SEPARATOR("/");
+const FolderSizePath PART_SUFFIX(".part");
+
+void fillEntryInfo(const struct stat& st, EntryInfo& info)
+{
+    if (S_ISREG(st.st_mode))
+    {
+        info.kind = EntryKind::FILE;
+    }
+    else if (S_ISDIR(st.st_mode))
+    {
+        info.kind = EntryKind::FOLDER;
+    }
+    info.device = static_cast<std::uint64_t>(st.st_dev);
+    info.inode = static_cast<std::uint64_t>(st.st_ino);
+#ifdef __APPLE__
+    info.modifiedTime = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    info.modifiedTime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    info.size = static_cast<long long>(st.st_size);
+    info.hasSeveralLinks = st.st_nlink > 1;
+}
+
+void addFile(const EntryInfo& info, FolderSizeCache::Folder& folder)
+{
+    ++folder.files;
+    if (info.hasSeveralLinks)
+    {
+        folder.hardLinks.push_back(FolderSizeCache::HardLink{info.device, info.inode, info.size});
+    }
+    else
+    {
+        folder.bytes += info.size;
+    }
+}
+
+bool getEntryInfo(const FolderSizePath& path, EntryInfo& info)
+{
+    struct stat st;
+    if (lstat(path.c_str(), &st))
+    {
+        return false;
+    }
+    fillEntryInfo(st, info);
+    return true;
+}
+
+// readdir gets the entries in big getdents batches; files are stat'ed relative to the folder
+// descriptor, folders are recognized from d_type without a stat when the filesystem gives it
+bool readFolder(const FolderSizePath& path, FolderSizeCache::Folder& folder)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    DIR* dir = fdopendir(fd);
+    if (!dir)
+    {
+        close(fd);
+        return false;
+    }
+
+    while (struct dirent* entry = readdir(dir))
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+        {
+            continue;
+        }
+
+        if (entry->d_type == DT_DIR)
+        {
+            folder.subfolders.emplace_back(name);
+            continue;
+        }
+
+        if (entry->d_type != DT_REG && entry->d_type != DT_UNKNOWN)
+        {
+            continue;
+        }
+
+        struct stat st;
+        if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW))
+        {
+            continue;
+        }
+
+        EntryInfo info;
+        fillEntryInfo(st, info);
+        if (info.kind == EntryKind::FOLDER)
+        {
+            folder.subfolders.emplace_back(name);
+        }
+        else if (info.kind == EntryKind::FILE)
+        {
+            addFile(info, folder);
+            folder.fileNames.emplace_back(name);
+        }
+    }
+
+    closedir(dir);
+    return true;
+}
+
+// Gets the current sizes of the files of a cached listing, relative to the folder descriptor.
+// Files removed since the listing are skipped, the next change of the folder lists it again
+bool refreshFiles(const FolderSizePath& path, FolderSizeCache::Folder& folder)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    folder.bytes = 0;
+    folder.files = 0;
+    folder.hardLinks.clear();
+    for (const auto& name : folder.fileNames)
+    {
+        struct stat st;
+        if (fstatat(fd, name.c_str(), &st, AT_SYMLINK_NOFOLLOW))
+        {
+            continue;
+        }
+
+        EntryInfo info;
+        fillEntryInfo(st, info);
+        if (info.kind == EntryKind::FILE)
+        {
+            addFile(info, folder);
+        }
+    }
+
+    close(fd);
+    return true;
+}
+#endif
+}
+
+//////////////////////////////////////////////////
+FolderSizeCache::FolderSizeCache(std::size_t maxFolders)
+    : mMaxFolders(std::max<std::size_t>(maxFolders, 1))
+{
+}
+
+bool FolderSizeCache::find(std::uint64_t device, std::uint64_t inode, std::int64_t modifiedTime, Folder& folder) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mFolders.find(Key{device, inode});
+    if (it == mFolders.end() || it->second.modifiedTime != modifiedTime)
+    {
+        return false;
+    }
+    folder = it->second;
+    return true;
+}
+
+void FolderSizeCache::store(std::uint64_t device, std::uint64_t inode, const Folder& folder)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Key key{device, inode};
+    if (mFolders.size() >= mMaxFolders && !mFolders.count(key))
+    {
+        mFolders.clear();
+    }
+    mFolders[key] = folder;
+}
+
+void FolderSizeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFolders.clear();
+}
+
+std::size_t FolderSizeCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFolders.size();
+}
+
+bool FolderSizeCache::load(const FolderSizePath& path)
+{
+    FILE* file = openFile(path, false);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::unordered_map<Key, Folder, KeyHash> folders;
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t count = 0;
+    bool ok = readValue(file, magic) && magic == CACHE_FILE_MAGIC
+              && readValue(file, version) && version == CACHE_FILE_VERSION
+              && readValue(file, count) && count <= mMaxFolders;
+
+    for (std::uint64_t i = 0; ok && i < count; ++i)
+    {
+        Key key;
+        Folder folder;
+        std::uint32_t hardLinks = 0;
+        ok = readValue(file, key.device) && readValue(file, key.inode)
+             && readValue(file, folder.modifiedTime) && readValue(file, folder.bytes)
+             && readValue(file, folder.files) && readValue(file, hardLinks);
+
+        for (std::uint32_t link = 0; ok && link < hardLinks; ++link)
+        {
+            FolderSizeCache::HardLink hardLink;
+            ok = readValue(file, hardLink.device) && readValue(file, hardLink.inode) && readValue(file, hardLink.size);
+            folder.hardLinks.push_back(hardLink);
+        }
+
+        ok = ok && readNames(file, folder.subfolders) && readNames(file, folder.fileNames);
+
+        if (ok)
+        {
+            folders[key] = std::move(folder);
+        }
+    }
+    fclose(file);
+
+    if (ok)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFolders = std::move(folders);
+    }
+    return ok;
+}
+
+bool FolderSizeCache::save(const FolderSizePath& path) const
+{
+    const FolderSizePath partPath(path + PART_SUFFIX);
+    FILE* file = openFile(partPath, true);
+    if (!file)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ok = writeValue(file, CACHE_FILE_MAGIC) && writeValue(file, CACHE_FILE_VERSION)
+             && writeValue(file, static_cast<std::uint64_t>(mFolders.size()));
+
+        for (auto it = mFolders.begin(); ok && it != mFolders.end(); ++it)
+        {
+            const auto& folder = it->second;
+            ok = writeValue(file, it->first.device) && writeValue(file, it->first.inode)
+                 && writeValue(file, folder.modifiedTime) && writeValue(file, folder.bytes)
+                 && writeValue(file, folder.files) && writeValue(file, static_cast<std::uint32_t>(folder.hardLinks.size()));
+
+            for (auto link = folder.hardLinks.begin(); ok && link != folder.hardLinks.end(); ++link)
+            {
+                ok = writeValue(file, link->device) && writeValue(file, link->inode) && writeValue(file, link->size);
+            }
+
+            ok = ok && writeNames(file, folder.subfolders) && writeNames(file, folder.fileNames);
+        }
+    }
+
+    ok = !fclose(file) && ok;
+    return ok && replaceFile(partPath, path);
+}
+
+//////////////////////////////////////////////////
+struct FolderSizeScanner::Scan
+{
+    ThreadPool* pool;
+    std::shared_ptr<FolderSizeCache> cache;
+    ThreadPool::CancelToken token;
+    ProgressCallback progress;
+    DoneCallback done;
+
+    std::atomic<long long> bytes {0};
+    std::atomic<long long> files {0};
+    std::atomic<long long> folders {0};
+    std::atomic<long long> cachedFolders {0};
+    std::atomic<long long> pendingFolders {0};
+    std::atomic<std::int64_t> nextProgressMs {0};
+
+    std::mutex hardLinksMutex;
+    std::unordered_set<FileIdentity, FileIdentityHash> hardLinks;
+
+    bool isCancelled() const
+    {
+        return token.isCancelled() || ThreadPool::isThreadInterrupted();
+    }
+
+    Result result(bool complete) const
+    {
+        Result result;
+        result.bytes = bytes;
+        result.files = files;
+        result.folders = folders;
+        result.cachedFolders = cachedFolders;
+        result.complete = complete;
+        return result;
+    }
+};
+
+FolderSizeScanner::FolderSizeScanner(ThreadPool& pool, std::shared_ptr<FolderSizeCache> cache)
+    : mPool(pool),
+      mCache(std::move(cache))
+{
+}
+
+void FolderSizeScanner::scanAsync(const std::vector<FolderSizePath>& roots,
+                                  ThreadPool::CancelToken token,
+                                  ProgressCallback progress,
+                                  DoneCallback done) const
+{
+    auto scan = std::make_shared<Scan>();
+    scan->pool = &mPool;
+    scan->cache = mCache;
+    scan->token = token;
+    scan->progress = std::move(progress);
+    scan->done = std::move(done);
+    scan->nextProgressMs = steadyNowMs() + PROGRESS_INTERVAL_MS;
+
+    if (roots.empty())
+    {
+        if (scan->done)
+        {
+            scan->done(scan->result(true));
+        }
+        return;
+    }
+
+    scan->pendingFolders = static_cast<long long>(roots.size());
+    for (const auto& root : roots)
+    {
+        // The tasks are not pushed with the token: dropping them would leave the scan unfinished
+        mPool.push([scan, root]() { scanFolder(scan, root); }, ThreadPool::Priority::BACKGROUND);
+    }
+}
+
+FolderSizeScanner::Result FolderSizeScanner::scan(const std::vector<FolderSizePath>& roots,
+                                                  ThreadPool::CancelToken token,
+                                                  ProgressCallback progress) const
+{
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    scanAsync(roots, token, std::move(progress), [promise](const Result& result)
+    {
+        promise->set_value(result);
+    });
+    return future.get();
+}
+
+std::shared_ptr<FolderSizeCache> FolderSizeScanner::sharedCache()
+{
+    static auto cache = std::make_shared<FolderSizeCache>();
+    return cache;
+}
+
+void FolderSizeScanner::scanFolder(const std::shared_ptr<Scan>& scan, const FolderSizePath& path)
+{
+    EntryInfo info;
+    if (!scan->isCancelled() && getEntryInfo(path, info))
+    {
+        if (info.kind == EntryKind::FILE)
+        {
+            FolderSizeCache::Folder file;
+            file.files = 1;
+            if (info.hasSeveralLinks)
+            {
+                file.hardLinks.push_back(FolderSizeCache::HardLink{info.device, info.inode, info.size});
+            }
+            else
+            {
+                file.bytes = info.size;
+            }
+            addFolder(*scan, file);
+        }
+        else if (info.kind == EntryKind::FOLDER)
+        {
+            FolderSizeCache::Folder folder;
+            if (scan->cache && scan->cache->find(info.device, info.inode, info.modifiedTime, folder))
+            {
+                const auto cachedBytes = folder.bytes;
+                const auto cachedHardLinks = folder.hardLinks.size();
+                if (refreshFiles(path, folder))
+                {
+                    ++scan->cachedFolders;
+                    // Keeps the new sizes for the saved cache. Folders with hard links are rare, they are always stored
+                    if (folder.bytes != cachedBytes || folder.hardLinks.size() != cachedHardLinks || cachedHardLinks)
+                    {
+                        scan->cache->store(info.device, info.inode, folder);
+                    }
+                }
+                else
+                {
+                    folder = FolderSizeCache::Folder();
+                }
+            }
+            else if (readFolder(path, folder))
+            {
+                // The time is taken before listing: a change while listing is seen by the next scan
+                folder.modifiedTime = info.modifiedTime;
+                if (scan->cache)
+                {
+                    scan->cache->store(info.device, info.inode, folder);
+                }
+            }
+
+            ++scan->folders;
+            addFolder(*scan, folder);
+
+            scan->pendingFolders += static_cast<long long>(folder.subfolders.size());
+            for (const auto& name : folder.subfolders)
+            {
+                auto subfolder = path + PATH_SEPARATOR + name;
+                scan->pool->push([scan, subfolder]() { scanFolder(scan, subfolder); }, ThreadPool::Priority::BACKGROUND);
+            }
+        }
+
+        if (scan->progress)
+        {
+            auto now = steadyNowMs();
+            auto next = scan->nextProgressMs.load();
+            if (now >= next && scan->nextProgressMs.compare_exchange_strong(next, now + PROGRESS_INTERVAL_MS))
+            {
+                scan->progress(scan->result(false));
+            }
+        }
+    }
+
+    finishFolder(scan);
+}
+
+void FolderSizeScanner::finishFolder(const std::shared_ptr<Scan>& scan)
+{
+    if (--scan->pendingFolders == 0 && scan->done)
+    {
+        scan->done(scan->result(!scan->isCancelled()));
+    }
+}
+
+void FolderSizeScanner::addFolder(Scan& scan, const FolderSizeCache::Folder& folder)
+{
+    long long bytes = folder.bytes;
+    if (!folder.hardLinks.empty())
+    {
+        std::lock_guard<std::mutex> lock(scan.hardLinksMutex);
+        for (const auto& link : folder.hardLinks)
+        {
+            if (scan.hardLinks.insert(FileIdentity{link.device, link.inode}).second)
+            {
+                bytes += link.size;
+            }
+        }
+    }
+
+    scan.bytes += bytes;
+    scan.files += folder.files;
+}
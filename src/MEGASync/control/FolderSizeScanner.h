@@ -0,0 +1,129 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sizes of folder trees, computed in parallel on the thread pool.
+//
+// Every folder is a pool task that lists its entries (readdir/fstatat relative to the folder
+// descriptor, FindFirstFileEx on Windows) and pushes one task per subfolder. Regular files are
+// added up, symbolic links are not followed and files with several hard links are counted once.
+// The listing of every folder is kept in a FolderSizeCache keyed by its identity and modification
+// time: when a folder has not changed, its listing is not read again but its files are, because
+// a file growing in place does not change the modification time of its folder.
+
+#ifdef WIN32
+using FolderSizePath = std::wstring;
+#else
+using FolderSizePath = std::string;
+#endif
+
+class FolderSizeCache
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_FOLDERS = 1000000;
+
+    struct HardLink
+    {
+        std::uint64_t device;
+        std::uint64_t inode;
+        long long size;
+    };
+
+    struct Folder
+    {
+        std::int64_t modifiedTime = 0;
+        long long bytes = 0;                  // Files with a single link
+        long long files = 0;
+        std::vector<HardLink> hardLinks;      // Files with several links, deduplicated per scan
+        std::vector<FolderSizePath> subfolders; // Names
+        std::vector<FolderSizePath> fileNames;  // Regular files, stat'ed again on every scan
+    };
+
+    explicit FolderSizeCache(std::size_t maxFolders = DEFAULT_MAX_FOLDERS);
+
+    // Copies the folder if it is known with that modification time
+    bool find(std::uint64_t device, std::uint64_t inode, std::int64_t modifiedTime, Folder& folder) const;
+    void store(std::uint64_t device, std::uint64_t inode, const Folder& folder);
+    void clear();
+    std::size_t size() const;
+
+    // Keeps the cache between executions
+    bool load(const FolderSizePath& path);
+    bool save(const FolderSizePath& path) const;
+
+private:
+    struct Key
+    {
+        std::uint64_t device;
+        std::uint64_t inode;
+        bool operator==(const Key& other) const {return device == other.device && inode == other.inode;}
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            return std::hash<std::uint64_t>()(key.inode * 31 + key.device);
+        }
+    };
+
+    const std::size_t mMaxFolders;
+    mutable std::mutex mMutex;
+    std::unordered_map<Key, Folder, KeyHash> mFolders;
+};
+
+class FolderSizeScanner
+{
+public:
+    struct Result
+    {
+        long long bytes = 0;
+        long long files = 0;
+        long long folders = 0;
+        long long cachedFolders = 0; // Folders whose listing came from the cache
+        bool complete = false;       // False if cancelled
+    };
+
+    using ProgressCallback = std::function<void(const Result&)>;
+    using DoneCallback = std::function<void(const Result&)>;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 200;
+
+    // cache can be null
+    FolderSizeScanner(ThreadPool& pool, std::shared_ptr<FolderSizeCache> cache);
+
+    // Starts scanning the roots (files or folders) and returns. progress receives partial results
+    // from the pool threads while scanning, done the final one from the thread that finished last.
+    // Safe to call from pool tasks
+    void scanAsync(const std::vector<FolderSizePath>& roots,
+                   ThreadPool::CancelToken token,
+                   ProgressCallback progress,
+                   DoneCallback done) const;
+
+    // Waits for scanAsync; do not call it from a pool task
+    Result scan(const std::vector<FolderSizePath>& roots,
+                ThreadPool::CancelToken token = ThreadPool::CancelToken(),
+                ProgressCallback progress = nullptr) const;
+
+    // Cache shared by the whole application
+    static std::shared_ptr<FolderSizeCache> sharedCache();
+
+private:
+    struct Scan;
+
+    static void scanFolder(const std::shared_ptr<Scan>& scan, const FolderSizePath& path);
+    static void finishFolder(const std::shared_ptr<Scan>& scan);
+    static void addFolder(Scan& scan, const FolderSizeCache::Folder& folder);
+
+    ThreadPool& mPool;
+    std::shared_ptr<FolderSizeCache> mCache;
+};
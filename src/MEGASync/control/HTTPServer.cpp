@@ -14,7 +14,36 @@
 using namespace mega;
 
 const unsigned int HTTPServer::MAX_REQUEST_TIME_SECS = 1800;
+const int HTTPServer::PROGRESS_STREAM_INTERVAL_MS = 500;
+const int HTTPServer::KEEP_ALIVE_TIMEOUT_MS = 30000;
 const QString PUBLIC_LINK_START = QString::fromUtf8("https://mega.nz/collection/");
+const QString KEEP_ALIVE_TIMER_NAME = QString::fromUtf8("keepAliveTimer");
+
+namespace
+{
+// Events are processed while creating the nodes of a download request after this many nodes
+const std::size_t DOWNLOAD_NODES_PER_EVENT_LOOP = 64;
+// Requests are logged up to this size
+const std::size_t MAX_LOGGED_BODY_SIZE = 4096;
+
+bool isFinishedTransferState(int state)
+{
+    return state == MegaTransfer::STATE_CANCELLED
+            || state == MegaTransfer::STATE_COMPLETED
+            || state == MegaTransfer::STATE_FAILED;
+}
+
+TransferProgressFeed::Progress toFeedProgress(const RequestTransferData* tData)
+{
+    TransferProgressFeed::Progress progress;
+    progress.state = tData->state;
+    progress.transferred = tData->progress;
+    progress.size = tData->size;
+    progress.speed = tData->speed;
+    progress.finished = isFinishedTransferState(tData->state);
+    return progress;
+}
+}
 
 bool ts_comparator(RequestData* i, RequestData *j)
 {
@@ -41,9 +70,33 @@ RequestTransferData::RequestTransferData()
     tPath = QString();
 }
 
+QString HTTPRequest::string(const char* name) const
+{
+    return content ? QString::fromStdString(content->string(name)) : QString();
+}
+
+long long HTTPRequest::number(const char* name) const
+{
+    return content ? content->number(name) : 0;
+}
+
+QStringList HTTPRequest::stringList(const char* name) const
+{
+    QStringList list;
+    if (content)
+    {
+        for (const std::string& item : content->stringList(name))
+        {
+            list.append(QString::fromStdString(item));
+        }
+    }
+    return list;
+}
+
 bool HTTPServer::isFirstWebDownloadDone = false;
 QMultiMap<QString, RequestData*> HTTPServer::webDataRequests;
 QMap<mega::MegaHandle, RequestTransferData*> HTTPServer::webTransferStateRequests;
+TransferProgressFeed HTTPServer::webTransferProgressFeed;
 
 HTTPServer::HTTPServer(MegaApi *megaApi, quint16 port)
     : QTcpServer(), disabled(false)
@@ -53,11 +106,18 @@ HTTPServer::HTTPServer(MegaApi *megaApi, quint16 port)
 
     connect(&mVersionCommandWatcher, &QFutureWatcher<VersionCommandAnswer>::finished,
             this, &HTTPServer::onVersionCommandFinished);
+
+    mProgressStreamTimer.setInterval(PROGRESS_STREAM_INTERVAL_MS);
+    connect(&mProgressStreamTimer, &QTimer::timeout, this, &HTTPServer::pushTransferProgress);
 }
 
 HTTPServer::~HTTPServer()
 {
-
+    // The feed is shared with the next server
+    for (TransferProgressFeed::SubscriberId id : qAsConst(mProgressStreams))
+    {
+        webTransferProgressFeed.unsubscribe(id);
+    }
 }
 
 void HTTPServer::incomingConnection(qintptr socket)
@@ -75,7 +135,7 @@ void HTTPServer::incomingConnection(qintptr socket)
     connect(s, SIGNAL(disconnected()), this, SLOT(discardClient()));
 
     s->setSocketDescriptor(socket);
-    requests.insert(s, new HTTPRequest());
+    requests.insert(s, new WebRequestParser());
 }
 
 void HTTPServer::pause()
@@ -108,9 +168,7 @@ void HTTPServer::checkAndPurgeRequests()
     for (QMap<MegaHandle, RequestTransferData*>::iterator it = webTransferStateRequests.begin() ; it != webTransferStateRequests.end();)
     {
         RequestTransferData *transferData = it.value();
-        if ((transferData->state == MegaTransfer::STATE_CANCELLED
-             || transferData->state == MegaTransfer::STATE_COMPLETED
-             || transferData->state == MegaTransfer::STATE_FAILED)
+        if (isFinishedTransferState(transferData->state)
                 && (((QDateTime::currentMSecsSinceEpoch() / 1000) - transferData->tsEnd) > MAX_REQUEST_TIME_SECS))
         {
             webTransferStateRequests.erase(it++);
@@ -175,20 +233,21 @@ void HTTPServer::onTransferDataUpdate(MegaHandle handle, int state, long long pr
         tData->tPath = localPath;
     }
 
-    if (state == MegaTransfer::STATE_CANCELLED
-            || state == MegaTransfer::STATE_COMPLETED
-            || state == MegaTransfer::STATE_FAILED)
+    if (isFinishedTransferState(state))
     {
         tData->tsEnd = QDateTime::currentMSecsSinceEpoch() / 1000;
     }
+
+    // Only stored: streams get the last state on their next push
+    webTransferProgressFeed.update(handle, toFeedProgress(tData));
 }
 
 void HTTPServer::readClient()
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Processing webclient request via HTTP").toUtf8().constData());
     QAbstractSocket *socket = (QAbstractSocket*)sender();
-    HTTPRequest *request = requests.value(socket);
-    if (disabled || !request)
+    WebRequestParser *parser = requests.value(socket);
+    if (disabled || !parser)
     {
         MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Webclient request not found");
         discardClient();
@@ -196,56 +255,110 @@ void HTTPServer::readClient()
     }
 
     QByteArray socketData = socket->readAll();
-    request->data.append(QString::fromUtf8(socketData.data()));
-    if (request->data.contains(QString::fromUtf8("\r\n\r\n")))
+    if (mProgressStreams.contains(socket))
+    {
+        // Progress streams only send
+        return;
+    }
+
+    if (QTimer* idleTimer = socket->findChild<QTimer*>(KEEP_ALIVE_TIMER_NAME, Qt::FindDirectChildrenOnly))
+    {
+        idleTimer->stop();
+    }
+
+    // Bytes received while the previous request is processed are kept for the next one
+    WebRequestParser::State previousState = parser->state();
+    parser->append(socketData.constData(), static_cast<std::size_t>(socketData.size()));
+    if (previousState == WebRequestParser::State::HEADERS || previousState == WebRequestParser::State::BODY)
     {
-        QStringList tokens = request->data.split(QString::fromUtf8("\r\n\r\n"));
-        QStringList headers = tokens[0].split(QString::fromUtf8("\r\n"));
-        bool requestIsPost = isRequestOfType(headers, "POST");
-        bool requestIsOption = isRequestOfType(headers, "OPTION");
+        processClientRequest(socket, parser);
+    }
+}
 
-        if (!headers.size() || (!requestIsPost && !requestIsOption))
+void HTTPServer::processClientRequest(QAbstractSocket* socket, WebRequestParser* parser)
+{
+    switch (parser->state())
+    {
+    case WebRequestParser::State::HEADERS:
+    case WebRequestParser::State::BODY:
+        return;
+    case WebRequestParser::State::FAILED:
+        switch (parser->error())
         {
+        case WebRequestParser::Error::METHOD_NOT_ALLOWED:
             MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Method not allowed for webclient request");
             rejectRequest(socket, QString::fromUtf8("405 Method Not Allowed"));
-            return;
+            break;
+        case WebRequestParser::Error::HEADERS_TOO_LARGE:
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Webclient request headers too large");
+            rejectRequest(socket, QString::fromUtf8("431 Request Header Fields Too Large"));
+            break;
+        case WebRequestParser::Error::BODY_TOO_LARGE:
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Webclient request too large: %1")
+                         .arg(QString::fromStdString(parser->header("Content-Length"))).toUtf8().constData());
+            rejectRequest(socket, QString::fromUtf8("413 Payload Too Large"));
+            break;
+        case WebRequestParser::Error::MISSING_CONTENT_LENGTH:
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Missing Content-length header");
+            rejectRequest(socket);
+            break;
+        case WebRequestParser::Error::INVALID_CONTENT_LENGTH:
+        case WebRequestParser::Error::NONE:
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Unable to parse Content-length header: %1")
+                         .arg(QString::fromStdString(parser->header("Content-Length"))).toUtf8().constData());
+            rejectRequest(socket);
+            break;
         }
+        return;
+    case WebRequestParser::State::COMPLETE:
+        break;
+    }
 
-        if (Preferences::HTTPS_ORIGIN_CHECK_ENABLED && !Preferences::HTTPS_ALLOWED_ORIGINS.isEmpty())
-        {
-            QString foundOrigin = findCorrespondingAllowedOrigin(headers);
-            if (!foundOrigin.isEmpty())
-            {
-                request->origin = foundOrigin;
-            }
-            else
-            {
-                MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Missing or invalid Origin header");
-                rejectRequest(socket);
-                return;
-            }
-        }
+    QStringList headers;
+    for (const std::string& line : parser->headerLines())
+    {
+        headers.append(QString::fromStdString(line));
+    }
 
-        if (requestIsPost)
+    HTTPRequest request;
+    if (Preferences::HTTPS_ORIGIN_CHECK_ENABLED && !Preferences::HTTPS_ALLOWED_ORIGINS.isEmpty())
+    {
+        QString foundOrigin = findCorrespondingAllowedOrigin(headers);
+        if (!foundOrigin.isEmpty())
         {
-            processPostRequest(socket, request, headers, tokens[1]);
+            request.origin = foundOrigin;
         }
-        else // requestIsOption
+        else
         {
-            processOptionRequest(socket, request, headers);
+            MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Missing or invalid Origin header");
+            rejectRequest(socket);
+            return;
         }
     }
+
+    request.keepAlive = !headers.filter(QRegExp(QString::fromUtf8("^Connection: *keep-alive"), Qt::CaseInsensitive)).isEmpty();
+
+    if (parser->isPost())
+    {
+        processPostRequest(socket, parser, request);
+    }
+    else // Option request
+    {
+        processOptionRequest(socket, &request, headers);
+    }
 }
+
 void HTTPServer::discardClient()
 {
     QAbstractSocket* socket = (QSslSocket*)sender();
     socket->deleteLater();
+    removeProgressStream(socket);
 
-    HTTPRequest *request = requests.value(socket);
-    if (request)
+    WebRequestParser *parser = requests.value(socket);
+    if (parser)
     {
         requests.remove(socket);
-        delete request;
+        delete parser;
     }
 }
 
@@ -257,11 +370,11 @@ void HTTPServer::rejectRequest(QAbstractSocket *socket, QString response)
     socket->disconnectFromHost();
     socket->deleteLater();
 
-    HTTPRequest *request = requests.value(socket);
-    if (request)
+    WebRequestParser *parser = requests.value(socket);
+    if (parser)
     {
         requests.remove(socket);
-        delete request;
+        delete parser;
     }
 }
 
@@ -310,6 +423,13 @@ void HTTPServer::processRequest(QPointer<QAbstractSocket> socket, HTTPRequest re
     case EXTERNAL_TRANSFER_QUERY_PROGRESS_START:
         externalTransferQueryProgress(response, request);
         break;
+    case EXTERNAL_TRANSFER_PROGRESS_STREAM_START:
+        if (externalTransferProgressStream(response, request, socket))
+        {
+            // The socket stays open to receive the progress events
+            return;
+        }
+        break;
     case EXTERNAL_SHOW_IN_FOLDER:
         externalShowInFolder(response, request);
         break;
@@ -341,18 +461,60 @@ void HTTPServer::endProcessRequest(QPointer<QAbstractSocket> socket,const HTTPRe
             MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Response to HTTP request: %1").arg(response).toUtf8().constData());
         }
 
+        // Reused connections need the exact length in bytes to find the next response
+        QByteArray body = response.toUtf8();
+        QString connection;
+        if (request.keepAlive)
+        {
+            connection = QString::fromUtf8("Connection: keep-alive\r\n"
+                                           "Keep-Alive: timeout=%1\r\n").arg(KEEP_ALIVE_TIMEOUT_MS / 1000);
+        }
+
         QString fullResponse = QString::fromUtf8("HTTP/1.0 200 Ok\r\n"
                                                  "Access-Control-Allow-Origin: %1\r\n"
                                                  "Content-Type: text/html; charset=\"utf-8\"\r\n"
                                                  "Content-Length: %2\r\n"
-                                                 "\r\n"
-                                                 "%3").arg(request.origin).arg(response.size()).arg(response);
+                                                 "%3"
+                                                 "\r\n").arg(request.origin).arg(body.size()).arg(connection);
         if (safeServer && socket)
         {
-            socket->write(fullResponse.toUtf8());
+            socket->write(fullResponse.toUtf8() + body);
             socket->flush();
-            socket->disconnectFromHost();
-            socket->deleteLater();
+            if (request.keepAlive)
+            {
+                // Ready for the next request, until the connection is idle for too long
+                if (WebRequestParser* parser = requests.value(socket))
+                {
+                    parser->reset();
+                    if (parser->state() != WebRequestParser::State::HEADERS)
+                    {
+                        // The next request was received while answering this one
+                        QTimer::singleShot(0, this, [this, socket]()
+                        {
+                            WebRequestParser* nextParser = socket ? requests.value(socket) : nullptr;
+                            if (nextParser)
+                            {
+                                processClientRequest(socket, nextParser);
+                            }
+                        });
+                    }
+                }
+
+                QTimer* idleTimer = socket->findChild<QTimer*>(KEEP_ALIVE_TIMER_NAME, Qt::FindDirectChildrenOnly);
+                if (!idleTimer)
+                {
+                    idleTimer = new QTimer(socket);
+                    idleTimer->setObjectName(KEEP_ALIVE_TIMER_NAME);
+                    idleTimer->setSingleShot(true);
+                    connect(idleTimer, &QTimer::timeout, socket.data(), &QAbstractSocket::disconnectFromHost);
+                }
+                idleTimer->start(KEEP_ALIVE_TIMEOUT_MS);
+            }
+            else
+            {
+                socket->disconnectFromHost();
+                socket->deleteLater();
+            }
         }
     }
 }
@@ -396,9 +558,9 @@ void HTTPServer::onVersionCommandFinished()
 void HTTPServer::openLinkRequest(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "OpenLink command received from the webclient");
-    QString handle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
-    QString key = Utilities::extractJSONString(request.data, QString::fromUtf8("k"));
-    QString auth = Utilities::extractJSONString(request.data, QString::fromUtf8("esid"));
+    QString handle = request.string("h");
+    QString key = request.string("k");
+    QString auth = request.string("esid");
 
     if (key.size() > 43)
     {
@@ -444,148 +606,116 @@ void HTTPServer::externalDownloadRequest(QString &response, const HTTPRequest& r
     QPointer<HTTPServer> safeServer = this;
 
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "ExternalDownload command received from the webclient");
-    int start = request.data.indexOf(QString::fromUtf8("\"f\":[")) + 5;
-    if (start > 0)
-    {
-        QString privateAuth = Utilities::extractJSONString(request.data.mid(0, start), QString::fromUtf8("esid"));
-        QString publicAuth  = Utilities::extractJSONString(request.data.mid(0, start), QString::fromUtf8("en"));
-        QString chatAuth    = Utilities::extractJSONString(request.data.mid(0, start), QString::fromUtf8("cauth"));
+    QString privateAuth = request.string("esid");
+    QString publicAuth  = request.string("en");
+    QString chatAuth    = request.string("cauth");
 
-        if (privateAuth.isEmpty() && publicAuth.isEmpty())
+    if (privateAuth.isEmpty() && publicAuth.isEmpty())
+    {
+        QString auth  = request.string("auth");
+        if (auth.length() == 8)
         {
-            QString auth  = Utilities::extractJSONString(request.data.mid(0, start), QString::fromUtf8("auth"));
-            if (auth.length() == 8)
-            {
-                publicAuth = auth;
-            }
-            else
-            {
-                privateAuth = auth;
-            }
+            publicAuth = auth;
         }
-
-        if (privateAuth.size() || publicAuth.size())
+        else
         {
-            QQueue<WrappedNode *> downloadQueue;
-
-            int end;
-            bool firstnode = true;
+            privateAuth = auth;
+        }
+    }
 
-            while (request.data[start] == QChar::fromLatin1('{'))
-            {
-                end = request.data.indexOf(QChar::fromLatin1('}'), start);
-                if (end < 0)
-                {
-                    MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Error parsing webclient request");
-                    qDeleteAll(downloadQueue);
-                    downloadQueue.clear();
-                    break;
-                }
+    if (privateAuth.size() || publicAuth.size())
+    {
+        QQueue<WrappedNode *> downloadQueue;
 
-                end++;
-                QString file = request.data.mid(start, end - start);
-                start = end + 1;
+        const QByteArray publicAuthArray = publicAuth.toUtf8();
+        const QByteArray privateAuthArray = privateAuth.toUtf8();
+        const QByteArray chatAuthArray = chatAuth.toUtf8();
 
-                long long type = Utilities::extractJSONNumber(file, QString::fromUtf8("t"));
-                if (type < 0)
-                {
-                    MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without type in webclient request");
-                    qDeleteAll(downloadQueue);
-                    downloadQueue.clear();
-                    break;
-                }
+        const std::vector<WebRequestNode>& files = request.content->nodes();
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            const WebRequestNode& file = files[i];
+            if (file.type < 0)
+            {
+                MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without type in webclient request");
+                qDeleteAll(downloadQueue);
+                downloadQueue.clear();
+                break;
+            }
 
-                QString handle = Utilities::extractJSONString(file, QString::fromUtf8("h"));
-                if (handle.isEmpty())
-                {
-                    MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without handle in webclient request");
-                    qDeleteAll(downloadQueue);
-                    downloadQueue.clear();
-                    break;
-                }
+            if (file.handle.empty())
+            {
+                MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without handle in webclient request");
+                qDeleteAll(downloadQueue);
+                downloadQueue.clear();
+                break;
+            }
 
-                QString name = Utilities::extractJSONString(file, QString::fromUtf8("n"));
-                name.replace(QString::fromUtf8("-"), QString::fromUtf8("+"));
-                name.replace(QString::fromUtf8("_"), QString::fromUtf8("/"));
-                name = QString::fromUtf8(QByteArray::fromBase64(name.toUtf8().constData()).constData());
-                if (name.isEmpty())
-                {
-                    MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without name in webclient request");
-                    qDeleteAll(downloadQueue);
-                    downloadQueue.clear();
-                    break;
-                }
+            QString name = QString::fromUtf8(QByteArray::fromBase64(QByteArray::fromStdString(file.name),
+                                                                    QByteArray::Base64UrlEncoding).constData());
+            if (name.isEmpty())
+            {
+                MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without name in webclient request");
+                qDeleteAll(downloadQueue);
+                downloadQueue.clear();
+                break;
+            }
 
-                MegaHandle h = megaApi->base64ToHandle(handle.toUtf8().constData());
-                MegaHandle p = INVALID_HANDLE;
+            MegaHandle h = megaApi->base64ToHandle(file.handle.c_str());
+            MegaHandle p = INVALID_HANDLE;
 
-                if (!firstnode)
+            if (i)
+            {
+                p = megaApi->base64ToHandle(file.parent.c_str());
+                // Large requests would freeze the GUI, but processing events for every node is slow too
+                if (i % DOWNLOAD_NODES_PER_EVENT_LOOP == 0)
                 {
-                    QString parentHandle = Utilities::extractJSONString(file, QString::fromUtf8("p"));
-                    p = megaApi->base64ToHandle(parentHandle.toUtf8().constData());
                     QApplication::processEvents();
                     if (!safeServer || !safeSocket)
                     {
+                        qDeleteAll(downloadQueue);
                         return;
                     }
                 }
-                else
-                {
-                    firstnode = false;
-                }
+            }
 
-                const QByteArray nameArray = name.toUtf8();
-                const QByteArray publicAuthArray = publicAuth.toUtf8();
-                const QByteArray privateAuthArray = privateAuth.toUtf8();
+            const QByteArray nameArray = name.toUtf8();
 
-                if (type != MegaNode::TYPE_FILE)
-                {
-                    MegaNode *node = megaApi->createForeignFolderNode(h, nameArray.constData(), p,
-                                                                     privateAuthArray.constData(),
-                                                                     publicAuthArray.constData());
-                    downloadQueue.append(new WrappedNode(WrappedNode::TransferOrigin::FROM_WEBSERVER, node, undelete));
-                }
-                else
+            if (file.type != MegaNode::TYPE_FILE)
+            {
+                MegaNode *node = megaApi->createForeignFolderNode(h, nameArray.constData(), p,
+                                                                 privateAuthArray.constData(),
+                                                                 publicAuthArray.constData());
+                downloadQueue.append(new WrappedNode(WrappedNode::TransferOrigin::FROM_WEBSERVER, node, undelete));
+            }
+            else if (file.key.size() == 43)
+            {
+                MegaNode *node = megaApi->createForeignFileNode(h, file.key.c_str(),
+                                                 nameArray.constData(), file.size, file.mtime,
+                                                 file.crc.empty() ? nullptr : file.crc.c_str(),
+                                                 p, privateAuthArray.constData(),
+                                                 publicAuthArray.constData(),
+                                                 chatAuth.isEmpty() ? nullptr :  chatAuthArray.constData());
+                downloadQueue.append(new WrappedNode(WrappedNode::TransferOrigin::FROM_WEBSERVER, node, undelete));
+                QMap<MegaHandle, RequestTransferData*>::iterator it = webTransferStateRequests.find(h);
+                if (it != webTransferStateRequests.end())
                 {
-                    QString key = Utilities::extractJSONString(file, QString::fromUtf8("k"));
-                    if (key.size() == 43)
-                    {
-                        const QByteArray keyArray = key.toUtf8();
-                        long long size = Utilities::extractJSONNumber(file, QString::fromUtf8("s"));
-                        long long mtime = Utilities::extractJSONNumber(file, QString::fromUtf8("ts"));
-
-                        QString crc    = Utilities::extractJSONString(file, QString::fromUtf8("c"));
-                        const QByteArray crcArray = crc.toUtf8();
-
-                        const QByteArray chatAuthArray = chatAuth.toUtf8();
-                        MegaNode *node = megaApi->createForeignFileNode(h, keyArray.constData(),
-                                                         nameArray.constData(), size, mtime,
-                                                         crc.isEmpty() ? nullptr : crcArray.constData(),
-                                                         p, privateAuthArray.constData(),
-                                                         publicAuthArray.constData(),
-                                                         chatAuth.isEmpty() ? nullptr :  chatAuthArray.constData());
-                        downloadQueue.append(new WrappedNode(WrappedNode::TransferOrigin::FROM_WEBSERVER, node, undelete));
-                        QMap<MegaHandle, RequestTransferData*>::iterator it = webTransferStateRequests.find(h);
-                        if (it != webTransferStateRequests.end())
-                        {
-                            delete it.value();
-                        }
-                        webTransferStateRequests.insert(h, new RequestTransferData());
-                    }
-                    else
-                    {
-                        MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without key (or an invalid key) in webclient request");
-                    }
+                    delete it.value();
                 }
+                webTransferStateRequests.insert(h, new RequestTransferData());
             }
-
-            if (downloadQueue.size())
+            else
             {
-                emit onExternalDownloadRequested(downloadQueue);
-                emit onExternalDownloadRequestFinished();
-                response = QString::number(MegaError::API_OK);
+                MegaApi::log(MegaApi::LOG_LEVEL_ERROR, "Node without key (or an invalid key) in webclient request");
             }
         }
+
+        if (downloadQueue.size())
+        {
+            emit onExternalDownloadRequested(downloadQueue);
+            emit onExternalDownloadRequestFinished();
+            response = QString::number(MegaError::API_OK);
+        }
     }
 }
 
@@ -600,8 +730,8 @@ void HTTPServer::externalDownloadSetRequest(QString &response, const HTTPRequest
     //!     "https://mega.nz/collection/" + auth" + "#" + k
     //! eg:
     //!     "https://mega.nz/collection/" + "Y7VXFI6b" + "#" + "2e4l7O_oI4qGxDY5eJCojg"
-    QString auth = Utilities::extractJSONString(request.data, QString::fromUtf8("auth"));
-    QString k = Utilities::extractJSONString(request.data, QString::fromUtf8("k"));
+    QString auth = request.string("auth");
+    QString k = request.string("k");
     if (auth.isEmpty() || k.isEmpty())
     {
         response = QString::number(MegaError::API_EARGS);
@@ -611,7 +741,7 @@ void HTTPServer::externalDownloadSetRequest(QString &response, const HTTPRequest
     QString publicLink = PUBLIC_LINK_START + auth + QString::fromUtf8("#") + k;
 
     // Get Element IDs
-    QStringList e = Utilities::extractJSONStringList(request.data, QString::fromUtf8("e"));
+    QStringList e = request.stringList("e");
 
     QList<mega::MegaHandle> handleList;
     for(const QString& eId : qAsConst(e))
@@ -634,7 +764,7 @@ void HTTPServer::externalDownloadSetRequest(QString &response, const HTTPRequest
 void HTTPServer::externalFileUploadRequest(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "UploadFile command received from the webclient");
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = ::mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -649,7 +779,7 @@ void HTTPServer::externalFileUploadRequest(QString &response, const HTTPRequest&
     else
     {
         delete targetNode;
-        QString bid = Utilities::extractJSONString(request.data, QString::fromUtf8("bid"));
+        QString bid = request.string("bid");
         if (!bid.isEmpty())
         {
             webDataRequests.insert(bid, new RequestData());
@@ -666,7 +796,7 @@ void HTTPServer::externalFileUploadRequest(QString &response, const HTTPRequest&
 void HTTPServer::externalFolderUploadRequest(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "UploadFolder command received from the webclient");
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = ::mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -681,7 +811,7 @@ void HTTPServer::externalFolderUploadRequest(QString &response, const HTTPReques
     else
     {
         delete targetNode;
-        QString bid = Utilities::extractJSONString(request.data, QString::fromUtf8("bid"));
+        QString bid = request.string("bid");
         if (!bid.isEmpty())
         {
             webDataRequests.insert(bid, new RequestData());
@@ -698,7 +828,7 @@ void HTTPServer::externalFolderUploadRequest(QString &response, const HTTPReques
 void HTTPServer::externalFolderSyncRequest(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Sync command received from the webclient");
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = ::mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -721,7 +851,7 @@ void HTTPServer::externalFolderSyncRequest(QString &response, const HTTPRequest&
 void HTTPServer::externalFolderSyncCheck(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Check sync folder command received from the webclient");
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = ::mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -756,7 +886,7 @@ void HTTPServer::externalFolderSyncCheck(QString &response, const HTTPRequest& r
 void HTTPServer::externalOpenTransferManager(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Open Transfer Manager command received from the webclient");
-    int tab = static_cast<int>(Utilities::extractJSONNumber(request.data, QString::fromUtf8("t")));
+    int tab = static_cast<int>(request.number("t"));
     if (tab < 0 || tab > 3) //Not valid number tab (all, downloads, uploads, completed)
     {
         response = QString::number(MegaError::API_EARGS);
@@ -771,7 +901,7 @@ void HTTPServer::externalOpenTransferManager(QString &response, const HTTPReques
 void HTTPServer::externalUploadSelectionStatus(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Upload selection status command received from the webclient");
-    QString bid = Utilities::extractJSONString(request.data, QString::fromUtf8("bid"));
+    QString bid = request.string("bid");
     if (!bid.isEmpty())
     {
         QList<RequestData*> values = webDataRequests.values(bid);
@@ -811,7 +941,7 @@ void HTTPServer::externalUploadSelectionStatus(QString &response, const HTTPRequ
 
 void HTTPServer::externalTransferQueryProgress(QString &response, const HTTPRequest& request)
 {
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -847,10 +977,118 @@ void HTTPServer::externalTransferQueryProgress(QString &response, const HTTPRequ
     }
 }
 
+bool HTTPServer::externalTransferProgressStream(QString& response, const HTTPRequest& request, QAbstractSocket* socket)
+{
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Transfer progress stream command received from the webclient");
+    QStringList targetHandles = request.stringList("h");
+    if (targetHandles.isEmpty())
+    {
+        response = QString::number(MegaError::API_EARGS);
+        return false;
+    }
+
+    std::vector<std::pair<TransferProgressFeed::Handle, std::string>> handles;
+    for (const QString& targetHandle : qAsConst(targetHandles))
+    {
+        MegaHandle handle = MegaApi::base64ToHandle(targetHandle.toUtf8().constData());
+        if (handle != mega::INVALID_HANDLE && webTransferStateRequests.contains(handle))
+        {
+            char* base64Handle = MegaApi::handleToBase64(handle);
+            handles.emplace_back(handle, std::string(base64Handle));
+            delete [] base64Handle;
+        }
+    }
+
+    if (handles.empty())
+    {
+        response = QString::number(MegaError::API_ENOENT);
+        return false;
+    }
+
+    TransferProgressFeed::SubscriberId id = webTransferProgressFeed.subscribe(handles);
+    for (const auto& handle : handles)
+    {
+        webTransferProgressFeed.update(handle.first, toFeedProgress(webTransferStateRequests.value(handle.first)));
+    }
+
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Transfer progress stream opened for %1 transfers")
+                 .arg(handles.size()).toUtf8().constData());
+
+    // No Content-Length: the events go on until the transfers finish or the client disconnects
+    socket->write(QString::fromUtf8("HTTP/1.1 200 Ok\r\n"
+                                    "Access-Control-Allow-Origin: %1\r\n"
+                                    "Content-Type: text/event-stream\r\n"
+                                    "Cache-Control: no-cache\r\n"
+                                    "Connection: close\r\n"
+                                    "\r\n").arg(request.origin).toUtf8());
+    socket->write(QByteArray::fromStdString(webTransferProgressFeed.takeEvent(id)));
+    socket->flush();
+
+    mProgressStreams.insert(socket, id);
+    if (webTransferProgressFeed.isDone(id))
+    {
+        removeProgressStream(socket);
+        socket->disconnectFromHost();
+    }
+    else if (!mProgressStreamTimer.isActive())
+    {
+        mProgressStreamTimer.start();
+    }
+    return true;
+}
+
+void HTTPServer::pushTransferProgress()
+{
+    if (!webTransferProgressFeed.hasPendingEvents())
+    {
+        return;
+    }
+
+    // Finished streams are removed while iterating
+    const QList<QAbstractSocket*> sockets = mProgressStreams.keys();
+    for (QAbstractSocket* socket : sockets)
+    {
+        auto stream = mProgressStreams.constFind(socket);
+        if (stream == mProgressStreams.constEnd())
+        {
+            continue;
+        }
+
+        TransferProgressFeed::SubscriberId id = stream.value();
+        std::string event = webTransferProgressFeed.takeEvent(id);
+        if (!event.empty())
+        {
+            socket->write(QByteArray::fromStdString(event));
+            socket->flush();
+        }
+
+        if (webTransferProgressFeed.isDone(id))
+        {
+            removeProgressStream(socket);
+            socket->disconnectFromHost();
+        }
+    }
+}
+
+void HTTPServer::removeProgressStream(QAbstractSocket* socket)
+{
+    auto stream = mProgressStreams.find(socket);
+    if (stream != mProgressStreams.end())
+    {
+        webTransferProgressFeed.unsubscribe(stream.value());
+        mProgressStreams.erase(stream);
+    }
+
+    if (mProgressStreams.isEmpty())
+    {
+        mProgressStreamTimer.stop();
+    }
+}
+
 void HTTPServer::externalShowInFolder(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Show in folder command received from the webclient");
-    QString targetHandle = Utilities::extractJSONString(request.data, QString::fromUtf8("h"));
+    QString targetHandle = request.string("h");
     MegaHandle handle = ::mega::INVALID_HANDLE;
     if (targetHandle.size())
     {
@@ -894,7 +1132,7 @@ void HTTPServer::externalShowInFolder(QString &response, const HTTPRequest& requ
 void HTTPServer::externalAddBackup(QString &response, const HTTPRequest& request)
 {
     MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, "Add backup command received from the webclient");
-    QString userHandle(Utilities::extractJSONString(request.data, QLatin1String("u")));
+    QString userHandle(request.string("u"));
     MegaHandle handle = INVALID_HANDLE;
 
     if (userHandle.size())
@@ -926,74 +1164,69 @@ void HTTPServer::externalAddBackup(QString &response, const HTTPRequest& request
 
 HTTPServer::RequestType HTTPServer::GetRequestType(const HTTPRequest &request)
 {
-    static const QString openLinkRequestStart(QLatin1String("{\"a\":\"l\","));
-    static const QString externalDownloadRequestStart(QLatin1String("{\"a\":\"d\","));
-    static const QString externalDownloadSetRequestStart(QLatin1String("{\"a\":\"ds\","));
-    static const QString externalRewindRequestStart(QLatin1String("{\"a\":\"gd\","));
-    static const QString externalFileUploadRequestStart(QLatin1String("{\"a\":\"ufi\","));
-    static const QString externalFolderUploadRequestStart(QLatin1String("{\"a\":\"ufo\","));
-    static const QString externalFolderSyncRequestStart(QLatin1String("{\"a\":\"s\","));
-    static const QString externalFolderSyncCheckStart(QLatin1String("{\"a\":\"sp\","));
-    static const QString externalOpenTransferManagerStart(QLatin1String("{\"a\":\"tm\","));
-    static const QString externalUploadSelectionStatusStart(QLatin1String("{\"a\":\"uss\","));
-    static const QString externalTransferQueryProgressStart(QLatin1String("{\"a\":\"t\","));
-    static const QString externalShowInFolder(QLatin1String("{\"a\":\"sf\","));
-    static const QString versionCommand(QLatin1String("{\"a\":\"v\"}"));
-    static const QString externalAddBackup(QLatin1String("{\"a\":\"ab\",\"u\":\""));
-
-    if(request.data == versionCommand)
+    if (!request.content)
+    {
+        return UNKNOWN_REQUEST;
+    }
+
+    const std::string& action = request.content->action();
+    if(action == "v")
     {
         return VERSION_COMMAND;
     }
-    else if(request.data.startsWith(openLinkRequestStart))
+    else if(action == "l")
     {
         return OPEN_LINK_REQUEST_START;
     }
-    else if(request.data.startsWith(externalDownloadRequestStart))
+    else if(action == "d")
     {
         return EXTERNAL_DOWNLOAD_REQUEST_START;
     }
-    else if(request.data.startsWith(externalDownloadSetRequestStart))
+    else if(action == "ds")
     {
         return EXTERNAL_DOWNLOAD_SET_REQUEST_START;
     }
-    else if(request.data.startsWith(externalFileUploadRequestStart))
+    else if(action == "ufi")
     {
         return EXTERNAL_FILE_UPLOAD_REQUEST_START;
     }
-    else if (request.data.startsWith(externalFolderUploadRequestStart))
+    else if (action == "ufo")
     {
         return EXTERNAL_FOLDER_UPLOAD_REQUEST_START;
     }
-    else if (request.data.startsWith(externalUploadSelectionStatusStart))
+    else if (action == "uss")
     {
         return EXTERNAL_UPLOAD_SELECTION_STATUS_START;
     }
-    else if (request.data.startsWith(externalFolderSyncRequestStart))
+    else if (action == "s")
     {
         return EXTERNAL_FOLDER_SYNC_REQUEST_START;
     }
-    else if (request.data.startsWith(externalFolderSyncCheckStart))
+    else if (action == "sp")
     {
         return EXTERNAL_FOLDER_SYNC_CHECK_START;
     }
-    else if(request.data.startsWith(externalOpenTransferManagerStart))
+    else if(action == "tm")
     {
         return EXTERNAL_OPEN_TRANSFER_MANAGER_START;
     }
-    else if(request.data.startsWith(externalShowInFolder))
+    else if(action == "sf")
     {
         return EXTERNAL_SHOW_IN_FOLDER;
     }
-    else if(request.data.startsWith(externalTransferQueryProgressStart))
+    else if(action == "t")
     {
         return EXTERNAL_TRANSFER_QUERY_PROGRESS_START;
     }
-    else if(request.data.startsWith(externalAddBackup))
+    else if(action == "tps")
+    {
+        return EXTERNAL_TRANSFER_PROGRESS_STREAM_START;
+    }
+    else if(action == "ab")
     {
         return EXTERNAL_ADD_BACKUP;
     }
-    else if(request.data.startsWith(externalRewindRequestStart))
+    else if(action == "gd")
     {
         return EXTERNAL_REWIND_REQUEST_START;
     }
@@ -1017,47 +1250,21 @@ QString HTTPServer::findCorrespondingAllowedOrigin(const QStringList& headers)
     return QString();
 }
 
-void HTTPServer::processPostRequest(QAbstractSocket *socket, HTTPRequest* request,
-                                    const QStringList& headers, const QString& content)
+void HTTPServer::processPostRequest(QAbstractSocket *socket, WebRequestParser* parser, HTTPRequest& request)
 {
-    QString contentLengthId = QString::fromUtf8("Content-length: ");
-    QStringList contentLengthHeader = headers.filter(QRegExp(contentLengthId, Qt::CaseInsensitive));
-    if (!contentLengthHeader.size())
+    const std::string& body = parser->body();
+    auto content = std::make_shared<WebRequest>();
+    if (!content->parse(body.data(), body.size()))
     {
-        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Missing Content-length header");
-        rejectRequest(socket);
-        return;
+        // Answered as an unknown request
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Unable to parse the JSON of a webclient request");
     }
-
-    bool ok;
-    request->contentLength = contentLengthHeader[0].mid(contentLengthId.size(), contentLengthHeader[0].size() - contentLengthId.size()).toInt(&ok);
-    if (!ok || request->contentLength < content.size())
-    {
-        if (!ok)
-        {
-            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Unable to parse Content-length header: %1")
-                         .arg(contentLengthHeader[0]).toUtf8().constData());
-        }
-        else
-        {
-            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, QString::fromUtf8("Invalid Content-length header. Header: %1 - Data: %2")
-                         .arg(request->contentLength).arg(content.size()).toUtf8().constData());
-        }
-        rejectRequest(socket);
-        return;
-    }
-
-    if (request->contentLength > content.size())
-    {
-        return;
-    }
-
-    request->data = content;
-
+    request.content = content;
+    request.data = QString::fromUtf8(body.data(), static_cast<int>(std::min(body.size(), MAX_LOGGED_BODY_SIZE)));
 
     QPointer<QAbstractSocket> safeSocket = socket;
     QPointer<HTTPServer> safeServer = this;
-    processRequest(socket, *request);
+    processRequest(socket, request);
     if (!safeServer || !safeSocket)
     {
         return;
@@ -1133,8 +1340,3 @@ bool HTTPServer::isPreFlightCorsRequest(const QStringList& headers)
 {
     return hasFieldWithValue(headers, "Access-Control-Request-Method", "POST");
 }
-
-bool HTTPServer::isRequestOfType(const QStringList& headers, const char* typeName)
-{
-    return headers[0].startsWith(QString::fromLatin1(typeName));
-}
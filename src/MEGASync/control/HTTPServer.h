@@ -10,11 +10,16 @@
 #include <QQueue>
 #include <QFutureWatcher>
 #include <QPointer>
+#include <QTimer>
+
+#include <memory>
 
 #include <megaapi.h>
 
 #include "Utilities.h"
 #include "SetManager.h"
+#include "TransferProgressFeed.h"
+#include "WebRequestParser.h"
 
 class RequestData
 {
@@ -50,10 +55,17 @@ public:
 class HTTPRequest
 {
 public:
-    HTTPRequest() : contentLength(0), origin(QString::fromUtf8("*")) {}
-    QString data;
-    int contentLength;
+    HTTPRequest() : origin(QString::fromUtf8("*")), keepAlive(false) {}
+
+    // Top level fields of the JSON content
+    QString string(const char* name) const;
+    long long number(const char* name) const;
+    QStringList stringList(const char* name) const;
+
+    QString data; // Start of the body, for the logs
     QString origin;
+    bool keepAlive;
+    std::shared_ptr<const WebRequest> content;
 };
 
 class HTTPServer: public QTcpServer
@@ -76,11 +88,14 @@ class HTTPServer: public QTcpServer
         EXTERNAL_ADD_BACKUP,
         UNKNOWN_REQUEST,
         EXTERNAL_REWIND_REQUEST_START,
-        EXTERNAL_DOWNLOAD_SET_REQUEST_START
+        EXTERNAL_DOWNLOAD_SET_REQUEST_START,
+        EXTERNAL_TRANSFER_PROGRESS_STREAM_START
     };
 
     public:
         static const unsigned int MAX_REQUEST_TIME_SECS;
+        static const int PROGRESS_STREAM_INTERVAL_MS;
+        static const int KEEP_ALIVE_TIMEOUT_MS;
 
         HTTPServer(mega::MegaApi *megaApi, quint16 port);
         ~HTTPServer();
@@ -110,6 +125,7 @@ class HTTPServer: public QTcpServer
 
     private slots:
         void onVersionCommandFinished();
+        void pushTransferProgress();
 
     public slots:
         void readClient();
@@ -120,13 +136,12 @@ class HTTPServer: public QTcpServer
     private:
         QString findCorrespondingAllowedOrigin(const QStringList& headers);
 
-        void processPostRequest(QAbstractSocket* socket, HTTPRequest* request,
-                                const QStringList& headers, const QString& content);
+        void processClientRequest(QAbstractSocket* socket, WebRequestParser* parser);
+        void processPostRequest(QAbstractSocket* socket, WebRequestParser* parser, HTTPRequest& request);
         void processOptionRequest(QAbstractSocket* socket, HTTPRequest* request, const QStringList& headers);
         void sendPreFlightResponse(QAbstractSocket* socket, HTTPRequest* request, bool sendPrivateNetworkField);
         bool hasFieldWithValue(const QStringList& headers, const char* fieldName, const char* value);
         bool isPreFlightCorsRequest(const QStringList& headers);
-        bool isRequestOfType(const QStringList& headers, const char* typeName);
 
         struct VersionCommandAnswer
         {
@@ -146,19 +161,25 @@ class HTTPServer: public QTcpServer
         void externalOpenTransferManager(QString& response, const HTTPRequest& request);
         void externalUploadSelectionStatus(QString& response, const HTTPRequest& request);
         void externalTransferQueryProgress(QString& response, const HTTPRequest& request);
+        bool externalTransferProgressStream(QString& response, const HTTPRequest& request, QAbstractSocket* socket);
         void externalShowInFolder(QString& response, const HTTPRequest& request);
         void externalAddBackup(QString& response, const HTTPRequest& request);
 
         void endProcessRequest(QPointer<QAbstractSocket> socket, const HTTPRequest &request, QString response);
+        void removeProgressStream(QAbstractSocket* socket);
 
         RequestType GetRequestType(const HTTPRequest& request);
         bool disabled;
         mega::MegaApi *megaApi;
-        QMap<QAbstractSocket*, HTTPRequest*> requests;
+        QMap<QAbstractSocket*, WebRequestParser*> requests;
         static bool isFirstWebDownloadDone;
         static QMultiMap<QString, RequestData*> webDataRequests;
         static QMap<mega::MegaHandle, RequestTransferData*> webTransferStateRequests;
+        static TransferProgressFeed webTransferProgressFeed;
         QFutureWatcher<VersionCommandAnswer> mVersionCommandWatcher;
+        // Sockets kept open to push the progress of their subscribed transfers
+        QMap<QAbstractSocket*, TransferProgressFeed::SubscriberId> mProgressStreams;
+        QTimer mProgressStreamTimer;
 };
 
 #endif // HTTPSERVER_H
@@ -0,0 +1,240 @@
+#include "LogCompressor.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <iostream>
+
+constexpr int LogCompressor::DEFAULT_LEVEL;
+constexpr std::size_t LogCompressor::DEFAULT_BLOCK_SIZE;
+constexpr std::size_t LogCompressor::DEFAULT_MAX_QUEUED_JOBS;
+
+struct LogCompressor::ZStream
+{
+    z_stream stream;
+    bool initialized = false;
+
+    ZStream()
+    {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+    }
+
+    ~ZStream()
+    {
+        if (initialized)
+        {
+            deflateEnd(&stream);
+        }
+    }
+};
+
+namespace
+{
+FILE* openForWriting(const LogCompressorPath& path)
+{
+#ifdef WIN32
+    FILE* file = nullptr;
+    return _wfopen_s(&file, path.c_str(), L"wb") ? nullptr : file;
+#else
+    return fopen(path.c_str(), "wb");
+#endif
+}
+
+void removeFile(const LogCompressorPath& path)
+{
+#ifdef WIN32
+    _wremove(path.c_str());
+#else
+    remove(path.c_str());
+#endif
+}
+}
+
+LogCompressor::LogCompressor(int level, std::size_t blockSize, std::size_t maxQueuedJobs)
+    : mLevel(std::max(Z_BEST_SPEED, std::min(level, Z_BEST_COMPRESSION))),
+      mBlockSize(std::max<std::size_t>(blockSize, 1)),
+      mMaxQueuedJobs(std::max<std::size_t>(maxQueuedJobs, 1)),
+      mStream(new ZStream())
+{
+    mPending.reserve(mBlockSize);
+    mWorker = std::thread([this]() { runWorker(); });
+}
+
+LogCompressor::~LogCompressor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+    mJobsAvailable.notify_one();
+    mWorker.join();
+    closeFile();
+}
+
+void LogCompressor::open(const LogCompressorPath& path)
+{
+    mPending.clear();
+    post([this, path]()
+    {
+        closeFile();
+        mPath = path;
+        mFailed = false;
+        mFile = openForWriting(path);
+        if (!mFile)
+        {
+            mFailed = true;
+            std::cerr << "Unable to open compressed log file for writing" << std::endl;
+        }
+    });
+}
+
+void LogCompressor::write(const char* data, std::size_t size)
+{
+    while (size)
+    {
+        auto count = std::min(size, mBlockSize - mPending.size());
+        mPending.insert(mPending.end(), data, data + count);
+        data += count;
+        size -= count;
+
+        if (mPending.size() == mBlockSize)
+        {
+            auto block = std::make_shared<std::vector<char>>();
+            block->reserve(mBlockSize);
+            std::swap(*block, mPending);
+            post([this, block]() { compressBlock(*block); });
+        }
+    }
+}
+
+void LogCompressor::finish(std::function<void(bool)> done)
+{
+    auto block = std::make_shared<std::vector<char>>();
+    std::swap(*block, mPending);
+    mPending.reserve(mBlockSize);
+    post([this, block, done]()
+    {
+        compressBlock(*block);
+        auto ok = mFile && !mFailed;
+        closeFile();
+        if (done)
+        {
+            done(ok);
+        }
+    });
+}
+
+void LogCompressor::discard()
+{
+    mPending.clear();
+    post([this]()
+    {
+        closeFile();
+        if (!mPath.empty())
+        {
+            removeFile(mPath);
+        }
+    });
+}
+
+void LogCompressor::post(std::function<void()> job)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobsDone.wait(lock, [this]() { return mJobs.size() < mMaxQueuedJobs; });
+    mJobs.push_back(std::move(job));
+    lock.unlock();
+    mJobsAvailable.notify_one();
+}
+
+void LogCompressor::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobsDone.wait(lock, [this]() { return mJobs.empty() && !mRunning; });
+}
+
+int LogCompressor::level() const
+{
+    return mLevel;
+}
+
+void LogCompressor::compressBlock(const std::vector<char>& block)
+{
+    if (block.empty() || !mFile || mFailed)
+    {
+        return;
+    }
+
+    auto& stream = mStream->stream;
+    if (!mStream->initialized)
+    {
+        // 16 + MAX_WBITS: gzip header and trailer around each block
+        if (deflateInit2(&stream, mLevel, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            mFailed = true;
+            return;
+        }
+        mStream->initialized = true;
+    }
+    else
+    {
+        deflateReset(&stream);
+    }
+
+    mCompressed.resize(deflateBound(&stream, static_cast<uLong>(block.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+    stream.avail_in = static_cast<uInt>(block.size());
+    stream.next_out = mCompressed.data();
+    stream.avail_out = static_cast<uInt>(mCompressed.size());
+
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+    {
+        mFailed = true;
+        return;
+    }
+
+    auto size = mCompressed.size() - stream.avail_out;
+    if (fwrite(mCompressed.data(), 1, size, mFile) != size)
+    {
+        mFailed = true;
+        std::cerr << "Unable to write compressed log file" << std::endl;
+    }
+}
+
+void LogCompressor::closeFile()
+{
+    if (mFile)
+    {
+        if (fclose(mFile))
+        {
+            mFailed = true;
+        }
+        mFile = nullptr;
+    }
+}
+
+void LogCompressor::runWorker()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;)
+    {
+        mJobsAvailable.wait(lock, [this]() { return mExit || !mJobs.empty(); });
+        if (mJobs.empty())
+        {
+            return;
+        }
+
+        auto job = std::move(mJobs.front());
+        mJobs.pop_front();
+        mRunning = true;
+        lock.unlock();
+        mJobsDone.notify_all();
+
+        job();
+
+        lock.lock();
+        mRunning = false;
+        mJobsDone.notify_all();
+    }
+}
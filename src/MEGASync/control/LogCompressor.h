@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Compresses the text of the current log file while it is being written.
+//
+// The text is cut in blocks and every block becomes a complete gzip member, appended to a
+// "part" file by one background worker. A sequence of gzip members is a valid gzip file, so
+// rotating the log only compresses the last partial block, and the rotated files can be joined
+// by concatenating them.
+// The worker queue is bounded: when compression falls behind, write() waits.
+
+#ifdef WIN32
+using LogCompressorPath = std::wstring;
+#else
+using LogCompressorPath = std::string;
+#endif
+
+class LogCompressor
+{
+public:
+    static constexpr int DEFAULT_LEVEL = 6;
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+    static constexpr std::size_t DEFAULT_MAX_QUEUED_JOBS = 8;
+
+    explicit LogCompressor(int level = DEFAULT_LEVEL,
+                           std::size_t blockSize = DEFAULT_BLOCK_SIZE,
+                           std::size_t maxQueuedJobs = DEFAULT_MAX_QUEUED_JOBS);
+    // Runs the jobs already queued (rotations must complete) and stops the worker
+    ~LogCompressor();
+
+    LogCompressor(const LogCompressor&) = delete;
+    LogCompressor& operator=(const LogCompressor&) = delete;
+
+    // Starts a new part file (truncated if it exists)
+    void open(const LogCompressorPath& path);
+    void write(const char* data, std::size_t size);
+    // Compresses what is left and closes the part file. done(ok) runs on the worker after that
+    void finish(std::function<void(bool)> done);
+    // Closes and removes the part file, without compressing what is left
+    void discard();
+
+    // Runs job on the worker, after the ones already queued
+    void post(std::function<void()> job);
+    void waitUntilIdle();
+
+    int level() const;
+
+private:
+    struct ZStream;
+
+    void compressBlock(const std::vector<char>& block);
+    void closeFile();
+    void runWorker();
+
+    const int mLevel;
+    const std::size_t mBlockSize;
+    const std::size_t mMaxQueuedJobs;
+
+    std::vector<char> mPending;
+
+    // Only used by the worker
+    std::unique_ptr<ZStream> mStream;
+    std::vector<unsigned char> mCompressed;
+    FILE* mFile = nullptr;
+    LogCompressorPath mPath;
+    bool mFailed = false;
+
+    std::mutex mMutex;
+    std::condition_variable mJobsAvailable;
+    std::condition_variable mJobsDone;
+    std::deque<std::function<void()>> mJobs;
+    bool mRunning = false;
+    bool mExit = false;
+    std::thread mWorker;
+};
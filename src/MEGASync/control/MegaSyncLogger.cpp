@@ -1,5 +1,7 @@
 ﻿#include "MegaSyncLogger.h"
 #include "Utilities.h"
+#include "BinaryLog.h"
+#include "LogCompressor.h"
 
 #include <fstream>
 #include <iostream>
@@ -46,45 +48,92 @@
 #endif
 
 
-void gzipCompressOnRotate(const QString filename, const QString destinationFilename)
+void renderBinaryLogLine(const BinaryLogEntry& entry, std::string& line);
+
+struct GzFileCloser
+{
+    void operator()(gzFile_s* f) const { if (f) gzclose(f); }
+};
+using GzFilePtr = std::unique_ptr<gzFile_s, GzFileCloser>;
+
+GzFilePtr openGzFileForWriting(const QString& filename)
+{
+#ifdef _WIN32
+    return GzFilePtr{ gzopen_w(filename.toStdWString().data(), "wb") };
+#else
+    return GzFilePtr{ gzopen(filename.toUtf8().data(), "wb") };
+#endif
+}
+
+BinaryLogPath toBinaryLogPath(const QString& filename)
 {
 #ifdef WIN32
-    std::ifstream file(filename.toStdWString().data(), std::ofstream::out);
+    return filename.toStdWString();
 #else
-    std::ifstream file(filename.toUtf8().data(), std::ofstream::out);
+    return filename.toUtf8().constData();
 #endif
-    if (!file.is_open())
+}
+
+LogCompressorPath toLogCompressorPath(const QString& filename)
+{
+#ifdef WIN32
+    return filename.toStdWString();
+#else
+    return filename.toUtf8().constData();
+#endif
+}
+
+// Feeds the text already in the log file (from a previous run) to the compressor
+void compressExistingLogFile(LogCompressor& compressor, const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
     {
-        std::cerr << "Unable to open log file for reading: "; CERRQSTRING(filename) << std::endl;
         return;
     }
 
-    auto gzdeleter = [](gzFile_s* f) { if (f) gzclose(f); };
+    std::vector<char> buffer(LogCompressor::DEFAULT_BLOCK_SIZE);
+    qint64 count = 0;
+    while ((count = file.read(buffer.data(), static_cast<qint64>(buffer.size()))) > 0)
+    {
+        compressor.write(buffer.data(), static_cast<std::size_t>(count));
+    }
+}
 
-#ifdef _WIN32
-    std::unique_ptr<gzFile_s, decltype(gzdeleter)> gzfile{ gzopen_w(destinationFilename.toStdWString().data(), "wb"), gzdeleter};
-#else
-    std::unique_ptr<gzFile_s, decltype(gzdeleter)> gzfile{ gzopen(destinationFilename.toUtf8().data(), "wb"), gzdeleter };
-#endif
+// Rotated binary segments are stored as compressed text, as the text logs
+void gzipCompressBinaryOnRotate(const QString filename, const QString destinationFilename)
+{
+    BinaryLogReader reader;
+    if (!reader.open(toBinaryLogPath(filename)))
+    {
+        std::cerr << "Unable to open binary log file for reading: "; CERRQSTRING(filename) << std::endl;
+        return;
+    }
+
+    auto gzfile = openGzFileForWriting(destinationFilename);
     if (!gzfile)
     {
         std::cerr << "Unable to open gzfile for writing: "; CERRQSTRING(filename) << std::endl;
         return;
     }
 
+    bool failed = false;
     std::string line;
-    while (std::getline(file, line))
+    reader.forEachEntry([&gzfile, &failed, &line](const BinaryLogEntry& entry)
     {
-        line.push_back('\n');
-        if (gzputs(gzfile.get(), line.c_str()) == -1)
+        renderBinaryLogLine(entry, line);
+        if (!failed && !line.empty() && gzwrite(gzfile.get(), line.data(), unsigned(line.size())) <= 0)
         {
-            std::cerr << "Unable to compress log file: "; CERRQSTRING(filename) << std::endl;
-            return;
+            failed = true;
         }
+    });
+    if (failed)
+    {
+        std::cerr << "Unable to compress log file: "; CERRQSTRING(filename) << std::endl;
+        return;
     }
 
     gzfile.reset();
-    file.close();
     QFile::remove(filename);
 }
 
@@ -156,7 +205,6 @@ struct LoggingThread
     std::unique_ptr<std::thread> logThread;
     std::condition_variable logConditionVariable;
     std::mutex logMutex;
-    std::mutex logRotationMutex;
     LogLinkedList logListFirst;
     LogLinkedList* logListLast = &logListFirst;
     bool logExit = false;
@@ -166,6 +214,8 @@ struct LoggingThread
     bool forceRenew = false; //to force removal of all logs and create an empty MEGAsync.log
     bool logToDesktop = false;
     bool logToDesktopChanged = false;
+    bool binaryRecordsReady = false;
+    std::unique_ptr<BinaryLogWriter> binaryLog; // set when MEGA_BINARY_LOG is defined
     int flushOnLevel = mega::MegaApi::LOG_LEVEL_WARNING;
     std::chrono::seconds logFlushPeriod = std::chrono::seconds(10);
     std::chrono::steady_clock::time_point nextFlushTime = std::chrono::steady_clock::now() + logFlushPeriod;
@@ -174,6 +224,11 @@ struct LoggingThread
     {
         if (!logThread)
         {
+            if (getenv("MEGA_BINARY_LOG"))
+            {
+                binaryLog.reset(new BinaryLogWriter());
+            }
+
             logThread.reset(new std::thread([this, filename, desktopFilename]() {
                 logThreadFunction(filename, desktopFilename);
             }));
@@ -192,6 +247,61 @@ private:
         return newName;
     }
 
+    QString binaryLogFilename(QString baseName)
+    {
+        auto index = baseName.lastIndexOf(QString::fromUtf8("."));
+        return (index > 0 ? baseName.left(index) : baseName) + QString::fromUtf8(".blog");
+    }
+
+    // New segments start with the names of the threads, so they can be rendered on their own
+    void openBinarySegment(BinaryLogSegment& segment, const QString& segmentFilename, std::uint64_t capacity)
+    {
+        if (!segment.open(toBinaryLogPath(segmentFilename), capacity, binaryLog->wallClockBaseMicros(), binaryLog->steadyBaseMicros()))
+        {
+            std::cerr << "Unable to open binary log file: "; CERRQSTRING(segmentFilename) << std::endl;
+            return;
+        }
+
+        std::vector<char> names;
+        binaryLog->threadNameRecords(names);
+        segment.write(names.data(), names.size());
+    }
+
+    // Runs on the compressor worker, so it is ordered with the rotations still being finished
+    void rotateNumberedLogs(const QString& filename, int logCountToRotate, int logCountToClean)
+    {
+        for (int i = logCountToClean; i--; )
+        {
+            QString toRename = numberedLogFilename(filename, i);
+
+            if (QFile::exists(toRename))
+            {
+                if (i + 1 >= logCountToRotate)
+                {
+                    if (!QFile::remove(toRename))
+                    {
+                        std::cerr << "Error removing log file " << i << std::endl;
+                    }
+
+                }
+                else
+                {
+                    if (!QFile(toRename).rename(numberedLogFilename(filename, i + 1)))
+                    {
+                        std::cerr << "Error renaming log file " << i << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    // Writes the records taken from the threads. Returns false if the segment is full
+    bool writeBinaryRecords(BinaryLogSegment& segment, const std::vector<char>& records, std::size_t& written)
+    {
+        written += segment.write(records.data() + written, records.size() - written);
+        return written == records.size();
+    }
+
     void logThreadFunction(QString filename, QString desktopFilename)
     {
         int logSizeBeforeCompressMb = MAX_LOG_FILESIZE_MB_DEFAULT;
@@ -207,13 +317,57 @@ private:
             logCountToClean = std::max(logCountToRotate, logCountToClean);
         }
 
+        int compressionLevel = LogCompressor::DEFAULT_LEVEL;
+        if (auto level = getenv("MEGA_LOG_COMPRESSION_LEVEL"))
+        {
+            compressionLevel = atoi(level);
+        }
+        LogCompressor compressor(compressionLevel);
+        const QString compressingFilename = filename + QString::fromUtf8(".zipping");
+        int binaryRotations = 0;
+
+        const bool binary = binaryLog != nullptr;
+        const QString binaryFilename = binaryLogFilename(filename);
+        const std::uint64_t binarySegmentCapacity = (static_cast<std::uint64_t>(logSizeBeforeCompressMb) + 1) * 1024 * 1024;
+        BinaryLogSegment binarySegment;
+        BinaryLogRenderer binaryRenderer;
+        std::vector<char> binaryRecords;
+        std::size_t binaryRecordsWritten = 0;
+        bool binarySegmentFull = false;
+        std::string renderedLine;
+
+        std::ofstream outputFile;
+        static const char programStart[] = "----------------------------- program start -----------------------------\n";
+        long long outFileSize = 0;
+        if (binary)
+        {
+            openBinarySegment(binarySegment, binaryFilename, binarySegmentCapacity);
+            binaryRenderer.setTimeBase(binaryLog->wallClockBaseMicros(), binaryLog->steadyBaseMicros());
+            binaryLog->appendRawLine(programStart, sizeof(programStart) - 1);
+            outFileSize = static_cast<long long>(binarySegment.used());
+        }
+        else
+        {
+            compressor.open(toLogCompressorPath(compressingFilename));
+            compressExistingLogFile(compressor, filename);
     #ifdef WIN32
-        std::ofstream outputFile(filename.toStdWString().data(), std::ofstream::out | std::ofstream::app);
+            outputFile.open(filename.toStdWString().data(), std::ofstream::out | std::ofstream::app);
     #else
-        std::ofstream outputFile(filename.toUtf8().data(), std::ofstream::out | std::ofstream::app);
+            outputFile.open(filename.toUtf8().data(), std::ofstream::out | std::ofstream::app);
     #endif
-        outputFile << "----------------------------- program start -----------------------------\n";
-        long long outFileSize = outputFile.tellp();
+            outputFile << programStart;
+            compressor.write(programStart, sizeof(programStart) - 1);
+            outFileSize = outputFile.tellp();
+        }
+
+        // The text written to the log file is compressed as it goes
+        std::ostringstream directOutput;
+        auto writeLogFile = [&outputFile, &compressor](const char* data, std::size_t size)
+        {
+            outputFile.write(data, static_cast<std::streamsize>(size));
+            compressor.write(data, size);
+        };
+        static const char gapLine[] = "<log gap - out of logging memory at this point>\n";
         std::ofstream logDesktopFile;
         bool logDesktopFileOpen = false;
 
@@ -221,92 +375,119 @@ private:
         {
             if (forceRenew)
             {
-                std::lock_guard<std::mutex> g(logRotationMutex);
-                for (int i = logCountToClean; i--; )
-                {
-                    QString toDelete = numberedLogFilename(filename, i);
-
-                    if (QFile::exists(toDelete))
+                compressor.post([=]() {
+                    for (int i = logCountToClean; i--; )
                     {
-                        if (!QFile::remove(toDelete))
+                        QString toDelete = numberedLogFilename(filename, i);
+
+                        if (QFile::exists(toDelete))
                         {
-                            std::cerr << "Error removing log file " << i << std::endl;
+                            if (!QFile::remove(toDelete))
+                            {
+                                std::cerr << "Error removing log file " << i << std::endl;
+                            }
                         }
                     }
-                }
 
-                outputFile.close();
-                if (!QFile::remove(filename) )
+                    if (g_megaSyncLogger)
+                    {
+                        emit g_megaSyncLogger->logCleaned();
+                    }
+                });
+
+                if (binary)
                 {
-                    std::cerr << "Error removing log file!! " << std::endl;
+                    binarySegment.close();
+                    if (!QFile::remove(binaryFilename))
+                    {
+                        std::cerr << "Error removing log file!! " << std::endl;
+                    }
+
+                    openBinarySegment(binarySegment, binaryFilename, binarySegmentCapacity);
+                    outFileSize = static_cast<long long>(binarySegment.used());
                 }
+                else
+                {
+                    outputFile.close();
+                    if (!QFile::remove(filename) )
+                    {
+                        std::cerr << "Error removing log file!! " << std::endl;
+                    }
 
+                    compressor.discard();
+                    compressor.open(toLogCompressorPath(compressingFilename));
     #ifdef WIN32
-                outputFile.open(filename.toStdWString().data(), std::ofstream::out);
+                    outputFile.open(filename.toStdWString().data(), std::ofstream::out);
     #else
-                outputFile.open(filename.toUtf8().data(), std::ofstream::out);
+                    outputFile.open(filename.toUtf8().data(), std::ofstream::out);
     #endif
-                outFileSize = 0;
+                    outFileSize = 0;
+                }
 
                 forceRenew = false;
+            }
+            else if (forceRotationForReporting || binarySegmentFull || outFileSize > logSizeBeforeCompressMb*1024*1024)
+            {
+                auto newNameDone = numberedLogFilename(filename, 0);
+                bool report = forceRotationForReporting;
+                forceRotationForReporting = false;
 
-                if (g_megaSyncLogger)
+                // Rotation only waits for the last block of the file to be compressed, so a bug report
+                // does not wait for the whole file. File operations happen in order on the compressor worker
+                if (binary)
                 {
-                    emit g_megaSyncLogger->logCleaned();
+                    binarySegment.close();
+                    auto newNameZipping = newNameDone + QString::fromUtf8(".zipping") + QString::number(binaryRotations++);
+                    QFile::remove(newNameZipping);
+                    QFile(binaryFilename).rename(newNameZipping);
+
+                    compressor.post([=]() {
+                        rotateNumberedLogs(filename, logCountToRotate, logCountToClean);
+                        gzipCompressBinaryOnRotate(newNameZipping, newNameDone);
+                        if (report && g_megaSyncLogger)
+                        {
+                            emit g_megaSyncLogger->logReadyForReporting();
+                        }
+                    });
                 }
-            }
-            else if (forceRotationForReporting || outFileSize > logSizeBeforeCompressMb*1024*1024)
-            {
-                std::lock_guard<std::mutex> g(logRotationMutex);
-                for (int i = logCountToClean; i--; )
+                else
                 {
-                    QString toRename = numberedLogFilename(filename, i);
-
-                    if (QFile::exists(toRename))
+                    outputFile.close();
+                    if (!QFile::remove(filename))
                     {
-                        if (i + 1 >= logCountToRotate)
-                        {
-                            if (!QFile::remove(toRename))
-                            {
-                                std::cerr << "Error removing log file " << i << std::endl;
-                            }
+                        std::cerr << "Error removing log file!! " << std::endl;
+                    }
 
+                    compressor.finish([=](bool compressed) {
+                        rotateNumberedLogs(filename, logCountToRotate, logCountToClean);
+                        if (!compressed || !QFile(compressingFilename).rename(newNameDone))
+                        {
+                            std::cerr << "Unable to compress log file: "; CERRQSTRING(newNameDone) << std::endl;
+                            QFile::remove(compressingFilename);
                         }
-                        else
+                        if (report && g_megaSyncLogger)
                         {
-                            if (!QFile(toRename).rename(numberedLogFilename(filename, i + 1)))
-                            {
-                                std::cerr << "Error renaming log file " << i << std::endl;
-                            }
+                            emit g_megaSyncLogger->logReadyForReporting();
                         }
-                    }
+                    });
+                    compressor.open(toLogCompressorPath(compressingFilename));
                 }
-                auto newNameDone = numberedLogFilename(filename, 0);
-                auto newNameZipping = newNameDone + QString::fromUtf8(".zipping");
-
-                outputFile.close();
-                QFile::remove(newNameZipping);
-                QFile(filename).rename(newNameZipping);
-
-                bool report = forceRotationForReporting;
-                forceRotationForReporting = false;
-
-                std::thread t([=]() {
-                    std::lock_guard<std::mutex> g(logRotationMutex); // prevent another rotation while we work on this file (in case of unfortunate timing with bug report etc)
-                    gzipCompressOnRotate(newNameZipping, newNameDone);
-                    if (report && g_megaSyncLogger)
-                    {
-                        emit g_megaSyncLogger->logReadyForReporting();
-                    }
-                });
-                t.detach();
 
+                if (binary)
+                {
+                    openBinarySegment(binarySegment, binaryFilename, binarySegmentCapacity);
+                    binarySegmentFull = !writeBinaryRecords(binarySegment, binaryRecords, binaryRecordsWritten);
+                    outFileSize = static_cast<long long>(binarySegment.used());
+                }
+                else
+                {
     #ifdef WIN32
-                outputFile.open(filename.toStdWString().data(), std::ofstream::out);
+                    outputFile.open(filename.toStdWString().data(), std::ofstream::out);
     #else
-                outputFile.open(filename.toUtf8().data(), std::ofstream::out);
+                    outputFile.open(filename.toUtf8().data(), std::ofstream::out);
     #endif
-                outFileSize = 0;
+                    outFileSize = 0;
+                }
             }
 
             LogLinkedList* newMessages = nullptr;
@@ -314,8 +495,10 @@ private:
             {
                 std::unique_lock<std::mutex> lock(logMutex);
                 logConditionVariable.wait_for(lock, std::chrono::milliseconds(500), [this, &newMessages, &topLevelMemoryGap]() {
-                        if (forceRenew || logListFirst.next || logExit || forceRotationForReporting || logToDesktopChanged || flushLog || closeLog)
+                        if (forceRenew || logListFirst.next || logExit || forceRotationForReporting || logToDesktopChanged || flushLog || closeLog
+                                || binaryRecordsReady)
                         {
+                            binaryRecordsReady = false;
                             newMessages = logListFirst.next;
                             logListFirst.next = nullptr;
                             logListLast = &logListFirst;
@@ -350,11 +533,11 @@ private:
             {
                 if (outputFile)
                 {
-                    outputFile << "<log gap - out of logging memory at this point>\n";
+                    writeLogFile(gapLine, sizeof(gapLine) - 1);
                 }
                 if (logDesktopFile)
                 {
-                    logDesktopFile << "<log gap - out of logging memory at this point>\n";
+                    logDesktopFile << gapLine;
                 }
             }
 
@@ -366,15 +549,18 @@ private:
                 {
                     if (p->needsDirectOutput())
                     {
-                        (*p->mDirectLoggingFunction)(&outputFile);
+                        directOutput.str(std::string());
+                        (*p->mDirectLoggingFunction)(&directOutput);
+                        auto text = directOutput.str();
+                        writeLogFile(text.data(), text.size());
                     }
                     else
                     {
-                        outputFile << p->message;
+                        writeLogFile(p->message, p->used);
                         outFileSize += p->used;
                         if (p->oomGap)
                         {
-                            outputFile << "<log gap - out of logging memory at this point>\n";
+                            writeLogFile(gapLine, sizeof(gapLine) - 1);
                         }
                     }
                 }
@@ -389,7 +575,7 @@ private:
                         logDesktopFile << p->message;
                         if (p->oomGap)
                         {
-                            logDesktopFile << "<log gap - out of logging memory at this point>\n";
+                            logDesktopFile << gapLine;
                         }
                     }
                     if (!newMessages)
@@ -416,10 +602,49 @@ private:
                 p->notifyWaiter();
                 free(p);
             }
+
+            if (binary && !binarySegmentFull)
+            {
+                binaryLog->takeRecords(binaryRecords);
+                binaryRecordsWritten = 0;
+                binarySegmentFull = !writeBinaryRecords(binarySegment, binaryRecords, binaryRecordsWritten);
+                outFileSize = static_cast<long long>(binarySegment.used());
+
+                // The text is only produced here, when someone is reading it live
+                bool toStdout = g_megaSyncLogger && g_megaSyncLogger->mLogToStdout;
+                if (logDesktopFileOpen || toStdout)
+                {
+                    binaryRenderer.render(binaryRecords.data(), binaryRecords.size(), [&](const BinaryLogEntry& entry)
+                    {
+                        renderBinaryLogLine(entry, renderedLine);
+                        if (logDesktopFileOpen)
+                        {
+                            logDesktopFile << renderedLine;
+                        }
+                        if (toStdout)
+                        {
+                            std::cout << renderedLine;
+                        }
+                    });
+                    if (logDesktopFileOpen)
+                    {
+                        logDesktopFile.flush();
+                    }
+                    if (toStdout)
+                    {
+                        std::cout << std::flush;
+                    }
+                }
+                else
+                {
+                    binaryRenderer.trackThreadNames(binaryRecords.data(), binaryRecords.size());
+                }
+            }
             if (flushLog || forceRotationForReporting || nextFlushTime <= std::chrono::steady_clock::now())
             {
                 flushLog = false;
                 outputFile.flush();
+                binarySegment.flush();
                 if (logDesktopFile)
                 {
                     logDesktopFile.flush();
@@ -433,6 +658,10 @@ private:
 
             if (closeLog)
             {
+                if (binary)
+                {
+                    closeBinarySegment(binarySegment, binaryRecords, binaryRecordsWritten);
+                }
                 outputFile.close();
                 if (logDesktopFile)
                 {
@@ -441,6 +670,23 @@ private:
                 return;  // This request means we have received a termination signal; close and exit the thread as quick & clean as possible
             }
         }
+
+        if (binary)
+        {
+            closeBinarySegment(binarySegment, binaryRecords, binaryRecordsWritten);
+        }
+    }
+
+    // Writes what the threads logged until now and trims the segment file
+    void closeBinarySegment(BinaryLogSegment& segment, std::vector<char>& records, std::size_t& written)
+    {
+        if (writeBinaryRecords(segment, records, written))
+        {
+            binaryLog->takeRecords(records);
+            written = 0;
+            writeBinaryRecords(segment, records, written);
+        }
+        segment.close();
     }
 
 };
@@ -522,6 +768,62 @@ char* filltime(char* s, struct tm*  gmt, int microsec)
     return s;
 }
 
+const char* logLevelString(int loglevel)
+{
+    switch (loglevel) // keeping these at 4 chars makes nice columns, easy to read
+    {
+    case mega::MegaApi::LOG_LEVEL_FATAL: return "CRIT ";
+    case mega::MegaApi::LOG_LEVEL_ERROR: return "ERR  ";
+    case mega::MegaApi::LOG_LEVEL_WARNING: return "WARN ";
+    case mega::MegaApi::LOG_LEVEL_INFO: return "INFO ";
+    case mega::MegaApi::LOG_LEVEL_DEBUG: return "DBG  ";
+    case mega::MegaApi::LOG_LEVEL_MAX: return "DTL  ";
+    }
+    return "     ";
+}
+
+// Same line as LoggingThread::log() writes in text mode
+void renderBinaryLogLine(const BinaryLogEntry& entry, std::string& line)
+{
+    line.clear();
+    switch (entry.type)
+    {
+    case BinaryLog::RAW_LINE:
+        line.append(entry.message, entry.length);
+        return;
+    case BinaryLog::GAP:
+        line.append("<log gap - out of logging memory at this point>\n");
+        return;
+    case BinaryLog::MESSAGE:
+        break;
+    default:
+        return;
+    }
+
+    // Only called from the logging and rotation threads, gmtime is called once per second
+    thread_local time_t lastSecond = -1;
+    thread_local struct tm lastGmt;
+    time_t t = static_cast<time_t>(entry.wallClockMicros / 1000000);
+    if (t != lastSecond)
+    {
+#ifdef WIN32
+        gmtime_s(&lastGmt, &t);
+#else
+        gmtime_r(&t, &lastGmt);
+#endif
+        lastSecond = t;
+    }
+
+    char timebuf[LOG_TIME_CHARS + 1];
+    filltime(timebuf, &lastGmt, static_cast<int>(entry.wallClockMicros % 1000000));
+
+    line.append(timebuf, LOG_TIME_CHARS);
+    line.append(*entry.threadName);
+    line.append(logLevelString(entry.level), LOG_LEVEL_CHARS);
+    line.append(entry.message, entry.length);
+    line.push_back('\n');
+}
+
 std::mutex threadNameMutex;
 std::map<std::thread::id, std::string> threadNames;
 struct tm lastTm;
@@ -600,6 +902,25 @@ void LoggingThread::log(int loglevel, const char *message, const char **directMe
 
     bool direct = directMessages != nullptr;
 
+    if (binaryLog)
+    {
+        // Only the message is copied here, the logging thread turns the records into text when needed
+        bool notify = direct ? binaryLog->append(loglevel, directMessages, directMessagesSizes, numberMessages)
+                             : binaryLog->append(loglevel, message, strlen(message));
+        // Lines at or above the flush level are written at once, as in text mode
+        bool flush = loglevel <= flushOnLevel;
+        if (notify || flush)
+        {
+            {
+                std::lock_guard<std::mutex> g(logMutex);
+                binaryRecordsReady |= notify;
+                flushLog |= flush;
+            }
+            logConditionVariable.notify_one();
+        }
+        return;
+    }
+
     char timebuf[LOG_TIME_CHARS + 1];
     auto now = std::chrono::system_clock::now();
     time_t t = std::chrono::system_clock::to_time_t(now);
@@ -611,16 +932,7 @@ void LoggingThread::log(int loglevel, const char *message, const char **directMe
     auto microsec = std::chrono::duration_cast<std::chrono::microseconds>(now - std::chrono::system_clock::from_time_t(t));
     filltime(timebuf, &gmt, (int)microsec.count() % 1000000);
 
-    const char* loglevelstring = "     ";
-    switch (loglevel) // keeping these at 4 chars makes nice columns, easy to read
-    {
-    case mega::MegaApi::LOG_LEVEL_FATAL: loglevelstring = "CRIT "; break;
-    case mega::MegaApi::LOG_LEVEL_ERROR: loglevelstring = "ERR  "; break;
-    case mega::MegaApi::LOG_LEVEL_WARNING: loglevelstring = "WARN "; break;
-    case mega::MegaApi::LOG_LEVEL_INFO: loglevelstring = "INFO "; break;
-    case mega::MegaApi::LOG_LEVEL_DEBUG: loglevelstring = "DBG  "; break;
-    case mega::MegaApi::LOG_LEVEL_MAX: loglevelstring = "DTL  "; break;
-    }
+    const char* loglevelstring = logLevelString(loglevel);
 
     auto messageLen = strlen(message);
     auto threadnameLen = strlen(threadname);
@@ -745,6 +1057,23 @@ void LoggingThread::log(int loglevel, const char *message, const char **directMe
     }
 }
 
+bool MegaSyncLogger::renderBinaryLog(const QString& binaryLogPath, std::ostream& output)
+{
+    BinaryLogReader reader;
+    if (!reader.open(toBinaryLogPath(binaryLogPath)))
+    {
+        return false;
+    }
+
+    std::string line;
+    reader.forEachEntry([&line, &output](const BinaryLogEntry& entry)
+    {
+        renderBinaryLogLine(entry, line);
+        output << line;
+    });
+    return output.good();
+}
+
 void MegaSyncLogger::setDebug(const bool enable)
 {
     g_loggingThread->logToDesktop = enable;
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <ostream>
 
 #include <QLocalSocket>
 #include <QLocalServer>
@@ -43,6 +44,9 @@ public:
     bool cleanLogs();
     void resumeAfterReporting();
 
+    // Writes a binary log file (MEGA_BINARY_LOG mode) as text, in the same format as the text logs
+    static bool renderBinaryLog(const QString& binaryLogPath, std::ostream& output);
+
 signals:
     void logReadyForReporting();
     void logCleaned();
@@ -0,0 +1,138 @@
+#ifndef MPSC_RING_BUFFER
+#define MPSC_RING_BUFFER
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+// Bounded multi-producer/single-consumer queue.
+// Producers never block: push() fails when the buffer is full, so the caller decides what to do
+// with the event (drop, coalesce or fall back to a slower path).
+// Each cell carries a sequence number that tells whether it is free for the producer that
+// reserved it or ready for the consumer (D. Vyukov's bounded queue design).
+template <typename T>
+class MpscRingBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "MpscRingBuffer items must be trivially copyable");
+
+public:
+    // Capacity is rounded up to the next power of two
+    explicit MpscRingBuffer(std::size_t capacity)
+        : mCapacity(roundUpToPowerOfTwo(capacity)),
+          mMask(mCapacity - 1),
+          mCells(new Cell[mCapacity])
+    {
+        for(std::size_t index = 0; index < mCapacity; ++index)
+        {
+            mCells[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    // Safe to call from any number of threads
+    bool push(const T& item)
+    {
+        auto position(mTail.load(std::memory_order_relaxed));
+        for(;;)
+        {
+            auto& cell(mCells[position & mMask]);
+            auto sequence(cell.sequence.load(std::memory_order_acquire));
+            auto diff(static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position));
+
+            if(diff == 0)
+            {
+                if(mTail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0)
+            {
+                // The consumer has not released this cell yet: full
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = mTail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only one thread may consume
+    bool pop(T& item)
+    {
+        auto& cell(mCells[mHead & mMask]);
+        auto sequence(cell.sequence.load(std::memory_order_acquire));
+
+        if(sequence != mHead + 1)
+        {
+            return false;
+        }
+
+        item = cell.item;
+        cell.sequence.store(mHead + mCapacity, std::memory_order_release);
+        ++mHead;
+        return true;
+    }
+
+    // Pops up to maxItems and passes them to func. Returns the number of items consumed
+    template <typename Func>
+    std::size_t drain(Func func, std::size_t maxItems)
+    {
+        std::size_t consumed(0);
+        T item;
+        while(consumed < maxItems && pop(item))
+        {
+            func(item);
+            ++consumed;
+        }
+        return consumed;
+    }
+
+    std::size_t capacity() const
+    {
+        return mCapacity;
+    }
+
+    // Number of pushes rejected because the buffer was full
+    std::size_t dropped() const
+    {
+        return mDropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result(2);
+        while(result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Avoid false sharing between the producers' and the consumer's counters
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T item;
+    };
+
+    const std::size_t mCapacity;
+    const std::size_t mMask;
+    std::unique_ptr<Cell[]> mCells;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mTail{0};
+    alignas(CACHE_LINE_SIZE) std::size_t mHead{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mDropped{0};
+};
+
+#endif // MPSC_RING_BUFFER
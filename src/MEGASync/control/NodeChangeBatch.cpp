@@ -0,0 +1,105 @@
+#include "NodeChangeBatch.h"
+
+#include <algorithm>
+#include <iterator>
+
+constexpr NodeChangeBatch::Handle NodeChangeBatch::INVALID_HANDLE;
+
+void NodeChangeBatch::add(Handle handle, Handle parent, unsigned int types)
+{
+    for (int type = 0; type < TYPES; ++type)
+    {
+        if (!(types & (1u << type)))
+        {
+            continue;
+        }
+
+        if (type == MOVED)
+        {
+            mMoves.push_back({handle, parent});
+        }
+        else
+        {
+            mHandles[type].push_back(handle);
+        }
+    }
+}
+
+void NodeChangeBatch::finish()
+{
+    for (int type = 0; type < TYPES; ++type)
+    {
+        auto& handles = mHandles[type];
+        std::sort(handles.begin(), handles.end());
+        handles.erase(std::unique(handles.begin(), handles.end()), handles.end());
+    }
+
+    // Stable, so that the last move of a node comes last among its duplicates
+    std::stable_sort(mMoves.begin(), mMoves.end(), [](const Move& a, const Move& b)
+    {
+        return a.handle < b.handle;
+    });
+    auto& moved = mHandles[MOVED];
+    moved.clear();
+    mParents.clear();
+    for (std::size_t i = 0; i < mMoves.size(); ++i)
+    {
+        if (i + 1 < mMoves.size() && mMoves[i + 1].handle == mMoves[i].handle)
+        {
+            continue;
+        }
+        moved.push_back(mMoves[i].handle);
+        mParents.push_back(mMoves[i].parent);
+    }
+    mMoves.clear();
+    mMoves.shrink_to_fit();
+
+    std::vector<Handle> nodes;
+    for (const auto& handles : mHandles)
+    {
+        std::vector<Handle> merged;
+        merged.reserve(nodes.size() + handles.size());
+        std::set_union(nodes.begin(), nodes.end(), handles.begin(), handles.end(), std::back_inserter(merged));
+        nodes.swap(merged);
+    }
+    mNodes = nodes.size();
+}
+
+bool NodeChangeBatch::empty() const
+{
+    return mNodes == 0;
+}
+
+std::size_t NodeChangeBatch::size() const
+{
+    return mNodes;
+}
+
+const std::vector<NodeChangeBatch::Handle>& NodeChangeBatch::handles(Type type) const
+{
+    return mHandles[type];
+}
+
+bool NodeChangeBatch::contains(Type type, Handle handle) const
+{
+    return std::binary_search(mHandles[type].begin(), mHandles[type].end(), handle);
+}
+
+NodeChangeBatch::Handle NodeChangeBatch::parentOf(Handle handle) const
+{
+    const auto& moved = mHandles[MOVED];
+    auto it = std::lower_bound(moved.begin(), moved.end(), handle);
+    if (it == moved.end() || *it != handle)
+    {
+        return INVALID_HANDLE;
+    }
+    return mParents[static_cast<std::size_t>(it - moved.begin())];
+}
+
+std::vector<NodeChangeBatch::Handle> NodeChangeBatch::movedParents() const
+{
+    std::vector<Handle> parents(mParents);
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    return parents;
+}
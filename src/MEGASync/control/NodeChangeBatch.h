@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Changes of the nodes received in one SDK update, grouped by type in sorted handle vectors.
+/// Consumers handle the whole update at once instead of reacting to a signal per node.
+/// Filled with add() and finish() before being shared; read only afterwards.
+class NodeChangeBatch
+{
+public:
+    using Handle = uint64_t;
+
+    enum Type
+    {
+        MOVED = 0,
+        ATTRIBUTES,
+        NAME,
+        NEW,
+        REMOVED,
+        TYPES
+    };
+
+    static constexpr Handle INVALID_HANDLE = ~Handle(0);
+
+    /// types is a mask of (1 << Type). parent is kept for moved nodes
+    void add(Handle handle, Handle parent, unsigned int types);
+    /// Sorts the handles and drops duplicates, keeping the last parent of a moved node
+    void finish();
+
+    bool empty() const;
+    /// Number of nodes with at least one change
+    std::size_t size() const;
+
+    const std::vector<Handle>& handles(Type type) const;
+    bool contains(Type type, Handle handle) const;
+
+    /// New parent of a moved node, INVALID_HANDLE when it did not move
+    Handle parentOf(Handle handle) const;
+    /// Distinct new parents of the moved nodes, sorted
+    std::vector<Handle> movedParents() const;
+
+private:
+    struct Move
+    {
+        Handle handle;
+        Handle parent;
+    };
+
+    std::vector<Handle> mHandles[TYPES];
+    // Filled by add(), split into mHandles[MOVED] and mParents by finish()
+    std::vector<Move> mMoves;
+    // Parent of each handle of mHandles[MOVED]
+    std::vector<Handle> mParents;
+    std::size_t mNodes = 0;
+};
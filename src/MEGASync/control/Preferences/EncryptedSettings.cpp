@@ -1,9 +1,26 @@
 #include "EncryptedSettings.h"
 #include "platform/Platform.h"
 
+constexpr int EncryptedSettings::FLUSH_DELAY_MS;
+constexpr int EncryptedSettings::SNAPSHOT_SHARDS;
+
 EncryptedSettings::EncryptedSettings(QString file) :
-    QSettings(file, QSettings::IniFormat)
+    QSettings(file, QSettings::IniFormat),
+    mStableGroup(std::make_shared<QString>()),
+    mFlushPending(false)
 {
+    clearCache();
+
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(FLUSH_DELAY_MS);
+    connect(&mFlushTimer, &QTimer::timeout, this, [this]()
+    {
+        if (mFlushPending.exchange(false))
+        {
+            flush();
+        }
+    });
+
 #ifdef _WIN32
     // On Win, LocalStorageKey can change after an OS update, so don't fetch it every time from the OS.
     // Use the cached one if available, and only get it from the OS if not.
@@ -29,14 +46,59 @@ EncryptedSettings::EncryptedSettings(QString file) :
 #endif
 }
 
+EncryptedSettings::~EncryptedSettings()
+{
+    if (mFlushPending.exchange(false))
+    {
+        flush();
+    }
+}
+
 void EncryptedSettings::setValue(const QString &key, const QVariant &value)
 {
     QSettings::setValue(hash(key), encrypt(key, value.toString()));
+    cacheValue(cacheKey(key), QVariant(value.toString()));
 }
 
 QVariant EncryptedSettings::value(const QString &key, const QVariant &defaultValue)
 {
-    return QVariant(decrypt(key, QSettings::value(hash(key), encrypt(key, defaultValue.toString())).toString()));
+    const QString fullKey(cacheKey(key));
+    QVariant storedValue;
+    auto values = std::atomic_load(&mValues[shardOf(fullKey)]);
+    auto it = values->constFind(fullKey);
+    if (it != values->constEnd())
+    {
+        storedValue = it.value();
+    }
+    else
+    {
+        QString hashedKey(hash(key));
+        if (QSettings::contains(hashedKey))
+        {
+            storedValue = QVariant(decrypt(key, QSettings::value(hashedKey).toString()));
+        }
+        cacheValue(fullKey, storedValue);
+    }
+    return storedValue.isValid() ? storedValue : QVariant(defaultValue.toString());
+}
+
+bool EncryptedSettings::cachedValue(const QString &key, const QVariant &defaultValue, QVariant &result) const
+{
+    auto group = std::atomic_load(&mStableGroup);
+    const QString fullKey(*group + QLatin1Char('\n') + key);
+    auto values = std::atomic_load(&mValues[shardOf(fullKey)]);
+    auto it = values->constFind(fullKey);
+    if (it == values->constEnd())
+    {
+        return false;
+    }
+    result = it.value().isValid() ? it.value() : QVariant(defaultValue.toString());
+    return true;
+}
+
+void EncryptedSettings::markGroupStable()
+{
+    std::atomic_store(&mStableGroup, std::shared_ptr<const QString>(std::make_shared<QString>(QSettings::group())));
 }
 
 void EncryptedSettings::beginGroup(const QString &prefix)
@@ -79,16 +141,20 @@ void EncryptedSettings::remove(const QString &key)
     {
         QSettings::remove(hash(key));
     }
+    // Removing a key can remove a whole group
+    clearCache();
 }
 
 void EncryptedSettings::clear()
 {
     QSettings::clear();
+    clearCache();
 }
 
 void EncryptedSettings::sync()
 {
-    QSettings::sync();
+    mFlushPending = false;
+    flush();
 }
  
 //Simplified XOR fun
@@ -150,12 +216,51 @@ QString EncryptedSettings::hash(const QString key) const
     return QString::fromLatin1(xKeyHash.toHex());
 }
 
+QString EncryptedSettings::cacheKey(const QString &key) const
+{
+    return group() + QLatin1Char('\n') + key;
+}
+
+std::size_t EncryptedSettings::shardOf(const QString &cacheKey)
+{
+    return qHash(cacheKey) % SNAPSHOT_SHARDS;
+}
+
+void EncryptedSettings::cacheValue(const QString &key, const QVariant &value)
+{
+    std::lock_guard<std::mutex> lock(mValuesWriteMutex);
+    auto& shard = mValues[shardOf(key)];
+    auto values = std::make_shared<ValueSnapshot>(*std::atomic_load(&shard));
+    values->insert(key, value);
+    std::atomic_store(&shard, std::shared_ptr<const ValueSnapshot>(std::move(values)));
+}
+
+void EncryptedSettings::clearCache()
+{
+    std::lock_guard<std::mutex> lock(mValuesWriteMutex);
+    std::shared_ptr<const ValueSnapshot> empty(std::make_shared<ValueSnapshot>());
+    for (auto& shard : mValues)
+    {
+        std::atomic_store(&shard, empty);
+    }
+}
+
+void EncryptedSettings::flush()
+{
+    QSettings::sync();
+    QFile::remove(this->fileName().append(QString::fromUtf8(".bak")));
+    QFile::copy(this->fileName(), this->fileName().append(QString::fromUtf8(".bak")));
+}
+
 bool EncryptedSettings::event(QEvent *event)
 {
     if (event->type() == QEvent::UpdateRequest) {
-        QSettings::sync();
-        QFile::remove(this->fileName().append(QString::fromUtf8(".bak")));
-        QFile::copy(this->fileName(), this->fileName().append(QString::fromUtf8(".bak")));
+        // Posted by QSettings after changes; the changes of the next FLUSH_DELAY_MS go in the same write
+        mFlushPending = true;
+        if (!mFlushTimer.isActive())
+        {
+            mFlushTimer.start();
+        }
         return true;
     }
     return QObject::event(event);
@@ -5,16 +5,34 @@
 #include <QVariant>
 #include <QStringList>
 #include <QCryptographicHash>
+#include <QHash>
+#include <QTimer>
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Values are kept decrypted in memory once read or written, so hashing and decryption only
+// happen the first time a key is used. Changes are written to disk FLUSH_DELAY_MS after the
+// first pending one; sync() writes them at once.
 class EncryptedSettings : protected QSettings
 {
     Q_OBJECT
 
 public:
+    static constexpr int FLUSH_DELAY_MS = 1000;
+
     explicit EncryptedSettings(QString file);
+    ~EncryptedSettings() override;
 
     void setValue(const QString & key, const QVariant & value);
     QVariant value(const QString & key, const QVariant & defaultValue = QVariant());
+    // Lock free; only looks at values already in memory, in the group of the last
+    // markGroupStable() call. Returns false if the value has to be read with value()
+    bool cachedValue(const QString & key, const QVariant & defaultValue, QVariant & result) const;
+    // The current group is the one lock free readers use, until the next call
+    void markGroupStable();
     void beginGroup(const QString & prefix);
     void beginGroup(int numGroup);
     void endGroup();
@@ -33,6 +51,26 @@ protected:
     QByteArray encryptionKey;
 
     bool event(QEvent* event) override;
+
+private:
+    // Group + key -> decrypted value, an invalid QVariant if the key is not stored.
+    // Readers use the published snapshots, writers replace the shard of the key, so a write
+    // copies a fraction of the values instead of all of them
+    using ValueSnapshot = QHash<QString, QVariant>;
+    static constexpr int SNAPSHOT_SHARDS = 64;
+
+    QString cacheKey(const QString & key) const;
+    static std::size_t shardOf(const QString & cacheKey);
+    void cacheValue(const QString & key, const QVariant & value);
+    void clearCache();
+    void flush();
+
+    std::array<std::shared_ptr<const ValueSnapshot>, SNAPSHOT_SHARDS> mValues;
+    std::shared_ptr<const QString> mStableGroup;
+    std::mutex mValuesWriteMutex;
+
+    QTimer mFlushTimer;
+    std::atomic<bool> mFlushPending;
 };
 
 #endif // ENCRYPTEDSETTINGS_H
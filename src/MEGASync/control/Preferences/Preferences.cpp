@@ -461,6 +461,7 @@ void Preferences::setSessionInUserGroup(QString session)
 {
     assert(logged());
     setValueConcurrent(sessionKey, session);
+    sync();
 }
 
 void Preferences::storeSessionInGeneral(QString session)
@@ -480,6 +481,8 @@ void Preferences::storeSessionInGeneral(QString session)
     {
         mSettings->beginGroup(currentAccount);
     }
+    // The session is written at once instead of with the next delayed flush
+    mSettings->sync();
     mutex.unlock();
 }
 
@@ -903,6 +906,13 @@ T Preferences::getValue(const QString &key, const T &defaultValue)
 template<typename T>
 T Preferences::getValueConcurrent(const QString &key)
 {
+    // Values already read or written are available without locking
+    QVariant value;
+    if (mSettings->cachedValue(key, QVariant(), value))
+    {
+        return value.value<T>();
+    }
+
     QMutexLocker locker(&mutex);
     return getValue<T>(key);
 }
@@ -910,6 +920,12 @@ T Preferences::getValueConcurrent(const QString &key)
 template<typename T>
 T Preferences::getValueConcurrent(const QString &key, const T &defaultValue)
 {
+    QVariant value;
+    if (mSettings->cachedValue(key, defaultValue, value))
+    {
+        return value.template value<T>();
+    }
+
     QMutexLocker locker(&mutex);
     return getValue<T>(key, defaultValue);
 }
@@ -2338,6 +2354,7 @@ void Preferences::enterUser(int i)
     if (i < mSettings->numChildGroups())
     {
         mSettings->beginGroup(i);
+        mSettings->markGroupStable();
     }
 
     readFolders();
@@ -2349,6 +2366,7 @@ void Preferences::leaveUser()
     mutex.lock();
     assert(logged());
     mSettings->endGroup();
+    mSettings->markGroupStable();
 
     mutex.unlock();
 }
@@ -2359,6 +2377,8 @@ void Preferences::unlink()
     assert(logged());
     mSettings->remove(sessionKey); // Remove session from specific account settings
     mSettings->endGroup();
+    mSettings->markGroupStable();
+    mSettings->sync();
     mutex.unlock();
 
     resetGlobalSettings();
@@ -2473,10 +2493,7 @@ void Preferences::disableFileVersioning(bool value)
 
 bool Preferences::overlayIconsDisabled()
 {
-    mutex.lock();
-    bool result = getValue(disableOverlayIconsKey, false);
-    mutex.unlock();
-    return result;
+    return getValueConcurrent<bool>(disableOverlayIconsKey, false);
 }
 
 void Preferences::disableOverlayIcons(bool value)
@@ -2587,6 +2604,7 @@ void Preferences::login(QString account)
     logout();
     mSettings->setValue(currentAccountKey, account);
     mSettings->beginGroup(account);
+    mSettings->markGroupStable();
     readFolders();
     loadExcludedSyncNames();
     int lastVersion = mSettings->value(lastVersionKey).toInt();
@@ -2637,6 +2655,7 @@ void Preferences::logout()
     if (logged())
     {
         mSettings->endGroup();
+        mSettings->markGroupStable();
     }
     clearTemporalBandwidth();
     mutex.unlock();
@@ -11,10 +11,31 @@
 #endif
 
 thread_local std::atomic<bool>* ThreadPool::mLocalToThreadDone = nullptr;
+thread_local const ThreadPool::CancelToken* ThreadPool::mLocalToThreadToken = nullptr;
+thread_local ThreadPool* ThreadPool::mLocalToThreadPool = nullptr;
+thread_local std::size_t ThreadPool::mLocalToThreadIndex = 0;
+
+namespace
+{
+constexpr std::size_t BACKGROUND_PRIORITY = static_cast<std::size_t>(ThreadPool::Priority::BACKGROUND);
+}
 
 ThreadPool::ThreadPool(const std::size_t threadCount)
+    // Keep at least one worker free of background tasks
+    : mMaxBackgroundTasks(threadCount > 1 ? threadCount - 1 : 1)
 {
     Q_ASSERT(threadCount > 0);
+
+    for (auto& pending : mPendingTasks)
+    {
+        pending = 0;
+    }
+
+    for (std::size_t i = 0; i < threadCount; ++i)
+    {
+        mQueues.emplace_back(new WorkerQueues());
+    }
+
     for (std::size_t i = 0; i < threadCount; ++i)
     {
         std::thread thread;
@@ -45,18 +66,44 @@ ThreadPool::~ThreadPool()
     shutdown();
 }
 
-void ThreadPool::push(std::function<void()> functor)
+void ThreadPool::push(std::function<void()> functor, Priority priority, CancelToken token)
 {
+    auto priorityIndex = static_cast<std::size_t>(priority);
+    Q_ASSERT(priorityIndex < PRIORITIES);
+
+    // Count the task before it is visible, so the counter is never lower than the queued tasks
+    ++mPendingTasks[priorityIndex];
+
+    // Tasks pushed from a worker stay in its own deques, the rest are spread among the workers
+    auto queueIndex = (mLocalToThreadPool == this) ? mLocalToThreadIndex
+                                                    : mNextQueue.fetch_add(1) % mQueues.size();
     {
-        std::lock_guard<std::mutex> lock{mMutex};
-        mFunctors.push(std::move(functor));
+        auto& queues = *mQueues[queueIndex];
+        std::lock_guard<std::mutex> lock{queues.mutex};
+        queues.tasks[priorityIndex].push_back(Task{std::move(functor), std::move(token)});
+    }
+
+    wakeSleepingWorker();
+}
+
+void ThreadPool::wakeSleepingWorker()
+{
+    // Busy workers look for more tasks before sleeping, only a sleeping one needs the wake up.
+    // Sleeping workers are counted before they check the pending tasks, so either they see the
+    // new task or this sees them
+    if (mSleepingWorkers > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mMutex};
+        }
+        mCv.notify_one();
     }
-    mCv.notify_one();
 }
 
 bool ThreadPool::isThreadInterrupted()
 {
-    if(mLocalToThreadDone && (*mLocalToThreadDone))
+    if((mLocalToThreadDone && (*mLocalToThreadDone))
+            || (mLocalToThreadToken && mLocalToThreadToken->isCancelled()))
     {
         return true;
     }
@@ -66,6 +113,101 @@ bool ThreadPool::isThreadInterrupted()
     }
 }
 
+std::size_t ThreadPool::threadCount() const
+{
+    return mQueues.size();
+}
+
+bool ThreadPool::hasRunnableTasks() const
+{
+    for (std::size_t priority = 0; priority < PRIORITIES; ++priority)
+    {
+        if (mPendingTasks[priority] > 0
+                && (priority != BACKGROUND_PRIORITY || mDone || mRunningBackgroundTasks < mMaxBackgroundTasks))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::popLocal(std::size_t index, std::size_t priority, Task& task)
+{
+    auto& queues = *mQueues[index];
+    std::lock_guard<std::mutex> lock{queues.mutex};
+    auto& tasks = queues.tasks[priority];
+    if (tasks.empty())
+    {
+        return false;
+    }
+
+    // The owner keeps FIFO order
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, std::size_t priority, Task& task)
+{
+    for (std::size_t offset = 1; offset < mQueues.size(); ++offset)
+    {
+        auto& queues = *mQueues[(thief + offset) % mQueues.size()];
+        std::lock_guard<std::mutex> lock{queues.mutex};
+        auto& tasks = queues.tasks[priority];
+        if (!tasks.empty())
+        {
+            // Oldest first, as the owner does, to keep the waiting time of every task bounded
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::takeTask(std::size_t index, Task& task, bool& isBackground)
+{
+    for (std::size_t priority = 0; priority < PRIORITIES; ++priority)
+    {
+        if (mPendingTasks[priority] == 0)
+        {
+            continue;
+        }
+
+        isBackground = (priority == BACKGROUND_PRIORITY);
+        if (isBackground && !mDone)
+        {
+            // Reserve a background slot before taking the task
+            auto running = mRunningBackgroundTasks.load();
+            do
+            {
+                if (running >= mMaxBackgroundTasks)
+                {
+                    return false;
+                }
+            }
+            while (!mRunningBackgroundTasks.compare_exchange_weak(running, running + 1));
+        }
+        else if (isBackground)
+        {
+            ++mRunningBackgroundTasks;
+        }
+
+        if (popLocal(index, priority, task) || steal(index, priority, task))
+        {
+            --mPendingTasks[priority];
+            return true;
+        }
+
+        if (isBackground)
+        {
+            --mRunningBackgroundTasks;
+        }
+    }
+
+    return false;
+}
+
 void ThreadPool::worker(const std::size_t index)
 {
     const auto threadName = "TPw" + std::to_string(index);
@@ -77,30 +219,50 @@ void ThreadPool::worker(const std::size_t index)
     }
 #endif
     mLocalToThreadDone = &mDone;
+    mLocalToThreadPool = this;
+    mLocalToThreadIndex = index;
     for (;;)
     {
-        std::function<void()> functor;
+        Task task;
+        bool isBackground(false);
+        if (!takeTask(index, task, isBackground))
         {
             std::unique_lock<std::mutex> lock{mMutex};
-            mCv.wait(lock, [this]
-            {
-                return mDone || !mFunctors.empty();
-            });
-            if (mDone && mFunctors.empty())
+            if (mDone && !hasRunnableTasks())
             {
                 break;
             }
-            functor = std::move(mFunctors.front());
-            mFunctors.pop();
+            ++mSleepingWorkers;
+            mCv.wait(lock, [this]
+            {
+                return mDone || hasRunnableTasks();
+            });
+            --mSleepingWorkers;
+            continue;
         }
-        try
+
+        // Cancelled before starting: drop it (a submitted task reports a broken promise)
+        if (!task.token.isCancelled())
         {
-            functor();
+            mLocalToThreadToken = &task.token;
+            try
+            {
+                task.functor();
+            }
+            catch (const std::exception& e)
+            {
+                qCritical("ThreadPool: Error: %s", e.what());
+                Q_ASSERT(false);
+            }
+            mLocalToThreadToken = nullptr;
         }
-        catch (const std::exception& e)
+        task.functor = nullptr;
+
+        if (isBackground)
         {
-            qCritical("ThreadPool: Error: %s", e.what());
-            Q_ASSERT(false);
+            // A background slot is free again
+            --mRunningBackgroundTasks;
+            wakeSleepingWorker();
         }
     }
 }
@@ -118,4 +280,3 @@ void ThreadPool::shutdown()
     }
     mThreads.clear();
 }
-
@@ -1,38 +1,113 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
 
+/// Work-stealing thread pool.
+/// Every worker owns one deque per priority. Tasks pushed from a worker go to its own deques,
+/// tasks pushed from other threads are spread round-robin. An idle worker takes the highest
+/// priority task available, first from its own deques and then stealing from the other workers.
+/// Pushes only signal the condition variable when some worker is sleeping.
+/// Background tasks never take all the workers, so a long scan cannot delay interactive work.
 class ThreadPool
 {
 public:
+    enum class Priority
+    {
+        INTERACTIVE = 0, // Work the user is waiting for (UI requests, sorting)
+        TRANSFERS,       // Transfer scheduling and SDK calls
+        BACKGROUND,      // Long running scans
+        LAST
+    };
+
+    /// Shared cancellation flag. Copies refer to the same flag
+    class CancelToken
+    {
+    public:
+        CancelToken() : mCancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+        void cancel() {mCancelled->store(true);}
+        bool isCancelled() const {return mCancelled->load();}
+
+    private:
+        std::shared_ptr<std::atomic<bool>> mCancelled;
+    };
 
     explicit ThreadPool(std::size_t threadCount);
     ~ThreadPool();
 
     Q_DISABLE_COPY(ThreadPool)
 
-    void push(std::function<void()> functor);
+    void push(std::function<void()> functor, Priority priority = Priority::TRANSFERS,
+              CancelToken token = CancelToken());
+
+    /// Runs func in the pool and returns its future. If the token is cancelled before the task
+    /// starts, the task is dropped and the future throws std::future_error (broken_promise)
+    template <typename Func, typename Result = decltype(std::declval<Func&>()())>
+    std::future<Result> submit(Func func, Priority priority = Priority::TRANSFERS, CancelToken token = CancelToken())
+    {
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+        auto future = task->get_future();
+        push([task](){(*task)();}, priority, std::move(token));
+        return future;
+    }
+
+    /// True when the pool is shutting down or the token of the running task has been cancelled.
+    /// Long tasks should poll it and return early
     static bool isThreadInterrupted();
 
+    std::size_t threadCount() const;
+
 private:
+    static constexpr std::size_t PRIORITIES = static_cast<std::size_t>(Priority::LAST);
+
+    struct Task
+    {
+        std::function<void()> functor;
+        CancelToken token;
+    };
+
+    struct WorkerQueues
+    {
+        std::mutex mutex;
+        std::array<std::deque<Task>, PRIORITIES> tasks;
+    };
+
     void worker(std::size_t index);
+    bool hasRunnableTasks() const;
+    void wakeSleepingWorker();
+    bool takeTask(std::size_t index, Task& task, bool& isBackground);
+    bool popLocal(std::size_t index, std::size_t priority, Task& task);
+    bool steal(std::size_t thief, std::size_t priority, Task& task);
 
     void shutdown();
 
     std::atomic<bool> mDone {false} ;
     static thread_local std::atomic<bool>* mLocalToThreadDone;
+    static thread_local const CancelToken* mLocalToThreadToken;
+    static thread_local ThreadPool* mLocalToThreadPool;
+    static thread_local std::size_t mLocalToThreadIndex;
 
     std::vector<std::thread> mThreads;
-    std::queue<std::function<void()>> mFunctors;
+    std::vector<std::unique_ptr<WorkerQueues>> mQueues;
+    std::atomic<std::size_t> mNextQueue {0};
+    std::array<std::atomic<std::size_t>, PRIORITIES> mPendingTasks;
+    std::atomic<std::size_t> mRunningBackgroundTasks {0};
+    std::size_t mMaxBackgroundTasks;
+    std::atomic<std::size_t> mSleepingWorkers {0};
+
     std::condition_variable mCv;
     std::mutex mMutex;
 };
-
@@ -0,0 +1,123 @@
+#include "TransferProgressFeed.h"
+
+#include <algorithm>
+
+TransferProgressFeed::SubscriberId TransferProgressFeed::subscribe(const std::vector<std::pair<Handle, std::string>>& handles)
+{
+    Subscriber subscriber;
+    for (const auto& handle : handles)
+    {
+        if (std::find(subscriber.handles.begin(), subscriber.handles.end(), handle.first) != subscriber.handles.end())
+        {
+            continue;
+        }
+
+        Entry& entry = mEntries[handle.first];
+        entry.text = handle.second;
+        ++entry.subscribers;
+        subscriber.handles.push_back(handle.first);
+    }
+
+    const SubscriberId id = mNextId++;
+    mSubscribers.emplace(id, std::move(subscriber));
+    return id;
+}
+
+void TransferProgressFeed::unsubscribe(SubscriberId id)
+{
+    auto subscriber = mSubscribers.find(id);
+    if (subscriber == mSubscribers.end())
+    {
+        return;
+    }
+
+    for (Handle handle : subscriber->second.handles)
+    {
+        auto entry = mEntries.find(handle);
+        if (entry != mEntries.end() && !--entry->second.subscribers)
+        {
+            mEntries.erase(entry);
+        }
+    }
+    mSubscribers.erase(subscriber);
+}
+
+bool TransferProgressFeed::isWatched(Handle handle) const
+{
+    return mEntries.count(handle) > 0;
+}
+
+void TransferProgressFeed::update(Handle handle, const Progress& progress)
+{
+    auto entry = mEntries.find(handle);
+    if (entry == mEntries.end())
+    {
+        return;
+    }
+
+    entry->second.progress = progress;
+    entry->second.version = ++mVersion;
+}
+
+bool TransferProgressFeed::hasPendingEvents() const
+{
+    return std::any_of(mSubscribers.begin(), mSubscribers.end(), [this](const std::pair<const SubscriberId, Subscriber>& subscriber)
+    {
+        return subscriber.second.sentVersion < mVersion;
+    });
+}
+
+std::string TransferProgressFeed::takeEvent(SubscriberId id)
+{
+    auto subscriber = mSubscribers.find(id);
+    if (subscriber == mSubscribers.end())
+    {
+        return std::string();
+    }
+
+    std::string event;
+    for (Handle handle : subscriber->second.handles)
+    {
+        const Entry& entry = mEntries[handle];
+        if (entry.version <= subscriber->second.sentVersion)
+        {
+            continue;
+        }
+
+        event.append(event.empty() ? "data: [" : ",");
+        event.append("{\"h\":\"").append(entry.text)
+             .append("\",\"s\":").append(std::to_string(entry.progress.state))
+             .append(",\"p\":").append(std::to_string(entry.progress.transferred))
+             .append(",\"t\":").append(std::to_string(entry.progress.size))
+             .append(",\"v\":").append(std::to_string(entry.progress.speed))
+             .append("}");
+    }
+    subscriber->second.sentVersion = mVersion;
+
+    if (!event.empty())
+    {
+        event.append("]\n\n");
+    }
+    return event;
+}
+
+bool TransferProgressFeed::isDone(SubscriberId id) const
+{
+    auto subscriber = mSubscribers.find(id);
+    if (subscriber == mSubscribers.end())
+    {
+        return true;
+    }
+
+    return std::all_of(subscriber->second.handles.begin(), subscriber->second.handles.end(), [&](Handle handle)
+    {
+        auto entry = mEntries.find(handle);
+        return entry == mEntries.end()
+                || (entry->second.progress.finished && entry->second.version <= subscriber->second.sentVersion);
+    });
+}
+
+std::size_t TransferProgressFeed::subscriberCount() const
+{
+    return mSubscribers.size();
+}
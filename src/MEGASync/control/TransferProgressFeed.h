@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Progress of the downloads started from the webclient, pushed to subscribed streams.
+/// Updates only overwrite the last snapshot of a handle, so any number of transfer events
+/// between two pushes produce at most one entry per handle. Each subscriber receives the
+/// handles that changed since its previous event, as Server-Sent Events.
+/// Not thread safe: used from the thread of the HTTP server.
+class TransferProgressFeed
+{
+public:
+    using SubscriberId = unsigned int;
+    using Handle = uint64_t;
+
+    struct Progress
+    {
+        int state = 0;
+        long long transferred = 0;
+        long long size = 0;
+        long long speed = 0;
+        bool finished = false;
+    };
+
+    /// handles pairs each handle with the text used for it in the events
+    SubscriberId subscribe(const std::vector<std::pair<Handle, std::string>>& handles);
+    void unsubscribe(SubscriberId id);
+
+    bool isWatched(Handle handle) const;
+    void update(Handle handle, const Progress& progress);
+
+    bool hasPendingEvents() const;
+    /// "data: [...]\n\n" with the handles updated since the last event of the subscriber.
+    /// Empty when nothing changed
+    std::string takeEvent(SubscriberId id);
+    /// Every handle of the subscriber finished and was sent
+    bool isDone(SubscriberId id) const;
+
+    std::size_t subscriberCount() const;
+
+private:
+    struct Entry
+    {
+        std::string text;
+        Progress progress;
+        uint64_t version = 0;
+        unsigned int subscribers = 0;
+    };
+
+    struct Subscriber
+    {
+        std::vector<Handle> handles;
+        uint64_t sentVersion = 0;
+    };
+
+    std::unordered_map<Handle, Entry> mEntries;
+    std::unordered_map<SubscriberId, Subscriber> mSubscribers;
+    uint64_t mVersion = 0;
+    SubscriberId mNextId = 1;
+};
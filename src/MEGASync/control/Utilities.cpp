@@ -11,10 +11,11 @@
 #include <QDesktopWidget>
 #include <QScreen>
 #include "MegaApplication.h"
-#include "control/gzjoin.h"
 #include "platform/Platform.h"
 #include <QCryptographicHash>
 
+#include <array>
+
 #ifndef WIN32
 #include "megaapi.h"
 #include <utime.h>
@@ -30,10 +31,12 @@ namespace
 {
     constexpr char AVATARS_EXTENSION_FILTER[] = "*.jpg";
 }
-QHash<QString, QString> Utilities::extensionIcons;
-QHash<QString, Utilities::FileType> Utilities::fileTypes;
 QHash<QString, QString> Utilities::languageNames;
 
+constexpr std::size_t Utilities::FILE_TYPE_COUNT;
+static_assert(Utilities::fileTypeIndex(Utilities::FileType::TYPE_IMAGE) + 1 == Utilities::FILE_TYPE_COUNT,
+              "FILE_TYPE_COUNT must cover every file type");
+
 std::unique_ptr<ThreadPool> ThreadPoolSingleton::instance = nullptr;
 
 const QString Utilities::SUPPORT_URL = QString::fromUtf8("https://mega.nz/contact");
@@ -53,191 +56,6 @@ const QRegularExpression Utilities::FORBIDDEN_CHARS_RX(QLatin1String("[\\\\/:\"*
 const qint64 FILE_READ_BUFFER_SIZE = 8192;
 
 
-void Utilities::initializeExtensions()
-{
-    extensionIcons[QString::fromLatin1("3ds")] = extensionIcons[QString::fromLatin1("3dm")]  = extensionIcons[QString::fromLatin1("max")] =
-                            extensionIcons[QString::fromLatin1("obj")]  = QString::fromLatin1("3D.png");
-
-    extensionIcons[QString::fromLatin1("aep")] = extensionIcons[QString::fromLatin1("aet")]  = QString::fromLatin1("aftereffects.png");
-
-    extensionIcons[QString::fromLatin1("mp3")] = extensionIcons[QString::fromLatin1("wav")]  = extensionIcons[QString::fromLatin1("3ga")]  =
-                            extensionIcons[QString::fromLatin1("aif")]  = extensionIcons[QString::fromLatin1("aiff")] =
-                            extensionIcons[QString::fromLatin1("flac")] = extensionIcons[QString::fromLatin1("iff")]  = extensionIcons[QString::fromLatin1("ogg")] =
-                            extensionIcons[QString::fromLatin1("m4a")]  = extensionIcons[QString::fromLatin1("wma")]  =  QString::fromLatin1("audio.png");
-
-    extensionIcons[QString::fromLatin1("dxf")] = extensionIcons[QString::fromLatin1("dwg")] =  QString::fromLatin1("cad.png");
-
-
-    extensionIcons[QString::fromLatin1("zip")] = extensionIcons[QString::fromLatin1("rar")] = extensionIcons[QString::fromLatin1("tgz")]  =
-                            extensionIcons[QString::fromLatin1("gz")]  = extensionIcons[QString::fromLatin1("bz2")]  =
-                            extensionIcons[QString::fromLatin1("tbz")] = extensionIcons[QString::fromLatin1("tar")]  =
-                            extensionIcons[QString::fromLatin1("7z")]  = extensionIcons[QString::fromLatin1("sitx")] =  QString::fromLatin1("compressed.png");
-
-    extensionIcons[QString::fromLatin1("sql")] = extensionIcons[QString::fromLatin1("accdb")] = extensionIcons[QString::fromLatin1("db")]  =
-                            extensionIcons[QString::fromLatin1("dbf")]  = extensionIcons[QString::fromLatin1("mdb")]  =
-                            extensionIcons[QString::fromLatin1("pdb")] = QString::fromLatin1("web_lang.png");
-
-    extensionIcons[QString::fromLatin1("folder")] = QString::fromLatin1("folder.png");
-
-    extensionIcons[QString::fromLatin1("xls")] = extensionIcons[QString::fromLatin1("xlsx")] = extensionIcons[QString::fromLatin1("xlt")]  =
-                            extensionIcons[QString::fromLatin1("xltm")]  = QString::fromLatin1("excel.png");
-
-    extensionIcons[QString::fromLatin1("exe")] = extensionIcons[QString::fromLatin1("com")] = extensionIcons[QString::fromLatin1("bin")]  =
-                            extensionIcons[QString::fromLatin1("apk")]  = extensionIcons[QString::fromLatin1("app")]  =
-                             extensionIcons[QString::fromLatin1("msi")]  = extensionIcons[QString::fromLatin1("cmd")]  =
-                            extensionIcons[QString::fromLatin1("gadget")] = QString::fromLatin1("executable.png");
-
-    extensionIcons[QString::fromLatin1("fnt")] = extensionIcons[QString::fromLatin1("otf")] = extensionIcons[QString::fromLatin1("ttf")]  =
-                            extensionIcons[QString::fromLatin1("fon")]  = QString::fromLatin1("font.png");
-
-    extensionIcons[QString::fromLatin1("gif")] = extensionIcons[QString::fromLatin1("tiff")]  = extensionIcons[QString::fromLatin1("tif")]  =
-                            extensionIcons[QString::fromLatin1("bmp")]  = extensionIcons[QString::fromLatin1("png")] =
-                            extensionIcons[QString::fromLatin1("tga")]  = QString::fromLatin1("image.png");
-
-    extensionIcons[QString::fromLatin1("ai")] = extensionIcons[QString::fromLatin1("ait")] = QString::fromLatin1("illustrator.png");
-    extensionIcons[QString::fromLatin1("jpg")] = extensionIcons[QString::fromLatin1("jpeg")] = extensionIcons[QString::fromLatin1("heic")] =
-                            extensionIcons[QString::fromLatin1("webp")] = QString::fromLatin1("image.png");
-    extensionIcons[QString::fromLatin1("indd")] = QString::fromLatin1("indesign.png");
-
-    extensionIcons[QString::fromLatin1("jar")] = extensionIcons[QString::fromLatin1("java")]  = extensionIcons[QString::fromLatin1("class")]  = QString::fromLatin1("web_data.png");
-
-    extensionIcons[QString::fromLatin1("pdf")] = QString::fromLatin1("pdf.png");
-    extensionIcons[QString::fromLatin1("abr")] = extensionIcons[QString::fromLatin1("psb")]  = extensionIcons[QString::fromLatin1("psd")]  =
-                            QString::fromLatin1("photoshop.png");
-
-    extensionIcons[QString::fromLatin1("pps")] = extensionIcons[QString::fromLatin1("ppt")]  = extensionIcons[QString::fromLatin1("pptx")] = QString::fromLatin1("powerpoint.png");
-
-    extensionIcons[QString::fromLatin1("prproj")] = extensionIcons[QString::fromLatin1("ppj")]  = QString::fromLatin1("premiere.png");
-
-    extensionIcons[QString::fromLatin1("3fr")] = extensionIcons[QString::fromLatin1("arw")]  = extensionIcons[QString::fromLatin1("bay")]  =
-                            extensionIcons[QString::fromLatin1("cr2")]  = extensionIcons[QString::fromLatin1("dcr")] =
-                            extensionIcons[QString::fromLatin1("dng")] = extensionIcons[QString::fromLatin1("fff")]  =
-                            extensionIcons[QString::fromLatin1("mef")] = extensionIcons[QString::fromLatin1("mrw")]  =
-                            extensionIcons[QString::fromLatin1("nef")] = extensionIcons[QString::fromLatin1("pef")]  =
-                            extensionIcons[QString::fromLatin1("rw2")] = extensionIcons[QString::fromLatin1("srf")]  =
-                            extensionIcons[QString::fromLatin1("orf")] = extensionIcons[QString::fromLatin1("rwl")]  =
-                            extensionIcons[QString::fromLatin1("ari")] = extensionIcons[QString::fromLatin1("braw")]  =
-                            extensionIcons[QString::fromLatin1("crw")] = extensionIcons[QString::fromLatin1("cr3")]  =
-                            extensionIcons[QString::fromLatin1("cap")] =
-                            extensionIcons[QString::fromLatin1("dcs")] = extensionIcons[QString::fromLatin1("drf")]  =
-                            extensionIcons[QString::fromLatin1("eip")] = extensionIcons[QString::fromLatin1("erf")]  =
-                            extensionIcons[QString::fromLatin1("gpr")] = extensionIcons[QString::fromLatin1("iiq")]  =
-                            extensionIcons[QString::fromLatin1("k25")] = extensionIcons[QString::fromLatin1("kdc")]  =
-                            extensionIcons[QString::fromLatin1("mdc")] = extensionIcons[QString::fromLatin1("mos")]  =
-                            extensionIcons[QString::fromLatin1("nrw")] = extensionIcons[QString::fromLatin1("obm")]  =
-                            extensionIcons[QString::fromLatin1("ptx")] = extensionIcons[QString::fromLatin1("pxn")]  =
-                            extensionIcons[QString::fromLatin1("r3d")] = extensionIcons[QString::fromLatin1("raf")]  =
-                            extensionIcons[QString::fromLatin1("raw")] = extensionIcons[QString::fromLatin1("rwz")]  =
-                            extensionIcons[QString::fromLatin1("sr2")] = extensionIcons[QString::fromLatin1("srw")]  =
-                            extensionIcons[QString::fromLatin1("tif")] = extensionIcons[QString::fromLatin1("x3f")]  =
-                            QString::fromLatin1("raw.png");
-
-    extensionIcons[QString::fromLatin1("ods")]  = extensionIcons[QString::fromLatin1("ots")]  =
-                            extensionIcons[QString::fromLatin1("gsheet")]  = extensionIcons[QString::fromLatin1("nb")] =
-                            extensionIcons[QString::fromLatin1("xlr")] = QString::fromLatin1("spreadsheet.png");
-
-    extensionIcons[QString::fromLatin1("torrent")] = QString::fromLatin1("torrent.png");
-    extensionIcons[QString::fromLatin1("dmg")] = QString::fromLatin1("dmg.png");
-
-    extensionIcons[QString::fromLatin1("txt")] = extensionIcons[QString::fromLatin1("rtf")]  = extensionIcons[QString::fromLatin1("ans")]  =
-                            extensionIcons[QString::fromLatin1("ascii")]  = extensionIcons[QString::fromLatin1("log")] =
-                            extensionIcons[QString::fromLatin1("odt")] = extensionIcons[QString::fromLatin1("wpd")]  =
-                            QString::fromLatin1("text.png");
-
-    extensionIcons[QString::fromLatin1("svgz")]  = extensionIcons[QString::fromLatin1("svg")]  =
-                            extensionIcons[QString::fromLatin1("cdr")]  = extensionIcons[QString::fromLatin1("eps")] =
-                            QString::fromLatin1("vector.png");
-
-     extensionIcons[QString::fromLatin1("mkv")]  = extensionIcons[QString::fromLatin1("webm")]  =
-                            extensionIcons[QString::fromLatin1("avi")]  = extensionIcons[QString::fromLatin1("mp4")] =
-                            extensionIcons[QString::fromLatin1("m4v")] = extensionIcons[QString::fromLatin1("mpg")]  =
-                            extensionIcons[QString::fromLatin1("mpeg")] = extensionIcons[QString::fromLatin1("mov")]  =
-                            extensionIcons[QString::fromLatin1("3g2")] = extensionIcons[QString::fromLatin1("3gp")]  =
-                            extensionIcons[QString::fromLatin1("asf")] = extensionIcons[QString::fromLatin1("wmv")]  =
-                            extensionIcons[QString::fromLatin1("flv")] = extensionIcons[QString::fromLatin1("vob")] =
-                            QString::fromLatin1("video.png");
-
-     extensionIcons[QString::fromLatin1("html")]  = extensionIcons[QString::fromLatin1("xml")] = extensionIcons[QString::fromLatin1("shtml")]  =
-                            extensionIcons[QString::fromLatin1("dhtml")] = extensionIcons[QString::fromLatin1("js")] =
-                            extensionIcons[QString::fromLatin1("css")]  = QString::fromLatin1("web_data.png");
-
-     extensionIcons[QString::fromLatin1("php")]  = extensionIcons[QString::fromLatin1("php3")]  =
-                            extensionIcons[QString::fromLatin1("php4")]  = extensionIcons[QString::fromLatin1("php5")] =
-                            extensionIcons[QString::fromLatin1("phtml")] = extensionIcons[QString::fromLatin1("inc")]  =
-                            extensionIcons[QString::fromLatin1("asp")] = extensionIcons[QString::fromLatin1("pl")]  =
-                            extensionIcons[QString::fromLatin1("cgi")] = extensionIcons[QString::fromLatin1("py")]  =
-                            QString::fromLatin1("web_lang.png");
-
-     extensionIcons[QString::fromLatin1("doc")]  = extensionIcons[QString::fromLatin1("docx")] = extensionIcons[QString::fromLatin1("dotx")]  =
-                            extensionIcons[QString::fromLatin1("wps")] = QString::fromLatin1("word.png");
-
-     extensionIcons[QString::fromLatin1("odt")]  = extensionIcons[QString::fromLatin1("ods")] = extensionIcons[QString::fromLatin1("odp")]  =
-                            extensionIcons[QString::fromLatin1("odb")] = extensionIcons[QString::fromLatin1("odg")] = QString::fromLatin1("openoffice.png");
-
-     extensionIcons[QString::fromLatin1("sketch")] = QString::fromLatin1("sketch.png");
-     extensionIcons[QString::fromLatin1("xd")] = QString::fromLatin1("experiencedesign.png");
-     extensionIcons[QString::fromLatin1("pages")] = QString::fromLatin1("pages.png");
-     extensionIcons[QString::fromLatin1("numbers")] = QString::fromLatin1("numbers.png");
-     extensionIcons[QString::fromLatin1("key")] = QString::fromLatin1("keynote.png");
-}
-
-void Utilities::initializeFileTypes()
-{
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.wav"), QString())]
-            = FileType::TYPE_AUDIO;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.mkv"), QString())]
-            = FileType::TYPE_VIDEO;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.tar"), QString())]
-            = FileType::TYPE_ARCHIVE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.torrent"), QString())]
-            = FileType::TYPE_ARCHIVE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.dmg"), QString())]
-            = FileType::TYPE_ARCHIVE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.xd"), QString())]
-            = FileType::TYPE_ARCHIVE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.sketch"), QString())]
-            = FileType::TYPE_ARCHIVE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.txt"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.odt"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.pdf"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.doc"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.ods"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.odt"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.ppt"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.pages"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.numbers"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.key"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.xml"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.xls"), QString())]
-            = FileType::TYPE_DOCUMENT;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.png"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.jpg"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.ai"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.abr"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.3fr"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.svg"), QString())]
-            = FileType::TYPE_IMAGE;
-    fileTypes[getExtensionPixmapName(QLatin1Literal("a.bin"), QString())]
-            = FileType::TYPE_OTHER;
-}
-
-
 void Utilities::queueFunctionInAppThread(std::function<void()> fun) {
    QObject temporary;
    QObject::connect(&temporary, &QObject::destroyed, qApp, std::move(fun), Qt::QueuedConnection);
@@ -255,50 +73,101 @@ void Utilities::getFolderSize(QString folderPath, long long *size)
         return;
     }
 
-    QDir dir(folderPath);
-    QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
-    for (int i = 0; i < entries.size(); i++)
+    (*size) += getFolderSize(QStringList() << folderPath);
+}
+
+long long Utilities::getFolderSize(const QStringList& folderPaths, ThreadPool::CancelToken token)
+{
+    std::vector<FolderSizePath> roots;
+    for (const auto& folderPath : folderPaths)
     {
-        QFileInfo info = entries[i];
-        if (info.isFile())
-        {
-            (*size) += info.size();
-        }
-        else if (info.isDir())
+        if (!folderPath.isEmpty())
         {
-            getFolderSize(info.absoluteFilePath(), size);
+            roots.push_back(toFolderSizePath(folderPath));
         }
     }
+
+    FolderSizeScanner scanner(*ThreadPoolSingleton::getInstance(), getFolderSizeCache());
+    auto result = scanner.scan(roots, token);
+    if (result.complete)
+    {
+        saveFolderSizeCache();
+    }
+    return result.bytes;
 }
 
-qreal Utilities::getDevicePixelRatio()
+FolderSizePath Utilities::toFolderSizePath(const QString& path)
 {
-    return qApp->testAttribute(Qt::AA_UseHighDpiPixmaps) ? qApp->devicePixelRatio() : 1.0;
+#ifdef WIN32
+    return QDir::toNativeSeparators(path).toStdWString();
+#else
+    return QFile::encodeName(path).toStdString();
+#endif
 }
 
-QString Utilities::getExtensionPixmapName(QString fileName, QString prefix)
+static QString folderSizeCachePath()
 {
-    if (extensionIcons.isEmpty())
-    {
-        initializeExtensions();
-        initializeFileTypes();
-    }
+    return MegaApplication::applicationDataPath() + QString::fromUtf8("/foldersizes.cache");
+}
 
-    QFileInfo f(fileName);
-    if (extensionIcons.contains(f.suffix().toLower()))
+std::shared_ptr<FolderSizeCache> Utilities::getFolderSizeCache()
+{
+    static std::once_flag loaded;
+    auto cache = FolderSizeScanner::sharedCache();
+    std::call_once(loaded, [cache]()
     {
-        return QString(extensionIcons[f.suffix().toLower()]).insert(0, prefix);
-    }
-    else
+        cache->load(toFolderSizePath(folderSizeCachePath()));
+    });
+    return cache;
+}
+
+void Utilities::saveFolderSizeCache()
+{
+    static std::mutex saveMutex;
+    std::lock_guard<std::mutex> lock(saveMutex);
+    if (!getFolderSizeCache()->save(toFolderSizePath(folderSizeCachePath())))
     {
-        return prefix + QString::fromLatin1("generic.png");
+        MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Unable to save the folder size cache");
     }
 }
 
-Utilities::FileType Utilities::getFileType(QString fileName, QString prefix)
+qreal Utilities::getDevicePixelRatio()
+{
+    return qApp->testAttribute(Qt::AA_UseHighDpiPixmaps) ? qApp->devicePixelRatio() : 1.0;
+}
+
+QString Utilities::getExtensionPixmapName(QString fileName, QString prefix)
+{
+    return prefix + QLatin1String(FileExtensionTable::iconFileName(getFileIcon(fileName)));
+}
+
+FileExtensionTable::Icon Utilities::getFileIcon(const QString& fileName)
+{
+    return FileExtensionTable::iconForFileName(fileName.utf16(), static_cast<std::size_t>(fileName.size()));
+}
+
+Utilities::FileType Utilities::getFileType(const QString& fileName)
+{
+    return getFileType(getFileIcon(fileName));
+}
+
+Utilities::FileType Utilities::getFileType(FileExtensionTable::Icon icon)
 {
-    auto extensionPixmapName = getExtensionPixmapName(fileName, prefix);
-    return fileTypes.value(extensionPixmapName,FileType::TYPE_OTHER);
+    switch (FileExtensionTable::kind(icon))
+    {
+        case FileExtensionTable::Kind::AUDIO:
+            return FileType::TYPE_AUDIO;
+        case FileExtensionTable::Kind::VIDEO:
+            return FileType::TYPE_VIDEO;
+        case FileExtensionTable::Kind::ARCHIVE:
+            return FileType::TYPE_ARCHIVE;
+        case FileExtensionTable::Kind::DOCUMENT:
+            return FileType::TYPE_DOCUMENT;
+        case FileExtensionTable::Kind::IMAGE:
+            return FileType::TYPE_IMAGE;
+        default:
+            return FileType::TYPE_OTHER;
+    }
 }
 
 QString Utilities::languageCodeToString(QString code)
@@ -511,12 +380,37 @@ QIcon Utilities::getCachedPixmap(QString fileName)
 
 QIcon Utilities::getExtensionPixmapSmall(QString fileName)
 {
-    return gIconCache.getDirect(getExtensionPixmapNameSmall(fileName));
+    return getExtensionPixmapSmall(getFileIcon(fileName));
 }
 
 QIcon Utilities::getExtensionPixmapMedium(QString fileName)
 {
-    return gIconCache.getDirect(getExtensionPixmapNameMedium(fileName));
+    return getExtensionPixmapMedium(getFileIcon(fileName));
+}
+
+// The icons of each size are kept in a flat array indexed by icon, so painting does not build names
+static QIcon getExtensionPixmap(FileExtensionTable::Icon icon, const char* prefix,
+                                std::array<QIcon, static_cast<std::size_t>(FileExtensionTable::Icon::LAST)>& icons)
+{
+    auto index = static_cast<std::size_t>(icon < FileExtensionTable::Icon::LAST ? icon : FileExtensionTable::Icon::GENERIC);
+    auto& cached = icons[index];
+    if (cached.isNull())
+    {
+        cached = gIconCache.getDirect(QString::fromLatin1(prefix) + QLatin1String(FileExtensionTable::iconFileName(icon)));
+    }
+    return cached;
+}
+
+QIcon Utilities::getExtensionPixmapSmall(FileExtensionTable::Icon icon)
+{
+    static std::array<QIcon, static_cast<std::size_t>(FileExtensionTable::Icon::LAST)> icons;
+    return getExtensionPixmap(icon, ":/images/small_", icons);
+}
+
+QIcon Utilities::getExtensionPixmapMedium(FileExtensionTable::Icon icon)
+{
+    static std::array<QIcon, static_cast<std::size_t>(FileExtensionTable::Icon::LAST)> icons;
+    return getExtensionPixmap(icon, ":/images/drag_", icons);
 }
 
 QString Utilities::getAvatarPath(QString email)
@@ -850,75 +744,6 @@ QString Utilities::createCompleteUsedString(long long usedData, long long totalD
             );
 }
 
-QString Utilities::extractJSONString(QString json, QString name)
-{
-    QString pattern = name + QString::fromUtf8("\":\"");
-    int pos = json.indexOf(pattern);
-    if (pos < 0)
-    {
-        return QString();
-    }
-
-    int end = json.indexOf(QString::fromUtf8("\""), pos + pattern.size());
-    if (end < 0)
-    {
-        return QString();
-    }
-
-    return json.mid(pos + pattern.size(), end - pos - pattern.size());
-}
-
-QStringList Utilities::extractJSONStringList(const QString& json, const QString& name)
-{
-    QStringList resultList;
-
-    QString pattern = name + QString::fromUtf8("\":[\"");
-    int startPos = json.indexOf(pattern);
-    if (startPos < 0)
-    {
-        return resultList;
-    }
-
-    startPos += pattern.size(); // Move to the beginning of the first string
-
-    int endPos = json.indexOf(QString::fromUtf8("\"]"), startPos);
-    if (endPos < 0)
-    {
-        return resultList;
-    }
-
-    QString substr = json.mid(startPos, endPos - startPos);
-    QStringList parts = substr.remove(QString::fromUtf8("\"")).split(QString::fromUtf8(","));
-
-    // Trim whitespace from each part and add it to the result list
-    for (const QString& part : parts)
-    {
-        resultList.append(part.trimmed());
-    }
-
-    return resultList;
-}
-
-long long Utilities::extractJSONNumber(QString json, QString name)
-{
-    QString pattern = name + QString::fromUtf8("\":");
-    int pos = json.indexOf(pattern);
-    if (pos < 0)
-    {
-        return 0;
-    }
-
-    int end = pos + pattern.size();
-    int count = 0;
-    while (json[end].isDigit())
-    {
-        end++;
-        count++;
-    }
-
-    return json.mid(pos + pattern.size(), count).toLongLong();
-}
-
 QString Utilities::getDefaultBasePath()
 {
         QStringList defaultPaths;
@@ -1033,19 +858,15 @@ QString Utilities::joinLogZipFiles(MegaApi *megaApi, const QDateTime *timestampS
             return QString();
         }
 
-        unsigned long crc, tot;
-        gzinit(&crc, &tot, pFile);
-
         QFileInfoList logFiles = logDir.entryInfoList(QStringList() << QString::fromUtf8("MEGAsync.[0-9]*.log"), QDir::Files);
-        int nLogFiles = logFiles.count();
 
         std::sort(logFiles.begin(), logFiles.end(), [](const QFileInfo &v1, const QFileInfo &v2){
             return v1.fileName().remove(QRegExp(QString::fromUtf8("[^\\d]"))).toInt() > v2.fileName().remove(QRegExp(QString::fromUtf8("[^\\d]"))).toInt();} );
 
+        // Rotated logs are sequences of gzip members, so joining them is a plain concatenation
+        std::vector<char> buffer(256 * 1024);
         foreach (QFileInfo i, logFiles)
         {
-            --nLogFiles;
-
             if (timestampSince)
             {
                 if ( i.lastModified() < *timestampSince && i.fileName() != QString::fromUtf8("MEGAsync.0.log")) //keep at least the last log
@@ -1054,19 +875,19 @@ QString Utilities::joinLogZipFiles(MegaApi *megaApi, const QDateTime *timestampS
                 }
             }
 
-            try
+            QFile logFile(i.absoluteFilePath());
+            bool copied = logFile.open(QIODevice::ReadOnly);
+            qint64 count = 0;
+            while (copied && (count = logFile.read(buffer.data(), static_cast<qint64>(buffer.size()))) > 0)
             {
-#ifdef _WIN32
-                gzcopy(i.absoluteFilePath().toStdWString().c_str(), nLogFiles, &crc, &tot, pFile);
-#else
-                gzcopy(i.absoluteFilePath().toUtf8().constData(), nLogFiles, &crc, &tot, pFile);
-#endif
+                copied = fwrite(buffer.data(), 1, static_cast<size_t>(count), pFile) == static_cast<size_t>(count);
             }
-            catch (const std::exception& e)
+
+            if (!copied || count < 0)
             {
-                std::cerr << "Error joining zip files for bug report " << e.what() << std::endl;
+                std::cerr << "Error joining zip files for bug report" << std::endl;
                 megaApi->log(MegaApi::LOG_LEVEL_ERROR, QString::fromUtf8("Error joining zip files for bug report : %1")
-                             .arg(QString::fromUtf8(e.what())).toUtf8().constData());
+                             .arg(i.fileName()).toUtf8().constData());
 
                 fclose(pFile);
                 QFile::remove(joinLogsFile.absoluteFilePath());
@@ -1636,7 +1457,7 @@ bool Utilities::isNodeNameValid(const QString& name)
     return !trimmedName.isEmpty() && !trimmedName.contains(FORBIDDEN_CHARS_RX);
 }
 
-QString Utilities::getFileHash(const QString& filePath)
+static QString computeFileHash(const QString& filePath)
 {
     QFile file(filePath);
 
@@ -1664,6 +1485,93 @@ QString Utilities::getFileHash(const QString& filePath)
     return hashString;
 }
 
+static QString computeFileCRC(const QString& filePath)
+{
+    std::unique_ptr<char[]> crc(MegaSyncApp->getMegaApi()->getCRC(QDir::toNativeSeparators(filePath).toUtf8().constData()));
+    return QString::fromUtf8(crc.get());
+}
+
+static QString fileHashCachePath()
+{
+    return MegaApplication::applicationDataPath() + QString::fromUtf8("/filehashes.cache");
+}
+
+std::shared_ptr<FileHashCache> Utilities::getFileHashCache()
+{
+    static std::once_flag opened;
+    static auto cache = std::make_shared<FileHashCache>();
+    std::call_once(opened, []()
+    {
+        if (!cache->open(toFolderSizePath(fileHashCachePath())))
+        {
+            MegaApi::log(MegaApi::LOG_LEVEL_WARNING, "Unable to map the file hash cache, it will not be kept");
+        }
+    });
+    return cache;
+}
+
+bool Utilities::findCachedFileDigest(const QString& filePath, FileHashCache::Digest digest, QString& value)
+{
+    FileIdentity identity;
+    std::string cached;
+    if (!FileIdentity::read(toFolderSizePath(filePath), identity)
+        || !getFileHashCache()->find(identity, digest, cached))
+    {
+        return false;
+    }
+
+    value = QString::fromStdString(cached);
+    return true;
+}
+
+static QString getFileDigest(const QString& filePath, FileHashCache::Digest digest)
+{
+    const bool isHash = digest == FileHashCache::Digest::SHA256;
+    const FileHashPath nativePath(Utilities::toFolderSizePath(filePath));
+    FileIdentity before;
+    if (!FileIdentity::read(nativePath, before))
+    {
+        return isHash ? computeFileHash(filePath) : computeFileCRC(filePath);
+    }
+
+    auto cache = Utilities::getFileHashCache();
+    std::string cached;
+    if (cache->find(before, digest, cached))
+    {
+        return QString::fromStdString(cached);
+    }
+
+    QString value(isHash ? computeFileHash(filePath) : computeFileCRC(filePath));
+    // The CRC samples blocks of the file just read, so it costs no more disk reads
+    QString crc;
+    if (isHash && !cache->find(before, FileHashCache::Digest::CRC, cached))
+    {
+        crc = computeFileCRC(filePath);
+    }
+
+    // Not kept if the file changed while it was read
+    FileIdentity after;
+    if (!value.isEmpty() && FileIdentity::read(nativePath, after) && after == before)
+    {
+        cache->store(before, digest, value.toStdString());
+        if (!crc.isEmpty())
+        {
+            cache->store(before, FileHashCache::Digest::CRC, crc.toStdString());
+        }
+    }
+    return value;
+}
+
+QString Utilities::getFileHash(const QString& filePath)
+{
+    return getFileDigest(filePath, FileHashCache::Digest::SHA256);
+}
+
+QString Utilities::getFileCRC(const QString& filePath)
+{
+    return getFileDigest(filePath, FileHashCache::Digest::CRC);
+}
+
 void MegaListenerFuncExecuter::setExecuteInAppThread(bool executeInAppThread)
 {
     mExecuteInAppThread = executeInAppThread;
@@ -3,6 +3,9 @@
 
 #include "megaapi.h"
 #include "ThreadPool.h"
+#include "FolderSizeScanner.h"
+#include "FileHashCache.h"
+#include "FileExtensionTable.h"
 
 #include <QString>
 #include <QHash>
@@ -304,6 +307,17 @@ public:
         TYPE_IMAGE    = 0x20,
     };
     Q_DECLARE_FLAGS(FileTypes, FileType)
+    static constexpr std::size_t FILE_TYPE_COUNT = 6;
+    // Position of the flag of the type, to index flat arrays
+    static constexpr std::size_t fileTypeIndex(FileType type)
+    {
+        std::size_t index = 0;
+        for (auto value = toInt(type); value > 1; value >>= 1)
+        {
+            ++index;
+        }
+        return index;
+    }
     static const QString SUPPORT_URL;
     static const QString BACKUP_CENTER_URL;
     static const QString SYNC_SUPPORT_URL;
@@ -328,9 +342,6 @@ public:
     static QString getTimeString(long long secs, bool secondPrecision = true, bool color = true);
     static QString getQuantityString(unsigned long long quantity);
     static QString getAddedTimeString(long long secs);
-    static QString extractJSONString(QString json, QString name);
-    static QStringList extractJSONStringList(const QString& json, const QString& name);
-    static long long extractJSONNumber(QString json, QString name);
     static QString getDefaultBasePath();
     static void getPROurlWithParameters(QString &url);
     static QString joinLogZipFiles(mega::MegaApi *megaApi, const QDateTime *timestampSince = nullptr, QString appendHashReference = QString());
@@ -375,11 +386,7 @@ public:
 
 private:
     Utilities() {}
-    static QHash<QString, QString> extensionIcons;
-    static QHash<QString, FileType> fileTypes;
     static QHash<QString, QString> languageNames;
-    static void initializeExtensions();
-    static void initializeFileTypes();
     static QString getExtensionPixmapNameSmall(QString fileName);
     static QString getExtensionPixmapNameMedium(QString fileName);
     static double toDoubleInUnit(unsigned long long bytes, unsigned long long unit);
@@ -402,13 +409,25 @@ public:
     static void queueFunctionInObjectThread(QObject* object, std::function<void()> fun);
 
     static void getFolderSize(QString folderPath, long long *size);
+    // Blocks until the folders are scanned in the thread pool; do not call it from a pool task
+    static long long getFolderSize(const QStringList& folderPaths,
+                                   ThreadPool::CancelToken token = ThreadPool::CancelToken());
+    static FolderSizePath toFolderSizePath(const QString& path);
+    // Shared folder size cache, loaded from disk the first time
+    static std::shared_ptr<FolderSizeCache> getFolderSizeCache();
+    static void saveFolderSizeCache();
     static qreal getDevicePixelRatio();
 
     static QIcon getCachedPixmap(QString fileName);
     static QIcon getExtensionPixmapSmall(QString fileName);
     static QIcon getExtensionPixmapMedium(QString fileName);
+    // For names already classified; must be called from the GUI thread
+    static QIcon getExtensionPixmapSmall(FileExtensionTable::Icon icon);
+    static QIcon getExtensionPixmapMedium(FileExtensionTable::Icon icon);
     static QString getExtensionPixmapName(QString fileName, QString prefix);
-    static FileType getFileType(QString fileName, QString prefix);
+    static FileExtensionTable::Icon getFileIcon(const QString& fileName);
+    static FileType getFileType(const QString& fileName);
+    static FileType getFileType(FileExtensionTable::Icon icon);
 
     static long long getSystemsAvailableMemory();
 
@@ -417,7 +436,15 @@ public:
     // Compute the part per <ref> of <part> from <total>. Defaults to %
     static int partPer(unsigned long long part, unsigned long long total, uint ref = 100);
 
+    // Digests of local files, answered from the file hash cache while the file is unchanged.
+    // SHA-256 of the contents; reading the whole file also fills the fingerprint CRC
     static QString getFileHash(const QString& filePath);
+    // CRC of the SDK fingerprint. Reads parts of the file when not cached
+    static QString getFileCRC(const QString& filePath);
+    // Only looks in the cache, the file is not read
+    static bool findCachedFileDigest(const QString& filePath, FileHashCache::Digest digest, QString& value);
+    // Shared file hash cache, mapped from disk the first time
+    static std::shared_ptr<FileHashCache> getFileHashCache();
 
     // Human-friendly list of forbidden chars for New Remote Folder
     static const QLatin1String FORBIDDEN_CHARS;
@@ -0,0 +1,793 @@
+#include "WebRequestParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+namespace
+{
+const char HEADERS_END[] = "\r\n\r\n";
+const std::size_t HEADERS_END_SIZE = 4;
+
+// Values nested deeper than this are rejected instead of skipped
+const int MAX_DEPTH = 32;
+
+bool equalsIgnoreCase(const std::string& text, std::size_t pos, std::size_t size, const char* other)
+{
+    if (strlen(other) != size)
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (tolower(static_cast<unsigned char>(text[pos + i])) != tolower(static_cast<unsigned char>(other[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, unsigned int codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        out.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Single pass JSON reader. Every function leaves mPos after what it read and returns false on
+// malformed input; the output arguments may be null to skip a value
+class JsonReader
+{
+public:
+    JsonReader(const char* data, std::size_t size) : mPos(data), mEnd(data + size) {}
+
+    bool atEnd()
+    {
+        skipSpace();
+        return mPos == mEnd;
+    }
+
+    bool consume(char c)
+    {
+        skipSpace();
+        if (mPos == mEnd || *mPos != c)
+        {
+            return false;
+        }
+        ++mPos;
+        return true;
+    }
+
+    char peek()
+    {
+        skipSpace();
+        return mPos == mEnd ? '\0' : *mPos;
+    }
+
+    bool readString(std::string* out)
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+
+        while (mPos != mEnd)
+        {
+            // Copy the run of plain characters at once
+            const char* start = mPos;
+            while (mPos != mEnd && *mPos != '"' && *mPos != '\\' && static_cast<unsigned char>(*mPos) >= 0x20)
+            {
+                ++mPos;
+            }
+            if (out)
+            {
+                out->append(start, mPos);
+            }
+
+            if (mPos == mEnd || static_cast<unsigned char>(*mPos) < 0x20)
+            {
+                return false;
+            }
+            if (*mPos++ == '"')
+            {
+                return true;
+            }
+
+            // Escape sequence
+            if (mPos == mEnd)
+            {
+                return false;
+            }
+            char escaped = *mPos++;
+            char plain = '\0';
+            switch (escaped)
+            {
+            case '"': plain = '"'; break;
+            case '\\': plain = '\\'; break;
+            case '/': plain = '/'; break;
+            case 'b': plain = '\b'; break;
+            case 'f': plain = '\f'; break;
+            case 'n': plain = '\n'; break;
+            case 'r': plain = '\r'; break;
+            case 't': plain = '\t'; break;
+            case 'u':
+            {
+                unsigned int codePoint;
+                if (!readHex(codePoint))
+                {
+                    return false;
+                }
+                if (codePoint >= 0xD800 && codePoint < 0xDC00)
+                {
+                    unsigned int low;
+                    if (mEnd - mPos < 2 || mPos[0] != '\\' || mPos[1] != 'u')
+                    {
+                        return false;
+                    }
+                    mPos += 2;
+                    if (!readHex(low) || low < 0xDC00 || low >= 0xE000)
+                    {
+                        return false;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (codePoint >= 0xDC00 && codePoint < 0xE000)
+                {
+                    return false;
+                }
+                if (out)
+                {
+                    appendUtf8(*out, codePoint);
+                }
+                continue;
+            }
+            default:
+                return false;
+            }
+            if (out)
+            {
+                out->push_back(plain);
+            }
+        }
+        return false;
+    }
+
+    // isInteger is false for fractions, exponents and integers out of range
+    bool readNumber(long long& value, bool& isInteger)
+    {
+        skipSpace();
+        const char* start = mPos;
+        bool negative = false;
+        if (mPos != mEnd && *mPos == '-')
+        {
+            negative = true;
+            ++mPos;
+        }
+        if (mPos == mEnd || !isdigit(static_cast<unsigned char>(*mPos)))
+        {
+            return false;
+        }
+        if (*mPos == '0' && mPos + 1 != mEnd && isdigit(static_cast<unsigned char>(mPos[1])))
+        {
+            return false;
+        }
+
+        // Accumulated as negative, which also holds LLONG_MIN
+        isInteger = true;
+        value = 0;
+        while (mPos != mEnd && isdigit(static_cast<unsigned char>(*mPos)))
+        {
+            const int digit = *mPos++ - '0';
+            if (value < (LLONG_MIN + digit) / 10)
+            {
+                isInteger = false;
+            }
+            else
+            {
+                value = value * 10 - digit;
+            }
+        }
+
+        if (mPos != mEnd && *mPos == '.')
+        {
+            ++mPos;
+            if (!skipDigits())
+            {
+                return false;
+            }
+            isInteger = false;
+        }
+        if (mPos != mEnd && (*mPos == 'e' || *mPos == 'E'))
+        {
+            ++mPos;
+            if (mPos != mEnd && (*mPos == '+' || *mPos == '-'))
+            {
+                ++mPos;
+            }
+            if (!skipDigits())
+            {
+                return false;
+            }
+            isInteger = false;
+        }
+
+        if (!negative)
+        {
+            if (value == LLONG_MIN)
+            {
+                isInteger = false;
+            }
+            else
+            {
+                value = -value;
+            }
+        }
+        return mPos != start;
+    }
+
+    bool skipValue(int depth)
+    {
+        if (depth > MAX_DEPTH)
+        {
+            return false;
+        }
+
+        switch (peek())
+        {
+        case '"':
+            return readString(nullptr);
+        case '{':
+            ++mPos;
+            if (consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                if (!readString(nullptr) || !consume(':') || !skipValue(depth + 1))
+                {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        case '[':
+            ++mPos;
+            if (consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                if (!skipValue(depth + 1))
+                {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        case 't':
+            return readLiteral("true");
+        case 'f':
+            return readLiteral("false");
+        case 'n':
+            return readLiteral("null");
+        default:
+        {
+            long long value;
+            bool isInteger;
+            return readNumber(value, isInteger);
+        }
+        }
+    }
+
+private:
+    void skipSpace()
+    {
+        while (mPos != mEnd && (*mPos == ' ' || *mPos == '\t' || *mPos == '\n' || *mPos == '\r'))
+        {
+            ++mPos;
+        }
+    }
+
+    bool skipDigits()
+    {
+        const char* start = mPos;
+        while (mPos != mEnd && isdigit(static_cast<unsigned char>(*mPos)))
+        {
+            ++mPos;
+        }
+        return mPos != start;
+    }
+
+    bool readHex(unsigned int& value)
+    {
+        if (mEnd - mPos < 4)
+        {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char c = *mPos++;
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+            {
+                value |= static_cast<unsigned int>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                value |= static_cast<unsigned int>(c - 'a' + 10);
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                value |= static_cast<unsigned int>(c - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readLiteral(const char* literal)
+    {
+        const std::size_t size = strlen(literal);
+        if (static_cast<std::size_t>(mEnd - mPos) < size || memcmp(mPos, literal, size))
+        {
+            return false;
+        }
+        mPos += size;
+        return true;
+    }
+
+    const char* mPos;
+    const char* mEnd;
+};
+
+bool readNode(JsonReader& reader, WebRequestNode& node)
+{
+    if (!reader.consume('{'))
+    {
+        return false;
+    }
+    if (reader.consume('}'))
+    {
+        return true;
+    }
+
+    std::string key;
+    do
+    {
+        key.clear();
+        if (!reader.readString(&key) || !reader.consume(':'))
+        {
+            return false;
+        }
+
+        std::string* text = nullptr;
+        long long* number = nullptr;
+        if (key.size() == 1)
+        {
+            switch (key[0])
+            {
+            case 'h': text = &node.handle; break;
+            case 'p': text = &node.parent; break;
+            case 'n': text = &node.name; break;
+            case 'k': text = &node.key; break;
+            case 'c': text = &node.crc; break;
+            case 't': number = &node.type; break;
+            case 's': number = &node.size; break;
+            }
+        }
+        else if (key == "ts")
+        {
+            number = &node.mtime;
+        }
+
+        bool ok;
+        if (text && reader.peek() == '"')
+        {
+            text->clear();
+            ok = reader.readString(text);
+        }
+        else if (number && (reader.peek() == '-' || isdigit(static_cast<unsigned char>(reader.peek()))))
+        {
+            bool isInteger;
+            long long value;
+            ok = reader.readNumber(value, isInteger);
+            if (ok && isInteger)
+            {
+                *number = value;
+            }
+        }
+        else
+        {
+            ok = reader.skipValue(2);
+        }
+
+        if (!ok)
+        {
+            return false;
+        }
+    } while (reader.consume(','));
+
+    return reader.consume('}');
+}
+}
+
+bool WebRequest::parse(const char* data, std::size_t size)
+{
+    mAction.clear();
+    mNodes.clear();
+    mFields.clear();
+
+    JsonReader reader(data, size);
+    if (!reader.consume('{'))
+    {
+        return false;
+    }
+
+    if (!reader.consume('}'))
+    {
+        do
+        {
+            Field field;
+            if (!reader.readString(&field.name) || !reader.consume(':'))
+            {
+                return false;
+            }
+
+            const char next = reader.peek();
+            if (next == '"')
+            {
+                if (!reader.readString(&field.text))
+                {
+                    return false;
+                }
+                if (field.name == "a")
+                {
+                    mAction = field.text;
+                }
+                mFields.push_back(std::move(field));
+            }
+            else if (next == '[' && field.name == "f")
+            {
+                reader.consume('[');
+                if (!reader.consume(']'))
+                {
+                    do
+                    {
+                        mNodes.emplace_back();
+                        if (!readNode(reader, mNodes.back()))
+                        {
+                            return false;
+                        }
+                    } while (reader.consume(','));
+
+                    if (!reader.consume(']'))
+                    {
+                        return false;
+                    }
+                }
+            }
+            else if (next == '[')
+            {
+                // Kept only when all the items are strings
+                reader.consume('[');
+                field.type = Field::Type::STRING_LIST;
+                bool strings = true;
+                if (!reader.consume(']'))
+                {
+                    do
+                    {
+                        if (strings && reader.peek() == '"')
+                        {
+                            field.list.emplace_back();
+                            if (!reader.readString(&field.list.back()))
+                            {
+                                return false;
+                            }
+                        }
+                        else
+                        {
+                            strings = false;
+                            if (!reader.skipValue(2))
+                            {
+                                return false;
+                            }
+                        }
+                    } while (reader.consume(','));
+
+                    if (!reader.consume(']'))
+                    {
+                        return false;
+                    }
+                }
+                if (strings)
+                {
+                    mFields.push_back(std::move(field));
+                }
+            }
+            else if (next == '-' || isdigit(static_cast<unsigned char>(next)))
+            {
+                bool isInteger;
+                if (!reader.readNumber(field.number, isInteger))
+                {
+                    return false;
+                }
+                if (isInteger)
+                {
+                    field.type = Field::Type::NUMBER;
+                    mFields.push_back(std::move(field));
+                }
+            }
+            else if (!reader.skipValue(1))
+            {
+                return false;
+            }
+        } while (reader.consume(','));
+
+        if (!reader.consume('}'))
+        {
+            return false;
+        }
+    }
+
+    return reader.atEnd();
+}
+
+const std::string& WebRequest::action() const
+{
+    return mAction;
+}
+
+const std::vector<WebRequestNode>& WebRequest::nodes() const
+{
+    return mNodes;
+}
+
+std::string WebRequest::string(const char* name) const
+{
+    const Field* field = find(name);
+    return field && field->type == Field::Type::STRING ? field->text : std::string();
+}
+
+long long WebRequest::number(const char* name, long long defaultValue) const
+{
+    const Field* field = find(name);
+    return field && field->type == Field::Type::NUMBER ? field->number : defaultValue;
+}
+
+std::vector<std::string> WebRequest::stringList(const char* name) const
+{
+    const Field* field = find(name);
+    return field && field->type == Field::Type::STRING_LIST ? field->list : std::vector<std::string>();
+}
+
+const WebRequest::Field* WebRequest::find(const char* name) const
+{
+    // The first one wins, as with a text search
+    auto field = std::find_if(mFields.begin(), mFields.end(), [name](const Field& field)
+    {
+        return field.name == name;
+    });
+    return field == mFields.end() ? nullptr : &*field;
+}
+
+WebRequestParser::WebRequestParser(std::size_t maxBodySize)
+    : mMaxBodySize(maxBodySize),
+      mState(State::HEADERS),
+      mError(Error::NONE),
+      mScanned(0),
+      mBodyStart(0),
+      mContentLength(0)
+{
+}
+
+WebRequestParser::State WebRequestParser::append(const char* data, std::size_t size)
+{
+    if (mState == State::COMPLETE || mState == State::FAILED)
+    {
+        // Kept for the next request
+        mBuffer.append(data, size);
+        return mState;
+    }
+
+    mBuffer.append(data, size);
+
+    if (mState == State::HEADERS)
+    {
+        // The end of the headers may start in the previous bytes
+        const std::size_t from = mScanned >= HEADERS_END_SIZE - 1 ? mScanned - (HEADERS_END_SIZE - 1) : 0;
+        const std::size_t end = mBuffer.find(HEADERS_END, from, HEADERS_END_SIZE);
+        if (end == std::string::npos)
+        {
+            mScanned = mBuffer.size();
+            if (mBuffer.size() > MAX_HEADERS_SIZE)
+            {
+                mError = Error::HEADERS_TOO_LARGE;
+                mState = State::FAILED;
+            }
+            return mState;
+        }
+
+        if (end > MAX_HEADERS_SIZE)
+        {
+            mError = Error::HEADERS_TOO_LARGE;
+            mState = State::FAILED;
+            return mState;
+        }
+
+        if (!parseHeaders(end))
+        {
+            mState = State::FAILED;
+            return mState;
+        }
+
+        mBodyStart = end + HEADERS_END_SIZE;
+        if (isOption())
+        {
+            mContentLength = 0;
+        }
+        mBuffer.reserve(mBodyStart + mContentLength);
+        mState = State::BODY;
+    }
+
+    if (mState == State::BODY && mBuffer.size() - mBodyStart >= mContentLength)
+    {
+        // The body is taken out of the buffer without copying it
+        std::string rest(mBuffer, mBodyStart + mContentLength);
+        mBuffer.erase(0, mBodyStart);
+        mBuffer.resize(mContentLength);
+        mBody.swap(mBuffer);
+        mBuffer.swap(rest);
+        mState = State::COMPLETE;
+    }
+
+    return mState;
+}
+
+WebRequestParser::State WebRequestParser::state() const
+{
+    return mState;
+}
+
+WebRequestParser::Error WebRequestParser::error() const
+{
+    return mError;
+}
+
+bool WebRequestParser::isPost() const
+{
+    return !mHeaderLines.empty() && mHeaderLines.front().compare(0, 4, "POST") == 0;
+}
+
+bool WebRequestParser::isOption() const
+{
+    return !mHeaderLines.empty() && mHeaderLines.front().compare(0, 6, "OPTION") == 0;
+}
+
+const std::vector<std::string>& WebRequestParser::headerLines() const
+{
+    return mHeaderLines;
+}
+
+std::string WebRequestParser::header(const char* name) const
+{
+    for (std::size_t i = 1; i < mHeaderLines.size(); ++i)
+    {
+        const std::string& line = mHeaderLines[i];
+        const std::size_t colon = line.find(':');
+        if (colon != std::string::npos && equalsIgnoreCase(line, 0, colon, name))
+        {
+            std::size_t start = colon + 1;
+            while (start < line.size() && (line[start] == ' ' || line[start] == '\t'))
+            {
+                ++start;
+            }
+            std::size_t end = line.size();
+            while (end > start && (line[end - 1] == ' ' || line[end - 1] == '\t'))
+            {
+                --end;
+            }
+            return line.substr(start, end - start);
+        }
+    }
+    return std::string();
+}
+
+const std::string& WebRequestParser::body() const
+{
+    return mBody;
+}
+
+void WebRequestParser::reset()
+{
+    std::string rest;
+    rest.swap(mBuffer);
+
+    mState = State::HEADERS;
+    mError = Error::NONE;
+    mScanned = 0;
+    mHeaderLines.clear();
+    mBodyStart = 0;
+    mContentLength = 0;
+    mBody.clear();
+    mBody.shrink_to_fit();
+
+    if (!rest.empty())
+    {
+        append(rest.data(), rest.size());
+    }
+}
+
+bool WebRequestParser::parseHeaders(std::size_t headersSize)
+{
+    std::size_t start = 0;
+    while (start <= headersSize)
+    {
+        std::size_t end = mBuffer.find("\r\n", start);
+        if (end == std::string::npos || end > headersSize)
+        {
+            end = headersSize;
+        }
+        mHeaderLines.push_back(mBuffer.substr(start, end - start));
+        start = end + 2;
+    }
+
+    if (!isPost() && !isOption())
+    {
+        mError = Error::METHOD_NOT_ALLOWED;
+        return false;
+    }
+    if (!isPost())
+    {
+        return true;
+    }
+
+    const std::string contentLength = header("Content-Length");
+    if (contentLength.empty())
+    {
+        mError = Error::MISSING_CONTENT_LENGTH;
+        return false;
+    }
+
+    mContentLength = 0;
+    for (char c : contentLength)
+    {
+        if (!isdigit(static_cast<unsigned char>(c)))
+        {
+            mError = Error::INVALID_CONTENT_LENGTH;
+            return false;
+        }
+        mContentLength = mContentLength * 10 + static_cast<std::size_t>(c - '0');
+        if (mContentLength > mMaxBodySize)
+        {
+            mError = Error::BODY_TOO_LARGE;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Node of the "f" list of a download request of the webclient
+struct WebRequestNode
+{
+    std::string handle;   // h
+    std::string parent;   // p
+    std::string name;     // n, base64url encoded
+    std::string key;      // k
+    std::string crc;      // c
+    long long type = -1;  // t
+    long long size = 0;   // s
+    long long mtime = 0;  // ts
+};
+
+/// Typed contents of a JSON request of the webclient, read in a single pass.
+/// Only the top level fields and the nodes of "f" are kept; other values are skipped
+class WebRequest
+{
+public:
+    /// Fails on malformed JSON or when the top level value is not an object
+    bool parse(const char* data, std::size_t size);
+
+    const std::string& action() const;
+    const std::vector<WebRequestNode>& nodes() const;
+
+    /// Empty when missing or not a string
+    std::string string(const char* name) const;
+    /// defaultValue when missing or not an integer
+    long long number(const char* name, long long defaultValue = 0) const;
+    /// Empty when missing or not an array of strings
+    std::vector<std::string> stringList(const char* name) const;
+
+private:
+    struct Field
+    {
+        enum class Type {STRING, NUMBER, STRING_LIST};
+
+        std::string name;
+        Type type = Type::STRING;
+        std::string text;
+        long long number = 0;
+        std::vector<std::string> list;
+    };
+
+    const Field* find(const char* name) const;
+
+    std::string mAction;
+    std::vector<WebRequestNode> mNodes;
+    std::vector<Field> mFields;
+};
+
+/// Incremental parser of the HTTP requests of the webclient.
+/// Bytes are appended as they arrive; the end of the headers is searched only in the new bytes
+/// and the body is collected up to its Content-Length, which is bounded.
+class WebRequestParser
+{
+public:
+    enum class State
+    {
+        HEADERS,   // Waiting for the end of the headers
+        BODY,      // Waiting for the rest of the body
+        COMPLETE,
+        FAILED
+    };
+
+    enum class Error
+    {
+        NONE,
+        METHOD_NOT_ALLOWED,
+        HEADERS_TOO_LARGE,
+        MISSING_CONTENT_LENGTH,
+        INVALID_CONTENT_LENGTH,
+        BODY_TOO_LARGE
+    };
+
+    static const std::size_t MAX_HEADERS_SIZE = 16 * 1024;
+    static const std::size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
+    explicit WebRequestParser(std::size_t maxBodySize = MAX_BODY_SIZE);
+
+    State append(const char* data, std::size_t size);
+    State state() const;
+    Error error() const;
+
+    bool isPost() const;
+    bool isOption() const;
+    /// Request line first, as received
+    const std::vector<std::string>& headerLines() const;
+    /// Value of the first header with that name, case insensitive. Empty when missing
+    std::string header(const char* name) const;
+    /// Only valid when COMPLETE
+    const std::string& body() const;
+
+    /// Ready for the next request of the connection, keeping the bytes already received for it
+    void reset();
+
+private:
+    bool parseHeaders(std::size_t headersSize);
+
+    std::size_t mMaxBodySize;
+    State mState;
+    Error mError;
+    std::string mBuffer;
+    std::size_t mScanned;
+    std::vector<std::string> mHeaderLines;
+    std::size_t mBodyStart;
+    std::size_t mContentLength;
+    std::string mBody;
+};
@@ -3,6 +3,7 @@ set(DESKTOP_APP_CONTROL_HEADERS
     control/AccountStatusController.h
     control/AppStatsEvents.h
     control/AsyncHandler.h
+    control/BinaryLog.h
     control/ConnectivityChecker.h
     control/CrashHandler.h
     control/DialogOpener.h
@@ -11,26 +12,33 @@ set(DESKTOP_APP_CONTROL_HEADERS
     control/StatsEventHandler.h
     control/ProxyStatsEventHandler.h
     control/ExportProcessor.h
+    control/FileExtensionTable.h
     control/FileFolderAttributes.h
+    control/FileHashCache.h
+    control/FolderSizeScanner.h
     control/HTTPServer.h
     control/IntervalExecutioner.h
     control/LinkProcessor.h
     control/LinkObject.h
     control/LoginController.h
+    control/LogCompressor.h
     control/MegaDownloader.h
     control/MegaSyncLogger.h
     control/MegaUploader.h
+    control/MpscRingBuffer.h
+    control/NodeChangeBatch.h
     control/TextDecorator.h
     control/ThreadPool.h
     control/TransferBatch.h
     control/TransferRemainingTime.h
+    control/TransferProgressFeed.h
     control/UpdateTask.h
     control/UserAttributesManager.h
+    control/WebRequestParser.h
     control/SetManager.h
     control/SetTypes.h
     control/Utilities.h
     control/Version.h
-    control/gzjoin.h
     control/qrcodegen.h
     control/Preferences/EncryptedSettings.h
     control/Preferences/EphemeralCredentials.h
@@ -40,6 +48,7 @@ set(DESKTOP_APP_CONTROL_HEADERS
 set(DESKTOP_APP_CONTROL_SOURCES
     control/AccountStatusController.cpp
     control/AppStatsEvents.cpp
+    control/BinaryLog.cpp
     control/ConnectivityChecker.cpp
     control/CrashHandler.cpp
     control/DialogOpener.cpp
@@ -47,22 +56,29 @@ set(DESKTOP_APP_CONTROL_SOURCES
     control/EmailRequester.cpp
     control/ProxyStatsEventHandler.cpp
     control/ExportProcessor.cpp
+    control/FileExtensionTable.cpp
     control/FileFolderAttributes.cpp
+    control/FileHashCache.cpp
+    control/FolderSizeScanner.cpp
     control/HTTPServer.cpp
     control/IntervalExecutioner.cpp
     control/LinkProcessor.cpp
     control/LinkObject.cpp
     control/LoginController.cpp
+    control/LogCompressor.cpp
     control/MegaDownloader.cpp
     control/MegaSyncLogger.cpp
     control/MegaUploader.cpp
+    control/NodeChangeBatch.cpp
     control/SetManager.cpp
     control/TextDecorator.cpp
     control/ThreadPool.cpp
     control/TransferBatch.cpp
     control/TransferRemainingTime.cpp
+    control/TransferProgressFeed.cpp
     control/UpdateTask.cpp
     control/UserAttributesManager.cpp
+    control/WebRequestParser.cpp
     control/Utilities.cpp
     control/qrcodegen.c
     control/Preferences/EncryptedSettings.cpp
@@ -23,14 +23,22 @@ SOURCES += $$PWD/HTTPServer.cpp \
     $$PWD/SetManager.cpp \
     $$PWD/ProxyStatsEventHandler.cpp \
     $$PWD/TransferRemainingTime.cpp \
+    $$PWD/TransferProgressFeed.cpp \
     $$PWD/UpdateTask.cpp \
     $$PWD/CrashHandler.cpp \
     $$PWD/ExportProcessor.cpp \
     $$PWD/UserAttributesManager.cpp \
+    $$PWD/WebRequestParser.cpp \
     $$PWD/Utilities.cpp \
     $$PWD/ThreadPool.cpp \
+    $$PWD/FolderSizeScanner.cpp \
+    $$PWD/FileHashCache.cpp \
+    $$PWD/NodeChangeBatch.cpp \
+    $$PWD/FileExtensionTable.cpp \
     $$PWD/MegaDownloader.cpp \
     $$PWD/MegaSyncLogger.cpp \
+    $$PWD/LogCompressor.cpp \
+    $$PWD/BinaryLog.cpp \
     $$PWD/ConnectivityChecker.cpp \
     $$PWD/TransferBatch.cpp \
     $$PWD/TextDecorator.cpp \
@@ -53,23 +61,31 @@ HEADERS  +=  $$PWD/HTTPServer.h \
     $$PWD/FileFolderAttributes.h \
     $$PWD/LinkProcessor.h \
     $$PWD/MegaUploader.h \
+    $$PWD/MpscRingBuffer.h \
     $$PWD/ProtectedQueue.h \
     $$PWD/ProxyStatsEventHandler.h \
     $$PWD/SetManager.h \
     $$PWD/SetTypes.h \
     $$PWD/TransferRemainingTime.h \
+    $$PWD/TransferProgressFeed.h \
     $$PWD/UpdateTask.h \
     $$PWD/CrashHandler.h \
     $$PWD/ExportProcessor.h \
     $$PWD/UserAttributesManager.h \
+    $$PWD/WebRequestParser.h \
     $$PWD/Utilities.h \
     $$PWD/ThreadPool.h \
+    $$PWD/FolderSizeScanner.h \
+    $$PWD/FileHashCache.h \
+    $$PWD/NodeChangeBatch.h \
+    $$PWD/FileExtensionTable.h \
     $$PWD/MegaDownloader.h \
     $$PWD/MegaSyncLogger.h \
+    $$PWD/LogCompressor.h \
+    $$PWD/BinaryLog.h \
     $$PWD/ConnectivityChecker.h \
     $$PWD/TransferBatch.h \
     $$PWD/TextDecorator.h \
     $$PWD/Version.h \
     $$PWD/EmailRequester.h \
-    $$PWD/qrcodegen.h \
-    $$PWD/gzjoin.h
+    $$PWD/qrcodegen.h
@@ -67,7 +67,7 @@ static constexpr int NETWORK_LIMITS_MAX {9999};
 
 long long calculateCacheSize()
 {
-    long long cacheSize = 0;
+    QStringList debrisFolders;
     auto model (SyncInfo::instance());
     for (auto syncType : SyncInfo::AllHandledSyncTypes)
     {
@@ -77,12 +77,12 @@ long long calculateCacheSize()
             QString syncPath = syncSetting->getLocalFolder();
             if (!syncPath.isEmpty())
             {
-                Utilities::getFolderSize(syncPath + QDir::separator()
-                                         + QString::fromUtf8(MEGA_DEBRIS_FOLDER), &cacheSize);
+                debrisFolders.append(syncPath + QDir::separator() + QString::fromUtf8(MEGA_DEBRIS_FOLDER));
             }
         }
     }
-    return cacheSize;
+    // All the folders in a single parallel scan
+    return Utilities::getFolderSize(debrisFolders);
 }
 
 long long calculateRemoteCacheSize(MegaApi* mMegaApi)
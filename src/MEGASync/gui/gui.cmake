@@ -68,6 +68,8 @@ set(DESKTOP_APP_GUI_HEADERS
     gui/node_selector/model/NodeSelectorModel.h
     gui/node_selector/model/NodeSelectorModelSpecialised.h
     gui/node_selector/model/NodeSelectorModelItem.h
+    gui/node_selector/model/NodeSelectorSearchResults.h
+    gui/node_selector/model/NodeSelectorTree.h
     gui/node_selector/gui/NodeSelectorTreeView.h
     gui/node_selector/gui/NodeSelectorTreeViewWidget.h
     gui/node_selector/gui/NodeSelectorTreeViewWidgetSpecializations.h
@@ -172,6 +172,8 @@ HEADERS  += $$PWD/SettingsDialog.h \
     $$PWD/node_selector/model/NodeSelectorModel.h \
     $$PWD/node_selector/model/NodeSelectorModelSpecialised.h \
     $$PWD/node_selector/model/NodeSelectorModelItem.h \
+    $$PWD/node_selector/model/NodeSelectorSearchResults.h \
+    $$PWD/node_selector/model/NodeSelectorTree.h \
     $$PWD/node_selector/gui/NodeSelectorTreeView.h \
     $$PWD/node_selector/gui/NodeSelectorTreeViewWidget.h \
     $$PWD/node_selector/gui/NodeSelectorTreeViewWidgetSpecializations.h \
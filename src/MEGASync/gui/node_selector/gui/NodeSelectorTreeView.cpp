@@ -51,6 +51,7 @@ void NodeSelectorTreeView::setModel(QAbstractItemModel *model)
 {
     QTreeView::setModel(model);
     connect(proxyModel(), &NodeSelectorProxyModel::navigateReady, this, &NodeSelectorTreeView::onNavigateReady);
+    connect(this, &QTreeView::collapsed, this, &NodeSelectorTreeView::onCollapsed, Qt::UniqueConnection);
 }
 
 void NodeSelectorTreeView::drawBranches(QPainter *painter, const QRect &rect, const QModelIndex &index) const
@@ -122,6 +123,84 @@ void NodeSelectorTreeView::mouseDoubleClickEvent(QMouseEvent *event)
     }
 }
 
+void NodeSelectorTreeView::verticalScrollbarValueChanged(int value)
+{
+    QTreeView::verticalScrollbarValueChanged(value);
+    fetchMoreChildrenNearBottom();
+}
+
+void NodeSelectorTreeView::updateGeometries()
+{
+    QTreeView::updateGeometries();
+    //Checked again once the rows of a page are laid out: if the filter hid most of them, nothing scrolled
+    fetchMoreChildrenNearBottom();
+}
+
+//Big folders get their children page by page: the next page of a folder is requested when the view
+//gets close to the last of its rows
+void NodeSelectorTreeView::fetchMoreChildrenNearBottom()
+{
+    auto megaModel = proxyModel() ? proxyModel()->getMegaModel() : nullptr;
+    if(!megaModel || proxyModel()->isModelProcessing())
+    {
+        return;
+    }
+
+    QModelIndex index = indexAt(QPoint(0, viewport()->height() - 1));
+    if(!index.isValid())
+    {
+        //The rows do not fill the view, so the last row shown is the last one of the tree
+        index = lastVisibleIndex();
+        if(!index.isValid())
+        {
+            return;
+        }
+    }
+
+    auto visibleRows = viewport()->height() / qMax(1, rowHeight(index));
+    while(index.isValid())
+    {
+        auto parentIndex = index.parent();
+        if(index.row() < model()->rowCount(parentIndex) - visibleRows)
+        {
+            break;
+        }
+
+        auto sourceParentIndex = proxyModel()->mapToSource(parentIndex);
+        if(megaModel->canFetchMoreChildren(sourceParentIndex))
+        {
+            megaModel->fetchMoreChildren(sourceParentIndex);
+        }
+        index = parentIndex;
+    }
+}
+
+QModelIndex NodeSelectorTreeView::lastVisibleIndex() const
+{
+    QModelIndex lastIndex;
+    auto parentIndex = rootIndex();
+    while(model()->rowCount(parentIndex) > 0)
+    {
+        lastIndex = model()->index(model()->rowCount(parentIndex) - 1, 0, parentIndex);
+        if(!isExpanded(lastIndex))
+        {
+            break;
+        }
+        parentIndex = lastIndex;
+    }
+
+    return lastIndex;
+}
+
+void NodeSelectorTreeView::onCollapsed(const QModelIndex& index)
+{
+    //The children not shown yet are listed again if the folder is expanded and scrolled later
+    if(auto megaModel = proxyModel()->getMegaModel())
+    {
+        megaModel->releaseChildren(proxyModel()->mapToSource(index));
+    }
+}
+
 void NodeSelectorTreeView::keyPressEvent(QKeyEvent *event)
 {
     if(!selectionModel())
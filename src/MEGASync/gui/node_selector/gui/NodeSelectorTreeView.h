@@ -31,6 +31,10 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
+    void updateGeometries() override;
+
+protected slots:
+    void verticalScrollbarValueChanged(int value) override;
 
 signals:
     void removeNodeClicked();
@@ -43,11 +47,14 @@ private slots:
     void renameNode();
     void getMegaLink();
     void onNavigateReady(const QModelIndex& index);
+    void onCollapsed(const QModelIndex& index);
 
 private:
     bool mousePressorReleaseEvent(QMouseEvent* event);
     bool handleStandardMouseEvent(QMouseEvent* event);
     QModelIndex getIndexFromSourceModel(const QModelIndex& index) const;
+    void fetchMoreChildrenNearBottom();
+    QModelIndex lastVisibleIndex() const;
     NodeSelectorProxyModel* proxyModel() const;
 
     MegaApi* mMegaApi;
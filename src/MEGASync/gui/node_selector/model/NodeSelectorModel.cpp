@@ -7,10 +7,40 @@
 #include "MegaNodeNames.h"
 
 #include <QApplication>
+#include <QSet>
 #include <QToolTip>
 
 const char* INDEX_PROPERTY = "INDEX";
 
+namespace
+{
+NodeSelectorTree::NodeData treeDataOf(mega::MegaNode* node)
+{
+    std::uint8_t flags(0);
+    if(node->isFile())
+    {
+        flags |= NodeSelectorTree::IS_FILE;
+    }
+    if(node->isInShare())
+    {
+        flags |= NodeSelectorTree::IS_IN_SHARE;
+    }
+    if(node->isOutShare())
+    {
+        flags |= NodeSelectorTree::IS_OUT_SHARE;
+    }
+    if(!node->isNodeKeyDecrypted())
+    {
+        flags |= NodeSelectorTree::IS_UNDECRYPTED;
+    }
+
+    return NodeSelectorTree::NodeData{node->getHandle(), node->getName(), node->getSize(), node->getModificationTime(), flags};
+}
+
+//So that no child to reveal can be passed as is to the tree
+static_assert(NodeSelectorTree::NO_HANDLE == mega::INVALID_HANDLE, "The tree and the SDK use different invalid handles");
+}
+
 NodeRequester::NodeRequester(NodeSelectorModel *model)
     : QObject(nullptr),
       mModel(model),
@@ -51,18 +81,27 @@ void NodeRequester::requestNodeAndCreateChildren(NodeSelectorModelItem* item, co
         if(!item->requestingChildren() && !item->areChildrenInitialized())
         {
             item->setRequestingChildren(true);
-            mega::MegaApi* megaApi = MegaSyncApp->getMegaApi();
-
-            auto childNodesFiltered = mega::MegaNodeList::createInstance();
-            mNodesRequested = true;
-            mShowFiles ?
-                childNodesFiltered = megaApi->getChildren(node.get(), mega::MegaApi::ORDER_NONE, mCancelToken.get())
-                    : childNodesFiltered = megaApi->getChildrenFromType(item->getNode().get(), mega::MegaNode::TYPE_FOLDER, mega::MegaApi::ORDER_NONE, mCancelToken.get());
-            mNodesRequested = false;
+
+            auto childNodesFiltered = getChildren(node.get());
             if(!isAborted())
             {
+                //Only the first page of children gets its items, the rest wait in the tree until they are needed
+                auto count(childNodesFiltered->size());
+                auto pendingChildren(0);
+                if(count > NodeSelectorModelItem::CHILDREN_PAGE_SIZE)
+                {
+                    auto folderId(mTree.findOrAdd(treeDataOf(node.get())));
+                    mTree.setChildren(folderId, childNodesFiltered->size(), [childNodesFiltered](int index)
+                    {
+                        return treeDataOf(childNodesFiltered->get(index));
+                    });
+                    auto page(mTree.nextPage(folderId, NodeSelectorModelItem::CHILDREN_PAGE_SIZE));
+                    count = static_cast<int>(page.end - page.begin);
+                    pendingChildren = mTree.pendingChildren(folderId);
+                }
+
                 lockDataMutex(true);
-                item->createChildItems(std::unique_ptr<mega::MegaNodeList>(childNodesFiltered));
+                item->createChildItems(std::unique_ptr<mega::MegaNodeList>(childNodesFiltered), count, pendingChildren);
                 lockDataMutex(false);
                 emit nodesReady(item);
             }
@@ -74,7 +113,135 @@ void NodeRequester::requestNodeAndCreateChildren(NodeSelectorModelItem* item, co
     }
 }
 
-void NodeRequester::search(const QString &text, NodeSelectorModelItemSearch::Types typesAllowed)
+void NodeRequester::requestChildrenPage(QPointer<NodeSelectorModelItem> item, mega::MegaHandle childToReveal, bool allChildren)
+{
+    QList<QPointer<NodeSelectorModelItem>> items;
+    auto pendingChildren(0);
+
+    if(item)
+    {
+        auto folderId(mTree.find(item->getNode()->getHandle()));
+        if(folderId == NodeSelectorTree::NO_ID)
+        {
+            folderId = snapshotPendingChildren(item);
+        }
+
+        if(folderId != NodeSelectorTree::NO_ID)
+        {
+            //The nodes are fetched now, the ones removed or moved since the folder was loaded are skipped
+            auto page(mTree.nextPage(folderId, allChildren ? mTree.pendingChildren(folderId) : NodeSelectorModelItem::CHILDREN_PAGE_SIZE,
+                                     childToReveal));
+            std::vector<std::unique_ptr<mega::MegaNode>> nodes;
+            for(auto id = page.begin; id < page.end && !isAborted(); ++id)
+            {
+                std::unique_ptr<mega::MegaNode> node(MegaSyncApp->getMegaApi()->getNodeByHandle(mTree.handle(id)));
+                if(node && node->getParentHandle() == mTree.handle(folderId))
+                {
+                    nodes.push_back(std::move(node));
+                }
+            }
+
+            pendingChildren = mTree.pendingChildren(folderId);
+            if(pendingChildren == 0)
+            {
+                releaseTreeChildren(folderId);
+            }
+
+            lockDataMutex(true);
+            items = item->createChildItemsPage(std::move(nodes));
+            lockDataMutex(false);
+        }
+    }
+
+    if(!isAborted())
+    {
+        emit childrenPageReady(item, items, pendingChildren, childToReveal);
+    }
+    else
+    {
+        foreach(auto& childItem, items)
+        {
+            removeItem(childItem);
+        }
+    }
+}
+
+void NodeRequester::releaseChildren(mega::MegaHandle folderHandle)
+{
+    auto folderId(mTree.find(folderHandle));
+    if(folderId != NodeSelectorTree::NO_ID)
+    {
+        releaseTreeChildren(folderId);
+    }
+}
+
+void NodeRequester::clearTree()
+{
+    mTree.clear();
+}
+
+mega::MegaNodeList* NodeRequester::getChildren(mega::MegaNode* node)
+{
+    //Sorted as the view sorts them by default, so that the first page holds the first rows
+    mega::MegaApi* megaApi = MegaSyncApp->getMegaApi();
+    mNodesRequested = true;
+    auto childNodes = mShowFiles ? megaApi->getChildren(node, mega::MegaApi::ORDER_DEFAULT_ASC, mCancelToken.get())
+                                 : megaApi->getChildrenFromType(node, mega::MegaNode::TYPE_FOLDER, mega::MegaApi::ORDER_DEFAULT_ASC, mCancelToken.get());
+    mNodesRequested = false;
+    return childNodes;
+}
+
+//The snapshot of a folder was released (e.g. it was collapsed) before all its children got their items:
+//it is taken again with the children that have no item yet
+NodeSelectorTree::Id NodeRequester::snapshotPendingChildren(NodeSelectorModelItem* item)
+{
+    std::unique_ptr<mega::MegaNodeList> childNodes(getChildren(item->getNode().get()));
+    if(isAborted())
+    {
+        return NodeSelectorTree::NO_ID;
+    }
+
+    QSet<mega::MegaHandle> loadedHandles;
+    lockDataMutex(true);
+    for(int row = 0; row < item->getNumChildren(); ++row)
+    {
+        auto child = item->getChild(row);
+        if(child)
+        {
+            loadedHandles.insert(child->getNode()->getHandle());
+        }
+    }
+    lockDataMutex(false);
+
+    std::vector<int> pendingIndexes;
+    for(int index = 0; index < childNodes->size(); ++index)
+    {
+        if(!loadedHandles.contains(childNodes->get(index)->getHandle()))
+        {
+            pendingIndexes.push_back(index);
+        }
+    }
+
+    auto folderId(mTree.findOrAdd(treeDataOf(item->getNode().get())));
+    mTree.setChildren(folderId, static_cast<int>(pendingIndexes.size()), [&childNodes, &pendingIndexes](int index)
+    {
+        return treeDataOf(childNodes->get(pendingIndexes[static_cast<std::size_t>(index)]));
+    });
+    return folderId;
+}
+
+void NodeRequester::releaseTreeChildren(NodeSelectorTree::Id folderId)
+{
+    mTree.removeChildren(folderId);
+
+    //The snapshots still needed are taken again after clearing, so the dead nodes never fill most of the tree
+    if(mTree.deadNodes() > mTree.size() / 2)
+    {
+        mTree.clear();
+    }
+}
+
+void NodeRequester::search(const QString &text, NodeSelectorModelItemSearch::Types typesAllowed, int searchId)
 {
     if(text.isEmpty())
     {
@@ -88,20 +255,70 @@ void NodeRequester::search(const QString &text, NodeSelectorModelItemSearch::Typ
         mRootItems.clear();
     }
     mSearchCanceled = false;
+    mSearchedTypes = NodeSelectorModelItemSearch::Type::NONE;
 
-    std::unique_ptr<mega::MegaSearchFilter> searchFilter(mega::MegaSearchFilter::createInstance());
-    searchFilter->byName(text.toUtf8().constData());
+    //A query extending the last one only matches nodes the last one matched, so its results are filtered
+    //instead of searching the whole account again
+    auto query(text.toUtf8().toStdString());
+    std::unique_ptr<mega::MegaNodeList> nodeList;
+    if(mSearchResultsOutdated || !mSearchResults.canRefine(query))
+    {
+        //Cleared before searching, so that the nodes updated meanwhile outdate these results
+        mSearchResultsOutdated = false;
 
-    auto nodeList = std::unique_ptr<mega::MegaNodeList>(MegaSyncApp->getMegaApi()->search(searchFilter.get(), mega::MegaApi::ORDER_NONE, mCancelToken.get()));
-    QList<NodeSelectorModelItem*> items;
-    mSearchedTypes = NodeSelectorModelItemSearch::Type::NONE;
+        std::unique_ptr<mega::MegaSearchFilter> searchFilter(mega::MegaSearchFilter::createInstance());
+        searchFilter->byName(query.c_str());
+        nodeList.reset(MegaSyncApp->getMegaApi()->search(searchFilter.get(), mega::MegaApi::ORDER_NONE, mCancelToken.get()));
+        if(isAborted() || mSearchCanceled)
+        {
+            //The list may be incomplete
+            mSearchResults.invalidate();
+            return;
+        }
 
-    for(int i = 0; i < nodeList->size(); i++)
+        mSearchResults.reset(query);
+        for(int i = 0; i < nodeList->size(); i++)
+        {
+            mSearchResults.add(nodeList->get(i)->getHandle(), nodeList->get(i)->getName());
+        }
+    }
+    else
     {
-        auto item = createSearchItem(nodeList->get(i), typesAllowed);
+        mSearchResults.refine(query);
+    }
+
+    //The most relevant items are created and sent first, in a small chunk, so that they are shown
+    //while the rest are created
+    QList<QPointer<NodeSelectorModelItem>> items;
+    auto firstItems(true);
+    auto chunkSize(NodeSelectorModel::FIRST_SEARCH_CHUNK_SIZE);
+    for(auto position : mSearchResults.rankedOrder())
+    {
+        if(isAborted() || mSearchCanceled)
+        {
+            break;
+        }
+
+        std::unique_ptr<mega::MegaNode> refinedNode;
+        auto node(nodeList ? nodeList->get(position) : nullptr);
+        if(!node)
+        {
+            //Skipped if it has been removed since it was found
+            refinedNode.reset(MegaSyncApp->getMegaApi()->getNodeByHandle(mSearchResults.handle(position)));
+            node = refinedNode.get();
+        }
+
+        auto item = node ? createSearchItem(node, typesAllowed) : nullptr;
         if(item)
         {
             items.append(item);
+            if(items.size() >= chunkSize)
+            {
+                emit searchItemsFound(searchId, items, firstItems);
+                items.clear();
+                firstItems = false;
+                chunkSize = NodeSelectorModel::SEARCH_CHUNK_SIZE;
+            }
         }
     }
 
@@ -109,11 +326,10 @@ void NodeRequester::search(const QString &text, NodeSelectorModelItemSearch::Typ
     {
         qDeleteAll(items);
     }
-    else
+    else if(firstItems || !items.isEmpty())
     {
-        QMutexLocker d(&mDataMutex);
-        mRootItems.append(items);
-        emit searchItemsCreated();
+        //The first chunk is sent even if empty, it finishes the reset of the model
+        emit searchItemsFound(searchId, items, firstItems);
     }
 }
 
@@ -418,6 +634,23 @@ void NodeRequester::restartSearch()
     }
 }
 
+void NodeRequester::invalidateSearchResults()
+{
+    mSearchResultsOutdated = true;
+}
+
+void NodeRequester::appendRootItems(const QList<QPointer<NodeSelectorModelItem>>& items)
+{
+    QMutexLocker lock(&mDataMutex);
+    foreach(auto& item, items)
+    {
+        if(item)
+        {
+            mRootItems.append(item);
+        }
+    }
+}
+
 void NodeRequester::cancelCurrentRequest()
 {
     if(mCancelToken)
@@ -466,13 +699,16 @@ void NodeRequester::abort()
 /* ------------------- MODEL ------------------------- */
 
 const int NodeSelectorModel::ROW_HEIGHT = 25;
+const int NodeSelectorModel::FIRST_SEARCH_CHUNK_SIZE = 100;
+const int NodeSelectorModel::SEARCH_CHUNK_SIZE = 2000;
 
 NodeSelectorModel::NodeSelectorModel(QObject *parent) :
     QAbstractItemModel(parent),
     mRequiredRights(mega::MegaShare::ACCESS_READ),
     mDisplayFiles(false),
     mSyncSetupMode(false),
-    mIsBeingModified(true)
+    mIsBeingModified(true),
+    mAllChildrenNeeded(false)
 {
     mCameraFolderAttribute = UserAttributes::CameraUploadFolder::requestCameraUploadFolder();
     mMyChatFilesFolderAttribute = UserAttributes::MyChatFilesFolder::requestMyChatFilesFolder();
@@ -483,6 +719,9 @@ NodeSelectorModel::NodeSelectorModel(QObject *parent) :
     mNodeRequesterThread->start();
 
     connect(this, &NodeSelectorModel::requestChildNodes, mNodeRequesterWorker, &NodeRequester::requestNodeAndCreateChildren, Qt::QueuedConnection);
+    connect(this, &NodeSelectorModel::requestChildrenPage, mNodeRequesterWorker, &NodeRequester::requestChildrenPage, Qt::QueuedConnection);
+    connect(this, &NodeSelectorModel::releaseChildrenSnapshot, mNodeRequesterWorker, &NodeRequester::releaseChildren, Qt::QueuedConnection);
+    connect(this, &NodeSelectorModel::modelAboutToBeReset, mNodeRequesterWorker, &NodeRequester::clearTree, Qt::QueuedConnection);
     connect(this, &NodeSelectorModel::requestAddNodes, mNodeRequesterWorker, &NodeRequester::onAddNodesRequested, Qt::QueuedConnection);
     connect(this, &NodeSelectorModel::removeItem, mNodeRequesterWorker, &NodeRequester::removeItem);
     connect(this, &NodeSelectorModel::removeRootItem, this, [this](NodeSelectorModelItem* item)
@@ -495,6 +734,7 @@ NodeSelectorModel::NodeSelectorModel(QObject *parent) :
 
     connect(mNodeRequesterWorker, &NodeRequester::nodesReady, this, &NodeSelectorModel::onChildNodesReady, Qt::QueuedConnection);
     connect(mNodeRequesterWorker, &NodeRequester::nodesAdded, this, &NodeSelectorModel::onNodesAdded, Qt::QueuedConnection);
+    connect(mNodeRequesterWorker, &NodeRequester::childrenPageReady, this, &NodeSelectorModel::onChildrenPageReady, Qt::QueuedConnection);
 
     connect(mNodeRequesterWorker, &NodeRequester::rootItemsAdded, this, &NodeSelectorModel::onRootItemAdded, Qt::QueuedConnection);
     connect(mNodeRequesterWorker, &NodeRequester::rootItemsDeleted, this, &NodeSelectorModel::onRootItemDeleted, Qt::QueuedConnection);
@@ -705,15 +945,7 @@ QModelIndex NodeSelectorModel::parent(const QModelIndex &index) const
             NodeSelectorModelItem* parent = item->getParent();
             if (parent)
             {
-                auto indexOfParent = mNodeRequesterWorker->rootIndexOf(parent);
-                if(indexOfParent >= 0)
-                {
-                    parentIndex = createIndex(indexOfParent, 0, parent);
-                }
-                else
-                {
-                    parentIndex = createIndex(parent->row(), 0, parent);
-                }
+                parentIndex = indexOfItem(parent);
             }
         }
     }
@@ -721,6 +953,12 @@ QModelIndex NodeSelectorModel::parent(const QModelIndex &index) const
     return parentIndex;
 }
 
+QModelIndex NodeSelectorModel::indexOfItem(NodeSelectorModelItem* item) const
+{
+    auto rootRow = mNodeRequesterWorker->rootIndexOf(item);
+    return createIndex(rootRow >= 0 ? rootRow : item->row(), 0, item);
+}
+
 int NodeSelectorModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
@@ -1043,7 +1281,12 @@ bool NodeSelectorModel::fetchMoreRecursively(const QModelIndex& parentIndex)
         if(node)
         {
             auto indexToCheck = getIndexFromNode(node, parentIndex);
-            if(canFetchMore(indexToCheck))
+            if(!indexToCheck.isValid() && fetchChildrenPage(parentIndex, node->getHandle()))
+            {
+                //Continues when the page that holds the node is ready
+                result = true;
+            }
+            else if(canFetchMore(indexToCheck))
             {
                 fetchMore(indexToCheck);
                 result = true;
@@ -1146,11 +1389,119 @@ void NodeSelectorModel::fetchItemChildren(const QModelIndex& parent)
     }
 }
 
+bool NodeSelectorModel::canFetchMoreChildren(const QModelIndex& parent) const
+{
+    NodeSelectorModelItem* item = static_cast<NodeSelectorModelItem*>(parent.internalPointer());
+    return item && item->areChildrenInitialized() && !item->requestingChildren() && item->pendingChildren() > 0;
+}
+
+void NodeSelectorModel::fetchMoreChildren(const QModelIndex& parent)
+{
+    fetchChildrenPage(parent, mega::INVALID_HANDLE);
+}
+
+bool NodeSelectorModel::fetchChildrenPage(const QModelIndex& parent, mega::MegaHandle childToReveal)
+{
+    if(!canFetchMoreChildren(parent))
+    {
+        return false;
+    }
+
+    NodeSelectorModelItem* item = static_cast<NodeSelectorModelItem*>(parent.internalPointer());
+    item->setRequestingChildren(true);
+    emit requestChildrenPage(item, childToReveal, mAllChildrenNeeded);
+    return true;
+}
+
+void NodeSelectorModel::releaseChildren(const QModelIndex& parent)
+{
+    NodeSelectorModelItem* item = static_cast<NodeSelectorModelItem*>(parent.internalPointer());
+    if(item && item->pendingChildren() > 0)
+    {
+        emit releaseChildrenSnapshot(item->getNode()->getHandle());
+    }
+}
+
+//The pages come in the default order, any other sort needs all the children
+void NodeSelectorModel::setAllChildrenNeeded(bool needed)
+{
+    if(mAllChildrenNeeded != needed)
+    {
+        mAllChildrenNeeded = needed;
+        if(needed)
+        {
+            fetchAllPendingChildren(QModelIndex());
+        }
+    }
+}
+
+void NodeSelectorModel::fetchAllPendingChildren(const QModelIndex& parent)
+{
+    for(int row = 0; row < rowCount(parent); ++row)
+    {
+        auto childIndex = index(row, COLUMN::NODE, parent);
+        NodeSelectorModelItem* item = static_cast<NodeSelectorModelItem*>(childIndex.internalPointer());
+        if(item && item->areChildrenInitialized())
+        {
+            fetchChildrenPage(childIndex, mega::INVALID_HANDLE);
+            fetchAllPendingChildren(childIndex);
+        }
+    }
+}
+
+void NodeSelectorModel::onChildrenPageReady(QPointer<NodeSelectorModelItem> parent, QList<QPointer<NodeSelectorModelItem>> items,
+                                            int pendingChildren, mega::MegaHandle childToReveal)
+{
+    if(!parent)
+    {
+        return;
+    }
+
+    items.removeAll(QPointer<NodeSelectorModelItem>());
+    auto parentIndex = indexOfItem(parent);
+    if(!items.isEmpty())
+    {
+        auto totalRows = rowCount(parentIndex);
+        beginInsertRows(parentIndex, totalRows, totalRows + items.size() - 1);
+    }
+
+    mNodeRequesterWorker->lockDataMutex(true);
+    parent->appendChildItems(items, pendingChildren);
+    mNodeRequesterWorker->lockDataMutex(false);
+
+    if(!items.isEmpty())
+    {
+        endInsertRows();
+        emit levelsAdded({}, false);
+    }
+
+    //The page was loaded to reveal the next node of the path being loaded
+    if(childToReveal != mega::INVALID_HANDLE && !mNodesToLoad.isEmpty() && mNodesToLoad.last()
+       && mNodesToLoad.last()->getHandle() == childToReveal)
+    {
+        if(!fetchMoreRecursively(parentIndex))
+        {
+            emit blockUi(false);
+            mNodesToLoad.clear();
+        }
+    }
+
+    if(mAllChildrenNeeded)
+    {
+        fetchChildrenPage(parentIndex, mega::INVALID_HANDLE);
+    }
+}
+
 void NodeSelectorModel::onChildNodesReady(NodeSelectorModelItem* parent)
 {
     auto index = parent->property(INDEX_PROPERTY).value<QModelIndex>();
     mIndexesActionInfo.indexesToBeExpanded.append(qMakePair(parent->getNode()->getHandle(), index));
     continueWithNextItemToLoad(index);
+
+    if(mAllChildrenNeeded)
+    {
+        fetchChildrenPage(index, mega::INVALID_HANDLE);
+    }
 }
 
 bool NodeSelectorModel::continueWithNextItemToLoad(const QModelIndex& parentIndex)
@@ -2,6 +2,8 @@
 #define NODESELECTORMODEL_H
 
 #include "NodeSelectorModelItem.h"
+#include "NodeSelectorSearchResults.h"
+#include "NodeSelectorTree.h"
 #include "Utilities.h"
 #include <megaapi.h>
 
@@ -67,6 +69,8 @@ public:
 
     void cancelCurrentRequest();
     void restartSearch();
+    void invalidateSearchResults();
+    void appendRootItems(const QList<QPointer<NodeSelectorModelItem>>& items);
 
     const NodeSelectorModelItemSearch::Types &searchedTypes() const;
 
@@ -76,7 +80,10 @@ public:
 
 public slots:
     void requestNodeAndCreateChildren(NodeSelectorModelItem* item, const QModelIndex& parentIndex);
-    void search(const QString& text, NodeSelectorModelItemSearch::Types typesAllowed);
+    void requestChildrenPage(QPointer<NodeSelectorModelItem> item, mega::MegaHandle childToReveal, bool allChildren);
+    void releaseChildren(mega::MegaHandle folderHandle);
+    void clearTree();
+    void search(const QString& text, NodeSelectorModelItemSearch::Types typesAllowed, int searchId);
     void createCloudDriveRootItem();
     void createIncomingSharesRootItems(std::shared_ptr<mega::MegaNodeList> nodeList);
     void addIncomingSharesRootItem(std::shared_ptr<mega::MegaNode> node);
@@ -97,18 +104,24 @@ signals:
      void rootItemsAdded();
      void rootItemsDeleted();
      void megaBackupRootItemsCreated();
-     void searchItemsCreated();
+     void searchItemsFound(int searchId, QList<QPointer<NodeSelectorModelItem>> items, bool firstItems);
      void nodeAdded(NodeSelectorModelItem* item);
      void nodesAdded(QList<QPointer<NodeSelectorModelItem>> item);
+     void childrenPageReady(QPointer<NodeSelectorModelItem> parent, QList<QPointer<NodeSelectorModelItem>> items,
+                            int pendingChildren, mega::MegaHandle childToReveal);
 
 private:
      bool isAborted();
+     mega::MegaNodeList* getChildren(mega::MegaNode* node);
+     NodeSelectorTree::Id snapshotPendingChildren(NodeSelectorModelItem* item);
+     void releaseTreeChildren(NodeSelectorTree::Id folderId);
     NodeSelectorModelItem* createSearchItem(mega::MegaNode* node, NodeSelectorModelItemSearch::Types typesAllowed);
 
      std::atomic<bool> mShowFiles{true};
      std::atomic<bool> mShowReadOnlyFolders{true};
      std::atomic<bool> mAborted{false};
      std::atomic<bool> mSearchCanceled{false};
+     std::atomic<bool> mSearchResultsOutdated{true};
      std::atomic<bool> mSyncSetupMode{false};
      std::atomic<bool> mNodesRequested{false};
      NodeSelectorModel* mModel;
@@ -117,6 +130,10 @@ private:
      mutable QMutex mSearchMutex;
      std::shared_ptr<mega::MegaCancelToken> mCancelToken;
      NodeSelectorModelItemSearch::Types mSearchedTypes;
+     //Children of the loaded folders, only used from the requester thread
+     NodeSelectorTree mTree;
+     //Results of the last search, only used from the requester thread
+     NodeSelectorSearchResults mSearchResults;
 };
 
 class NodeSelectorModel : public QAbstractItemModel
@@ -125,6 +142,8 @@ class NodeSelectorModel : public QAbstractItemModel
 
 public:
     static const int ROW_HEIGHT;
+    static const int FIRST_SEARCH_CHUNK_SIZE;
+    static const int SEARCH_CHUNK_SIZE;
 
     enum COLUMN{
       NODE = 0,
@@ -153,6 +172,10 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation,
                                     int role = Qt::DisplayRole) const override;
     bool canFetchMore(const QModelIndex &parent) const override;
+    bool canFetchMoreChildren(const QModelIndex &parent) const;
+    void fetchMoreChildren(const QModelIndex &parent);
+    void releaseChildren(const QModelIndex &parent);
+    void setAllChildrenNeeded(bool needed);
 
     bool isRequestingNodes() const;
 
@@ -197,6 +220,8 @@ public:
 signals:
     void levelsAdded(const QList<QPair<mega::MegaHandle, QModelIndex>>& parent, bool force = false);
     void requestChildNodes(NodeSelectorModelItem* parent, const QModelIndex& parentIndex);
+    void requestChildrenPage(QPointer<NodeSelectorModelItem> parent, mega::MegaHandle childToReveal, bool allChildren);
+    void releaseChildrenSnapshot(mega::MegaHandle folderHandle);
     void firstLoadFinished(const QModelIndex& parent);
     void requestAddNodes(QList<std::shared_ptr<mega::MegaNode>> newNodes, const QModelIndex& parentIndex, NodeSelectorModelItem* parent);
     void removeItem(NodeSelectorModelItem* items);
@@ -225,6 +250,8 @@ protected slots:
 private slots:
     void onChildNodesReady(NodeSelectorModelItem *parent);
     void onNodesAdded(QList<QPointer<NodeSelectorModelItem> > childrenItem);
+    void onChildrenPageReady(QPointer<NodeSelectorModelItem> parent, QList<QPointer<NodeSelectorModelItem>> items,
+                             int pendingChildren, mega::MegaHandle childToReveal);
 
 private:
     virtual void createRootNodes() = 0;
@@ -235,12 +262,16 @@ private:
 
     QIcon getFolderIcon(NodeSelectorModelItem* item) const;
     bool fetchMoreRecursively(const QModelIndex& parentIndex);
+    bool fetchChildrenPage(const QModelIndex& parent, mega::MegaHandle childToReveal);
+    void fetchAllPendingChildren(const QModelIndex& parent);
+    QModelIndex indexOfItem(NodeSelectorModelItem* item) const;
 
     std::shared_ptr<const UserAttributes::CameraUploadFolder> mCameraFolderAttribute;
     std::shared_ptr<const UserAttributes::MyChatFilesFolder> mMyChatFilesFolderAttribute;
 
     QThread* mNodeRequesterThread;
     bool mIsBeingModified; //Used to know if the model is being modified in order to avoid nesting beginInsertRows and any other begin* methods
+    bool mAllChildrenNeeded;
 };
 
 Q_DECLARE_METATYPE(std::shared_ptr<mega::MegaNodeList>)
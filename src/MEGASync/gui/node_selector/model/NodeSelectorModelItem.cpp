@@ -8,6 +8,7 @@
 #include "mega/utils.h"
 
 const int NodeSelectorModelItem::ICON_SIZE = 17;
+const int NodeSelectorModelItem::CHILDREN_PAGE_SIZE = 500;
 
 using namespace mega;
 
@@ -17,6 +18,7 @@ NodeSelectorModelItem::NodeSelectorModelItem(std::unique_ptr<MegaNode> node, boo
     mStatus(Status::NONE),
     mRequestingChildren(false),
     mShowFiles(showFiles),
+    mPendingChildren(0),
     mMegaApi(MegaSyncApp->getMegaApi()),
     mNode(std::move(node)),
     mOwner(nullptr)
@@ -45,26 +47,58 @@ std::shared_ptr<mega::MegaNode> NodeSelectorModelItem::getNode() const
     return mNode;
 }
 
-void NodeSelectorModelItem::createChildItems(std::unique_ptr<mega::MegaNodeList> nodeList)
+void NodeSelectorModelItem::createChildItems(std::unique_ptr<mega::MegaNodeList> nodeList, int count, int pendingChildren)
 {
     if(!mNode->isFile())
     {
-        for(int i = 0; i < nodeList->size(); i++)
+        count = qMin(count, nodeList->size());
+        for(int i = 0; i < count; i++)
         {
             auto node = std::unique_ptr<MegaNode>(nodeList->get(i)->copy());
             mChildItems.append(createModelItem(move(node), mShowFiles, this));
         }
 
+        mPendingChildren = pendingChildren;
         mRequestingChildren = false;
         mChildrenAreInit = true;
     }
 }
 
+QList<QPointer<NodeSelectorModelItem>> NodeSelectorModelItem::createChildItemsPage(std::vector<std::unique_ptr<mega::MegaNode>> nodes)
+{
+    //The items are not children until they are appended, so that the model can announce the new rows
+    QList<QPointer<NodeSelectorModelItem>> items;
+    for(auto& node : nodes)
+    {
+        items.append(createModelItem(std::move(node), mShowFiles, this));
+    }
+    return items;
+}
+
+void NodeSelectorModelItem::appendChildItems(const QList<QPointer<NodeSelectorModelItem>>& items, int pendingChildren)
+{
+    foreach(auto& item, items)
+    {
+        if(item)
+        {
+            mChildItems.append(item);
+        }
+    }
+
+    mPendingChildren = pendingChildren;
+    mRequestingChildren = false;
+}
+
 bool NodeSelectorModelItem::areChildrenInitialized() const
 {
     return mChildrenAreInit;
 }
 
+int NodeSelectorModelItem::pendingChildren() const
+{
+    return mPendingChildren;
+}
+
 bool NodeSelectorModelItem::canFetchMore()
 {
     if(!mChildrenAreInit)
@@ -112,7 +146,8 @@ int NodeSelectorModelItem::getNumChildren()
     }
     else if(!areChildrenInitialized())
     {
-        return mChildrenCounter;
+        //Only the first page of children gets its items when they are loaded
+        return static_cast<int>(qMin<long long>(mChildrenCounter, CHILDREN_PAGE_SIZE));
     }
 
     return mChildItems.size();
@@ -7,6 +7,7 @@
 #include "megaapi.h"
 
 #include <memory>
+#include <vector>
 
 namespace UserAttributes{
 class FullName;
@@ -19,6 +20,7 @@ class NodeSelectorModelItem : public QObject
 
 public:
     static const int ICON_SIZE;
+    static const int CHILDREN_PAGE_SIZE;
 
     enum class Status{
         SYNC = 0,
@@ -33,8 +35,11 @@ public:
 
     std::shared_ptr<mega::MegaNode> getNode() const;
 
-    void createChildItems(std::unique_ptr<mega::MegaNodeList> nodeList);
+    void createChildItems(std::unique_ptr<mega::MegaNodeList> nodeList, int count, int pendingChildren);
+    QList<QPointer<NodeSelectorModelItem>> createChildItemsPage(std::vector<std::unique_ptr<mega::MegaNode>> nodes);
+    void appendChildItems(const QList<QPointer<NodeSelectorModelItem>>& items, int pendingChildren);
     bool areChildrenInitialized() const;
+    int pendingChildren() const;
 
     bool canFetchMore();
 
@@ -73,6 +78,8 @@ protected:
     long long mChildrenCounter;
     bool mShowFiles;
     bool mChildrenAreInit;
+    //Children not created yet, they are created page by page
+    int mPendingChildren;
 
     mega::MegaApi* mMegaApi;
     std::shared_ptr<mega::MegaNode> mNode;
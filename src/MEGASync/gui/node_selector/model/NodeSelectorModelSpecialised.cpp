@@ -312,7 +312,10 @@ void NodeSelectorModelBackups::onRootItemCreated()
 
 NodeSelectorModelSearch::NodeSelectorModelSearch(NodeSelectorModelItemSearch::Types allowedTypes, QObject *parent)
     : NodeSelectorModel(parent),
-      mAllowedTypes(allowedTypes)
+      mAllowedTypes(allowedTypes),
+      mSearchId(0),
+      mResettingSearch(false),
+      mRootItemsChanging(0)
 {
     qRegisterMetaType<NodeSelectorModelItemSearch::Types>("NodeSelectorModelItemSearch::Types");
 }
@@ -330,7 +333,10 @@ void NodeSelectorModelSearch::firstLoad()
             {
                 mNodeRequesterWorker->removeRootItem(node);
             });
-    connect(mNodeRequesterWorker, &NodeRequester::searchItemsCreated, this, &NodeSelectorModelSearch::onRootItemsCreated, Qt::QueuedConnection);
+    connect(mNodeRequesterWorker, &NodeRequester::searchItemsFound, this, &NodeSelectorModelSearch::onSearchItemsFound, Qt::QueuedConnection);
+    //Connected after the base model, so they run once the rows have been inserted or removed
+    connect(mNodeRequesterWorker, &NodeRequester::rootItemsAdded, this, &NodeSelectorModelSearch::onRootItemsChanged, Qt::QueuedConnection);
+    connect(mNodeRequesterWorker, &NodeRequester::rootItemsDeleted, this, &NodeSelectorModelSearch::onRootItemsChanged, Qt::QueuedConnection);
 }
 
 void NodeSelectorModelSearch::createRootNodes()
@@ -341,13 +347,16 @@ void NodeSelectorModelSearch::createRootNodes()
 void NodeSelectorModelSearch::searchByText(const QString &text)
 {
     mNodeRequesterWorker->restartSearch();
+    dropPendingSearchItems();
+    mResettingSearch = true;
     addRootItems();
-    emit searchNodes(text, mAllowedTypes);
+    emit searchNodes(text, mAllowedTypes, mSearchId);
 }
 
 void NodeSelectorModelSearch::stopSearch()
 {
     mNodeRequesterWorker->restartSearch();
+    dropPendingSearchItems();
 }
 
 int NodeSelectorModelSearch::rootItemsCount() const
@@ -400,17 +409,22 @@ void NodeSelectorModelSearch::addNodes(QList<std::shared_ptr<mega::MegaNode>> no
     clearIndexesNodeInfo();
     auto totalRows = rowCount(parent);
     beginInsertRows(QModelIndex(), totalRows, totalRows + nodes.size() - 1);
+    mRootItemsChanging++;
     emit requestAddSearchRootItem(nodes, mAllowedTypes);
 }
 
 bool NodeSelectorModelSearch::rootNodeUpdated(mega::MegaNode *node)
 {
+    //Any node may have started or stopped matching the last search
+    mNodeRequesterWorker->invalidateSearchResults();
+
     if(node->getChanges() & MegaNode::CHANGE_TYPE_INSHARE)
     {
         if(node->isInShare())
         {
             auto totalRows = rowCount(QModelIndex());
             beginInsertRows(QModelIndex(), totalRows, totalRows);
+            mRootItemsChanging++;
             QList<std::shared_ptr<mega::MegaNode>> nodes;
             emit requestAddSearchRootItem(nodes << std::shared_ptr<mega::MegaNode>(node->copy()), mAllowedTypes);
         }
@@ -425,6 +439,7 @@ bool NodeSelectorModelSearch::rootNodeUpdated(mega::MegaNode *node)
             if(index.isValid())
             {
                 beginRemoveRows(QModelIndex(), index.row(), index.row());
+                mRootItemsChanging++;
                 emit requestDeleteSearchRootItem(std::shared_ptr<mega::MegaNode>(node->copy()));
                 return true;
             }
@@ -444,17 +459,85 @@ bool NodeSelectorModelSearch::rootNodeUpdated(mega::MegaNode *node)
 void NodeSelectorModelSearch::proxyInvalidateFinished()
 {
     mNodeRequesterWorker->lockSearchMutex(false);
+    insertPendingSearchItems();
 }
 
 void NodeSelectorModelSearch::onRootItemsCreated()
 {
     if(mNodeRequesterWorker->trySearchLock())
     {
+        mResettingSearch = false;
         rootItemsLoaded();
         emit levelsAdded(mIndexesActionInfo.indexesToBeExpanded, true);
     }
 }
 
+void NodeSelectorModelSearch::onSearchItemsFound(int searchId, QList<QPointer<NodeSelectorModelItem>> items, bool firstItems)
+{
+    items.removeAll(QPointer<NodeSelectorModelItem>());
+    if(searchId != mSearchId)
+    {
+        foreach(auto& item, items)
+        {
+            item->deleteLater();
+        }
+    }
+    else if(firstItems)
+    {
+        //The model is being reset, the first items are shown when it finishes
+        mNodeRequesterWorker->appendRootItems(items);
+        onRootItemsCreated();
+    }
+    else
+    {
+        mPendingSearchItems.append(items);
+        insertPendingSearchItems();
+    }
+}
+
+void NodeSelectorModelSearch::onRootItemsChanged()
+{
+    if(mRootItemsChanging > 0)
+    {
+        mRootItemsChanging--;
+    }
+    insertPendingSearchItems();
+}
+
+void NodeSelectorModelSearch::dropPendingSearchItems()
+{
+    mSearchId++;
+    foreach(auto& item, mPendingSearchItems)
+    {
+        if(item)
+        {
+            item->deleteLater();
+        }
+    }
+    mPendingSearchItems.clear();
+}
+
+void NodeSelectorModelSearch::insertPendingSearchItems()
+{
+    //Rows are not inserted while the proxy sorts the model or another change of the root items is open
+    if(mPendingSearchItems.isEmpty() || mResettingSearch || mRootItemsChanging > 0
+        || !mNodeRequesterWorker->trySearchLock())
+    {
+        return;
+    }
+
+    mPendingSearchItems.removeAll(QPointer<NodeSelectorModelItem>());
+    if(!mPendingSearchItems.isEmpty())
+    {
+        auto totalRows = rowCount(QModelIndex());
+        beginInsertRows(QModelIndex(), totalRows, totalRows + mPendingSearchItems.size() - 1);
+        mNodeRequesterWorker->appendRootItems(mPendingSearchItems);
+        mPendingSearchItems.clear();
+        endInsertRows();
+    }
+    mNodeRequesterWorker->lockSearchMutex(false);
+}
+
 const NodeSelectorModelItemSearch::Types &NodeSelectorModelSearch::searchedTypes() const
 {
     return mNodeRequesterWorker->searchedTypes();
@@ -115,15 +115,26 @@ protected:
     void proxyInvalidateFinished() override;
 
 signals:
-    void searchNodes(const QString& text, NodeSelectorModelItemSearch::Types);
+    void searchNodes(const QString& text, NodeSelectorModelItemSearch::Types, int searchId);
     void requestAddSearchRootItem(QList<std::shared_ptr<mega::MegaNode>> nodes, NodeSelectorModelItemSearch::Types typesAllowed);
     void requestDeleteSearchRootItem(std::shared_ptr<mega::MegaNode> node);
 
 private slots:
     void onRootItemsCreated();
+    void onSearchItemsFound(int searchId, QList<QPointer<NodeSelectorModelItem>> items, bool firstItems);
+    void onRootItemsChanged();
 
 private:
+    void dropPendingSearchItems();
+    void insertPendingSearchItems();
+
     NodeSelectorModelItemSearch::Types mAllowedTypes;
+    //Id of the current search, the items found by previous ones are dropped
+    int mSearchId;
+    bool mResettingSearch;
+    //Root items added or removed by the requester, not finished yet
+    int mRootItemsChanging;
+    QList<QPointer<NodeSelectorModelItem>> mPendingSearchItems;
 };
 
 #endif // NODESELECTORMODELSPECIALISED_H
@@ -30,6 +30,9 @@ void NodeSelectorProxyModel::sort(int column, Qt::SortOrder order)
     mOrder = order;
     mSortColumn = column;
 
+    //Children are loaded page by page in the default order: any other order needs them all
+    getMegaModel()->setAllChildrenNeeded(column != NodeSelectorModel::NODE || order != Qt::AscendingOrder);
+
     //If it is already blocked, it is ignored.
     emit getMegaModel()->blockUi(true);
     emit layoutAboutToBeChanged();
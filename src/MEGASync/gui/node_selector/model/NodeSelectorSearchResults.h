@@ -0,0 +1,208 @@
+#ifndef NODESELECTORSEARCHRESULTS_H
+#define NODESELECTORSEARCHRESULTS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Results of the last node selector search: the handle and the case folded name of each node found.
+//
+// A query that extends the last one (e.g. "hol" after "ho") only matches nodes that the last one
+// matched, so its results are found by filtering these ones instead of searching the whole account
+// again. This is only done for plain ASCII queries without wildcards, which are matched here as the
+// SDK matches them: case insensitive, anywhere in the name.
+// rankedOrder() gives the results in relevance order, so that the best ones can be shown first.
+class NodeSelectorSearchResults
+{
+public:
+    using Handle = std::uint64_t;
+
+    // Starts the results of a new search
+    void reset(const std::string& query)
+    {
+        mQuery = folded(query);
+        mHandles.clear();
+        mNameOffsets.clear();
+        mNames.clear();
+        mValid = true;
+    }
+
+    // The results must be searched again, e.g. nodes were added, renamed or removed
+    void invalidate()
+    {
+        mValid = false;
+    }
+
+    void add(Handle handle, const char* name)
+    {
+        mHandles.push_back(handle);
+        mNameOffsets.push_back(static_cast<std::uint32_t>(mNames.size()));
+        for(auto character = name ? name : ""; *character; ++character)
+        {
+            mNames.push_back(fold(*character));
+        }
+        mNames.push_back('\0');
+    }
+
+    int size() const
+    {
+        return static_cast<int>(mHandles.size());
+    }
+
+    Handle handle(int position) const
+    {
+        return mHandles[position];
+    }
+
+    // Case folded name
+    const char* name(int position) const
+    {
+        return mNames.data() + mNameOffsets[position];
+    }
+
+    bool canRefine(const std::string& query) const
+    {
+        return mValid && isPlain(mQuery) && isPlain(query) && folded(query).find(mQuery) != std::string::npos;
+    }
+
+    // Keeps the results that match the query, in the same order. Requires canRefine(query)
+    void refine(const std::string& query)
+    {
+        mQuery = folded(query);
+
+        auto kept(0);
+        std::uint32_t namesEnd(0);
+        for(int position = 0; position < size(); ++position)
+        {
+            auto resultName(name(position));
+            if(std::strstr(resultName, mQuery.c_str()))
+            {
+                // Moved towards the front, so it never overwrites a name still to be checked
+                auto length(std::strlen(resultName) + 1);
+                std::memmove(mNames.data() + namesEnd, resultName, length);
+                mHandles[kept] = mHandles[position];
+                mNameOffsets[kept] = namesEnd;
+                namesEnd += static_cast<std::uint32_t>(length);
+                ++kept;
+            }
+        }
+
+        mHandles.resize(static_cast<std::size_t>(kept));
+        mNameOffsets.resize(static_cast<std::size_t>(kept));
+        mNames.resize(namesEnd);
+    }
+
+    // Positions of the results, the most relevant first: names equal to the query, names starting
+    // with it, names with a word starting with it, names containing it and the rest (matched by the
+    // SDK in a way not checked here). Shorter names go first in each group, then the search order
+    std::vector<int> rankedOrder() const
+    {
+        // Counting sort on (relevance, length): linear on the number of results
+        std::vector<std::uint16_t> keys(mHandles.size());
+        std::vector<int> starts(RANKS * MAX_RANKED_LENGTH + 1, 0);
+        for(int position = 0; position < size(); ++position)
+        {
+            auto resultName(name(position));
+            auto length(std::strlen(resultName));
+            auto key(rankOf(resultName) * MAX_RANKED_LENGTH
+                     + static_cast<int>(length < MAX_RANKED_LENGTH ? length : MAX_RANKED_LENGTH - 1));
+            keys[position] = static_cast<std::uint16_t>(key);
+            ++starts[key + 1];
+        }
+        for(std::size_t key = 1; key < starts.size(); ++key)
+        {
+            starts[key] += starts[key - 1];
+        }
+
+        std::vector<int> order(mHandles.size());
+        for(int position = 0; position < size(); ++position)
+        {
+            order[starts[keys[position]]++] = position;
+        }
+        return order;
+    }
+
+    // Bytes used by the results
+    std::size_t memoryUsage() const
+    {
+        return mHandles.capacity() * sizeof(Handle) + mNameOffsets.capacity() * sizeof(std::uint32_t)
+               + mNames.capacity() + mQuery.capacity();
+    }
+
+private:
+    enum
+    {
+        RANKS = 5,
+        MAX_RANKED_LENGTH = 256
+    };
+
+    static char fold(char character)
+    {
+        return character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a') : character;
+    }
+
+    static std::string folded(const std::string& text)
+    {
+        std::string result(text);
+        for(auto& character : result)
+        {
+            character = fold(character);
+        }
+        return result;
+    }
+
+    static bool isWordCharacter(char character)
+    {
+        return (character >= 'a' && character <= 'z') || (character >= '0' && character <= '9')
+               || static_cast<unsigned char>(character) >= 0x80;
+    }
+
+    // Printable ASCII without wildcards, matched here as the SDK matches it
+    static bool isPlain(const std::string& query)
+    {
+        if(query.empty())
+        {
+            return false;
+        }
+
+        for(auto character : query)
+        {
+            if(character < ' ' || character > '~' || character == '*' || character == '?')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int rankOf(const char* resultName) const
+    {
+        auto match(std::strstr(resultName, mQuery.c_str()));
+        if(!match || mQuery.empty())
+        {
+            return 4;
+        }
+        else if(match == resultName)
+        {
+            return resultName[mQuery.size()] == '\0' ? 0 : 1;
+        }
+
+        for(; match; match = std::strstr(match + 1, mQuery.c_str()))
+        {
+            if(!isWordCharacter(match[-1]))
+            {
+                return 2;
+            }
+        }
+        return 3;
+    }
+
+    std::string mQuery;
+    std::vector<Handle> mHandles;
+    std::vector<std::uint32_t> mNameOffsets;
+    std::vector<char> mNames;
+    bool mValid = false;
+};
+
+#endif // NODESELECTORSEARCHRESULTS_H
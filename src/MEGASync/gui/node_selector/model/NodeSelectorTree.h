@@ -0,0 +1,331 @@
+#ifndef NODESELECTORTREE_H
+#define NODESELECTORTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Compact snapshot of the folders shown by the node selector.
+//
+// Nodes live in one contiguous arena and are found by handle through a flat open addressing index.
+// Each node keeps only what is needed to show it before its MegaNode is fetched: name, type flags,
+// size and modification time (about 48 bytes plus its name, instead of a QObject item holding a
+// MegaNode). The children of a folder are stored together, in the order they were given, and are
+// handed out in pages so that the items of a big folder are only created as they are needed.
+// Nodes replaced by a newer snapshot of their folder, or removed with removeChildren(), stay dead in
+// the arena until clear(). deadNodes() tells when clearing is worth it.
+class NodeSelectorTree
+{
+public:
+    using Handle = std::uint64_t;
+    using Id = std::uint32_t;
+
+    enum : Id
+    {
+        NO_ID = 0xffffffff
+    };
+
+    static constexpr Handle NO_HANDLE = ~Handle(0);
+
+    enum Flag : std::uint8_t
+    {
+        IS_FILE = 0x01,
+        IS_IN_SHARE = 0x02,
+        IS_OUT_SHARE = 0x04,
+        IS_UNDECRYPTED = 0x08
+    };
+
+    struct NodeData
+    {
+        Handle handle;
+        const char* name; // UTF-8, null terminated
+        long long size;
+        long long modificationTime;
+        std::uint8_t flags;
+    };
+
+    struct Range
+    {
+        Id begin;
+        Id end;
+    };
+
+    int size() const
+    {
+        return static_cast<int>(mNodes.size());
+    }
+
+    // NO_ID if the handle is not in the tree
+    Id find(Handle handle) const
+    {
+        auto id(mIdByHandle.find(handle));
+        return id != NO_ID && isLive(id) ? id : NO_ID;
+    }
+
+    // The node, added without parent if it is not in the tree yet (e.g. the root of a tab)
+    Id findOrAdd(const NodeData& data)
+    {
+        auto id(find(data.handle));
+        if(id == NO_ID)
+        {
+            id = append(data, NO_ID);
+        }
+        return id;
+    }
+
+    // Replaces the children of parent with count nodes, dataOf(index) giving each one of them
+    template <typename DataOf>
+    Range setChildren(Id parent, int count, DataOf dataOf)
+    {
+        auto first(static_cast<Id>(mNodes.size()));
+        mNodes.reserve(mNodes.size() + static_cast<std::size_t>(count));
+        for(int index = 0; index < count; ++index)
+        {
+            append(dataOf(index), parent);
+        }
+
+        // Looked up again: the arena may have moved
+        auto& node(mNodes[parent]);
+        mDeadNodes += static_cast<int>(node.childCount);
+        node.firstChild = first;
+        node.childCount = static_cast<Id>(count);
+        node.loadedChildren = 0;
+        return Range{first, first + static_cast<Id>(count)};
+    }
+
+    // The children of parent are no longer needed (e.g. all of them were handed out)
+    void removeChildren(Id parent)
+    {
+        auto& node(mNodes[parent]);
+        mDeadNodes += static_cast<int>(node.childCount);
+        node.firstChild = NO_ID;
+        node.childCount = 0;
+        node.loadedChildren = 0;
+    }
+
+    // Nodes removed or replaced so far. Their own children are not counted, so it is a lower bound
+    int deadNodes() const
+    {
+        return mDeadNodes;
+    }
+
+    int childCount(Id parent) const
+    {
+        return static_cast<int>(mNodes[parent].childCount);
+    }
+
+    // Children already handed out by nextPage()
+    int loadedChildren(Id parent) const
+    {
+        return static_cast<int>(mNodes[parent].loadedChildren);
+    }
+
+    int pendingChildren(Id parent) const
+    {
+        return childCount(parent) - loadedChildren(parent);
+    }
+
+    // The next pageSize children not handed out yet, or more if needed to reach the child with the
+    // handle. The range is empty when every child has been handed out
+    Range nextPage(Id parent, int pageSize, Handle upTo = NO_HANDLE)
+    {
+        auto& node(mNodes[parent]);
+        auto begin(node.firstChild + node.loadedChildren);
+        auto childrenEnd(node.firstChild + node.childCount);
+        auto end(begin + std::min<Id>(node.childCount - node.loadedChildren, static_cast<Id>(std::max(pageSize, 0))));
+
+        auto target(upTo != NO_HANDLE ? find(upTo) : NO_ID);
+        if(target != NO_ID && target >= end && target < childrenEnd)
+        {
+            end = target + 1;
+        }
+
+        node.loadedChildren = end - node.firstChild;
+        return Range{begin, end};
+    }
+
+    // Position of the child in its parent, -1 if the node is not in the tree or has no parent
+    int rowOf(Handle handle) const
+    {
+        auto id(find(handle));
+        if(id == NO_ID || mNodes[id].parent == NO_ID)
+        {
+            return -1;
+        }
+        return static_cast<int>(id - mNodes[mNodes[id].parent].firstChild);
+    }
+
+    Handle handle(Id id) const
+    {
+        return mNodes[id].handle;
+    }
+
+    Id parent(Id id) const
+    {
+        return mNodes[id].parent;
+    }
+
+    const char* name(Id id) const
+    {
+        return mNames.data() + mNodes[id].nameOffset;
+    }
+
+    long long size(Id id) const
+    {
+        return mNodes[id].size;
+    }
+
+    long long modificationTime(Id id) const
+    {
+        return mNodes[id].modificationTime;
+    }
+
+    std::uint8_t flags(Id id) const
+    {
+        return mNodes[id].flags;
+    }
+
+    bool isFile(Id id) const
+    {
+        return (mNodes[id].flags & IS_FILE) != 0;
+    }
+
+    void clear()
+    {
+        *this = NodeSelectorTree();
+    }
+
+    // Bytes used by the tree
+    std::size_t memoryUsage() const
+    {
+        return mNodes.capacity() * sizeof(Node) + mNames.capacity() + mIdByHandle.memoryUsage();
+    }
+
+private:
+    struct Node
+    {
+        Handle handle;
+        long long size;
+        long long modificationTime;
+        Id parent;
+        Id firstChild = NO_ID;
+        Id childCount = 0;
+        Id loadedChildren = 0;
+        std::uint32_t nameOffset;
+        std::uint8_t flags;
+    };
+
+    // Maps handles to ids with linear probing. Handles are never erased: a handle found again gets
+    // its new id, the old one becomes dead
+    class IdIndex
+    {
+    public:
+        Id find(Handle handle) const
+        {
+            if(mIds.empty())
+            {
+                return NO_ID;
+            }
+
+            for(auto bucket = bucketOf(handle);; bucket = (bucket + 1) & (mIds.size() - 1))
+            {
+                if(mIds[bucket] == NO_ID || mHandles[bucket] == handle)
+                {
+                    return mIds[bucket];
+                }
+            }
+        }
+
+        void set(Handle handle, Id id)
+        {
+            if((mUsed + 1) * 2 > mIds.size())
+            {
+                grow();
+            }
+
+            auto bucket(bucketOf(handle));
+            while(mIds[bucket] != NO_ID && mHandles[bucket] != handle)
+            {
+                bucket = (bucket + 1) & (mIds.size() - 1);
+            }
+
+            if(mIds[bucket] == NO_ID)
+            {
+                mHandles[bucket] = handle;
+                ++mUsed;
+            }
+            mIds[bucket] = id;
+        }
+
+        std::size_t memoryUsage() const
+        {
+            return mHandles.capacity() * sizeof(Handle) + mIds.capacity() * sizeof(Id);
+        }
+
+    private:
+        std::size_t bucketOf(Handle handle) const
+        {
+            // Fibonacci hashing, handles use only their low 48 bits
+            return static_cast<std::size_t>((handle * 0x9E3779B97F4A7C15ULL) >> 32) & (mIds.size() - 1);
+        }
+
+        void grow()
+        {
+            std::vector<Handle> handles(std::max<std::size_t>(16, mIds.size() * 2));
+            std::vector<Id> ids(handles.size(), NO_ID);
+            handles.swap(mHandles);
+            ids.swap(mIds);
+            mUsed = 0;
+            for(std::size_t bucket = 0; bucket < ids.size(); ++bucket)
+            {
+                if(ids[bucket] != NO_ID)
+                {
+                    set(handles[bucket], ids[bucket]);
+                }
+            }
+        }
+
+        std::vector<Handle> mHandles;
+        std::vector<Id> mIds;
+        std::size_t mUsed = 0;
+    };
+
+    Id append(const NodeData& data, Id parent)
+    {
+        auto id(static_cast<Id>(mNodes.size()));
+        Node node;
+        node.handle = data.handle;
+        node.size = data.size;
+        node.modificationTime = data.modificationTime;
+        node.parent = parent;
+        node.flags = data.flags;
+        node.nameOffset = static_cast<std::uint32_t>(mNames.size());
+        auto name(data.name ? data.name : "");
+        mNames.insert(mNames.end(), name, name + std::strlen(name) + 1);
+        mNodes.push_back(node);
+        mIdByHandle.set(data.handle, id);
+        return id;
+    }
+
+    // False for nodes left behind by a newer snapshot of their folder
+    bool isLive(Id id) const
+    {
+        auto parentId(mNodes[id].parent);
+        if(parentId == NO_ID)
+        {
+            return true;
+        }
+
+        auto& parentNode(mNodes[parentId]);
+        return id >= parentNode.firstChild && id < parentNode.firstChild + parentNode.childCount
+               && isLive(parentId);
+    }
+
+    std::vector<Node> mNodes;
+    std::vector<char> mNames;
+    IdIndex mIdByHandle;
+    int mDeadNodes = 0;
+};
+
+#endif // NODESELECTORTREE_H
@@ -1,4 +1,5 @@
 #include "ExtServer.h"
+#include "ExtServerProtocol.h"
 
 #include <sys/types.h>
 #include <pwd.h>
@@ -9,7 +10,7 @@
 using namespace mega;
 using namespace std;
 
-constexpr char ASCII_FILE_SEP = 0x1C;
+constexpr char ASCII_FILE_SEP = ExtServerProtocol::FILE_SEP;
 constexpr int  BUFSIZE = 1024;
 constexpr char RESPONSE_SYNCED[]  = "0";
 constexpr char RESPONSE_PENDING[] = "1";
@@ -18,14 +19,19 @@ constexpr char RESPONSE_IGNORED[] = "3";
 constexpr char RESPONSE_PAUSED[]  = "4";
 constexpr char RESPONSE_DEFAULT[] = "9";
 constexpr char RESPONSE_ERROR[]   = "10";
+constexpr int  STATE_CACHE_STATS_INTERVAL_MS = 5 * 60 * 1000;
 
 ExtServer::ExtServer(MegaApplication *app): QObject(),
-    m_localServer(0)
+    m_localServer(0),
+    mStateCacheStatsTimer(new QTimer(this)),
+    mLoggedStateCacheLookups(0)
 {
     connect(this, SIGNAL(newUploadQueue(QQueue<QString>)), app, SLOT(shellUpload(QQueue<QString>)),Qt::QueuedConnection);
     connect(this, SIGNAL(newExportQueue(QQueue<QString>)), app, SLOT(shellExport(QQueue<QString>)),Qt::QueuedConnection);
     connect(this, SIGNAL(viewOnMega(QByteArray, bool)), app, SLOT(shellViewOnMega(QByteArray, bool)), Qt::QueuedConnection);
 
+    connect(mStateCacheStatsTimer, &QTimer::timeout, this, &ExtServer::logStateCacheStats);
+    mStateCacheStatsTimer->start(STATE_CACHE_STATS_INTERVAL_MS);
 
     // construct local socket path
     sockPath = MegaApplication::applicationDataPath() + QDir::separator() + QString::fromLatin1("mega.socket");
@@ -59,6 +65,11 @@ ExtServer::~ExtServer()
     delete m_localServer;
 }
 
+void ExtServer::notifyItemChange(const string& localPath)
+{
+    mStateCache.invalidate(localPath);
+}
+
 // a new connection is available
 void ExtServer::acceptConnection()
 {
@@ -83,6 +94,7 @@ void ExtServer::onClientDisconnected()
     if (!client)
         return;
     m_clients.removeAll(client);
+    mPendingBatches.remove(client);
     client->deleteLater();
 
     //LOG_debug << "Client disconnected";
@@ -104,6 +116,14 @@ void ExtServer::onClientData()
     qint64 count;
     do
     {
+        // Batches can be longer than buf, they are read whole
+        if (mPendingBatches.contains(client)
+                || (client->peek(buf, 2) == 2 && ExtServerProtocol::isBatchRequest(buf, 2)))
+        {
+            count = readBatchRequest(client) ? 1 : 0;
+            continue;
+        }
+
         count = client->readLine(buf, sizeof(buf));
         if (count > 0)
         {
@@ -183,66 +203,7 @@ const char *ExtServer::GetAnswerToRequest(const char *buf)
         // get the state of an object
         case 'P':
         {
-            int state = MegaSync::SyncRunningState::RUNSTATE_DISABLED;
-            string scontent(content);
-
-            // ASCII_FILE_SEP is used to separate the file name and an optional '1' or '0'
-            // which is used to force-get the state (get link for instance)
-            // The overlay icon 'P' requests sometimes do not have it (coming from Dolphin for instance).
-            size_t possep = scontent.find(ASCII_FILE_SEP);
-            bool forceGetState = possep != string::npos
-                                 && (possep + 1) < scontent.size()
-                                 && scontent.at(possep + 1) == '1';
-
-            if (forceGetState || !Preferences::instance()->overlayIconsDisabled())
-            {
-                if (possep != string::npos)
-                {
-                    scontent.resize(possep);
-                }
-                if (!scontent.empty())
-                {
-                    state = MegaSyncApp->getMegaApi()->syncPathState(&scontent);
-                    mLastPath = scontent;
-                }
-            }
-
-            switch(state)
-            {
-                case MegaApi::STATE_SYNCED:
-                    strncpy(out, RESPONSE_SYNCED, BUFSIZE);
-                    break;
-                case MegaApi::STATE_SYNCING:
-                    strncpy(out, RESPONSE_SYNCING, BUFSIZE);
-                    break;
-                case MegaApi::STATE_PENDING:
-                    strncpy(out, RESPONSE_PENDING, BUFSIZE);
-                    break;
-                case MegaApi::STATE_IGNORED:
-                {
-                    int runState = MegaSync::SyncRunningState::RUNSTATE_DISABLED;
-                    auto megaSync = MegaSyncApp->getMegaApi()->getSyncByPath(scontent.c_str());
-                    if (megaSync != nullptr)
-                    {
-                        runState = megaSync->getRunState();
-                    }
-
-                    if (runState == MegaSync::SyncRunningState::RUNSTATE_PAUSED || runState == MegaSync::SyncRunningState::RUNSTATE_SUSPENDED)
-                    {
-                        strncpy(out, RESPONSE_PAUSED, BUFSIZE);
-                    }
-                    else
-                    {
-                        strncpy(out, RESPONSE_IGNORED, BUFSIZE);
-                    }
-                    break;
-                }
-                case MegaApi::STATE_NONE:                
-                default:
-                {
-                    strncpy(out, RESPONSE_DEFAULT, BUFSIZE);
-                }
-            }
+            strncpy(out, getPathState(content, true), BUFSIZE);
             break;
         }
         case 'E':
@@ -273,6 +234,113 @@ const char *ExtServer::GetAnswerToRequest(const char *buf)
     return out;
 }
 
+// content is the path, optionally followed by ASCII_FILE_SEP and '1' to force-get the state
+const char *ExtServer::getPathState(string content, bool rememberPath)
+{
+    int state = MegaSync::SyncRunningState::RUNSTATE_DISABLED;
+
+    // ASCII_FILE_SEP is used to separate the file name and an optional '1' or '0'
+    // which is used to force-get the state (get link for instance)
+    // The overlay icon 'P' requests sometimes do not have it (coming from Dolphin for instance).
+    size_t possep = content.find(ASCII_FILE_SEP);
+    bool forceGetState = possep != string::npos
+                         && (possep + 1) < content.size()
+                         && content.at(possep + 1) == '1';
+
+    if (forceGetState || !Preferences::instance()->overlayIconsDisabled())
+    {
+        if (possep != string::npos)
+        {
+            content.resize(possep);
+        }
+        if (!content.empty())
+        {
+            if (!mStateCache.find(content, state))
+            {
+                state = MegaSyncApp->getMegaApi()->syncPathState(&content);
+                mStateCache.insert(content, state);
+            }
+            if (rememberPath)
+            {
+                mLastPath = content;
+            }
+        }
+    }
+
+    switch(state)
+    {
+        case MegaApi::STATE_SYNCED:
+            return RESPONSE_SYNCED;
+        case MegaApi::STATE_SYNCING:
+            return RESPONSE_SYNCING;
+        case MegaApi::STATE_PENDING:
+            return RESPONSE_PENDING;
+        case MegaApi::STATE_IGNORED:
+        {
+            int runState = MegaSync::SyncRunningState::RUNSTATE_DISABLED;
+            auto megaSync = MegaSyncApp->getMegaApi()->getSyncByPath(content.c_str());
+            if (megaSync != nullptr)
+            {
+                runState = megaSync->getRunState();
+            }
+
+            if (runState == MegaSync::SyncRunningState::RUNSTATE_PAUSED || runState == MegaSync::SyncRunningState::RUNSTATE_SUSPENDED)
+            {
+                return RESPONSE_PAUSED;
+            }
+            return RESPONSE_IGNORED;
+        }
+        case MegaApi::STATE_NONE:
+        default:
+            return RESPONSE_DEFAULT;
+    }
+}
+
+// Reads what is available of a batch request, and answers it once the whole line is there.
+// Returns false if there was nothing to read
+bool ExtServer::readBatchRequest(QLocalSocket *client)
+{
+    QByteArray data = client->readLine();
+    if (data.isEmpty())
+    {
+        return false;
+    }
+
+    QByteArray& request = mPendingBatches[client];
+    request.append(data);
+    if (request.endsWith('\n'))
+    {
+        // Overlay batches do not change the path the context menu strings refer to
+        client->write(QByteArray::fromStdString(ExtServerProtocol::answerBatchRequest(request.constData(), static_cast<size_t>(request.size()),
+            [this](const string& content)
+            {
+                return getPathState(content, false);
+            })));
+        mPendingBatches.remove(client);
+    }
+    else if (static_cast<size_t>(request.size()) > ExtServerProtocol::MAX_BATCH_REQUEST_SIZE)
+    {
+        client->write(RESPONSE_ERROR);
+        client->write("\n");
+        mPendingBatches.remove(client);
+    }
+    return true;
+}
+
+void ExtServer::logStateCacheStats()
+{
+    const uint64_t lookups = mStateCache.hits() + mStateCache.misses();
+    if (lookups == mLoggedStateCacheLookups)
+    {
+        return;
+    }
+    mLoggedStateCacheLookups = lookups;
+
+    MegaApi::log(MegaApi::LOG_LEVEL_DEBUG, QString::fromUtf8("Overlay state cache: %1 hits, %2 misses, %3 entries, %4 invalidations")
+                 .arg(mStateCache.hits()).arg(mStateCache.misses())
+                 .arg(mStateCache.size()).arg(mStateCache.invalidations()).toUtf8().constData());
+}
+
 QString ExtServer::getActionName(const int actionId)
 {
     QString name(QString::fromLatin1(RESPONSE_DEFAULT));
@@ -2,6 +2,7 @@
 #define EXTSERVER_H
 
 #include "MegaApplication.h"
+#include "OverlayStateCache.h"
 #include "megaapi.h"
 #include "control/Preferences/Preferences.h"
 
@@ -21,6 +22,8 @@ class ExtServer: public QObject
  public:
     ExtServer(MegaApplication *app);
     virtual ~ExtServer();
+    // Called for the same sync events that are pushed to the extensions by NotifyServer
+    void notifyItemChange(const std::string& localPath);
 
  protected:
     QLocalServer *m_localServer;
@@ -31,12 +34,19 @@ class ExtServer: public QObject
     void acceptConnection();
     void onClientData();
     void onClientDisconnected();
+    void logStateCacheStats();
  private:
     QString sockPath;
     QList<QLocalSocket *> m_clients;
+    QHash<QLocalSocket *, QByteArray> mPendingBatches; // batch requests still missing their '\n'
     std::string mLastPath;
+    OverlayStateCache mStateCache;
+    QTimer *mStateCacheStatsTimer;
+    uint64_t mLoggedStateCacheLookups;
 
     const char *GetAnswerToRequest(const char *buf);
+    const char *getPathState(std::string content, bool rememberPath);
+    bool readBatchRequest(QLocalSocket *client);
     QString getActionName(const int actionId);
 
     void addToQueue(QQueue<QString>& queue, const char* content);
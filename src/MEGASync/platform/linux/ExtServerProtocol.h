@@ -0,0 +1,65 @@
+#ifndef EXTSERVERPROTOCOL_H
+#define EXTSERVERPROTOCOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Batched path state requests of the file manager extensions.
+//
+// The single letter requests ("P:<path><FS><force>") get one answer each, so the client waits
+// for a round trip per file. A batch carries many paths and gets all their states in one line:
+//   request: "B:<id>" then "<RS><path><FS><force>" for each path, ended by '\n'
+//   answer:  "B:<id>:<state>,<state>,...\n", in the order of the paths
+// Answers are written in the order the requests arrive, so a client can have several batches
+// in flight. Servers without batches answer "9" (default) to a 'B' request.
+namespace ExtServerProtocol
+{
+constexpr char BATCH_REQUEST = 'B';
+constexpr char FILE_SEP = 0x1C;
+constexpr char PATH_SEP = 0x1E;
+constexpr char STATE_SEP = ',';
+constexpr std::size_t MAX_BATCH_REQUEST_SIZE = 4 * 1024 * 1024;
+
+inline bool isBatchRequest(const char* data, std::size_t size)
+{
+    return size >= 2 && data[0] == BATCH_REQUEST && data[1] == ':';
+}
+
+// Calls stateOfPath("<path><FS><force>") for every path of a complete request and returns the answer
+template <typename Func>
+std::string answerBatchRequest(const char* data, std::size_t size, Func stateOfPath)
+{
+    while (size && (data[size - 1] == '\n' || data[size - 1] == '\r'))
+    {
+        --size;
+    }
+
+    auto end = data + size;
+    auto idEnd = std::find(data + 2, end, PATH_SEP);
+
+    std::string answer(data, idEnd);
+    answer.push_back(':');
+
+    bool first = true;
+    std::string content;
+    for (auto begin = idEnd; begin != end;)
+    {
+        auto pathEnd = std::find(begin + 1, end, PATH_SEP);
+        content.assign(begin + 1, pathEnd);
+        if (!first)
+        {
+            answer.push_back(STATE_SEP);
+        }
+        answer.append(stateOfPath(content));
+        first = false;
+        begin = pathEnd;
+    }
+
+    answer.push_back('\n');
+    return answer;
+}
+}
+
+#endif // EXTSERVERPROTOCOL_H
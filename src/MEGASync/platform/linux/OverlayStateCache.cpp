@@ -0,0 +1,140 @@
+#include "OverlayStateCache.h"
+
+#include <algorithm>
+
+constexpr std::size_t OverlayStateCache::DEFAULT_MAX_ENTRIES;
+
+OverlayStateCache::OverlayStateCache(std::size_t maxEntries)
+    : mMaxEntries(std::max<std::size_t>(maxEntries, 1))
+{
+}
+
+bool OverlayStateCache::find(const std::string& path, int& state)
+{
+    std::string directory;
+    std::string name;
+    split(path, directory, name);
+
+    auto itDirectory = mDirectories.find(directory);
+    if (itDirectory != mDirectories.end())
+    {
+        auto itEntry = itDirectory->second.find(name);
+        if (itEntry != itDirectory->second.end())
+        {
+            state = itEntry->second;
+            ++mHits;
+            return true;
+        }
+    }
+
+    ++mMisses;
+    return false;
+}
+
+void OverlayStateCache::insert(const std::string& path, int state)
+{
+    // Browsing big trees outside the syncs must not grow the cache without limit
+    if (mEntries >= mMaxEntries)
+    {
+        clear();
+    }
+
+    std::string directory;
+    std::string name;
+    split(path, directory, name);
+
+    auto result = mDirectories[directory].emplace(std::move(name), state);
+    if (result.second)
+    {
+        ++mEntries;
+    }
+    else
+    {
+        result.first->second = state;
+    }
+}
+
+void OverlayStateCache::invalidate(const std::string& path)
+{
+    ++mInvalidations;
+
+    std::string directory;
+    std::string name;
+    split(path, directory, name);
+
+    auto itDirectory = mDirectories.find(directory);
+    if (itDirectory != mDirectories.end())
+    {
+        mEntries -= itDirectory->second.erase(name);
+        if (itDirectory->second.empty())
+        {
+            mDirectories.erase(itDirectory);
+        }
+    }
+
+    // The folder itself and its subfolders: keys equal to the path or starting with "<path>/"
+    // (the root folder "/" is the empty key)
+    std::string folder(name.empty() ? directory : directory + '/' + name);
+
+    auto itFolder = mDirectories.find(folder);
+    if (itFolder != mDirectories.end())
+    {
+        mEntries -= itFolder->second.size();
+        mDirectories.erase(itFolder);
+    }
+
+    auto prefix(folder + '/');
+    auto it = mDirectories.lower_bound(prefix);
+    while (it != mDirectories.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+    {
+        mEntries -= it->second.size();
+        it = mDirectories.erase(it);
+    }
+}
+
+void OverlayStateCache::clear()
+{
+    mDirectories.clear();
+    mEntries = 0;
+}
+
+std::size_t OverlayStateCache::size() const
+{
+    return mEntries;
+}
+
+std::uint64_t OverlayStateCache::hits() const
+{
+    return mHits;
+}
+
+std::uint64_t OverlayStateCache::misses() const
+{
+    return mMisses;
+}
+
+std::uint64_t OverlayStateCache::invalidations() const
+{
+    return mInvalidations;
+}
+
+// "/a/b/c" is stored as "c" in directory "/a/b"; trailing separators are ignored
+void OverlayStateCache::split(const std::string& path, std::string& directory, std::string& name)
+{
+    auto end = path.size();
+    while (end > 1 && path[end - 1] == '/')
+    {
+        --end;
+    }
+
+    auto separator = path.rfind('/', end - 1);
+    if (end == 0 || separator == std::string::npos)
+    {
+        directory.clear();
+        name.assign(path, 0, end);
+        return;
+    }
+
+    directory.assign(path, 0, separator);
+    name.assign(path, separator + 1, end - separator - 1);
+}
@@ -0,0 +1,47 @@
+#ifndef OVERLAYSTATECACHE_H
+#define OVERLAYSTATECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// Sync states of local paths, as answered by MegaApi::syncPathState, grouped by directory.
+//
+// Entries are added when the file manager asks for a path and removed by the same sync events
+// that are pushed to the extensions (NotifyServer). Invalidating a folder drops the states of
+// everything under it, which covers syncs being added, removed or paused.
+class OverlayStateCache
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_ENTRIES = 200000;
+
+    explicit OverlayStateCache(std::size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+    bool find(const std::string& path, int& state);
+    void insert(const std::string& path, int state);
+    // Removes path and, if it is a folder, all the paths under it
+    void invalidate(const std::string& path);
+    void clear();
+
+    std::size_t size() const;
+    std::uint64_t hits() const;
+    std::uint64_t misses() const;
+    std::uint64_t invalidations() const;
+
+private:
+    using Directory = std::unordered_map<std::string, int>;
+
+    static void split(const std::string& path, std::string& directory, std::string& name);
+
+    const std::size_t mMaxEntries;
+    std::map<std::string, Directory> mDirectories;
+    std::size_t mEntries = 0;
+
+    std::uint64_t mHits = 0;
+    std::uint64_t mMisses = 0;
+    std::uint64_t mInvalidations = 0;
+};
+
+#endif // OVERLAYSTATECACHE_H
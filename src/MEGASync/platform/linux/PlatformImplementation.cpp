@@ -38,9 +38,13 @@ void PlatformImplementation::notifyItemChange(const QString& path, int)
 {
     if (!path.isEmpty())
     {
+        std::string stdPath = path.toStdString();
+        if (ext_server)
+        {
+            ext_server->notifyItemChange(stdPath);
+        }
         if (notify_server && !Preferences::instance()->overlayIconsDisabled())
         {
-            std::string stdPath = path.toStdString();
             notify_server->notifyItemChange(&stdPath);
         }
         mShellNotifier->notify(path);
@@ -176,6 +180,11 @@ void PlatformImplementation::syncFolderAdded(QString syncPath, QString /*syncNam
 
     }
 
+    if (ext_server)
+    {
+        ext_server->notifyItemChange(syncPath.toStdString());
+    }
+
     if (notify_server)
     {
         notify_server->notifySyncAdd(syncPath);
@@ -191,6 +200,11 @@ void PlatformImplementation::syncFolderRemoved(QString syncPath, QString /*syncN
     }
     delete folder;
 
+    if (ext_server)
+    {
+        ext_server->notifyItemChange(syncPath.toStdString());
+    }
+
     if (notify_server)
     {
         notify_server->notifySyncDel(syncPath);
@@ -83,11 +83,14 @@ target_sources_conditional(MEGAsync
    PRIVATE
    platform/linux/PlatformImplementation.h
    platform/linux/ExtServer.h
+   platform/linux/ExtServerProtocol.h
+   platform/linux/OverlayStateCache.h
    platform/linux/NotifyServer.h
    platform/linux/DolphinFileManager.h
    platform/linux/NautilusFileManager.h
    platform/linux/PlatformImplementation.cpp
    platform/linux/ExtServer.cpp
+   platform/linux/OverlayStateCache.cpp
    platform/linux/NotifyServer.cpp
    platform/linux/PowerOptions.cpp
    platform/linux/PlatformStrings.cpp
@@ -55,6 +55,7 @@ unix:!macx {
 
     SOURCES += $$PWD/linux/PlatformImplementation.cpp \
         $$PWD/linux/ExtServer.cpp \
+        $$PWD/linux/OverlayStateCache.cpp \
         $$PWD/linux/NotifyServer.cpp \
         $$PWD/linux/PowerOptions.cpp \
         $$PWD/linux/PlatformStrings.cpp \
@@ -63,6 +64,8 @@ unix:!macx {
 
     HEADERS += $$PWD/linux/PlatformImplementation.h \
         $$PWD/linux/ExtServer.h \
+        $$PWD/linux/ExtServerProtocol.h \
+        $$PWD/linux/OverlayStateCache.h \
         $$PWD/linux/NotifyServer.h \
         $$PWD/linux/DolphinFileManager.h \
         $$PWD/linux/NautilusFileManager.h 
@@ -124,6 +124,28 @@ bool MoveOrRenameCannotOccurIssue::checkForExternalChanges()
     return isPotentiallySolved();
 }
 
+ExternalChangeProbes MoveOrRenameCannotOccurIssue::getExternalChangeProbes() const
+{
+    ExternalChangeProbe localProbe;
+    ExternalChangeProbe cloudProbe;
+    if(mPathToSolve.isCloud)
+    {
+        localProbe.type = ExternalChangeProbe::Type::LOCAL_EXISTS;
+        localProbe.path = consultLocalData()->getMovePath().path;
+        cloudProbe.type = ExternalChangeProbe::Type::CLOUD_REMOVED;
+        cloudProbe.path = mPathToSolve.currentPath;
+    }
+    else
+    {
+        localProbe.type = ExternalChangeProbe::Type::LOCAL_REMOVED;
+        localProbe.path = mPathToSolve.currentPath;
+        cloudProbe.type = ExternalChangeProbe::Type::CLOUD_EXISTS;
+        cloudProbe.path = consultCloudData()->getMovePath().path;
+    }
+
+    return ExternalChangeProbes() << localProbe << cloudProbe;
+}
+
 const QString& MoveOrRenameCannotOccurIssue::currentPath() const
 {
     return mPathToSolve.currentPath;
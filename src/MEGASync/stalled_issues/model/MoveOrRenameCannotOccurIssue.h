@@ -20,6 +20,7 @@ public:
     void solveIssue();
 
     bool checkForExternalChanges() override;
+    ExternalChangeProbes getExternalChangeProbes() const override;
 
     const QString &currentPath() const;
     QString previousPath() const;
@@ -267,6 +267,34 @@ bool NameConflictedStalledIssue::checkForExternalChanges()
     return isPotentiallySolved();
 }
 
+ExternalChangeProbes NameConflictedStalledIssue::getExternalChangeProbes() const
+{
+    ExternalChangeProbes probes;
+
+    auto conflictedNames(mLocalConflictedNames);
+    conflictedNames.append(mCloudConflictedNames.getConflictedNames());
+    foreach(auto conflictedName, conflictedNames)
+    {
+        if(!conflictedName->isSolved())
+        {
+            ExternalChangeProbe probe;
+            probe.path = conflictedName->mConflictedPath;
+            if(conflictedName->mHandle != mega::INVALID_HANDLE)
+            {
+                probe.type = ExternalChangeProbe::Type::CLOUD_NODE_PATH_CHANGED;
+                probe.handle = conflictedName->mHandle;
+            }
+            else
+            {
+                probe.type = ExternalChangeProbe::Type::LOCAL_REMOVED;
+            }
+            probes.append(probe);
+        }
+    }
+
+    return probes;
+}
+
 bool NameConflictedStalledIssue::solveLocalConflictedNameByRemove(int conflictIndex)
 {
     auto result(false);
@@ -516,6 +516,7 @@ public:
     void updateName() override;
 
     bool checkForExternalChanges() override;
+    ExternalChangeProbes getExternalChangeProbes() const override;
 
     bool solveLocalConflictedNameByRemove(int conflictIndex);
     bool solveCloudConflictedNameByRemove(int conflictIndex);
@@ -184,12 +184,35 @@ void CloudStalledIssueData::setPathHandle(mega::MegaHandle newPathHandle)
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// \brief StalledIssueKey::StalledIssueKey
+/// \param stall
+///
+StalledIssueKey::StalledIssueKey(const mega::MegaSyncStall* stall)
+    : mReason(stall->reason())
+{
+    for(auto cloud : {false, true})
+    {
+        auto pathCount(stall->pathCount(cloud));
+        for(unsigned int index = 0; index < pathCount; ++index)
+        {
+            mPaths.append(stall->path(cloud, static_cast<int>(index)));
+            mPaths.append('\0');
+        }
+        //Separates the local paths from the cloud ones
+        mPaths.append('\1');
+    }
+
+    mHash = qHash(mPaths) ^ static_cast<uint>(mReason);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief StalledIssue::StalledIssue
 /// \param stallIssue
 ///
 StalledIssue::StalledIssue(const mega::MegaSyncStall* stallIssue)
-    : mFileSystemWatcher(new FileSystemSignalHandler(this))
+    : mKey(stallIssue),
+      mFileSystemWatcher(new FileSystemSignalHandler(this))
 {
     originalStall.reset(stallIssue->copy());
 }
@@ -557,6 +580,78 @@ bool StalledIssue::checkForExternalChanges()
     return isPotentiallySolved();
 }
 
+ExternalChangeProbes StalledIssue::getExternalChangeProbes() const
+{
+    ExternalChangeProbes probes;
+
+    if(mLocalData && !missingFingerprint())
+    {
+        ExternalChangeProbe probe;
+        probe.type = ExternalChangeProbe::Type::LOCAL_REMOVED;
+        probe.path = mLocalData->getPath().path;
+        probes.append(probe);
+    }
+
+    if(mCloudData)
+    {
+        auto currentNode = mCloudData->getNode();
+        if(currentNode)
+        {
+            ExternalChangeProbe probe;
+            probe.type = ExternalChangeProbe::Type::CLOUD_NODE_MOVED;
+            probe.handle = mCloudData->getPathHandle();
+            probe.parentHandle = currentNode->getParentHandle();
+            probe.missingFingerprint = missingFingerprint();
+            probes.append(probe);
+        }
+    }
+
+    return probes;
+}
+
+bool ExternalChangeProbe::hasChanged() const
+{
+    auto megaApi(MegaSyncApp->getMegaApi());
+
+    switch(type)
+    {
+        case Type::LOCAL_REMOVED:
+        {
+            return !QFileInfo::exists(path);
+        }
+        case Type::LOCAL_EXISTS:
+        {
+            return QFileInfo::exists(path);
+        }
+        case Type::CLOUD_REMOVED:
+        case Type::CLOUD_EXISTS:
+        {
+            std::unique_ptr<mega::MegaNode> node(megaApi->getNodeByPath(path.toUtf8().constData()));
+            return (node != nullptr) == (type == Type::CLOUD_EXISTS);
+        }
+        case Type::CLOUD_NODE_MOVED:
+        {
+            std::unique_ptr<mega::MegaNode> node(megaApi->getNodeByHandle(handle));
+            return !node ||
+                   megaApi->isInRubbish(node.get()) ||
+                   node->getParentHandle() != parentHandle ||
+                   (missingFingerprint && (node->getFingerprint() != nullptr));
+        }
+        case Type::CLOUD_NODE_PATH_CHANGED:
+        {
+            std::unique_ptr<mega::MegaNode> node(megaApi->getNodeByHandle(handle));
+            if(node && node->isNodeKeyDecrypted())
+            {
+                std::unique_ptr<char[]> nodePath(megaApi->getNodePathByNodeHandle(handle));
+                return QString::fromUtf8(nodePath.get()) != path;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
 QStringList StalledIssue::getLocalFiles()
 {
     QStringList files;
@@ -649,6 +744,50 @@ mega::MegaSyncStall::SyncStallReason StalledIssue::getReason() const
     return mReason;
 }
 
+const StalledIssueKey& StalledIssue::getKey() const
+{
+    return mKey;
+}
+
+bool StalledIssue::canBeReusedFor(const mega::MegaSyncStall* stall) const
+{
+    //Solved issues and issues of removed syncs are filled again, as the paths may now belong to another sync
+    if(isSolved() || mSyncIds.isEmpty())
+    {
+        return false;
+    }
+
+    foreach(auto& syncId, mSyncIds)
+    {
+        if(!SyncInfo::instance()->getSyncSettingByTag(syncId))
+        {
+            return false;
+        }
+    }
+
+    if(stall->detectedCloudSide() != originalStall->detectedCloudSide())
+    {
+        return false;
+    }
+
+    //Same key, so same paths. Check what the SDK says about them
+    for(auto cloud : {false, true})
+    {
+        auto pathCount(static_cast<int>(stall->pathCount(cloud)));
+        for(int index = 0; index < pathCount; ++index)
+        {
+            if(stall->pathProblem(cloud, index) != originalStall->pathProblem(cloud, index) ||
+               stall->couldSuggestIgnoreThisPath(cloud, index) != originalStall->couldSuggestIgnoreThisPath(cloud, index) ||
+               (cloud && stall->cloudNodeHandle(index) != originalStall->cloudNodeHandle(index)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 QString StalledIssue::getFileName(bool preferCloud) const
 {
     QString fileName;
@@ -9,9 +9,11 @@
 #include <QObject>
 #include <QFileInfo>
 #include <QSize>
+#include <QByteArray>
 #include <QDebug>
 
 #include <QFileSystemWatcher>
+#include <QVector>
 
 #include <memory>
 
@@ -211,9 +213,65 @@ using LocalStalledIssueDataList = QList<LocalStalledIssueDataPtr>;
 Q_DECLARE_METATYPE(LocalStalledIssueDataPtr)
 Q_DECLARE_METATYPE(LocalStalledIssueDataList)
 
+//Identifies a stall across the refreshes of the stall list: its reason and its local and cloud paths
+class StalledIssueKey
+{
+public:
+    StalledIssueKey(){}
+    explicit StalledIssueKey(const mega::MegaSyncStall* stall);
+
+    bool operator==(const StalledIssueKey& key) const
+    {
+        return mHash == key.mHash && mReason == key.mReason && mPaths == key.mPaths;
+    }
+
+    uint hash() const {return mHash;}
+
+    struct Hash
+    {
+        std::size_t operator()(const StalledIssueKey& key) const {return key.hash();}
+    };
+
+private:
+    mega::MegaSyncStall::SyncStallReason mReason = mega::MegaSyncStall::SyncStallReason::NoReason;
+    //All the paths in UTF-8, local ones first, so that a key is a single allocation
+    QByteArray mPaths;
+    uint mHash = 0;
+};
+
+inline uint qHash(const StalledIssueKey& key, uint seed = 0)
+{
+    return key.hash() ^ seed;
+}
+
 struct UploadTransferInfo;
 struct DownloadTransferInfo;
 
+//One of the lookups done by StalledIssue::checkForExternalChanges, copied from the issue so that
+//it can be done out of the model lock (e.g. in the thread pool) without touching the issue
+struct ExternalChangeProbe
+{
+    enum class Type
+    {
+        LOCAL_REMOVED,          //The local path does not exist
+        LOCAL_EXISTS,           //The local path exists
+        CLOUD_REMOVED,          //There is no node in the cloud path
+        CLOUD_EXISTS,           //There is a node in the cloud path
+        CLOUD_NODE_MOVED,       //The node is gone, in the rubbish bin, in another folder or got a fingerprint
+        CLOUD_NODE_PATH_CHANGED //The decrypted node is not in the path any more
+    };
+
+    Type type;
+    QString path;
+    mega::MegaHandle handle = mega::INVALID_HANDLE;
+    mega::MegaHandle parentHandle = mega::INVALID_HANDLE;
+    bool missingFingerprint = false;
+
+    bool hasChanged() const;
+};
+
+using ExternalChangeProbes = QVector<ExternalChangeProbe>;
+
 class StalledIssue
 {
     class FileSystemSignalHandler : public QObject
@@ -276,8 +334,13 @@ public:
     virtual void updateName(){}
 
     virtual bool checkForExternalChanges();
+    //The lookups of checkForExternalChanges. If none of them has changed, it would not find any change
+    virtual ExternalChangeProbes getExternalChangeProbes() const;
 
     mega::MegaSyncStall::SyncStallReason getReason() const;
+    const StalledIssueKey& getKey() const;
+    //True if the issue can be kept for the stall, which has the same key, instead of filling a new one
+    bool canBeReusedFor(const mega::MegaSyncStall* stall) const;
     QString getFileName(bool preferCloud) const;
     static StalledIssueFilterCriterion getCriterionByReason(mega::MegaSyncStall::SyncStallReason reason);
 
@@ -361,6 +424,7 @@ protected:
     void setIsFile(const QString& path, bool isLocal);
 
     std::shared_ptr<mega::MegaSyncStall> originalStall;
+    StalledIssueKey mKey;
     mega::MegaSyncStall::SyncStallReason mReason = mega::MegaSyncStall::SyncStallReason::NoReason;
     QList<mega::MegaHandle> mSyncIds;
     mutable SolveType mIsSolved = SolveType::Unsolved;
@@ -0,0 +1,174 @@
+#ifndef STALLEDISSUESBATCHES_H
+#define STALLEDISSUESBATCHES_H
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <utility>
+#include <vector>
+
+// Splits a list of issues to solve in batches, keeping together the issues of the same group (the
+// same sync and folder), so that the checks and the SDK operations of a batch work on the same folders.
+//
+// Groups are ordered by their first issue and issues keep their order inside their group. Small
+// groups share a batch; a group bigger than a batch is split in several batches.
+// solve() checks the batches in a thread pool, a few batches ahead of the one being solved, so that
+// the file system and SDK lookups of the checks overlap with the SDK operations of the solve.
+class StalledIssuesBatches
+{
+public:
+    struct Range
+    {
+        int begin;
+        int end;
+    };
+
+    // groupOfItem[item] is the group of each item, from 0 to the number of groups - 1
+    StalledIssuesBatches(const std::vector<int>& groupOfItem, int maxBatchSize)
+    {
+        auto items(static_cast<int>(groupOfItem.size()));
+        maxBatchSize = std::max(maxBatchSize, 1);
+
+        //Groups by first appearance
+        std::vector<int> orderOfGroup;
+        std::vector<int> groupSizes;
+        for(auto group : groupOfItem)
+        {
+            if(group >= static_cast<int>(orderOfGroup.size()))
+            {
+                orderOfGroup.resize(static_cast<std::size_t>(group) + 1, NO_GROUP);
+            }
+            if(orderOfGroup[group] == NO_GROUP)
+            {
+                orderOfGroup[group] = static_cast<int>(groupSizes.size());
+                groupSizes.push_back(0);
+            }
+            ++groupSizes[orderOfGroup[group]];
+        }
+
+        //Stable counting sort of the items by group
+        std::vector<int> groupStarts(groupSizes.size() + 1, 0);
+        for(std::size_t group = 0; group < groupSizes.size(); ++group)
+        {
+            groupStarts[group + 1] = groupStarts[group] + groupSizes[group];
+        }
+        mOrder.resize(static_cast<std::size_t>(items));
+        auto nextInGroup(groupStarts);
+        for(int item = 0; item < items; ++item)
+        {
+            mOrder[nextInGroup[orderOfGroup[groupOfItem[item]]]++] = item;
+        }
+
+        //Whole groups are added to the batch while they fit
+        auto batchBegin(0);
+        for(std::size_t group = 0; group < groupSizes.size(); ++group)
+        {
+            auto groupEnd(groupStarts[group + 1]);
+            if(groupEnd - batchBegin > maxBatchSize && groupStarts[group] > batchBegin)
+            {
+                mBatches.push_back(Range{batchBegin, groupStarts[group]});
+                batchBegin = groupStarts[group];
+            }
+            while(groupEnd - batchBegin > maxBatchSize)
+            {
+                mBatches.push_back(Range{batchBegin, batchBegin + maxBatchSize});
+                batchBegin += maxBatchSize;
+            }
+        }
+        if(batchBegin < items)
+        {
+            mBatches.push_back(Range{batchBegin, items});
+        }
+    }
+
+    int batchCount() const
+    {
+        return static_cast<int>(mBatches.size());
+    }
+
+    // Positions in order() of the items of the batch
+    const Range& batch(int index) const
+    {
+        return mBatches[index];
+    }
+
+    // The items, grouped
+    const std::vector<int>& order() const
+    {
+        return mOrder;
+    }
+
+    // check(item) runs in pool and returns true if the item changed externally and must not be solved.
+    // solveBatch(batch, changed) runs in the calling thread, batch after batch, with one value per item
+    // of the batch (1 if changed, or if it could not be checked); it returns false to stop.
+    // Returns false if it was stopped. Must not be called from a task of pool
+    template <typename Check, typename SolveBatch>
+    bool solve(ThreadPool& pool, Check check, SolveBatch solveBatch) const
+    {
+        ThreadPool::CancelToken token;
+        std::deque<std::future<std::vector<char>>> checks;
+        auto checkedBatches(0);
+        auto batchesAhead(static_cast<int>(pool.threadCount()));
+
+        auto stop = [&token, &checks]()
+        {
+            //The checks already running use this object
+            token.cancel();
+            for(auto& pendingCheck : checks)
+            {
+                pendingCheck.wait();
+            }
+            return false;
+        };
+
+        for(int batch = 0; batch < batchCount(); ++batch)
+        {
+            for(; checkedBatches < batchCount() && checkedBatches <= batch + batchesAhead; ++checkedBatches)
+            {
+                auto range(mBatches[checkedBatches]);
+                checks.push_back(pool.submit([this, range, check]()
+                {
+                    std::vector<char> changed(static_cast<std::size_t>(range.end - range.begin), 1);
+                    for(int position = range.begin; position < range.end && !ThreadPool::isThreadInterrupted(); ++position)
+                    {
+                        changed[position - range.begin] = check(mOrder[position]) ? 1 : 0;
+                    }
+                    return changed;
+                }, ThreadPool::Priority::INTERACTIVE, token));
+            }
+
+            std::vector<char> changed;
+            try
+            {
+                changed = checks.front().get();
+            }
+            catch(const std::future_error&)
+            {
+                //The pool dropped the check, it is shutting down
+                checks.pop_front();
+                return stop();
+            }
+            checks.pop_front();
+
+            if(!solveBatch(batch, changed))
+            {
+                return stop();
+            }
+        }
+
+        return true;
+    }
+
+private:
+    enum
+    {
+        NO_GROUP = -1
+    };
+
+    std::vector<int> mOrder;
+    std::vector<Range> mBatches;
+};
+
+#endif // STALLEDISSUESBATCHES_H
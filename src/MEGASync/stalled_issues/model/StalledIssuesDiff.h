@@ -0,0 +1,218 @@
+#ifndef STALLEDISSUESDIFF_H
+#define STALLEDISSUESDIFF_H
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Rows to remove and insert to turn a list of issues into a newer one, issues being matched by key.
+//
+// Matched issues keep their row as long as they keep their relative order (the longest run of them
+// that is still in order); the rest are removed and inserted again in their new row. A key can be
+// repeated: its nth occurrence in the old list matches its nth occurrence in the new one.
+template <typename Key, typename Hash = std::hash<Key>>
+class StalledIssuesDiff
+{
+public:
+    struct Range
+    {
+        int first;
+        int last;
+    };
+
+    // keyOf(item) returns a reference to the key of the item, alive while the diff is built
+    template <typename OldList, typename NewList, typename KeyOf>
+    StalledIssuesDiff(const OldList& oldItems, const NewList& newItems, KeyOf keyOf)
+    {
+        auto oldSize(static_cast<int>(oldItems.size()));
+        auto newSize(static_cast<int>(newItems.size()));
+
+        // Old rows by key, in a flat table so that the whole table is a single allocation. The
+        // other old rows with the same key are chained from the first one
+        std::vector<Bucket> buckets(tableSizeFor(oldSize));
+        auto mask(buckets.size() - 1);
+        std::vector<int> nextOldRow(static_cast<std::size_t>(oldSize), NO_ROW);
+        for(int row = oldSize - 1; row >= 0; --row)
+        {
+            auto& key(keyOf(oldItems[row]));
+            auto hash(Hash()(key));
+            auto bucket(hash & mask);
+            while(buckets[bucket].first != NO_ROW
+                  && (buckets[bucket].hash != hash || !(keyOf(oldItems[buckets[bucket].first]) == key)))
+            {
+                bucket = (bucket + 1) & mask;
+            }
+
+            nextOldRow[row] = buckets[bucket].first;
+            buckets[bucket] = Bucket{hash, row, row};
+        }
+
+        std::vector<int> oldRowOfNewRow(static_cast<std::size_t>(newSize), NO_ROW);
+        for(int row = 0; row < newSize && oldSize > 0; ++row)
+        {
+            auto& key(keyOf(newItems[row]));
+            auto hash(Hash()(key));
+            for(auto bucket = hash & mask; buckets[bucket].first != NO_ROW; bucket = (bucket + 1) & mask)
+            {
+                if(buckets[bucket].hash == hash && keyOf(oldItems[buckets[bucket].first]) == key)
+                {
+                    auto oldRow(buckets[bucket].unmatched);
+                    if(oldRow != NO_ROW)
+                    {
+                        oldRowOfNewRow[row] = oldRow;
+                        buckets[bucket].unmatched = nextOldRow[oldRow];
+                    }
+                    break;
+                }
+            }
+        }
+
+        keepLongestOrderedRun(oldRowOfNewRow);
+
+        std::vector<bool> keptOldRows(static_cast<std::size_t>(oldSize), false);
+        for(auto& kept : mKept)
+        {
+            keptOldRows[kept.first] = true;
+        }
+        for(int row = oldSize - 1; row >= 0; --row)
+        {
+            if(!keptOldRows[row])
+            {
+                ++mChangedRows;
+                if(!mRemoved.empty() && mRemoved.back().first == row + 1)
+                {
+                    mRemoved.back().first = row;
+                }
+                else
+                {
+                    mRemoved.push_back(Range{row, row});
+                }
+            }
+        }
+
+        auto kept(mKept.begin());
+        for(int row = 0; row < newSize; ++row)
+        {
+            if(kept != mKept.end() && kept->second == row)
+            {
+                ++kept;
+                continue;
+            }
+
+            ++mChangedRows;
+            if(!mInserted.empty() && mInserted.back().last == row - 1)
+            {
+                mInserted.back().last = row;
+            }
+            else
+            {
+                mInserted.push_back(Range{row, row});
+            }
+        }
+    }
+
+    // Rows of the old list, from the last ones to the first ones so they can be removed in turn
+    const std::vector<Range>& removed() const
+    {
+        return mRemoved;
+    }
+
+    // Rows of the new list, from the first ones to the last ones, inserted after the removals
+    const std::vector<Range>& inserted() const
+    {
+        return mInserted;
+    }
+
+    // (old row, new row) of the matched issues that keep their row, in ascending order
+    const std::vector<std::pair<int, int>>& kept() const
+    {
+        return mKept;
+    }
+
+    bool hasRowChanges() const
+    {
+        return mChangedRows > 0;
+    }
+
+    // Removed plus inserted rows
+    int changedRows() const
+    {
+        return mChangedRows;
+    }
+
+private:
+    static constexpr int NO_ROW = -1;
+
+    struct Bucket
+    {
+        std::size_t hash = 0;
+        // First old row with the key, and first one not matched yet
+        int first = NO_ROW;
+        int unmatched = NO_ROW;
+    };
+
+    // At most half full
+    static std::size_t tableSizeFor(int rows)
+    {
+        std::size_t size(16);
+        while(size < static_cast<std::size_t>(rows) * 2)
+        {
+            size *= 2;
+        }
+        return size;
+    }
+
+    // Longest increasing subsequence of the matched old rows, in O(n log n)
+    void keepLongestOrderedRun(const std::vector<int>& oldRowOfNewRow)
+    {
+        // New row ending the best run of each length, and the new row before each one in its run
+        std::vector<int> runEnds;
+        std::vector<int> previousInRun(oldRowOfNewRow.size(), NO_ROW);
+        for(int row = 0; row < static_cast<int>(oldRowOfNewRow.size()); ++row)
+        {
+            auto oldRow(oldRowOfNewRow[row]);
+            if(oldRow == NO_ROW)
+            {
+                continue;
+            }
+
+            // Old rows usually keep their order, so the run is usually extended at its end
+            auto position(runEnds.size());
+            if(!runEnds.empty() && oldRowOfNewRow[runEnds.back()] > oldRow)
+            {
+                position = static_cast<std::size_t>(
+                    std::lower_bound(runEnds.begin(), runEnds.end(), oldRow, [&oldRowOfNewRow](int end, int value){
+                        return oldRowOfNewRow[end] < value;
+                    }) - runEnds.begin());
+            }
+
+            previousInRun[row] = position > 0 ? runEnds[position - 1] : NO_ROW;
+            if(position == runEnds.size())
+            {
+                runEnds.push_back(row);
+            }
+            else
+            {
+                runEnds[position] = row;
+            }
+        }
+
+        mKept.resize(runEnds.size());
+        auto row(runEnds.empty() ? NO_ROW : runEnds.back());
+        for(auto index = mKept.size(); index-- > 0; row = previousInRun[row])
+        {
+            mKept[index] = std::make_pair(oldRowOfNewRow[row], row);
+        }
+    }
+
+    std::vector<Range> mRemoved;
+    std::vector<Range> mInserted;
+    std::vector<std::pair<int, int>> mKept;
+    int mChangedRows = 0;
+};
+
+template <typename Key, typename Hash>
+constexpr int StalledIssuesDiff<Key, Hash>::NO_ROW;
+
+#endif // STALLEDISSUESDIFF_H
@@ -11,14 +11,44 @@
 #include <StalledIssuesDialog.h>
 #include <syncs/control/MegaIgnoreManager.h>
 #include "StatsEventHandler.h"
+#include "StalledIssuesBatches.h"
 
 #include <QSortFilterProxyModel>
+#include <QSet>
+
+#include <algorithm>
 
 StalledIssuesReceiver::StalledIssuesReceiver(QObject* parent) : QObject(parent), mega::MegaRequestListener()
 {
     qRegisterMetaType<StalledIssuesReceived>("StalledIssuesReceived");
 }
 
+StalledIssueVariant StalledIssuesReceiver::createIssue(const mega::MegaSyncStall* stall)
+{
+    if(stall->reason() == mega::MegaSyncStall::SyncStallReason::NamesWouldClashWhenSynced)
+    {
+        return StalledIssueVariant(std::make_shared<NameConflictedStalledIssue>(stall));
+    }
+    else if(stall->couldSuggestIgnoreThisPath(false, 0) ||
+            stall->couldSuggestIgnoreThisPath(false, 1) ||
+            stall->couldSuggestIgnoreThisPath(true, 0) ||
+            stall->couldSuggestIgnoreThisPath(true, 1))
+    {
+        return StalledIssueVariant(std::make_shared<IgnoredStalledIssue>(stall));
+    }
+    else if(stall->reason() == mega::MegaSyncStall::SyncStallReason::LocalAndRemoteChangedSinceLastSyncedState_userMustChoose
+            || stall->reason() == mega::MegaSyncStall::SyncStallReason::LocalAndRemotePreviouslyUnsyncedDiffer_userMustChoose)
+    {
+        return StalledIssueVariant(std::make_shared<LocalOrRemoteUserMustChooseStalledIssue>(stall));
+    }
+    else if(stall->reason() == mega::MegaSyncStall::SyncStallReason::MoveOrRenameCannotOccur)
+    {
+        return StalledIssueVariant(std::make_shared<MoveOrRenameCannotOccurIssue>(stall));
+    }
+
+    return StalledIssueVariant(std::make_shared<StalledIssue>(stall));
+}
+
 void StalledIssuesReceiver::onRequestFinish(mega::MegaApi*, mega::MegaRequest* request, mega::MegaError*)
 {
     if (request->getType() == ::mega::MegaRequest::TYPE_GET_SYNC_STALL_LIST)
@@ -27,6 +57,10 @@ void StalledIssuesReceiver::onRequestFinish(mega::MegaApi*, mega::MegaRequest* r
         mCacheStalledIssues.clear();
         IgnoredStalledIssue::clearIgnoredSyncs();
 
+        //Only the lists shown in the model reuse and keep the issues
+        auto reuseIssues(!mIsEventRequest);
+        ++mRefresh;
+
         if (auto stalls = request->getMegaSyncStallList())
         {
             StalledIssuesVariantList solvableItems;
@@ -38,66 +72,53 @@ void StalledIssuesReceiver::onRequestFinish(mega::MegaApi*, mega::MegaRequest* r
                 auto stall = stalls->get(i);
                 StalledIssueVariant variant;
 
-                if(stall->reason() == mega::MegaSyncStall::SyncStallReason::NamesWouldClashWhenSynced)
-                {
-                    auto d = std::make_shared<NameConflictedStalledIssue>(stall);
-                    variant = StalledIssueVariant(d);
-                }
-                else if(stall->couldSuggestIgnoreThisPath(false, 0) ||
-                        stall->couldSuggestIgnoreThisPath(false, 1) ||
-                        stall->couldSuggestIgnoreThisPath(true, 0) ||
-                        stall->couldSuggestIgnoreThisPath(true, 1))
-                {
-                    auto d = std::make_shared<IgnoredStalledIssue>(stall);
-                    variant = StalledIssueVariant(d);
-                }
-                else if(stall->reason() == mega::MegaSyncStall::SyncStallReason::LocalAndRemoteChangedSinceLastSyncedState_userMustChoose
-                        || stall->reason() == mega::MegaSyncStall::SyncStallReason::LocalAndRemotePreviouslyUnsyncedDiffer_userMustChoose)
-                {
-                    auto d = std::make_shared<LocalOrRemoteUserMustChooseStalledIssue>(stall);
-                    variant = StalledIssueVariant(d);
-                }
-                else if(stall->reason() == mega::MegaSyncStall::SyncStallReason::MoveOrRenameCannotOccur)
+                auto knownIssue(reuseIssues ? mKnownIssues.find(StalledIssueKey(stall)) : mKnownIssues.end());
+                if(knownIssue != mKnownIssues.end() && knownIssue->refresh != mRefresh &&
+                   knownIssue->issue.consultData()->canBeReusedFor(stall))
                 {
-                    auto d = std::make_shared<MoveOrRenameCannotOccurIssue>(stall);
-                    variant = StalledIssueVariant(d);
+                    //Keeps the filled data, the file attributes and the UI state of the issue
+                    knownIssue->refresh = mRefresh;
+                    variant = knownIssue->issue;
                 }
                 else
                 {
-                    auto d = std::make_shared<StalledIssue>(stall);
-                    variant = StalledIssueVariant(d);
-                }
+                    variant = createIssue(stall);
+                    variant.getData()->fillIssue(stall);
 
-                variant.getData()->fillIssue(stall);
+                    //Chec if it is being solved...
+                    if(variant.shouldBeIgnored() || variant.getData()->isSolved())
+                    {
+                        continue;
+                    }
 
-                if(variant.shouldBeIgnored())
-                {
-                    continue;
+                    variant.getData()->endFillingIssue();
+
+                    if(reuseIssues)
+                    {
+                        KnownIssue issue;
+                        issue.issue = variant;
+                        issue.refresh = mRefresh;
+                        mKnownIssues.insert(variant.consultData()->getKey(), issue);
+                    }
                 }
 
-                //Chec if it is being solved...
-                if(!variant.getData()->isSolved())
+                if(mIsEventRequest)
                 {
-                    variant.getData()->endFillingIssue();
-
-                    if(mIsEventRequest)
+                    if(!variant.getData()->isSolvable())
                     {
-                        if(!variant.getData()->isSolvable())
-                        {
-                            MegaSyncApp->getStatsEventHandler()->sendEvent(AppStatsEvents::EventType::SI_STALLED_ISSUE_RECEIVED,
-                                                                           { QString::number(stall->reason()) });
-                        }
+                        MegaSyncApp->getStatsEventHandler()->sendEvent(AppStatsEvents::EventType::SI_STALLED_ISSUE_RECEIVED,
+                                                                       { QString::number(stall->reason()) });
+                    }
+                }
+                else
+                {
+                    if(variant.getData()->isSolvable())
+                    {
+                        solvableItems.append(variant);
                     }
                     else
                     {
-                        if(variant.getData()->isSolvable())
-                        {
-                            solvableItems.append(variant);
-                        }
-                        else
-                        {
-                            mCacheStalledIssues.stalledIssues.append(variant);
-                        }
+                        mCacheStalledIssues.stalledIssues.append(variant);
                     }
                 }
             }
@@ -121,6 +142,23 @@ void StalledIssuesReceiver::onRequestFinish(mega::MegaApi*, mega::MegaRequest* r
             }
         }
 
+        if(reuseIssues)
+        {
+            //Forget the issues which are not stalled anymore
+            auto knownIssue(mKnownIssues.begin());
+            while(knownIssue != mKnownIssues.end())
+            {
+                if(knownIssue->refresh != mRefresh)
+                {
+                    knownIssue = mKnownIssues.erase(knownIssue);
+                }
+                else
+                {
+                    ++knownIssue;
+                }
+            }
+        }
+
         StalledIssuesBySyncFilter filter;
         filter.resetFilter();
 
@@ -142,6 +180,7 @@ void StalledIssuesReceiver::onSetIsEventRequest()
 
 const int StalledIssuesModel::ADAPTATIVE_HEIGHT_ROLE = Qt::UserRole;
 const int EVENT_REQUEST_DELAY = 600000; /*10 minutes*/
+const int SOLVE_BATCH_SIZE = 64; /*issues checked and solved together*/
 const char* FILEWATCHER_ROW = "FILEWATCHER_ROW";
 
 StalledIssuesModel::StalledIssuesModel(QObject* parent)
@@ -183,6 +222,8 @@ StalledIssuesModel::StalledIssuesModel(QObject* parent)
 
     connect(&mEventTimer,&QTimer::timeout, this, &StalledIssuesModel::onSendEvent);
     mEventTimer.setSingleShot(true);
+
+    connect(MegaSyncApp, &MegaApplication::nodesChanged, this, &StalledIssuesModel::onNodesChanged);
 }
 
 bool StalledIssuesModel::issuesRequested() const
@@ -222,72 +263,160 @@ void StalledIssuesModel::onProcessStalledIssues(StalledIssuesReceiver::StalledIs
         mEventTimer.start(EVENT_REQUEST_DELAY);
     }
 
-    Utilities::queueFunctionInObjectThread(mStalledIssuedReceiver, [this, issuesReceived]()
+    //The solved issues stay at the end of the list until the list is fully reset
+    auto newRows(issuesReceived.stalledIssues + mSolvedStalledIssues);
+    auto receivedRows(static_cast<int>(issuesReceived.stalledIssues.size()));
+
+    //Only the differences with the current rows are applied, the issues kept from the last list keep their rows
+    Utilities::queueFunctionInObjectThread(mStalledIssuedReceiver, [this, newRows, receivedRows]()
     {
-        reset();
-        mModelMutex.lockForWrite();
+        if(mThreadFinished)
+        {
+            return;
+        }
 
-        blockSignals(true);
+        //Only this copy shares the rows, so that it can be released before the rows change
+        mModelMutex.lockForRead();
+        auto oldRows(std::make_shared<StalledIssuesVariantList>(mStalledIssues));
+        mModelMutex.unlock();
 
-        auto totalRows = rowCount(QModelIndex());
-        auto rowsToBeInserted(static_cast<int>(issuesReceived.stalledIssues.size()));
+        auto diff(std::make_shared<RowsDiff>(diffRows(*oldRows, newRows)));
 
-        if(rowsToBeInserted > 0)
+        //Rows are inserted and removed in the model thread, where the views receive the changes
+        Utilities::queueFunctionInObjectThread(this, [this, oldRows, newRows, receivedRows, diff]()
         {
-            beginInsertRows(QModelIndex(), totalRows, totalRows + rowsToBeInserted - 1);
+            updateRows(*oldRows, newRows, receivedRows, *diff);
+        });
+    });
+}
 
-            for (auto it = issuesReceived.stalledIssues.begin(); it != issuesReceived.stalledIssues.end();)
-            {
-                if(mThreadFinished)
-                {
-                    return;
-                }
+StalledIssuesModel::RowsDiff StalledIssuesModel::diffRows(const StalledIssuesVariantList& oldRows,
+                                                          const StalledIssuesVariantList& newRows)
+{
+    return RowsDiff(oldRows, newRows, [](const StalledIssueVariant& issue) -> const StalledIssueKey& {
+        return issue.consultData()->getKey();
+    });
+}
 
-                StalledIssueVariant issue(*it);
-                mStalledIssues.append(issue);
-                mStalledIssuesByOrder.insert(issue.consultData().get(), rowCount(QModelIndex()) - 1);
-                mCountByFilterCriterion[static_cast<int>(StalledIssue::getCriterionByReason((*it).consultData()->getReason()))]++;
+void StalledIssuesModel::updateRows(StalledIssuesVariantList& oldRows, const StalledIssuesVariantList& newRows,
+                                    int receivedRows, const RowsDiff& diff)
+{
+    //The rows changed while the diff was done
+    std::unique_ptr<RowsDiff> currentDiff;
+    if(!mStalledIssues.isSharedWith(oldRows))
+    {
+        currentDiff.reset(new RowsDiff(diffRows(mStalledIssues, newRows)));
+    }
+    auto& rowsDiff(currentDiff ? *currentDiff : diff);
+    //Stop sharing the rows, otherwise changing them would copy them and the child indexes point to them
+    oldRows.clear();
 
-                it++;
-            }
+    //When most of the rows change (e.g. the first list), a reset is cheaper for the views than the row changes
+    if(rowsDiff.changedRows() > std::max(rowCount(QModelIndex()), newRows.size()) / 2)
+    {
+        beginResetModel();
+        mModelMutex.lockForWrite();
+        mStalledIssues = newRows;
+        mStalledIssuesByOrder.clear();
+        mModelMutex.unlock();
+        endResetModel();
 
-            endInsertRows();
-        }
+        finishUpdatingRows(0, receivedRows);
+        return;
+    }
 
-        totalRows = rowCount(QModelIndex());
-        rowsToBeInserted = static_cast<int>(mSolvedStalledIssues.size());
+    //Rows before the first changed one keep their order
+    auto firstChangedRow(rowCount(QModelIndex()));
 
-        if(rowsToBeInserted > 0)
+    for(auto& range : rowsDiff.removed())
+    {
+        beginRemoveRows(QModelIndex(), range.first, range.last);
+        mModelMutex.lockForWrite();
+        for(int row = range.first; row <= range.last; ++row)
         {
-             beginInsertRows(QModelIndex(), totalRows, totalRows + rowsToBeInserted - 1);
+            mStalledIssuesByOrder.remove(mStalledIssues.at(row).consultData().get());
+        }
+        mStalledIssues.erase(mStalledIssues.begin() + range.first, mStalledIssues.begin() + range.last + 1);
+        mModelMutex.unlock();
+        endRemoveRows();
 
-             for (auto it = mSolvedStalledIssues.begin(); it != mSolvedStalledIssues.end();)
-             {
-                 if(mThreadFinished)
-                 {
-                     return;
-                 }
+        firstChangedRow = range.first;
+    }
 
-                 StalledIssueVariant issue(*it);
-                 mStalledIssues.append(issue);
-                 mStalledIssuesByOrder.insert(issue.consultData().get(), rowCount(QModelIndex()) - 1);
-                 mCountByFilterCriterion[static_cast<int>(StalledIssueFilterCriterion::SOLVED_CONFLICTS)]++;
+    for(auto& range : rowsDiff.inserted())
+    {
+        beginInsertRows(QModelIndex(), range.first, range.last);
+        mModelMutex.lockForWrite();
+        for(int row = range.first; row <= range.last; ++row)
+        {
+            mStalledIssues.insert(row, newRows.at(row));
+        }
+        mModelMutex.unlock();
+        endInsertRows();
 
-                 it++;
-             }
+        firstChangedRow = std::min(firstChangedRow, range.first);
+    }
 
-             endInsertRows();
+    //Issues with the same key, filled again because something else changed
+    int firstUpdatedRow(-1);
+    int lastUpdatedRow(-1);
+    for(auto& kept : rowsDiff.kept())
+    {
+        auto row(kept.second);
+        auto& issue(newRows.at(row));
+        if(mStalledIssues.at(row).consultData() == issue.consultData())
+        {
+            continue;
         }
 
-        blockSignals(false);
+        mModelMutex.lockForWrite();
+        mStalledIssuesByOrder.remove(mStalledIssues.at(row).consultData().get());
+        mStalledIssuesByOrder.insert(issue.consultData().get(), row);
+        mStalledIssues[row] = issue;
         mModelMutex.unlock();
 
-        mIssuesRequested = false;
+        if(firstUpdatedRow >= 0 && row != lastUpdatedRow + 1)
+        {
+            emit dataChanged(index(firstUpdatedRow, 0), index(lastUpdatedRow, 0));
+            firstUpdatedRow = -1;
+        }
+        if(firstUpdatedRow < 0)
+        {
+            firstUpdatedRow = row;
+        }
+        lastUpdatedRow = row;
+    }
+    if(firstUpdatedRow >= 0)
+    {
+        emit dataChanged(index(firstUpdatedRow, 0), index(lastUpdatedRow, 0));
+    }
 
-        emit stalledIssuesCountChanged();
-        emit stalledIssuesReceived();
-        emit stalledIssuesChanged();
-    });
+    finishUpdatingRows(firstChangedRow, receivedRows);
+}
+
+void StalledIssuesModel::finishUpdatingRows(int firstChangedRow, int receivedRows)
+{
+    mModelMutex.lockForWrite();
+    for(int row = firstChangedRow; row < rowCount(QModelIndex()); ++row)
+    {
+        mStalledIssuesByOrder.insert(mStalledIssues.at(row).consultData().get(), row);
+    }
+
+    //The solved issues are after the received ones
+    mCountByFilterCriterion.clear();
+    for(int row = 0; row < rowCount(QModelIndex()); ++row)
+    {
+        auto criterion(row < receivedRows ? StalledIssue::getCriterionByReason(mStalledIssues.at(row).consultData()->getReason())
+                                          : StalledIssueFilterCriterion::SOLVED_CONFLICTS);
+        mCountByFilterCriterion[static_cast<int>(criterion)]++;
+    }
+    mModelMutex.unlock();
+
+    mIssuesRequested = false;
+
+    emit stalledIssuesCountChanged();
+    emit stalledIssuesReceived();
+    emit stalledIssuesChanged();
 }
 
 void StalledIssuesModel::onSendEvent()
@@ -337,48 +466,8 @@ void StalledIssuesModel::updateStalledIssues()
 
 void StalledIssuesModel::onNodesUpdate(mega::MegaApi*, mega::MegaNodeList* nodes)
 {
-    if(nodes)
-    {
-        mega::MegaNodeList* copiedNodes(nodes->copy());
-        Utilities::queueFunctionInObjectThread(mStalledIssuedReceiver, [this, copiedNodes]()
-        {
-            for (int i = 0; i < copiedNodes->size(); i++)
-            {
-                mega::MegaNode *node = copiedNodes->get(i);
-                if (node->getChanges() & mega::MegaNode::CHANGE_TYPE_PARENT)
-                {
-                    std::unique_ptr<mega::MegaNode> parentNode(MegaSyncApp->getMegaApi()->getNodeByHandle(node->getParentHandle()));
-                    if(parentNode && parentNode->getType() == mega::MegaNode::TYPE_FILE)
-                    {
-                        for(int row = 0; row < rowCount(QModelIndex()); ++row)
-                        {
-                            mModelMutex.lockForWrite();
-                            auto item = mStalledIssues.at(row);
-                            if(item.getData()->containsHandle(node->getHandle()))
-                            {
-                                auto parentFound(false);
-                                while (!parentFound)
-                                {
-                                    auto currentParentHandle(parentNode->getHandle());
-                                    auto parentNodeRaw(MegaSyncApp->getMegaApi()->getParentNode(parentNode.get()));
-                                    parentNode.reset(parentNodeRaw);
-                                    if(!parentNode || parentNode->getType() != mega::MegaNode::TYPE_FILE)
-                                    {
-                                        item.getData()->updateHandle(currentParentHandle);
-                                        item.getData()->resetUIUpdated();
-                                        parentFound = true;
-                                    }
-                                }
-                            }
-                            mModelMutex.unlock();
-                        }
-                    }
-                }
-            }
-            delete copiedNodes;
-        });
-    }
-    else
+    //The changes of the nodes are received in batches by onNodesChanged
+    if(!nodes)
     {
         auto stalledIssuesDialog = DialogOpener::findDialog<StalledIssuesDialog>();
         if (stalledIssuesDialog && stalledIssuesDialog->getDialog()->isActiveWindow())
@@ -399,6 +488,88 @@ void StalledIssuesModel::onNodesUpdate(mega::MegaApi*, mega::MegaNodeList* nodes
     }
 }
 
+void StalledIssuesModel::onNodesChanged(std::shared_ptr<const NodeChangeBatch> changes)
+{
+    if(changes->handles(NodeChangeBatch::MOVED).empty())
+    {
+        return;
+    }
+
+    Utilities::queueFunctionInObjectThread(mStalledIssuedReceiver, [this, changes]()
+    {
+        //Only the nodes moved under a file (new versions) change the issues.
+        //Each new parent is looked up once, not once per moved node
+        std::vector<NodeChangeBatch::Handle> fileParents;
+        for(auto parentHandle : changes->movedParents())
+        {
+            std::unique_ptr<mega::MegaNode> parentNode(MegaSyncApp->getMegaApi()->getNodeByHandle(parentHandle));
+            if(parentNode && parentNode->getType() == mega::MegaNode::TYPE_FILE)
+            {
+                fileParents.push_back(parentHandle);
+            }
+        }
+
+        std::vector<std::pair<NodeChangeBatch::Handle, NodeChangeBatch::Handle>> newVersions;
+        if(!fileParents.empty())
+        {
+            for(auto handle : changes->handles(NodeChangeBatch::MOVED))
+            {
+                auto parentHandle(changes->parentOf(handle));
+                if(std::binary_search(fileParents.begin(), fileParents.end(), parentHandle))
+                {
+                    newVersions.emplace_back(handle, parentHandle);
+                }
+            }
+        }
+
+        if(newVersions.empty())
+        {
+            return;
+        }
+
+        int firstRow(-1);
+        int lastRow(-1);
+        mModelMutex.lockForWrite();
+        for(int row = 0; row < mStalledIssues.size(); ++row)
+        {
+            auto item = mStalledIssues.at(row);
+            for(const auto& newVersion : newVersions)
+            {
+                if(item.getData()->containsHandle(newVersion.first))
+                {
+                    //The issue follows the topmost file of the versions chain
+                    std::unique_ptr<mega::MegaNode> parentNode(MegaSyncApp->getMegaApi()->getNodeByHandle(newVersion.second));
+                    while(parentNode)
+                    {
+                        auto currentParentHandle(parentNode->getHandle());
+                        parentNode.reset(MegaSyncApp->getMegaApi()->getParentNode(parentNode.get()));
+                        if(!parentNode || parentNode->getType() != mega::MegaNode::TYPE_FILE)
+                        {
+                            item.getData()->updateHandle(currentParentHandle);
+                            item.getData()->resetUIUpdated();
+                            firstRow = firstRow < 0 ? row : firstRow;
+                            lastRow = row;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        mModelMutex.unlock();
+
+        if(firstRow >= 0)
+        {
+            Utilities::queueFunctionInObjectThread(this, [this, firstRow, lastRow]()
+            {
+                if(lastRow < rowCount(QModelIndex()))
+                {
+                    emit dataChanged(index(firstRow, 0), index(lastRow, 0));
+                }
+            });
+        }
+    });
+}
+
 Qt::DropActions StalledIssuesModel::supportedDropActions() const
 {
     return Qt::IgnoreAction;
@@ -484,8 +655,9 @@ QModelIndex StalledIssuesModel::index(int row, int column, const QModelIndex& pa
 {
     if(parent.isValid() && mStalledIssues.size() > parent.row())
     {
-        auto& stalledIssue = mStalledIssues[parent.row()];
-        return createIndex(0, 0, &stalledIssue);
+        //at() does not detach the rows, so the child index points to the row kept by the model
+        auto& stalledIssue = mStalledIssues.at(parent.row());
+        return createIndex(0, 0, const_cast<StalledIssueVariant*>(&stalledIssue));
     }
     else
     {
@@ -771,32 +943,101 @@ void StalledIssuesModel::solveListOfIssues(const SolveListInfo &info)
            info.startFunc();
        }
 
-       auto issueCounter(1);
        auto issuesFixed(0);
        auto issuesExternallyChanged(0);
-       auto totalRows(info.indexes.size());
+
+       //Issues grouped by sync and folder, so that the checks and solutions of a batch work on the same folders
+       StalledIssuesVariantList issues;
+       std::vector<int> groupOfIssue;
+       //What the checks look up, copied from the issues so that the pool never touches them
+       QVector<ExternalChangeProbes> probes;
+       QSet<const StalledIssue*> addedIssues;
+       QHash<QPair<mega::MegaHandle, QString>, int> groups;
+       //Write lock, as the probes may refresh the cached node of the issue
+       mModelMutex.lockForWrite();
        foreach(auto index, info.indexes)
        {
-           if(checkIfUserStopSolving())
+           auto potentialIndex = getSolveIssueIndex(index);
+           auto issue(mStalledIssues.at(potentialIndex.row()));
+           //The same issue can be selected through its row and through its child row
+           if(issue.consultData() && !addedIssues.contains(issue.consultData().get()))
            {
-               break;
+               addedIssues.insert(issue.consultData().get());
+
+               auto syncId(issue.consultData()->syncIds().isEmpty() ? mega::INVALID_HANDLE
+                                                                     : issue.consultData()->syncIds().first());
+               QString folder;
+               if(auto localData = issue.consultData()->consultLocalData())
+               {
+                   folder = QFileInfo(localData->getPath().path).path();
+               }
+               else if(auto cloudData = issue.consultData()->consultCloudData())
+               {
+                   folder = QFileInfo(cloudData->getPath().path).path();
+               }
+
+               auto group(groups.value(qMakePair(syncId, folder), groups.size()));
+               groups.insert(qMakePair(syncId, folder), group);
+               groupOfIssue.push_back(group);
+               probes.append(issue.consultData()->getExternalChangeProbes());
+               issues.append(issue);
            }
+       }
+       mModelMutex.unlock();
+
+       auto totalRows(issues.size());
+       StalledIssuesBatches batches(groupOfIssue, SOLVE_BATCH_SIZE);
 
-           mModelMutex.lockForWrite();
+       //The file system and SDK lookups run in the pool ahead of the batch being solved. If none of
+       //them changed, checkForExternalChanges would not find anything either
+       auto checkIssue = [probes](int issue) -> bool
+       {
+           foreach(const auto& probe, probes.at(issue))
+           {
+               if(probe.hasChanged())
+               {
+                   return true;
+               }
+           }
+           return false;
+       };
 
-           sendFixingIssuesMessage(issueCounter, totalRows);
+       //Groups with issues solved by an earlier batch: their files may have changed since they were probed
+       QSet<int> touchedGroups;
 
-           auto potentialIndex = getSolveIssueIndex(index);
-           auto issue(mStalledIssues.at(potentialIndex.row()));
-           if(issue.getData())
+       auto solveBatch = [this, &info, &issues, &groupOfIssue, &batches, &touchedGroups,
+                          &issuesFixed, &issuesExternallyChanged, totalRows]
+           (int batch, const std::vector<char>& externallyChanged) -> bool
+       {
+           if(checkIfUserStopSolving())
+           {
+               return false;
+           }
+
+           //Progress is reported once per batch
+           auto range(batches.batch(batch));
+           sendFixingIssuesMessage(range.end, totalRows);
+
+           QSet<int> solvedGroups;
+           for(int position = range.begin; position < range.end; ++position)
            {
-               if(issue.getData()->checkForExternalChanges())
+               auto issueIndex(batches.order()[position]);
+               auto issue(issues.at(issueIndex));
+               auto group(groupOfIssue[issueIndex]);
+
+               //Each issue is checked again and solved with the model locked for writing, as the views
+               //read the data changed here. The check only looks things up again when needed
+               mModelMutex.lockForWrite();
+               auto recheck(externallyChanged[position - range.begin] || touchedGroups.contains(group)
+                            || issue.consultData()->isSolved());
+               if(recheck && issue.getData()->checkForExternalChanges())
                {
                    issuesExternallyChanged++;
                }
                else
                {
-                   if(info.solveFunc && info.solveFunc(potentialIndex.row()))
+                   auto row(mStalledIssuesByOrder.value(issue.consultData().get(), -1));
+                   if(row >= 0 && info.solveFunc && info.solveFunc(row))
                    {
                        if(!issue.getData()->isSolved())
                        {
@@ -804,13 +1045,17 @@ void StalledIssuesModel::solveListOfIssues(const SolveListInfo &info)
                        }
                        issuesFixed++;
                        issueSolved(issue);
+                       solvedGroups.insert(group);
                    }
                }
+               mModelMutex.unlock();
            }
-           issueCounter++;
 
-           mModelMutex.unlock();
-       }
+           touchedGroups.unite(solvedGroups);
+           return true;
+       };
+
+       batches.solve(*ThreadPoolSingleton::getInstance(), checkIssue, solveBatch);
 
        if(!info.async)
        {
@@ -1268,19 +1513,17 @@ void StalledIssuesModel::semiAutoSolveNameConflictIssues(const QModelIndexList&
 {
     auto resolveIssue = [this, option](int row) -> bool
     {
+        //solveListOfIssues has already checked the issue for external changes
         auto item = mStalledIssues.at(row);
-        if(!item.getData()->checkForExternalChanges())
+        if(item.consultData()->getReason() == mega::MegaSyncStall::SyncStallReason::NamesWouldClashWhenSynced)
         {
-            if(item.consultData()->getReason() == mega::MegaSyncStall::SyncStallReason::NamesWouldClashWhenSynced)
+            if(auto nameConflict = item.convert<NameConflictedStalledIssue>())
             {
-                if(auto nameConflict = item.convert<NameConflictedStalledIssue>())
+                nameConflict->semiAutoSolveIssue(option);
+                if(item.consultData()->isSolved())
                 {
-                    nameConflict->semiAutoSolveIssue(option);
-                    if(item.consultData()->isSolved())
-                    {
-                        MegaSyncApp->getStatsEventHandler()->sendEvent(AppStatsEvents::EventType::SI_NAMECONFLICT_SOLVED_SEMI_AUTOMATICALLY);
-                        return true;
-                    }
+                    MegaSyncApp->getStatsEventHandler()->sendEvent(AppStatsEvents::EventType::SI_NAMECONFLICT_SOLVED_SEMI_AUTOMATICALLY);
+                    return true;
                 }
             }
         }
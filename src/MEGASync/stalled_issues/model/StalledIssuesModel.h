@@ -7,6 +7,8 @@
 #include "StalledIssuesUtilities.h"
 #include "ViewLoadingScene.h"
 #include "QMegaMessageBox.h"
+#include "StalledIssuesDiff.h"
+#include "control/NodeChangeBatch.h"
 
 #include <QObject>
 #include <QReadWriteLock>
@@ -45,9 +47,20 @@ protected:
     void onRequestFinish(::mega::MegaApi*, ::mega::MegaRequest* request, ::mega::MegaError*);
 
 private:
+    StalledIssueVariant createIssue(const mega::MegaSyncStall* stall);
+
     QMutex mCacheMutex;
     StalledIssuesReceived mCacheStalledIssues;
     std::atomic_bool mIsEventRequest { false };
+
+    //Issues of the last list, reused when the same stall is received again
+    struct KnownIssue
+    {
+        StalledIssueVariant issue;
+        unsigned int refresh = 0;
+    };
+    QHash<StalledIssueKey, KnownIssue> mKnownIssues;
+    unsigned int mRefresh = 0;
 };
 
 Q_DECLARE_METATYPE(StalledIssuesReceiver::StalledIssuesReceived);
@@ -157,6 +170,7 @@ protected slots:
 
 private slots:
     void onProcessStalledIssues(StalledIssuesReceiver::StalledIssuesReceived issuesReceived);
+    void onNodesChanged(std::shared_ptr<const NodeChangeBatch> changes);
     void onSendEvent();
 
 private:
@@ -164,6 +178,11 @@ private:
 
     void removeRows(QModelIndexList& indexesToRemove);
     bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) override;
+    using RowsDiff = StalledIssuesDiff<StalledIssueKey, StalledIssueKey::Hash>;
+    static RowsDiff diffRows(const StalledIssuesVariantList& oldRows, const StalledIssuesVariantList& newRows);
+    void updateRows(StalledIssuesVariantList& oldRows, const StalledIssuesVariantList& newRows,
+                    int receivedRows, const RowsDiff& diff);
+    void finishUpdatingRows(int firstChangedRow, int receivedRows);
     void updateStalledIssuedByOrder();
     void reset();
     QModelIndex getSolveIssueIndex(const QModelIndex& index);
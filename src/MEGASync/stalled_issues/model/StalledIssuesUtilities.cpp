@@ -156,6 +156,15 @@ mega::MegaHandle StalledIssuesBySyncFilter::filterByPath(const QString &path, bo
         {
             return mSyncIdCache.value(key);
         }
+
+        auto syncSetting(SyncInfo::instance()->findSyncForLocalPath(path));
+        if(!syncSetting)
+        {
+            return mega::INVALID_HANDLE;
+        }
+
+        mSyncIdCache.insert(key, syncSetting->backupId());
+        return syncSetting->backupId();
     }
 
     std::unique_ptr<mega::MegaSyncList> syncList(MegaSyncApp->getMegaApi()->getSyncs());
@@ -166,25 +175,12 @@ mega::MegaHandle StalledIssuesBySyncFilter::filterByPath(const QString &path, bo
 
         if(syncSetting)
         {
-            if(cloud)
-            {
-                auto remoteFolder(syncSetting->getMegaFolder());
-                auto commonPath = Utilities::getCommonPath(path, remoteFolder, cloud);
-                if(commonPath == remoteFolder)
-                {
-                    mSyncIdCache.insert(key, syncId);
-                    return syncId;
-                }
-            }
-            else
+            auto remoteFolder(syncSetting->getMegaFolder());
+            auto commonPath = Utilities::getCommonPath(path, remoteFolder, cloud);
+            if(commonPath == remoteFolder)
             {
-                auto localFolder(syncSetting->getLocalFolder());
-                auto commonPath = Utilities::getCommonPath(path, localFolder, cloud);
-                if(commonPath == localFolder)
-                {
-                    mSyncIdCache.insert(key, syncId);
-                    return syncId;
-                }
+                mSyncIdCache.insert(key, syncId);
+                return syncId;
             }
         }
     }
@@ -23,6 +23,8 @@ set(DESKTOP_APP_STALLED_ISSUES_HEADERS
     stalled_issues/model/NameConflictStalledIssue.h
     stalled_issues/model/StalledIssuesUtilities.h
     stalled_issues/model/StalledIssuesModel.h
+    stalled_issues/model/StalledIssuesDiff.h
+    stalled_issues/model/StalledIssuesBatches.h
     stalled_issues/model/StalledIssue.h
     stalled_issues/model/StalledIssuesProxyModel.h
 )
@@ -54,6 +54,8 @@ HEADERS  +=   \
     $$PWD/model/NameConflictStalledIssue.h \
     $$PWD/model/StalledIssuesUtilities.h \
     $$PWD/model/StalledIssuesModel.h \
+    $$PWD/model/StalledIssuesDiff.h \
+    $$PWD/model/StalledIssuesBatches.h \
     $$PWD/model/StalledIssue.h \
     $$PWD/model/StalledIssuesProxyModel.h
 
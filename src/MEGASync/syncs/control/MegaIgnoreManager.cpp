@@ -138,6 +138,19 @@ void MegaIgnoreManager::parseIgnoresFile()
     }
 }
 
+std::shared_ptr<MegaIgnoreMatcher> MegaIgnoreManager::compileMatcher() const
+{
+    std::vector<std::string> ruleLines;
+    for (const auto& rule : mRules)
+    {
+        if (rule->isValid() && !rule->isCommented() && !rule->isDeleted())
+        {
+            ruleLines.push_back(rule->getModifiedRule().toStdString());
+        }
+    }
+    return std::make_shared<MegaIgnoreMatcher>(ruleLines);
+}
+
 std::shared_ptr<MegaIgnoreSizeRule> MegaIgnoreManager::getLowLimitRule() const
 {
     return mLowLimitRule;
@@ -2,6 +2,7 @@
 #define MEGAIGNOREMANAGER_H
 
 #include <syncs/control/MegaIgnoreRules.h>
+#include <syncs/control/MegaIgnoreMatcher.h>
 
 #include <QString>
 #include <QFile>
@@ -39,6 +40,9 @@ public:
 
     void parseIgnoresFile();
 
+    // Compiles the enabled rules, including the changes not applied yet (to preview them)
+    std::shared_ptr<MegaIgnoreMatcher> compileMatcher() const;
+
     std::shared_ptr<MegaIgnoreNameRule> addIgnoreSymLinksRule();
     std::shared_ptr<MegaIgnoreNameRule> addIgnoreSymLinkRule(const QString& pattern);
     std::shared_ptr<MegaIgnoreNameRule> addNameRule(MegaIgnoreNameRule::Class classType
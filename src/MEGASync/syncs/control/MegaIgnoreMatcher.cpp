@@ -0,0 +1,592 @@
+#include "MegaIgnoreMatcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <queue>
+
+constexpr std::size_t MegaIgnoreMatcher::EVALUATE_CHUNK_SIZE;
+
+namespace
+{
+// Anchors added around the subjects, so "name", "prefix*" and "*suffix" are plain substrings
+constexpr char SUBJECT_BEGIN = '\x02';
+constexpr char SUBJECT_END = '\x03';
+
+constexpr char LARGE_SIZE_RULE[] = "exclude-larger";
+constexpr char SMALL_SIZE_RULE[] = "exclude-smaller";
+
+char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string toLowerAscii(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) { return toLowerAscii(c); });
+    return text;
+}
+
+bool hasGlobSpecials(const std::string& text)
+{
+    return text.find_first_of("?[\\") != std::string::npos;
+}
+}
+
+struct MegaIgnoreMatcher::CompiledSubject
+{
+    using Transitions = std::array<int, 256>;
+
+    explicit CompiledSubject(bool isCaseSensitive)
+        : caseSensitive(isCaseSensitive)
+    {
+        addState();
+    }
+
+    int addState()
+    {
+        Transitions transitions;
+        transitions.fill(-1);
+        next.push_back(transitions);
+        outputs.emplace_back();
+        return static_cast<int>(next.size() - 1);
+    }
+
+    void addLiteral(const std::string& literal, int ruleIndex)
+    {
+        int state = 0;
+        for (auto c : literal)
+        {
+            auto index = static_cast<unsigned char>(c);
+            if (next[state][index] < 0)
+            {
+                auto added = addState();
+                next[state][index] = added;
+            }
+            state = next[state][index];
+        }
+        outputs[state].push_back(ruleIndex);
+    }
+
+    // Turns the trie into a complete automaton: missing transitions follow the failure links
+    void build()
+    {
+        std::vector<int> failure(next.size(), 0);
+        std::queue<int> pending;
+        for (auto& target : next[0])
+        {
+            if (target < 0)
+            {
+                target = 0;
+            }
+            else
+            {
+                pending.push(target);
+            }
+        }
+
+        while (!pending.empty())
+        {
+            auto state = pending.front();
+            pending.pop();
+            for (std::size_t c = 0; c < next[state].size(); ++c)
+            {
+                auto target = next[state][c];
+                if (target < 0)
+                {
+                    next[state][c] = next[failure[state]][c];
+                    continue;
+                }
+
+                failure[target] = next[failure[state]][c];
+                const auto& inherited = outputs[failure[target]];
+                outputs[target].insert(outputs[target].end(), inherited.begin(), inherited.end());
+                pending.push(target);
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        return next.size() == 1 && extensions.empty() && matchAll.empty() && globs.empty() && regexes.empty();
+    }
+
+    template <typename Func>
+    void forEachMatch(const std::string& subject, Func&& onMatch) const
+    {
+        const std::string* text = &subject;
+        std::string lowered;
+        if (!caseSensitive)
+        {
+            lowered = toLowerAscii(subject);
+            text = &lowered;
+        }
+
+        for (auto ruleIndex : matchAll)
+        {
+            onMatch(ruleIndex);
+        }
+
+        if (next.size() > 1)
+        {
+            auto feed = [this, &onMatch](int state, char c)
+            {
+                state = next[state][static_cast<unsigned char>(c)];
+                for (auto ruleIndex : outputs[state])
+                {
+                    onMatch(ruleIndex);
+                }
+                return state;
+            };
+
+            int state = feed(0, SUBJECT_BEGIN);
+            for (auto c : *text)
+            {
+                state = feed(state, c);
+            }
+            feed(state, SUBJECT_END);
+        }
+
+        if (!extensions.empty())
+        {
+            auto dot = text->rfind('.');
+            if (dot != std::string::npos)
+            {
+                auto it = extensions.find(text->substr(dot + 1));
+                if (it != extensions.end())
+                {
+                    for (auto ruleIndex : it->second)
+                    {
+                        onMatch(ruleIndex);
+                    }
+                }
+            }
+        }
+
+        for (const auto& glob : globs)
+        {
+            if (matchesGlob(glob.first.c_str(), text->c_str()))
+            {
+                onMatch(glob.second);
+            }
+        }
+
+        for (const auto& regex : regexes)
+        {
+            if (std::regex_match(subject, regex.first))
+            {
+                onMatch(regex.second);
+            }
+        }
+    }
+
+    const bool caseSensitive;
+    std::vector<Transitions> next;
+    std::vector<std::vector<int>> outputs;
+    std::unordered_map<std::string, std::vector<int>> extensions;
+    std::vector<int> matchAll;
+    std::vector<std::pair<std::string, int>> globs;
+    std::vector<std::pair<std::regex, int>> regexes;
+};
+
+MegaIgnoreMatcher::MegaIgnoreMatcher(const std::vector<std::string>& ruleLines)
+{
+    for (auto isPath : {0, 1})
+    {
+        for (auto isCaseSensitive : {0, 1})
+        {
+            mSubjects[isPath][isCaseSensitive].reset(new CompiledSubject(isCaseSensitive != 0));
+        }
+    }
+
+    for (auto line : ruleLines)
+    {
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+        {
+            line.pop_back();
+        }
+
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        if (!parseSizeRule(line))
+        {
+            parseNameRule(line, mRules.size());
+        }
+    }
+
+    for (auto& subjects : mSubjects)
+    {
+        for (auto& subject : subjects)
+        {
+            subject->build();
+            if (subject->empty())
+            {
+                subject.reset();
+            }
+        }
+    }
+}
+
+MegaIgnoreMatcher::~MegaIgnoreMatcher() = default;
+
+bool MegaIgnoreMatcher::isExcluded(const Entry& entry) const
+{
+    FolderCache folders;
+    return isExcluded(entry, folders);
+}
+
+std::vector<char> MegaIgnoreMatcher::evaluate(const std::vector<Entry>& entries, ThreadPool& pool) const
+{
+    std::vector<char> results(entries.size(), 0);
+    std::vector<std::future<void>> chunks;
+    for (std::size_t begin = 0; begin < entries.size(); begin += EVALUATE_CHUNK_SIZE)
+    {
+        auto end = std::min(entries.size(), begin + EVALUATE_CHUNK_SIZE);
+        chunks.push_back(pool.submit([this, &entries, &results, begin, end]()
+        {
+            // Entries of the same folder are usually together, so their ancestors are only
+            // evaluated once per chunk
+            FolderCache folders;
+            for (auto index = begin; index < end; ++index)
+            {
+                results[index] = isExcluded(entries[index], folders) ? 1 : 0;
+            }
+        }, ThreadPool::Priority::INTERACTIVE));
+    }
+
+    for (auto& chunk : chunks)
+    {
+        chunk.get();
+    }
+    return results;
+}
+
+std::size_t MegaIgnoreMatcher::ruleCount() const
+{
+    return mRules.size() + (mHasLowLimit ? 1 : 0) + (mHasHighLimit ? 1 : 0);
+}
+
+bool MegaIgnoreMatcher::matchesGlob(const char* pattern, const char* text)
+{
+    // Backtracks to the last '*' only, which is enough for globs
+    const char* starPattern = nullptr;
+    const char* starText = nullptr;
+    while (*text)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = ++pattern;
+            starText = text;
+            continue;
+        }
+
+        bool matched = false;
+        const char* afterPattern = pattern + 1;
+        if (*pattern == '?')
+        {
+            matched = true;
+        }
+        else if (*pattern == '[')
+        {
+            const char* set = pattern + 1;
+            bool negated = *set == '!' || *set == '^';
+            if (negated)
+            {
+                ++set;
+            }
+
+            bool inSet = false;
+            const char* current = set;
+            while (*current && (*current != ']' || current == set))
+            {
+                if (current[1] == '-' && current[2] && current[2] != ']')
+                {
+                    inSet = inSet || (*text >= current[0] && *text <= current[2]);
+                    current += 3;
+                }
+                else
+                {
+                    inSet = inSet || *text == *current;
+                    ++current;
+                }
+            }
+
+            if (*current == ']')
+            {
+                matched = inSet != negated;
+                afterPattern = current + 1;
+            }
+            else
+            {
+                // Unterminated set: a literal '['
+                matched = *text == '[';
+            }
+        }
+        else if (*pattern == '\\' && pattern[1])
+        {
+            matched = pattern[1] == *text;
+            afterPattern = pattern + 2;
+        }
+        else
+        {
+            matched = *pattern && *pattern == *text;
+        }
+
+        if (matched)
+        {
+            pattern = afterPattern;
+            ++text;
+        }
+        else if (starPattern)
+        {
+            pattern = starPattern;
+            text = ++starText;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+    {
+        ++pattern;
+    }
+    return !*pattern;
+}
+
+// "<class><target><type><strategy>:<pattern>", for example "-f:*.tmp" or "+pR:^docs/.*$"
+bool MegaIgnoreMatcher::parseNameRule(const std::string& line, std::size_t ruleIndex)
+{
+    auto colon = line.find(':');
+    if (colon == std::string::npos || colon == 0 || (line[0] != '-' && line[0] != '+'))
+    {
+        return false;
+    }
+
+    Rule rule{line[0] == '-', Target::ALL, Scope::NAME};
+    bool isRegex = false;
+    bool caseSensitive = false;
+    for (std::size_t i = 1; i < colon; ++i)
+    {
+        switch (line[i])
+        {
+            case 'a': rule.target = Target::ALL; break;
+            case 'd': rule.target = Target::FOLDER; break;
+            case 'f': rule.target = Target::FILE; break;
+            case 's': rule.target = Target::SYMLINK; break;
+            case 'N': rule.scope = Scope::LOCAL_NAME; break;
+            case 'n': rule.scope = Scope::NAME; break;
+            case 'p': rule.scope = Scope::PATH; break;
+            case 'g': isRegex = false; caseSensitive = false; break;
+            case 'G': isRegex = false; caseSensitive = true; break;
+            case 'r': isRegex = true; caseSensitive = false; break;
+            case 'R': isRegex = true; caseSensitive = true; break;
+            default: return false;
+        }
+    }
+
+    auto pattern = line.substr(colon + 1);
+    auto& subject = *mSubjects[rule.scope == Scope::PATH][caseSensitive];
+    auto index = static_cast<int>(ruleIndex);
+
+    if (isRegex)
+    {
+        try
+        {
+            auto flags = std::regex::ECMAScript | std::regex::optimize;
+            subject.regexes.emplace_back(std::regex(pattern, caseSensitive ? flags : flags | std::regex::icase), index);
+        }
+        catch (const std::regex_error&)
+        {
+            return false;
+        }
+        mRules.push_back(rule);
+        return true;
+    }
+
+    if (!caseSensitive)
+    {
+        pattern = toLowerAscii(pattern);
+    }
+
+    auto firstStar = pattern.find('*');
+    auto lastStar = pattern.rfind('*');
+    auto literal = pattern;
+    bool leadingStar = false;
+    bool trailingStar = false;
+    if (firstStar != std::string::npos)
+    {
+        leadingStar = firstStar == 0;
+        trailingStar = lastStar == pattern.size() - 1;
+        auto literalBegin = pattern.find_first_not_of('*');
+        auto literalEnd = pattern.find_last_not_of('*');
+        literal = literalBegin == std::string::npos ? std::string() : pattern.substr(literalBegin, literalEnd - literalBegin + 1);
+    }
+
+    if (hasGlobSpecials(pattern) || literal.find('*') != std::string::npos)
+    {
+        subject.globs.emplace_back(pattern, index);
+    }
+    else if (literal.empty())
+    {
+        subject.matchAll.push_back(index);
+    }
+    else if (leadingStar && !trailingStar && literal[0] == '.' && literal.find('.', 1) == std::string::npos)
+    {
+        subject.extensions[literal.substr(1)].push_back(index);
+    }
+    else
+    {
+        subject.addLiteral((leadingStar ? std::string() : std::string(1, SUBJECT_BEGIN))
+                           + literal
+                           + (trailingStar ? std::string() : std::string(1, SUBJECT_END)), index);
+    }
+
+    mRules.push_back(rule);
+    return true;
+}
+
+// "exclude-larger:<size>" and "exclude-smaller:<size>", size in bytes or with a k, m or g unit
+bool MegaIgnoreMatcher::parseSizeRule(const std::string& line)
+{
+    auto colon = line.find(':');
+    if (colon == std::string::npos)
+    {
+        return false;
+    }
+
+    auto kind = line.substr(0, colon);
+    bool isHigh = kind == LARGE_SIZE_RULE;
+    if (!isHigh && kind != SMALL_SIZE_RULE)
+    {
+        return false;
+    }
+
+    const char* value = line.c_str() + colon + 1;
+    char* unit = nullptr;
+    long long size = std::strtoll(value, &unit, 10);
+    if (unit == value || size < 0)
+    {
+        return true;
+    }
+
+    switch (toLowerAscii(*unit))
+    {
+        case 'g': size *= 1024;
+        // fall through
+        case 'm': size *= 1024;
+        // fall through
+        case 'k': size *= 1024;
+        // fall through
+        default: break;
+    }
+
+    if (isHigh)
+    {
+        mHasHighLimit = true;
+        mHighLimit = size;
+    }
+    else
+    {
+        mHasLowLimit = true;
+        mLowLimit = size;
+    }
+    return true;
+}
+
+bool MegaIgnoreMatcher::isApplicable(int ruleIndex, EntryType type, bool isRootEntry) const
+{
+    const auto& rule = mRules[static_cast<std::size_t>(ruleIndex)];
+    if (rule.scope == Scope::LOCAL_NAME && !isRootEntry)
+    {
+        return false;
+    }
+
+    switch (rule.target)
+    {
+        case Target::FOLDER: return type == EntryType::FOLDER;
+        case Target::FILE: return type == EntryType::FILE;
+        case Target::SYMLINK: return type == EntryType::SYMLINK;
+        default: return true;
+    }
+}
+
+int MegaIgnoreMatcher::lastMatchingRule(const std::string& path, std::size_t nameStart, EntryType type) const
+{
+    int last = -1;
+    const bool isRootEntry = nameStart == 0;
+    auto onMatch = [this, &last, type, isRootEntry](int ruleIndex)
+    {
+        if (ruleIndex > last && isApplicable(ruleIndex, type, isRootEntry))
+        {
+            last = ruleIndex;
+        }
+    };
+
+    std::string name;
+    for (auto isPath : {0, 1})
+    {
+        for (const auto& subject : mSubjects[isPath])
+        {
+            if (!subject)
+            {
+                continue;
+            }
+
+            if (isPath)
+            {
+                subject->forEachMatch(path, onMatch);
+            }
+            else
+            {
+                if (name.empty())
+                {
+                    name = path.substr(nameStart);
+                }
+                subject->forEachMatch(name, onMatch);
+            }
+        }
+    }
+    return last;
+}
+
+bool MegaIgnoreMatcher::isExcludedBySize(const Entry& entry) const
+{
+    return entry.type == EntryType::FILE
+           && ((mHasLowLimit && entry.size < mLowLimit) || (mHasHighLimit && entry.size > mHighLimit));
+}
+
+bool MegaIgnoreMatcher::isExcluded(const Entry& entry, FolderCache& folders) const
+{
+    std::size_t nameStart = 0;
+    for (auto separator = entry.path.find('/'); separator != std::string::npos; separator = entry.path.find('/', separator + 1))
+    {
+        if (separator > nameStart)
+        {
+            auto folder = entry.path.substr(0, separator);
+            auto it = folders.find(folder);
+            if (it == folders.end())
+            {
+                auto rule = lastMatchingRule(folder, nameStart, EntryType::FOLDER);
+                it = folders.emplace(std::move(folder), rule >= 0 && mRules[static_cast<std::size_t>(rule)].exclude).first;
+            }
+
+            if (it->second)
+            {
+                return true;
+            }
+        }
+        nameStart = separator + 1;
+    }
+
+    auto rule = lastMatchingRule(entry.path, nameStart, entry.type);
+    if (rule >= 0 && mRules[static_cast<std::size_t>(rule)].exclude)
+    {
+        return true;
+    }
+    return isExcludedBySize(entry);
+}
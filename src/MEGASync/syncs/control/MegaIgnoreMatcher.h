@@ -0,0 +1,107 @@
+#ifndef MEGAIGNOREMATCHER_H
+#define MEGAIGNOREMATCHER_H
+
+#include "ThreadPool.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Evaluates the rules of a .megaignore file against many local paths.
+//
+// The rules are compiled once:
+//  - Glob patterns made of one literal with optional leading/trailing '*' ("name", "prefix*",
+//    "*suffix", "*part*") are merged into one Aho-Corasick automaton per subject (name or path,
+//    case sensitive or not), so one pass over a name finds all of them.
+//  - Extension rules ("*.ext") go to a hash set keyed by extension.
+//  - Size rules become a range check.
+//  - Other globs and the regular expressions are tried one by one.
+// As in the SDK, the last rule that matches decides, and the contents of an excluded folder
+// are excluded too.
+class MegaIgnoreMatcher
+{
+public:
+    static constexpr std::size_t EVALUATE_CHUNK_SIZE = 4096;
+
+    enum class EntryType
+    {
+        FILE,
+        FOLDER,
+        SYMLINK
+    };
+
+    struct Entry
+    {
+        std::string path; // Relative to the sync root, '/' separated, UTF-8
+        EntryType type;
+        long long size;
+    };
+
+    // Lines as written in .megaignore; commented and invalid lines are skipped
+    explicit MegaIgnoreMatcher(const std::vector<std::string>& ruleLines);
+    ~MegaIgnoreMatcher();
+
+    MegaIgnoreMatcher(const MegaIgnoreMatcher&) = delete;
+    MegaIgnoreMatcher& operator=(const MegaIgnoreMatcher&) = delete;
+
+    bool isExcluded(const Entry& entry) const;
+
+    // One value per entry (1 if excluded). The entries are split in chunks run on pool with
+    // interactive priority; do not call it from a task of the same pool
+    std::vector<char> evaluate(const std::vector<Entry>& entries, ThreadPool& pool) const;
+
+    std::size_t ruleCount() const;
+
+    // '*' any sequence, '?' any character, '[...]' a set ("[!...]" negated, "a-z" ranges)
+    static bool matchesGlob(const char* pattern, const char* text);
+
+private:
+    enum class Target
+    {
+        ALL,
+        FOLDER,
+        FILE,
+        SYMLINK
+    };
+
+    enum class Scope
+    {
+        LOCAL_NAME, // N: entries in the sync root only
+        NAME,       // n
+        PATH        // p
+    };
+
+    struct Rule
+    {
+        bool exclude;
+        Target target;
+        Scope scope;
+    };
+
+    struct CompiledSubject;
+    using FolderCache = std::unordered_map<std::string, bool>;
+
+    bool parseNameRule(const std::string& line, std::size_t ruleIndex);
+    bool parseSizeRule(const std::string& line);
+
+    bool isApplicable(int ruleIndex, EntryType type, bool isRootEntry) const;
+    // Index of the last rule matching the entry itself, or -1
+    int lastMatchingRule(const std::string& path, std::size_t nameStart, EntryType type) const;
+    bool isExcludedBySize(const Entry& entry) const;
+    bool isExcluded(const Entry& entry, FolderCache& folders) const;
+
+    std::vector<Rule> mRules;
+    // [scope is PATH][case sensitive]
+    std::array<std::array<std::unique_ptr<CompiledSubject>, 2>, 2> mSubjects;
+
+    bool mHasLowLimit = false;
+    long long mLowLimit = 0;
+    bool mHasHighLimit = false;
+    long long mHighLimit = 0;
+};
+
+#endif // MEGAIGNOREMATCHER_H
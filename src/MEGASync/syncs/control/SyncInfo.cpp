@@ -9,6 +9,8 @@
 
 #include <assert.h>
 
+#include <QDir>
+
 using namespace mega;
 
 #ifdef WIN32
@@ -76,6 +78,7 @@ void SyncInfo::removeSyncedFolderByBackupId(MegaHandle backupId)
 
     preferences->removeSyncSetting(cs);
     configuredSyncsMap.remove(backupId);
+    mLocalRoots.remove(backupId);
 
     auto type (cs->getType());
 
@@ -113,6 +116,7 @@ void SyncInfo::removeAllFolders()
     }
     configuredSyncs.clear();
     configuredSyncsMap.clear();
+    mLocalRoots.clear();
     syncsSettingPickedFromOldConfig.clear();
     unattendedDisabledSyncs.clear();
 }
@@ -257,6 +261,8 @@ std::shared_ptr<SyncSettings> SyncInfo::updateSyncSettings(MegaSync *sync)
         configuredSyncs[static_cast<SyncType>(sync->getType())].append(sync->getBackupId());
     }
 
+    mLocalRoots.insert(toLocalRootKey(cs->getLocalFolder()), sync->getBackupId());
+
     //queue an update of the sync remote node
     ThreadPoolSingleton::getInstance()->push([this, cs]()
     {//thread pool function
@@ -315,6 +321,7 @@ void SyncInfo::reset()
     QMutexLocker qm(&syncMutex);
     configuredSyncs.clear();
     configuredSyncsMap.clear();
+    mLocalRoots.clear();
     syncsSettingPickedFromOldConfig.clear();
     unattendedDisabledSyncs.clear();
     mIsFirstTwoWaySyncDone = false;
@@ -531,6 +538,31 @@ std::shared_ptr<SyncSettings> SyncInfo::getSyncSettingByTag(MegaHandle tag) cons
     return configuredSyncsMap.value(tag, nullptr);
 }
 
+std::shared_ptr<SyncSettings> SyncInfo::findSyncForLocalPath(const QString& localPath) const
+{
+    const auto key (toLocalRootKey(localPath));
+
+    QMutexLocker qm(&syncMutex);
+
+    const auto backupId (mLocalRoots.find(key));
+    if (backupId == SyncPathTrie::INVALID_ID)
+    {
+        return nullptr;
+    }
+    return configuredSyncsMap.value(backupId, nullptr);
+}
+
+std::string SyncInfo::toLocalRootKey(QString localPath)
+{
+#ifdef WIN32
+    if (localPath.startsWith(QString::fromUtf8("\\\\?\\")))
+    {
+        localPath = localPath.mid(4);
+    }
+#endif
+    return QDir::fromNativeSeparators(localPath).toStdString();
+}
+
 void SyncInfo::saveUnattendedDisabledSyncs()
 {
     if (preferences->logged())
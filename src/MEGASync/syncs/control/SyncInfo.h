@@ -1,6 +1,7 @@
 #pragma once
 
 #include "syncs/control/SyncSettings.h"
+#include "syncs/control/SyncPathTrie.h"
 #include "QTMegaListener.h"
 
 #include "megaapi.h"
@@ -70,6 +71,9 @@ protected:
     QMap<mega::MegaHandle, std::shared_ptr<SyncSettings>> syncsSettingPickedFromOldConfig;
     QMap<SyncType, QSet<mega::MegaHandle>> unattendedDisabledSyncs; //Tags of syncs disabled due to errors since last dismissed
     std::unique_ptr<mega::QTMegaListener> delegateListener;
+    SyncPathTrie mLocalRoots; // Local folders of configuredSyncsMap
+
+    static std::string toLocalRootKey(QString localPath);
 
 public:
     static const QVector<SyncType> AllHandledSyncTypes;
@@ -102,6 +106,8 @@ public:
     // Getters
     std::shared_ptr<SyncSettings> getSyncSetting(int num, SyncType type);
     std::shared_ptr<SyncSettings> getSyncSettingByTag(mega::MegaHandle tag) const;
+    // Sync whose local folder is localPath or contains it (nullptr if none)
+    std::shared_ptr<SyncSettings> findSyncForLocalPath(const QString& localPath) const;
     QList<std::shared_ptr<SyncSettings>> getSyncSettingsByType(const QVector<SyncType>& types);
     QList<std::shared_ptr<SyncSettings>> getSyncSettingsByType(SyncType type)
         {return getSyncSettingsByType(QVector<SyncType>({type}));}
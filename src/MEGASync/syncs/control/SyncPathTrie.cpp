@@ -0,0 +1,129 @@
+#include "SyncPathTrie.h"
+
+#include <vector>
+
+constexpr SyncPathTrie::SyncId SyncPathTrie::INVALID_ID;
+
+SyncPathTrie::SyncPathTrie()
+    : mRoot(new Node())
+{
+}
+
+SyncPathTrie::~SyncPathTrie() = default;
+
+void SyncPathTrie::insert(const std::string& rootPath, SyncId id)
+{
+    remove(id);
+
+    Node* node = mRoot.get();
+    forEachComponent(rootPath, [&node](const std::string& component)
+    {
+        auto& child = node->children[component];
+        if (!child)
+        {
+            child.reset(new Node());
+        }
+        node = child.get();
+        return true;
+    });
+
+    node->id = id;
+    mRootPaths[id] = rootPath;
+}
+
+void SyncPathTrie::remove(SyncId id)
+{
+    auto it = mRootPaths.find(id);
+    if (it == mRootPaths.end())
+    {
+        return;
+    }
+
+    std::vector<std::pair<Node*, std::string>> path;
+    Node* node = mRoot.get();
+    forEachComponent(it->second, [&node, &path](const std::string& component)
+    {
+        auto child = node->children.find(component);
+        if (child == node->children.end())
+        {
+            return false;
+        }
+        path.emplace_back(node, component);
+        node = child->second.get();
+        return true;
+    });
+
+    if (node->id == id)
+    {
+        node->id = INVALID_ID;
+    }
+
+    // Drop the nodes left without roots below them
+    while (!path.empty() && node->id == INVALID_ID && node->children.empty())
+    {
+        auto parent = path.back().first;
+        parent->children.erase(path.back().second);
+        path.pop_back();
+        node = parent;
+    }
+
+    mRootPaths.erase(it);
+}
+
+void SyncPathTrie::clear()
+{
+    mRoot.reset(new Node());
+    mRootPaths.clear();
+}
+
+SyncPathTrie::SyncId SyncPathTrie::find(const std::string& path) const
+{
+    SyncId found = mRoot->id;
+    const Node* node = mRoot.get();
+    forEachComponent(path, [&node, &found](const std::string& component)
+    {
+        auto child = node->children.find(component);
+        if (child == node->children.end())
+        {
+            return false;
+        }
+        node = child->second.get();
+        if (node->id != INVALID_ID)
+        {
+            found = node->id;
+        }
+        return true;
+    });
+    return found;
+}
+
+std::size_t SyncPathTrie::size() const
+{
+    return mRootPaths.size();
+}
+
+// Calls func for every component until it returns false. The component buffer is reused
+template <typename Func>
+void SyncPathTrie::forEachComponent(const std::string& path, Func&& func)
+{
+    std::string component;
+    std::size_t begin = 0;
+    while (begin < path.size())
+    {
+        auto end = path.find('/', begin);
+        if (end == std::string::npos)
+        {
+            end = path.size();
+        }
+
+        if (end > begin)
+        {
+            component.assign(path, begin, end - begin);
+            if (!func(component))
+            {
+                return;
+            }
+        }
+        begin = end + 1;
+    }
+}
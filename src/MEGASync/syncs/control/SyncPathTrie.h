@@ -0,0 +1,45 @@
+#ifndef SYNCPATHTRIE_H
+#define SYNCPATHTRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Local root folders of the syncs, stored component by component, so finding the sync of a
+// path costs one hash lookup per path component whatever the number of syncs.
+// Paths are UTF-8 and '/' separated; empty components are ignored.
+class SyncPathTrie
+{
+public:
+    using SyncId = std::uint64_t;
+    static constexpr SyncId INVALID_ID = ~static_cast<SyncId>(0);
+
+    SyncPathTrie();
+    ~SyncPathTrie();
+
+    // A sync has one root: inserting it again moves it
+    void insert(const std::string& rootPath, SyncId id);
+    void remove(SyncId id);
+    void clear();
+
+    // Id of the deepest root that is the path or one of its ancestors, or INVALID_ID
+    SyncId find(const std::string& path) const;
+    std::size_t size() const;
+
+private:
+    struct Node
+    {
+        SyncId id = INVALID_ID;
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    };
+
+    template <typename Func>
+    static void forEachComponent(const std::string& path, Func&& func);
+
+    std::unique_ptr<Node> mRoot;
+    std::unordered_map<SyncId, std::string> mRootPaths;
+};
+
+#endif // SYNCPATHTRIE_H
@@ -20,9 +20,11 @@ set(DESKTOP_APP_SYNCS_HEADERS
     syncs/model/BackupItemModel.h
     syncs/model/SyncItemModel.h
     syncs/control/MegaIgnoreManager.h
+    syncs/control/MegaIgnoreMatcher.h
     syncs/control/MegaIgnoreRules.h
     syncs/control/SyncController.h
     syncs/control/SyncInfo.h
+    syncs/control/SyncPathTrie.h
     syncs/control/SyncSettings.h
 )
 
@@ -47,8 +49,10 @@ set(DESKTOP_APP_SYNCS_SOURCES
     syncs/model/BackupItemModel.cpp
     syncs/model/SyncItemModel.cpp
     syncs/control/MegaIgnoreManager.cpp
+    syncs/control/MegaIgnoreMatcher.cpp
     syncs/control/MegaIgnoreRules.cpp
     syncs/control/SyncInfo.cpp
+    syncs/control/SyncPathTrie.cpp
     syncs/control/SyncController.cpp
     syncs/control/SyncSettings.cpp
 )
@@ -21,8 +21,10 @@ SOURCES += $$PWD/gui/Backups/AddBackupDialog.cpp \
            $$PWD/model/BackupItemModel.cpp \
            $$PWD/model/SyncItemModel.cpp \
            $$PWD/control/MegaIgnoreManager.cpp \
+           $$PWD/control/MegaIgnoreMatcher.cpp \
            $$PWD/control/MegaIgnoreRules.cpp \
            $$PWD/control/SyncInfo.cpp \
+           $$PWD/control/SyncPathTrie.cpp \
            $$PWD/control/SyncController.cpp \
            $$PWD/control/SyncSettings.cpp
 
@@ -46,9 +48,11 @@ HEADERS += $$PWD/gui/Backups/AddBackupDialog.h \
            $$PWD/model/BackupItemModel.h \
            $$PWD/model/SyncItemModel.h \
            $$PWD/control/MegaIgnoreManager.h \
+           $$PWD/control/MegaIgnoreMatcher.h \
            $$PWD/control/MegaIgnoreRules.h \
            $$PWD/control/SyncController.h \
            $$PWD/control/SyncInfo.h \
+           $$PWD/control/SyncPathTrie.h \
            $$PWD/control/SyncSettings.h
 
 win32 {
@@ -27,6 +27,8 @@ MegaTransferDelegate::MegaTransferDelegate(TransfersSortFilterProxyBaseModel* mo
                         mProxyModel->sourceModel())),
       mView (view)
 {
+    //Layers built with the old texts or style are dropped
+    mView->installEventFilter(this);
 }
 
 MegaTransferDelegate::~MegaTransferDelegate()
@@ -82,7 +84,19 @@ void MegaTransferDelegate::paint(QPainter *painter, const QStyleOptionViewItem &
 
         painter->save();
         painter->translate(pos);
-        w->render(option, painter, QRegion(0, 0, width, height));
+
+        //The hovered row is rendered by its widget, for its action buttons. The rest paint their cached
+        //static parts and their progress fields, without the layout and style sheets of the widget
+        if(data && w->canPaintDirectly(option))
+        {
+            auto layer(getRowLayer(w, option, data, QSize(width, height)));
+            painter->drawPixmap(0, 0, layer->pixmap);
+            w->paintProgress(painter, layer->progressFields);
+        }
+        else
+        {
+            w->render(option, painter, QRegion(0, 0, width, height));
+        }
 
         painter->restore();
     }
@@ -121,18 +135,116 @@ bool MegaTransferDelegate::event(QEvent *event)
     return QStyledItemDelegate::event(event);
 }
 
+bool MegaTransferDelegate::eventFilter(QObject *watched, QEvent *event)
+{
+    if(watched == mView)
+    {
+        switch(event->type())
+        {
+            case QEvent::LanguageChange:
+            case QEvent::StyleChange:
+            case QEvent::FontChange:
+            case QEvent::PaletteChange:
+            {
+                mRowLayers.clear();
+                break;
+            }
+            default:
+                break;
+        }
+
+        //Not an editor, the base class must not see its events
+        return false;
+    }
+
+    return QStyledItemDelegate::eventFilter(watched, event);
+}
+
+QRegion MegaTransferDelegate::progressRegion(const QModelIndex &index) const
+{
+    if(index.isValid() && index != mHoverIndex)
+    {
+        auto transferItem (qvariant_cast<TransferItem>(index.data(Qt::DisplayRole)));
+        auto data = transferItem.getTransferData();
+        auto layer(data ? mRowLayers.object(data->mTag) : nullptr);
+        if(layer && hasSameStaticParts(*layer, data))
+        {
+            return layer->progressRegion;
+        }
+    }
+
+    return QRegion();
+}
+
+const MegaTransferDelegate::RowLayer *MegaTransferDelegate::getRowLayer(TransferBaseDelegateWidget* w, const QStyleOptionViewItem &option,
+                                                                        const QExplicitlySharedDataPointer<TransferData>& data, const QSize& size) const
+{
+    auto devicePixelRatio(mView->devicePixelRatioF());
+    auto selected(option.state.testFlag(QStyle::State_Selected));
+
+    auto layer(mRowLayers.object(data->mTag));
+    if(!layer || !hasSameStaticParts(*layer, data) || layer->size != size
+       || layer->devicePixelRatio != devicePixelRatio || layer->selected != selected)
+    {
+        //Rendered once per size and state, with holes where the progress fields go
+        layer = new RowLayer();
+        layer->size = size;
+        layer->devicePixelRatio = devicePixelRatio;
+        layer->selected = selected;
+        layer->state = data->getState();
+        layer->started = data->mTransferredBytes > 0;
+        layer->errorCode = data->mErrorCode;
+        layer->errorValue = data->mErrorValue;
+        layer->pixmap = QPixmap(size * devicePixelRatio);
+        layer->pixmap.setDevicePixelRatio(devicePixelRatio);
+
+        //The fields are read from the layout of the hidden widget, so the row is rendered only once
+        TransferBaseDelegateWidget::layOutHidden(w);
+        layer->progressFields = w->progressFields();
+        foreach(auto& field, layer->progressFields)
+        {
+            layer->progressRegion += field;
+        }
+
+        layer->pixmap.fill(Qt::transparent);
+        QPainter layerPainter(&layer->pixmap);
+        w->render(option, &layerPainter, QRegion(0, 0, size.width(), size.height()).subtracted(layer->progressRegion));
+
+        //Enough for the rows in view while scrolling
+        auto maxLayers(2 * rowsInView(size.height()));
+        if(mRowLayers.maxCost() < maxLayers)
+        {
+            mRowLayers.setMaxCost(maxLayers);
+        }
+        mRowLayers.insert(data->mTag, layer);
+    }
+
+    return layer;
+}
+
+bool MegaTransferDelegate::hasSameStaticParts(const RowLayer& layer, const QExplicitlySharedDataPointer<TransferData>& data)
+{
+    return layer.state == data->getState() && layer.started == (data->mTransferredBytes > 0)
+           && layer.errorCode == data->mErrorCode && layer.errorValue == data->mErrorValue;
+}
+
+int MegaTransferDelegate::rowsInView(int rowHeight) const
+{
+    auto nbRowsMaxInView(1);
+    if(rowHeight > 0)
+    {
+        nbRowsMaxInView = mView->height() / rowHeight + 1;
+    }
+    return nbRowsMaxInView;
+}
+
 TransferBaseDelegateWidget *MegaTransferDelegate::getTransferItemWidget(const QModelIndex& index, const QSize& size) const
 { 
     TransferBaseDelegateWidget* item(nullptr);
     
     if(index.isValid())
     {
-        auto nbRowsMaxInView(1);
-        if(size.height() > 0)
-        {
-            nbRowsMaxInView = mView->height() / size.height() + 1;
-        }
-        auto row (index.row() % nbRowsMaxInView);
+        auto row (index.row() % rowsInView(size.height()));
 
         if(row >= mTransferItems.size())
         {
@@ -225,6 +337,11 @@ QSize MegaTransferDelegate::sizeHint(const QStyleOptionViewItem&,
 
 void MegaTransferDelegate::onHoverLeave(const QModelIndex& index, const QRect& rect)
 {
+    if(mHoverIndex == index)
+    {
+        mHoverIndex = QPersistentModelIndex();
+    }
+
     auto currentRow (getTransferItemWidget(index, rect.size()));
     if(currentRow)
     {
@@ -234,6 +351,8 @@ void MegaTransferDelegate::onHoverLeave(const QModelIndex& index, const QRect& r
 
 void MegaTransferDelegate::onHoverEnter(const QModelIndex& index, const QRect& rect)
 {
+    mHoverIndex = index;
+
     auto currentRow (getTransferItemWidget(index, rect.size()));
     if(currentRow)
     {
@@ -6,6 +6,9 @@
 
 #include <QStyledItemDelegate>
 #include <QAbstractItemView>
+#include <QCache>
+#include <QPersistentModelIndex>
+#include <QPixmap>
 
 class TransfersSortFilterProxyBaseModel;
 class TransferBaseDelegateWidget;
@@ -20,9 +23,14 @@ public:
 
     QSize sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const;
 
+    // Part of the row to repaint when only its progress changed, relative to the row.
+    // Empty if the whole row must be repainted
+    QRegion progressRegion(const QModelIndex& index) const;
+
 protected:
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
     bool event(QEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
     bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
     bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option, const QModelIndex &index) override;
 
@@ -32,11 +40,33 @@ protected slots:
     void onHoverMove(const QModelIndex& index, const QRect& rect, const QPoint& point);
 
 private:
+    // Static parts of a row (icons, elided name, status), rendered once by its widget, and the
+    // rects of its progress fields
+    struct RowLayer
+    {
+        QPixmap pixmap;
+        QVector<QRect> progressFields;
+        QRegion progressRegion;
+        QSize size;
+        qreal devicePixelRatio;
+        bool selected;
+        TransferData::TransferState state;
+        bool started;
+        int errorCode;
+        long long errorValue;
+    };
+
     TransferBaseDelegateWidget *getTransferItemWidget(const QModelIndex &index, const QSize &size) const;
+    int rowsInView(int rowHeight) const;
+    const RowLayer* getRowLayer(TransferBaseDelegateWidget* w, const QStyleOptionViewItem &option,
+                                const QExplicitlySharedDataPointer<TransferData>& data, const QSize& size) const;
+    static bool hasSameStaticParts(const RowLayer& layer, const QExplicitlySharedDataPointer<TransferData>& data);
 
     TransfersSortFilterProxyBaseModel* mProxyModel;
     TransfersModel* mSourceModel;
     mutable QVector<TransferBaseDelegateWidget*> mTransferItems;
+    mutable QCache<int, RowLayer> mRowLayers;
+    QPersistentModelIndex mHoverIndex;
     QAbstractItemView* mView;
 };
 
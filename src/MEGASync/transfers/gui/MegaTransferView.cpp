@@ -4,6 +4,7 @@
 #include "control/Utilities.h"
 #include "gui/QMegaMessageBox.h"
 #include "TransfersWidget.h"
+#include "MegaTransferDelegate.h"
 
 #include <QScrollBar>
 #include <QtConcurrent/QtConcurrent>
@@ -1046,6 +1047,23 @@ void MegaTransferView::paintEvent(QPaintEvent *event)
     QTreeView::paintEvent(event);
 }
 
+void MegaTransferView::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    //A progress update repaints only the progress fields of the row, the rest of it comes from the delegate cache
+    auto transferDelegate(qobject_cast<MegaTransferDelegate*>(itemDelegate()));
+    if(transferDelegate && topLeft == bottomRight)
+    {
+        auto region(transferDelegate->progressRegion(topLeft));
+        if(!region.isEmpty())
+        {
+            viewport()->update(region.translated(visualRect(topLeft).topLeft()));
+            return;
+        }
+    }
+
+    QTreeView::dataChanged(topLeft, bottomRight, roles);
+}
+
 void MegaTransferView::moveToTopClicked()
 {
     auto proxy(qobject_cast<QSortFilterProxyModel*>(model()));
@@ -5,6 +5,7 @@
 
 #include <QPointer>
 #include <QLayout>
+#include <QResizeEvent>
 
 TransferBaseDelegateWidget::TransferBaseDelegateWidget(QWidget *parent)
     : QWidget(parent),
@@ -60,6 +61,32 @@ void TransferBaseDelegateWidget::render(const QStyleOptionViewItem&, QPainter *p
     QWidget::render(painter,QPoint(0,0),sourceRegion);
 }
 
+void TransferBaseDelegateWidget::layOutHidden(QWidget* widget)
+{
+    widget->ensurePolished();
+    if(widget->layout())
+    {
+        widget->layout()->activate();
+    }
+
+    //Hidden widgets keep their resize events until they are shown. The event filters of the rows
+    //elide their texts on resize
+    if(widget->testAttribute(Qt::WA_PendingResizeEvent))
+    {
+        widget->setAttribute(Qt::WA_PendingResizeEvent, false);
+        QResizeEvent resizeEvent(widget->size(), QSize());
+        QCoreApplication::sendEvent(widget, &resizeEvent);
+    }
+
+    foreach(auto child, widget->findChildren<QWidget*>(QString(), Qt::FindDirectChildrenOnly))
+    {
+        if(!child->isHidden() && !child->isWindow())
+        {
+            layOutHidden(child);
+        }
+    }
+}
+
 bool TransferBaseDelegateWidget::setActionTransferIcon(QToolButton *button, const QString &iconName)
 {
     bool update(false);
@@ -55,6 +55,16 @@ public:
     void setCurrentIndex(const QModelIndex &currentIndex);
 
     virtual void render(const QStyleOptionViewItem &, QPainter *painter, const QRegion &sourceRegion);
+    //Lays out a hidden widget and its children for their current size and texts, as render() does
+    //before painting, so the geometry of the children can be read without rendering
+    static void layOutHidden(QWidget* widget);
+
+    //Painting without rendering the widget: the delegate caches the rest of the row and this paints
+    //only the fields updated with the progress. Rows keep the widget path by default
+    virtual bool canPaintDirectly(const QStyleOptionViewItem&) const {return false;}
+    //Rects of the progress fields for the current size and state
+    virtual QVector<QRect> progressFields() {return QVector<QRect>();}
+    virtual void paintProgress(QPainter*, const QVector<QRect>&) {}
 
 signals:
     void retryTransfer();
@@ -57,25 +57,85 @@ const TransferData::TransferStates TransferData::ACTIVE_STATES_MASK = TransferDa
             TransferData::TransferState::TRANSFER_ACTIVE |
             TransferData::TransferState::TRANSFER_COMPLETING);
 
-void TransferData::update(mega::MegaTransfer* transfer)
+std::atomic<quint64> TransferData::mAllocations(0);
+std::atomic<quint64> TransferData::mInPlaceUpdates(0);
+
+TransferIdentity::TransferIdentity(mega::MegaTransfer* transfer)
+    : rawFilename(transfer->getFileName() ? transfer->getFileName() : ""),
+      rawPath(transfer->getPath() ? transfer->getPath() : ""),
+      filename(QString::fromStdString(rawFilename)),
+      path(QString::fromStdString(rawPath)),
+      fileIcon(Utilities::getFileIcon(filename)),
+      fileType(Utilities::getFileType(fileIcon))
+{
+}
+
+bool TransferIdentity::matches(mega::MegaTransfer* transfer) const
+{
+    auto transferFilename(transfer->getFileName());
+    auto transferPath(transfer->getPath());
+
+    //The path of a download may change when it finishes (e.g. renamed because of a name clash)
+    return rawFilename.compare(transferFilename ? transferFilename : "") == 0
+           && rawPath.compare(transferPath ? transferPath : "") == 0;
+}
+
+TransferProgress::TransferProgress(mega::MegaTransfer* transfer, long long currentSpeed)
+    : tag(transfer->getTag()),
+      state(transfer->getState()),
+      notificationNumber(transfer->getNotificationNumber()),
+      priority(transfer->getPriority()),
+      transferredBytes(static_cast<unsigned long long>(transfer->getTransferredBytes())),
+      totalBytes(static_cast<unsigned long long>(transfer->getTotalBytes())),
+      speed(static_cast<unsigned long long>(std::min(transfer->getSpeed(), currentSpeed)))
+{
+}
+
+TransferData::TransferData(mega::MegaTransfer* transfer, const TransferIdentity* identity)
+{
+    ++mAllocations;
+    update(transfer, identity);
+}
+
+quint64 TransferData::allocations()
+{
+    return mAllocations;
+}
+
+quint64 TransferData::inPlaceUpdates()
+{
+    return mInPlaceUpdates;
+}
+
+void TransferData::update(mega::MegaTransfer* transfer, const TransferIdentity* identity)
 {
     auto megaApi = MegaSyncApp->getMegaApi();
     if(transfer && megaApi)
     {   
         mTag = transfer->getTag();
-
-        mPath = QString::fromUtf8(transfer->getPath());
         mFolderTransferTag = transfer->getFolderTransferTag();
 
-        mFilename = QString::fromUtf8(transfer->getFileName());
+        if(identity)
+        {
+            mPath = identity->path;
+            mFilename = identity->filename;
+            mFileIcon = identity->fileIcon;
+            mFileType = identity->fileType;
+        }
+        else
+        {
+            mPath = QString::fromUtf8(transfer->getPath());
+            mFilename = QString::fromUtf8(transfer->getFileName());
+            mFileIcon = Utilities::getFileIcon(mFilename);
+            mFileType = Utilities::getFileType(mFileIcon);
+        }
+
         mType = static_cast<TransferData::TransferType>(1 << transfer->getType());
         if (transfer->isSyncTransfer())
         {
             mType |= TransferData::TRANSFER_SYNC;
         }
 
-        mFileType = Utilities::getFileType(mFilename, QString());
-
         //Update priority before setState as the setState changes the priority
         mPriority = transfer->getPriority();
 
@@ -133,6 +193,37 @@ void TransferData::update(mega::MegaTransfer* transfer)
     }
 }
 
+void TransferData::update(const TransferProgress& progress)
+{
+    ++mInPlaceUpdates;
+
+    auto previousState(mState);
+
+    //Same as a full update: the raw priority is restored before setState applies the state offsets
+    mPriority = progress.priority;
+    mState = TransferState::TRANSFER_NONE;
+    setState(convertState(progress.state));
+    mPreviousState = previousState;
+
+    mNotificationNumber = progress.notificationNumber;
+    mTemporaryError = false;
+    mTransferredBytes = progress.transferredBytes;
+    mTotalSize = progress.totalBytes;
+    mSpeed = (mState & TransferData::TRANSFER_COMPLETING) ? 0 : progress.speed;
+    mMeanSpeed = 0;
+
+    if(mTotalSize > mTransferredBytes)
+    {
+        unsigned long long remBytes = mTotalSize - mTransferredBytes;
+        TransferRemainingTime rem(mSpeed, remBytes);
+        mRemainingTime = rem.calculateRemainingTimeSeconds(mSpeed, remBytes).count();
+    }
+    else
+    {
+        mRemainingTime = 0;
+    }
+}
+
 bool TransferData::hasChanged(QExplicitlySharedDataPointer<TransferData> data)
 {
     bool result = true;
@@ -7,6 +7,9 @@
 #include <QSharedData>
 #include <QMimeDatabase>
 
+#include <atomic>
+#include <string>
+
 //Place here as they represent the number of real columns
 enum class SortCriterion
 {
@@ -23,6 +26,37 @@ static const QColor DOWNLOAD_TRANSFER_COLOR = QColor("#31B500");
 
 typedef int TransferTag;
 
+//Compact snapshot of the fields that change while a transfer is in progress
+//It is trivially copyable, so it can travel through lock-free buffers
+struct TransferProgress
+{
+    TransferTag         tag = 0;
+    int                 state = mega::MegaTransfer::STATE_NONE;
+    long long           notificationNumber = 0;
+    unsigned long long  priority = 0;
+    unsigned long long  transferredBytes = 0;
+    unsigned long long  totalBytes = 0;
+    unsigned long long  speed = 0;
+
+    TransferProgress() = default;
+    TransferProgress(mega::MegaTransfer* transfer, long long currentSpeed);
+};
+
+//Data that does not change during the life of a transfer
+//It is interned when the transfer starts, so later events do not convert names and paths again
+struct TransferIdentity
+{
+    explicit TransferIdentity(mega::MegaTransfer* transfer);
+    bool matches(mega::MegaTransfer* transfer) const;
+
+    std::string         rawFilename;
+    std::string         rawPath;
+    QString             filename;
+    QString             path;
+    FileExtensionTable::Icon fileIcon;
+    Utilities::FileType fileType;
+};
+
 class TransferData : public QSharedData
 {
 public:
@@ -59,7 +93,7 @@ public:
 
     static const TransferTypes TYPE_MASK;
 
-    TransferData(mega::MegaTransfer* transfer = nullptr){update(transfer);}
+    TransferData(mega::MegaTransfer* transfer = nullptr, const TransferIdentity* identity = nullptr);
     ~TransferData(){}
 
     TransferData(TransferData const* dr) :
@@ -70,13 +104,21 @@ public:
         mMeanSpeed(dr->mMeanSpeed),
         mTransferredBytes(dr->mTransferredBytes),
         mNotificationNumber(dr->mNotificationNumber),
-        mFileType(dr->mFileType),
+        mFileIcon(dr->mFileIcon), mFileType(dr->mFileType),
         mParentHandle (dr->mParentHandle), mNodeHandle (dr->mNodeHandle), mFailedTransfer(dr->mFailedTransfer),
         mFilename(dr->mFilename), mNodeAccess(mega::MegaShare::ACCESS_UNKNOWN),
         mPath(dr->mPath), mFinishedTime(dr->mFinishedTime),mState(dr->mState), mIgnorePauseQueueState(dr->mIgnorePauseQueueState)
-    {}
+    {
+        ++mAllocations;
+    }
 
-    void update(mega::MegaTransfer* transfer);
+    void update(mega::MegaTransfer* transfer, const TransferIdentity* identity = nullptr);
+    //Writes a progress record in place, without allocating
+    void update(const TransferProgress& progress);
+
+    //Number of TransferData created and of progress records written in place since startup
+    static quint64 allocations();
+    static quint64 inPlaceUpdates();
     bool hasChanged(QExplicitlySharedDataPointer<TransferData> data);
     void removeFailedTransfer();
 
@@ -99,6 +141,7 @@ public:
     unsigned long long                  mMeanSpeed = 0;
     unsigned long long                  mTransferredBytes = 0;
     long long                           mNotificationNumber = 0;
+    FileExtensionTable::Icon            mFileIcon = FileExtensionTable::Icon::GENERIC;
     Utilities::FileType                 mFileType = Utilities::FileType::TYPE_OTHER;
     mega::MegaHandle                    mParentHandle = 0;
     mega::MegaHandle                    mNodeHandle = 0;
@@ -149,6 +192,9 @@ private:
     TransferState   mPreviousState = TransferState::TRANSFER_NONE;
     bool            mIgnorePauseQueueState = false;
 
+    static std::atomic<quint64> mAllocations;
+    static std::atomic<quint64> mInPlaceUpdates;
+
 };
 Q_DECLARE_TYPEINFO(TransferData, Q_MOVABLE_TYPE);
 Q_DECLARE_METATYPE(TransferData)
@@ -10,6 +10,8 @@
 
 #include <QMouseEvent>
 #include <QPainterPath>
+#include <QStyleOptionButton>
+#include <QStyleOptionProgressBar>
 
 constexpr uint PB_PRECISION = 1000;
 #ifdef Q_OS_MACOS
@@ -340,8 +342,7 @@ void TransferManagerDelegateWidget::setFileNameAndType()
     // Update members
     QIcon icon;
     // File type icon
-    icon = Utilities::getCachedPixmap(Utilities::getExtensionPixmapName(
-                                          getData()->mFilename, QLatin1String(":/images/drag_")));
+    icon = Utilities::getExtensionPixmapMedium(getData()->mFileIcon);
     mUi->tFileType->setIcon(icon);
 
     // File name
@@ -446,13 +447,7 @@ TransferBaseDelegateWidget::ActionHoverType TransferManagerDelegateWidget::mouse
 
 void TransferManagerDelegateWidget::render(const QStyleOptionViewItem &option, QPainter *painter, const QRegion &sourceRegion)
 {
-    bool isDragging(false);
-
-    auto view = dynamic_cast<MegaTransferView*>(parent());
-    if(view)
-    {
-        isDragging = view->state() == MegaTransferView::DraggingState;
-    }
+    bool isDragging(isViewDragging());
 
     if(option.state & (QStyle::State_MouseOver | QStyle::State_Selected))
     {
@@ -505,6 +500,107 @@ void TransferManagerDelegateWidget::render(const QStyleOptionViewItem &option, Q
     TransferBaseDelegateWidget::render(option, painter, sourceRegion);
 }
 
+bool TransferManagerDelegateWidget::canPaintDirectly(const QStyleOptionViewItem &option) const
+{
+    //Dragged rows are painted translucent by the widget path
+    return !option.state.testFlag(QStyle::State_MouseOver)
+           && !(option.state.testFlag(QStyle::State_Selected) && isViewDragging());
+}
+
+QVector<QRect> TransferManagerDelegateWidget::progressFields()
+{
+    QVector<QRect> fields(PROGRESS_FIELDS);
+    if(mUi->wProgressBar->isVisibleTo(this))
+    {
+        fields[PROGRESS_BAR] = rectInRow(mUi->pbTransfer);
+    }
+    if(mUi->wSize->isVisibleTo(this))
+    {
+        fields[SIZE] = rectInRow(mUi->wSize);
+    }
+    if(mUi->bItemSpeed->isVisibleTo(this))
+    {
+        fields[SPEED] = rectInRow(mUi->bItemSpeed);
+    }
+    if(mUi->lItemTime->isVisibleTo(this))
+    {
+        fields[TIME] = rectInRow(mUi->lItemTime);
+    }
+    return fields;
+}
+
+void TransferManagerDelegateWidget::paintProgress(QPainter *painter, const QVector<QRect> &fields)
+{
+    if(fields.size() != PROGRESS_FIELDS)
+    {
+        return;
+    }
+
+    //Fonts and colours come from the style sheet
+    ensurePolished();
+
+    //Drawn as the widgets draw themselves, at the rects laid out when the row was cached
+    if(!fields[PROGRESS_BAR].isEmpty())
+    {
+        QStyleOptionProgressBar progressOption;
+        progressOption.initFrom(mUi->pbTransfer);
+        progressOption.rect = fields[PROGRESS_BAR];
+        progressOption.state |= QStyle::State_Horizontal;
+        progressOption.minimum = mUi->pbTransfer->minimum();
+        progressOption.maximum = mUi->pbTransfer->maximum();
+        progressOption.progress = mUi->pbTransfer->value();
+        progressOption.textVisible = false;
+        progressOption.invertedAppearance = mUi->pbTransfer->invertedAppearance();
+        mUi->pbTransfer->style()->drawControl(QStyle::CE_ProgressBar, &progressOption, painter, mUi->pbTransfer);
+    }
+
+    if(!fields[SIZE].isEmpty())
+    {
+        //Done and total sizes side by side, as their layout places them
+        auto sizeRect(fields[SIZE].marginsRemoved(mUi->wSize->layout()->contentsMargins()));
+        if(mUi->lDone->isVisibleTo(this))
+        {
+            paintLabelText(painter, mUi->lDone, sizeRect);
+            sizeRect.setLeft(sizeRect.left() + mUi->lDone->fontMetrics().horizontalAdvance(mUi->lDone->text()));
+        }
+        paintLabelText(painter, mUi->lTotal, sizeRect);
+    }
+
+    if(!fields[SPEED].isEmpty())
+    {
+        QStyleOptionButton speedOption;
+        speedOption.initFrom(mUi->bItemSpeed);
+        speedOption.rect = fields[SPEED];
+        speedOption.features = mUi->bItemSpeed->isFlat() ? QStyleOptionButton::Flat : QStyleOptionButton::None;
+        speedOption.text = mUi->bItemSpeed->text();
+        speedOption.icon = mUi->bItemSpeed->icon();
+        speedOption.iconSize = mUi->bItemSpeed->iconSize();
+        mUi->bItemSpeed->style()->drawControl(QStyle::CE_PushButton, &speedOption, painter, mUi->bItemSpeed);
+    }
+
+    if(!fields[TIME].isEmpty())
+    {
+        paintLabelText(painter, mUi->lItemTime, fields[TIME]);
+    }
+}
+
+void TransferManagerDelegateWidget::paintLabelText(QPainter *painter, QLabel *label, const QRect &rect)
+{
+    auto alignment(QStyle::visualAlignment(label->layoutDirection(), label->alignment()));
+    //Vertically centered by the layout when the label has no vertical alignment
+    if(!(alignment & Qt::AlignVertical_Mask))
+    {
+        alignment = (alignment & ~Qt::AlignVertical_Mask) | Qt::AlignVCenter;
+    }
+
+    painter->save();
+    painter->setFont(label->font());
+    label->style()->drawItemText(painter, rect, static_cast<int>(alignment), label->palette(), label->isEnabled(),
+                                 label->fontMetrics().elidedText(label->text(), Qt::ElideMiddle, rect.width()),
+                                 label->foregroundRole());
+    painter->restore();
+}
+
 void TransferManagerDelegateWidget::mouseDoubleClickEvent(QMouseEvent *event)
 {
     emit openTransfer();
@@ -549,6 +645,17 @@ bool TransferManagerDelegateWidget::eventFilter(QObject *watched, QEvent *event)
     return TransferBaseDelegateWidget::eventFilter(watched, event);
 }
 
+bool TransferManagerDelegateWidget::isViewDragging() const
+{
+    auto view = dynamic_cast<MegaTransferView*>(parent());
+    return view && view->state() == MegaTransferView::DraggingState;
+}
+
+QRect TransferManagerDelegateWidget::rectInRow(QWidget *field) const
+{
+    return QRect(field->mapTo(this, QPoint(0, 0)), field->size());
+}
+
 void TransferManagerDelegateWidget::reset()
 {
     mPauseResumeTransferDefaultIconName.clear();
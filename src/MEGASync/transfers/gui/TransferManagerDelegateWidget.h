@@ -6,6 +6,7 @@
 
 
 #include <QDateTime>
+#include <QLabel>
 #include <QUrl>
 
 namespace Ui {
@@ -24,6 +25,10 @@ public:
 
     void render(const QStyleOptionViewItem &option, QPainter *painter, const QRegion &sourceRegion) override;
 
+    bool canPaintDirectly(const QStyleOptionViewItem& option) const override;
+    QVector<QRect> progressFields() override;
+    void paintProgress(QPainter *painter, const QVector<QRect>& fields) override;
+
 protected:
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     bool eventFilter(QObject* watched, QEvent* event) override;
@@ -41,11 +46,23 @@ private slots:
     void on_tItemRetry_clicked();
 
 private:
+    enum ProgressField
+    {
+        PROGRESS_BAR = 0,
+        SIZE,
+        SPEED,
+        TIME,
+        PROGRESS_FIELDS
+    };
+
     void updateTransferState() override;
     void setFileNameAndType() override;
     void setType() override;
     void setFileType(const QString& fileName);
     void adjustFileName();
+    bool isViewDragging() const;
+    QRect rectInRow(QWidget* field) const;
+    static void paintLabelText(QPainter* painter, QLabel* label, const QRect& rect);
 
     bool setCancelClearTransferIcon(const QString &name);
     bool setPauseResumeTransferIcon(const QString &name);
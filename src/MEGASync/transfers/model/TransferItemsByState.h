@@ -0,0 +1,398 @@
+#ifndef TRANSFERITEMSBYSTATE_H
+#define TRANSFERITEMSBYSTATE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Items of a transfer batch, grouped by state.
+//
+// Items are stored by value in a slab (a deque, so their addresses survive appends) and found by
+// tag through a flat open addressing index. The state of an item is one byte kept out of the
+// item: moving an item to another state rewrites that byte and two counters, so the common
+// "pending -> completed" step does not touch any tree or allocate. The tags of a state are only
+// collected when they are asked for, and kept until that state changes again.
+// An item can join a group (the folder of a file), which chains it to the other items of the
+// group through their slots, so the items of a group are found without a separate multimap.
+template <typename Item, int States>
+class TransferItemsByState
+{
+    static_assert(States > 0 && States < 0xff, "States must fit in a byte");
+
+public:
+    using Tag = int;
+    using Group = std::uint64_t;
+
+    int size() const
+    {
+        return mSize;
+    }
+
+    bool isEmpty() const
+    {
+        return mSize == 0;
+    }
+
+    int count(int state) const
+    {
+        return mCounts[state];
+    }
+
+    // Adds the item in the state and returns it, or nullptr if the tag is already stored.
+    // Pointers to items stay valid until an item is removed (removals may compact the slab)
+    Item* insert(Tag tag, int state, Item item)
+    {
+        auto slot(mSlotByTag.find(tag));
+        if(slot != NO_SLOT && mStates[slot] != NO_STATE)
+        {
+            return nullptr;
+        }
+
+        // A removed tag gets a new slot, its old one stays dead until the next compaction
+        slot = static_cast<std::uint32_t>(mItems.size());
+        mItems.push_back(std::move(item));
+        mTags.push_back(tag);
+        mStates.push_back(NO_STATE);
+        mGroups.push_back(NO_GROUP);
+        mNextInGroup.push_back(NO_SLOT);
+        mSlotByTag.set(tag, slot);
+
+        ++mSize;
+        moveTo(slot, state);
+        return &mItems[slot];
+    }
+
+    Item* find(Tag tag)
+    {
+        auto slot(liveSlot(tag));
+        return slot != NO_SLOT ? &mItems[slot] : nullptr;
+    }
+
+    const Item* find(Tag tag) const
+    {
+        auto slot(liveSlot(tag));
+        return slot != NO_SLOT ? &mItems[slot] : nullptr;
+    }
+
+    // The item only if it is in the state
+    Item* find(Tag tag, int state)
+    {
+        auto slot(liveSlot(tag));
+        return slot != NO_SLOT && mStates[slot] == state ? &mItems[slot] : nullptr;
+    }
+
+    bool contains(Tag tag, int state) const
+    {
+        auto slot(liveSlot(tag));
+        return slot != NO_SLOT && mStates[slot] == state;
+    }
+
+    // -1 if the tag is not stored
+    int stateOf(Tag tag) const
+    {
+        auto slot(liveSlot(tag));
+        return slot != NO_SLOT ? mStates[slot] : -1;
+    }
+
+    bool setState(Tag tag, int state)
+    {
+        auto slot(liveSlot(tag));
+        if(slot != NO_SLOT)
+        {
+            moveTo(slot, state);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool remove(Tag tag)
+    {
+        auto slot(liveSlot(tag));
+        if(slot != NO_SLOT)
+        {
+            killSlot(slot);
+            compactIfNeeded();
+            return true;
+        }
+
+        return false;
+    }
+
+    // Returns the number of removed items
+    int removeAll(int state)
+    {
+        int removed(0);
+        if(mCounts[state] > 0)
+        {
+            for(std::uint32_t slot = 0; slot < mStates.size(); ++slot)
+            {
+                if(mStates[slot] == state)
+                {
+                    killSlot(slot);
+                    ++removed;
+                }
+            }
+            compactIfNeeded();
+        }
+
+        return removed;
+    }
+
+    void clear()
+    {
+        *this = TransferItemsByState();
+    }
+
+    // Tags of the items in the state, in ascending order
+    const std::vector<Tag>& tags(int state) const
+    {
+        auto& list(mTagLists[state]);
+        if(!mTagListValid[state])
+        {
+            list.clear();
+            list.reserve(static_cast<std::size_t>(mCounts[state]));
+            for(std::size_t slot = 0; slot < mStates.size(); ++slot)
+            {
+                if(mStates[slot] == state)
+                {
+                    list.push_back(mTags[slot]);
+                }
+            }
+            // Tags are given in ascending order by the SDK, so this is usually a single pass
+            if(!std::is_sorted(list.begin(), list.end()))
+            {
+                std::sort(list.begin(), list.end());
+            }
+            mTagListValid[state] = true;
+        }
+
+        return list;
+    }
+
+    // Calls func(item) for each item in the state, in ascending tag order
+    template <typename Func>
+    void forEach(int state, Func func) const
+    {
+        for(auto tag : tags(state))
+        {
+            func(mItems[mSlotByTag.find(tag)]);
+        }
+    }
+
+    // Adds the item to the group. An item joins one group for its whole life, later calls are ignored
+    void setGroup(Tag tag, Group group)
+    {
+        auto slot(liveSlot(tag));
+        if(slot != NO_SLOT && mGroups[slot] == NO_GROUP && group != NO_GROUP)
+        {
+            mGroups[slot] = group;
+            mNextInGroup[slot] = mFirstInGroup.find(group);
+            mFirstInGroup.set(group, slot);
+        }
+    }
+
+    // True if func(item) is true for an item of the group in the state
+    template <typename Func>
+    bool anyInGroup(Group group, int state, Func func) const
+    {
+        for(auto slot = mFirstInGroup.find(group); slot != NO_SLOT; slot = mNextInGroup[slot])
+        {
+            if(mStates[slot] == state && func(mItems[slot]))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Bytes used by the store, without what the items allocate themselves
+    std::size_t memoryUsage() const
+    {
+        std::size_t bytes(mItems.size() * sizeof(Item));
+        bytes += mTags.capacity() * sizeof(Tag) + mStates.capacity() + mGroups.capacity() * sizeof(Group)
+                 + mNextInGroup.capacity() * sizeof(std::uint32_t);
+        bytes += mSlotByTag.memoryUsage() + mFirstInGroup.memoryUsage();
+        for(const auto& list : mTagLists)
+        {
+            bytes += list.capacity() * sizeof(Tag);
+        }
+        return bytes;
+    }
+
+    void compact()
+    {
+        if(mDeadSlots == 0)
+        {
+            return;
+        }
+
+        TransferItemsByState compacted;
+        for(std::uint32_t slot = 0; slot < mStates.size(); ++slot)
+        {
+            if(mStates[slot] != NO_STATE)
+            {
+                compacted.insert(mTags[slot], mStates[slot], std::move(mItems[slot]));
+                compacted.setGroup(mTags[slot], mGroups[slot]);
+            }
+        }
+        *this = std::move(compacted);
+    }
+
+private:
+    static constexpr std::uint8_t NO_STATE = 0xff;
+    static constexpr std::uint32_t NO_SLOT = 0xffffffff;
+    static constexpr Group NO_GROUP = ~Group(0);
+    // Do not compact small stores, the copy would cost more than the dead slots
+    static constexpr int MIN_DEAD_SLOTS_TO_COMPACT = 1024;
+
+    // Maps keys to slots with linear probing. Keys are never erased: a removed tag keeps its dead
+    // slot until it is inserted again
+    template <typename Key>
+    class SlotIndex
+    {
+    public:
+        std::uint32_t find(Key key) const
+        {
+            if(mSlots.empty())
+            {
+                return NO_SLOT;
+            }
+
+            for(auto bucket = bucketOf(key);; bucket = (bucket + 1) & (mSlots.size() - 1))
+            {
+                if(mSlots[bucket] == NO_SLOT || mKeys[bucket] == key)
+                {
+                    return mSlots[bucket];
+                }
+            }
+        }
+
+        void set(Key key, std::uint32_t slot)
+        {
+            if((mUsed + 1) * 2 > mSlots.size())
+            {
+                grow();
+            }
+
+            auto bucket(bucketOf(key));
+            while(mSlots[bucket] != NO_SLOT && mKeys[bucket] != key)
+            {
+                bucket = (bucket + 1) & (mSlots.size() - 1);
+            }
+
+            if(mSlots[bucket] == NO_SLOT)
+            {
+                mKeys[bucket] = key;
+                ++mUsed;
+            }
+            mSlots[bucket] = slot;
+        }
+
+        std::size_t memoryUsage() const
+        {
+            return mKeys.capacity() * sizeof(Key) + mSlots.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        std::size_t bucketOf(Key key) const
+        {
+            // Fibonacci hashing, tags are consecutive integers
+            auto hash(static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ULL);
+            return static_cast<std::size_t>(hash >> 32) & (mSlots.size() - 1);
+        }
+
+        void grow()
+        {
+            std::vector<Key> keys(std::max<std::size_t>(16, mSlots.size() * 2));
+            std::vector<std::uint32_t> slots(keys.size(), NO_SLOT);
+            keys.swap(mKeys);
+            slots.swap(mSlots);
+            mUsed = 0;
+            for(std::size_t bucket = 0; bucket < slots.size(); ++bucket)
+            {
+                if(slots[bucket] != NO_SLOT)
+                {
+                    set(keys[bucket], slots[bucket]);
+                }
+            }
+        }
+
+        std::vector<Key> mKeys;
+        std::vector<std::uint32_t> mSlots;
+        std::size_t mUsed = 0;
+    };
+
+    std::uint32_t liveSlot(Tag tag) const
+    {
+        auto slot(mSlotByTag.find(tag));
+        return slot != NO_SLOT && mStates[slot] != NO_STATE ? slot : NO_SLOT;
+    }
+
+    void moveTo(std::uint32_t slot, int state)
+    {
+        auto previous(mStates[slot]);
+        if(previous == state)
+        {
+            return;
+        }
+
+        if(previous != NO_STATE)
+        {
+            --mCounts[previous];
+            mTagListValid[previous] = false;
+        }
+        if(state != NO_STATE)
+        {
+            ++mCounts[state];
+            mTagListValid[state] = false;
+        }
+        mStates[slot] = static_cast<std::uint8_t>(state);
+    }
+
+    void killSlot(std::uint32_t slot)
+    {
+        moveTo(slot, NO_STATE);
+        // Releases what the item holds, e.g. the copy of a failed transfer
+        mItems[slot] = Item();
+        --mSize;
+        ++mDeadSlots;
+    }
+
+    void compactIfNeeded()
+    {
+        if(mDeadSlots >= MIN_DEAD_SLOTS_TO_COMPACT && mDeadSlots > mSize)
+        {
+            compact();
+        }
+    }
+
+    std::deque<Item> mItems;
+    // Per slot, apart from the items so that scanning states does not load them
+    std::vector<Tag> mTags;
+    std::vector<std::uint8_t> mStates;
+    std::vector<Group> mGroups;
+    std::vector<std::uint32_t> mNextInGroup;
+
+    SlotIndex<Tag> mSlotByTag;
+    SlotIndex<Group> mFirstInGroup;
+    std::array<int, States> mCounts{};
+    int mSize = 0;
+    int mDeadSlots = 0;
+
+    mutable std::array<std::vector<Tag>, States> mTagLists;
+    mutable std::array<bool, States> mTagListValid{};
+};
+
+template <typename Item, int States>
+constexpr std::uint8_t TransferItemsByState<Item, States>::NO_STATE;
+template <typename Item, int States>
+constexpr std::uint32_t TransferItemsByState<Item, States>::NO_SLOT;
+template <typename Item, int States>
+constexpr typename TransferItemsByState<Item, States>::Group TransferItemsByState<Item, States>::NO_GROUP;
+
+#endif // TRANSFERITEMSBYSTATE_H
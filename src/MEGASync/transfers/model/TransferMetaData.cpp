@@ -10,6 +10,11 @@
 #include <megaapi.h>
 #include <mega/types.h>
 
+namespace
+{
+using Files = TransferMetaDataItemsByState<TransferMetaDataItem>;
+using EmptyFolders = TransferMetaDataItemsByState<TransferMetaDataFolderItem>;
+}
 
 //CLASS TRANSFERMETADATAITEMID
 bool TransferMetaDataItemId::operator==(const TransferMetaDataItemId& item) const
@@ -75,7 +80,7 @@ void TransferMetaData::remove()
 
 bool TransferMetaData::isNonExistData() const
 {
-    return !mFiles.nonExistFailedTransfers.isEmpty();
+    return mFiles.count(Files::NON_EXIST_FAILED) > 0;
 }
 
 bool TransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaError* e)
@@ -127,14 +132,14 @@ bool TransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaError* e)
                 state = TransferData::TRANSFER_COMPLETED;
             }
 
-            auto isEmptyFolder(value->files.size() == 0);
+            auto isEmptyFolder(value->files == 0);
 
             if(!nonExistError(transfer, e))
             {
                 //The folder has finished but it is empty, so it is added to the empty folders list
                 if(isEmptyFolder)
                 {
-                    mEmptyFolders.insertItem(state, value);
+                    mEmptyFolders.insertItem(state, *value);
                 }
                 //Update Key
                 else
@@ -149,8 +154,7 @@ bool TransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaError* e)
                 {
                     if(isEmptyFolder)
                     {
-                        value->state = TransferData::TRANSFER_FAILED;
-                        nonExistData->mEmptyFolders.nonExistFailedTransfers.insert(id, value);
+                        nonExistData->mEmptyFolders.insertNonExistFailed(*value);
                     }
                     else
                     {
@@ -172,11 +176,10 @@ bool TransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaError* e)
     {
         TransferMetaDataItemId id(transfer->getTag(), transfer->getNodeHandle(), QString::fromUtf8(transfer->getFileName()), QString::fromUtf8(transfer->getPath()));
 
-        auto item = mFiles.pendingTransfers.value(id);
+        auto item = mFiles.find(id.tag, Files::PENDING);
         if(item)
         {
             item->id = id;
-            mFiles.removeItem(item);
 
             TransferData::TransferState state = TransferData::convertState(transfer->getState());
             if(state == TransferData::TRANSFER_FAILED)
@@ -194,19 +197,22 @@ bool TransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaError* e)
                 }
             }
 
-            item->folderId.handle = transfer->getParentHandle();
+            item->folderHandle = transfer->getParentHandle();
 
             if(!nonExistError(transfer, e))
             {
-                mFiles.insertItem(state, item);
+                mFiles.moveItem(state, item);
             }
             else
             {
                 auto nonExistData = TransferMetaDataContainer::getAppDataById(mNonExistsFailAppId);
                 if(nonExistData)
                 {
-                    item->state = TransferData::TRANSFER_FAILED;
-                    mFiles.nonExistFailedTransfers.insert(item->id, item);
+                    mFiles.moveToNonExistFailed(item);
+                }
+                else
+                {
+                    mFiles.removeItem(item);
                 }
             }
         }
@@ -259,7 +265,7 @@ void TransferMetaData::increaseFinishedTopLevelTransfers(mega::MegaTransfer *tra
     }
     //If the transfermetadata has been created from other session from a folder download/upload
     //Increase the mFinishedTopLevelTransfers (which will be maximum 1, the folder) when all the nested files have finished
-    else if(mCreatedFromOtherSession && mFiles.pendingTransfers.isEmpty())
+    else if(mCreatedFromOtherSession && mFiles.count(Files::PENDING) == 0)
     {
         if(transfer->getFolderTransferTag() > 0)
         {
@@ -272,10 +278,10 @@ bool TransferMetaData::isSingleTransfer() const
 {
     if(isNonExistData())
     {
-        return mFiles.nonExistFailedTransfers.size() == 1;
+        return mFiles.count(Files::NON_EXIST_FAILED) == 1;
     }
 
-    return (mFiles.completedTransfers.size() + mFiles.failedTransfers.size() + getTotalEmptyFolders()) == 1;
+    return (mFiles.count(Files::COMPLETED) + mFiles.count(Files::FAILED) + getTotalEmptyFolders()) == 1;
 }
 
 int TransferMetaData::getTotalFiles() const
@@ -285,7 +291,7 @@ int TransferMetaData::getTotalFiles() const
 
 int TransferMetaData::getPendingFiles() const
 {
-    return mFiles.pendingTransfers.size() + mEmptyFolders.pendingTransfers.size();
+    return mFiles.count(Files::PENDING) + mEmptyFolders.count(EmptyFolders::PENDING);
 }
 
 int TransferMetaData::getTotalEmptyFolders() const
@@ -301,71 +307,68 @@ bool TransferMetaData::isRetriedFolder(const TransferMetaDataItemId &folderId) c
 QList<TransferMetaDataItemId> TransferMetaData::getFileFailedTagsFromFolderTag(const TransferMetaDataItemId& folderId) const
 {
     QList<TransferMetaDataItemId> ids;
-    foreach(auto& file, mFiles.failedTransfers)
-    {
-        if(file->topLevelFolderId == folderId)
+    mFiles.forEach(Files::FAILED, [&ids, &folderId](const TransferMetaDataItem& file){
+        if(file.topLevelFolderId == folderId)
         {
-            ids.append(file->id);
+            ids.append(file.id);
         }
-    }
+    });
 
     return ids;
 }
 
 int TransferMetaData::getFileTransfersOK() const
 {
-    return mFiles.completedTransfers.size();
+    return mFiles.count(Files::COMPLETED);
 }
 
 int TransferMetaData::getFileTransfersFailed() const
 {
-    return mFiles.failedTransfers.size() + mFiles.nonExistFailedTransfers.size();
+    return mFiles.count(Files::FAILED) + mFiles.count(Files::NON_EXIST_FAILED);
 }
 
-void TransferMetaData::getFileTransferFailedTags(QList<std::shared_ptr<TransferMetaDataItem>>& files, QList<TransferMetaDataItemId>& folders) const
+void TransferMetaData::getFileTransferFailedTags(QList<TransferMetaDataItem>& files, QList<TransferMetaDataItemId>& folders) const
 {
+    auto append = [&files](const TransferMetaDataItem& file){
+        files.append(file);
+    };
+
     if(isNonExistData())
     {
         //Retry only the non exist
-        foreach(auto file, mFiles.nonExistFailedTransfers)
-        {
-            files.append(file);
-        }
+        mFiles.forEach(Files::NON_EXIST_FAILED, append);
     }
     else
     {
-        foreach(auto file, mFiles.failedTransfers)
-        {
-            files.append(file);
-            //For future folder retry
-            //        if(!file->topLevelFolderId.isValid())
-            //        {
-            //            if(!files.contains(file))
-            //            {
-            //                files.append(file);
-            //            }
-            //        }
-            //        else if(!folders.contains(file->topLevelFolderId))
-            //        {
-            //            folders.append(file->topLevelFolderId);
-            //        }
-        }
+        mFiles.forEach(Files::FAILED, append);
+        //For future folder retry
+        //        if(!file->topLevelFolderId.isValid())
+        //        {
+        //            if(!files.contains(file))
+        //            {
+        //                files.append(file);
+        //            }
+        //        }
+        //        else if(!folders.contains(file->topLevelFolderId))
+        //        {
+        //            folders.append(file->topLevelFolderId);
+        //        }
     }
 }
 
 int TransferMetaData::getFileTransfersCancelled() const
 {
-    return mFiles.cancelledTransfers.size();
+    return mFiles.count(Files::CANCELLED);
 }
 
 int TransferMetaData::getTotaTransfersCancelled() const
 {
-    return mFiles.cancelledTransfers.size() + mEmptyFolders.cancelledTransfers.size();
+    return mFiles.count(Files::CANCELLED) + mEmptyFolders.count(EmptyFolders::CANCELLED);
 }
 
 int TransferMetaData::getNonExistentCount() const
 {
-    return mFiles.nonExistFailedTransfers.size();
+    return mFiles.count(Files::NON_EXIST_FAILED);
 }
 
 TransferMetaDataItemId TransferMetaData::getFirstTransferIdByState(TransferData::TransferState state) const
@@ -390,26 +393,15 @@ QList<TransferMetaDataItemId> TransferMetaData::getTransferIdsByState(TransferDa
     return ids;
 }
 
+//Only folders without files are added to mEmptyFolders
 int TransferMetaData::getEmptyFolderTransfersOK() const
 {
-    return getEmptyFolders(mEmptyFolders.completedTransfers);
+    return mEmptyFolders.count(EmptyFolders::COMPLETED);
 }
 
 int TransferMetaData::getEmptyFolderTransfersFailed() const
 {
-    return getEmptyFolders(mEmptyFolders.failedTransfers);
-}
-
-int TransferMetaData::getEmptyFolders(const QMap<TransferMetaDataItemId, std::shared_ptr<TransferMetaDataFolderItem>>& folders) const
-{
-    auto counter(0);
-
-    foreach(auto& folder, folders)
-    {
-       folder->files.size() == 0 ? counter++ : counter;
-    }
-
-    return counter;
+    return mEmptyFolders.count(EmptyFolders::FAILED);
 }
 
 void TransferMetaData::setCreatedFromOtherSession()
@@ -420,8 +412,7 @@ void TransferMetaData::setCreatedFromOtherSession()
 void TransferMetaData::addFile(int tag)
 {
     TransferMetaDataItemId id(tag, mega::INVALID_HANDLE);
-    auto fileItem = std::make_shared<TransferMetaDataItem>(id);
-    mFiles.pendingTransfers.insert(id, fileItem);
+    mFiles.addPending(TransferMetaDataItem(id));
     mTotalFileCount++;
 
     if(mStartedTopLevelTransfers <= mInitialTopLevelTransfers)
@@ -437,9 +428,9 @@ void TransferMetaData::addFile(int tag)
 void TransferMetaData::addFileFromFolder(int folderTag, int fileTag)
 {
     TransferMetaDataItemId fileId(fileTag, mega::INVALID_HANDLE);
-    auto fileItem = std::make_shared<TransferMetaDataItem>(fileId);
-    fileItem->topLevelFolderId.tag = folderTag;
-    mFiles.pendingTransfers.insert(fileId, fileItem);
+    TransferMetaDataItem fileItem(fileId);
+    fileItem.topLevelFolderId.tag = folderTag;
+    mFiles.addPending(fileItem);
 
     TransferMetaDataItemId folderId(folderTag, mega::INVALID_HANDLE);
     auto folderItem = mFolders.value(folderId, nullptr);
@@ -451,7 +442,7 @@ void TransferMetaData::addFileFromFolder(int folderTag, int fileTag)
         addInitialPendingTopLevelTransferFromOtherSession(true);
     }
 
-    folderItem->files.pendingTransfers.insert(fileId, fileItem);
+    folderItem->files++;
 }
 
 void TransferMetaData::topLevelFolderScanningFinished(int filecount)
@@ -471,7 +462,7 @@ void TransferMetaData::processCancelled()
 
 void TransferMetaData::checkAndSendNotification()
 {
-    if (mFinishedTopLevelTransfers == mInitialTopLevelTransfers && mFiles.pendingTransfers.isEmpty())
+    if (mFinishedTopLevelTransfers == mInitialTopLevelTransfers && mFiles.count(Files::PENDING) == 0)
     {
         //If all the transfers have been cancelled, do not show any notification
         if (Preferences::instance()->isNotificationEnabled(Preferences::NotificationsTypes::COMPLETED_UPLOADS_DOWNLOADS))
@@ -541,7 +532,7 @@ void TransferMetaData::checkScanningState()
     //Only for Top Level transfers
     if(mInitialTopLevelTransfers > 0 &&
             ((!mProcessCancelled && ((mTotalFileCount == mFiles.size() && mStartedTopLevelTransfers == mInitialTopLevelTransfers)))
-            || (mProcessCancelled && mFiles.pendingTransfers.isEmpty())))
+            || (mProcessCancelled && mFiles.count(Files::PENDING) == 0)))
     {
         //This method is called from the transfer model secondary thread
         auto id = getAppId();
@@ -651,10 +642,7 @@ void TransferMetaData::retryFileFromFolderFailingItem(int fileTag, int folderTag
 {
     TransferMetaDataItemId fileId(fileTag, nodeHandle);
 
-    auto removed = mFiles.failedTransfers.remove(fileId);
-    removed += mFiles.nonExistFailedTransfers.remove(fileId);
-
-    if(removed != 0)
+    if(mFiles.removeFailed(fileId.tag))
     {
         TransferMetaDataItemId folderId(folderTag, mega::INVALID_HANDLE);
         if(mFolders.contains(folderId))
@@ -673,10 +661,7 @@ void TransferMetaData::retryFailingFile(int tag, mega::MegaHandle nodeHandle)
     //Don´t use isSingleTransfer as this one takes into account empty folders
     auto isSingle(getTotalFiles() == 1);
 
-    auto removed = mFiles.failedTransfers.remove(fileId);
-    removed += mFiles.nonExistFailedTransfers.remove(fileId);
-
-    if(removed != 0)
+    if(mFiles.removeFailed(fileId.tag))
     {
         if(isSingle)
         {
@@ -692,8 +677,7 @@ void TransferMetaData::retryFailingFile(int tag, mega::MegaHandle nodeHandle)
 
 void TransferMetaData::retryAllPressed()
 {
-    mFiles.failedTransfers.clear();
-    mFiles.nonExistFailedTransfers.clear();
+    mFiles.removeAllFailed();
 
     if(mNotification)
     {
@@ -788,7 +772,7 @@ bool DownloadTransferMetaData::hasBeenPreviouslyCompleted(mega::MegaTransfer *tr
     //If the file has been previously completed, the node is already on the CD.
     //If not, the file should be uploaded again
     TransferMetaDataItemId fileId(-1, transfer->getNodeHandle());
-    return mFiles.completedTransfers.contains(fileId);
+    return mFiles.contains(fileId.tag, Files::COMPLETED);
 }
 
 std::shared_ptr<TransferMetaData> DownloadTransferMetaData::createNonExistData()
@@ -877,15 +861,10 @@ bool UploadTransferMetaData::hasBeenPreviouslyCompleted(mega::MegaTransfer *tran
 {
     //If the file has been previously completed, the node is already on the CD.
     //If not, the file should be uploaded again
-    foreach(auto& file, mFiles.completedTransfersByFolderHandle.values(transfer->getParentHandle()))
-    {
-        if(file->id.name == QString::fromUtf8(transfer->getFileName()))
-        {
-            return true;
-        }
-    }
-
-    return false;
+    auto fileName(QString::fromUtf8(transfer->getFileName()));
+    return mFiles.anyCompletedInFolder(transfer->getParentHandle(), [&fileName](const TransferMetaDataItem& file){
+        return file.id.name == fileName;
+    });
 }
 
 std::shared_ptr<TransferMetaData> UploadTransferMetaData::createNonExistData()
@@ -955,8 +934,7 @@ bool UploadTransferMetaData::finish(mega::MegaTransfer *transfer, mega::MegaErro
 
 //////////CONTAINER AND MANAGER
 
-QHash<unsigned long long, std::shared_ptr<TransferMetaData>> TransferMetaDataContainer::transferAppData = QHash<unsigned long long, std::shared_ptr<TransferMetaData>>();
-QMutex TransferMetaDataContainer::mMutex;
+std::array<TransferMetaDataContainer::Shard, TransferMetaDataContainer::SHARDS> TransferMetaDataContainer::mShards;
 
 bool TransferMetaDataContainer::start(mega::MegaTransfer *transfer)
 {
@@ -1019,7 +997,7 @@ void TransferMetaDataContainer::retryTransfer(mega::MegaTransfer *transfer, unsi
         {
             if(!transfer->isFolderTransfer())
             {
-                QMutexLocker lock(&mMutex);
+                QMutexLocker lock(&shardOf(appDataId).mutex);
                 data->retryFailingFile(transfer->getTag(), transfer->getNodeHandle());
             }
 
@@ -1029,7 +1007,7 @@ void TransferMetaDataContainer::retryTransfer(mega::MegaTransfer *transfer, unsi
                 if(nonExistData)
                 {
                     {
-                        QMutexLocker lock(&mMutex);
+                        QMutexLocker lock(&shardOf(data->mNonExistsFailAppId).mutex);
                         nonExistData->retryFailingFile(transfer->getTag(), transfer->getNodeHandle());
                     }
 
@@ -1049,7 +1027,7 @@ void TransferMetaDataContainer::retryTransfer(mega::MegaTransfer *transfer, unsi
         if(data)
         {
             {
-                QMutexLocker lock(&mMutex);
+                QMutexLocker lock(&shardOf(data->getAppId()).mutex);
                 data->retryFileFromFolderFailingItem(transfer->getTag(), transfer->getFolderTransferTag(),transfer->getNodeHandle());
             }
 
@@ -1059,7 +1037,7 @@ void TransferMetaDataContainer::retryTransfer(mega::MegaTransfer *transfer, unsi
                 if(nonExistData)
                 {
                     {
-                        QMutexLocker lock(&mMutex);
+                        QMutexLocker lock(&shardOf(data->mNonExistsFailAppId).mutex);
                         nonExistData->retryFileFromFolderFailingItem(transfer->getTag(), transfer->getFolderTransferTag(), transfer->getNodeHandle());
                     }
 
@@ -1074,20 +1052,106 @@ void TransferMetaDataContainer::retryTransfer(mega::MegaTransfer *transfer, unsi
     }
 }
 
+void TransferMetaDataContainer::retryAllPressed()
+{
+    for(auto& shard : mShards)
+    {
+        QMutexLocker lock(&shard.mutex);
+        foreach(auto& appdata, shard.transferAppData)
+        {
+            appdata->retryAllPressed();
+        }
+    }
+}
+
 bool TransferMetaDataContainer::addAppData(unsigned long long appId, std::shared_ptr<TransferMetaData> data)
 {
-    QMutexLocker lock(&mMutex);
-    return transferAppData.insert(appId, data) != transferAppData.end();
+    auto& shard(shardOf(appId));
+    QMutexLocker lock(&shard.mutex);
+    return shard.transferAppData.insert(appId, data) != shard.transferAppData.end();
 }
 
 void TransferMetaDataContainer::removeAppData(unsigned long long appId)
 {
-    auto data = TransferMetaDataContainer::getAppDataById(appId);
-    if(data)
     {
-        QMutexLocker lock(&mMutex);
-        transferAppData.remove(appId);
+        auto& shard(shardOf(appId));
+        QMutexLocker lock(&shard.mutex);
+        if(shard.transferAppData.remove(appId) == 0)
+        {
+            return;
+        }
+    }
+
+    //Forget the folder tags of the removed data
+    for(auto& shard : mShards)
+    {
+        QMutexLocker lock(&shard.mutex);
+        for(auto it = shard.appDataIdByFolderTag.begin(); it != shard.appDataIdByFolderTag.end();)
+        {
+            it = it.value() == appId ? shard.appDataIdByFolderTag.erase(it) : std::next(it);
+        }
+    }
+}
+
+std::shared_ptr<TransferMetaData> TransferMetaDataContainer::findAppDataByFolderTransferTag(int tag)
+{
+    TransferMetaDataItemId id(tag, mega::INVALID_HANDLE);
+    auto& tagShard(shardOfFolderTag(tag));
+
+    //Every nested file of a folder transfer asks for it, so the data found is remembered
+    unsigned long long cachedAppId(0);
+    bool cached(false);
+    {
+        QMutexLocker lock(&tagShard.mutex);
+        auto it = tagShard.appDataIdByFolderTag.constFind(tag);
+        if(it != tagShard.appDataIdByFolderTag.constEnd())
+        {
+            cachedAppId = it.value();
+            cached = true;
+        }
+    }
+
+    if(cached)
+    {
+        auto& shard(shardOf(cachedAppId));
+        QMutexLocker lock(&shard.mutex);
+        auto data = shard.transferAppData.value(cachedAppId);
+        if(data && data->isRetriedFolder(id))
+        {
+            return data;
+        }
     }
+
+    std::shared_ptr<TransferMetaData> found;
+    for(auto& shard : mShards)
+    {
+        QMutexLocker lock(&shard.mutex);
+        foreach(auto& appdata, shard.transferAppData)
+        {
+            if(appdata->isRetriedFolder(id))
+            {
+                found = appdata;
+                break;
+            }
+        }
+
+        if(found)
+        {
+            break;
+        }
+    }
+
+    QMutexLocker lock(&tagShard.mutex);
+    if(found)
+    {
+        tagShard.appDataIdByFolderTag.insert(tag, found->getAppId());
+    }
+    else if(cached)
+    {
+        tagShard.appDataIdByFolderTag.remove(tag);
+    }
+
+    return found;
 }
 
 bool TransferMetaDataContainer::finishFromFolderTransfer(mega::MegaTransfer *transfer, mega::MegaError *e)
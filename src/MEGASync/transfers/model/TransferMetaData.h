@@ -1,6 +1,7 @@
 #ifndef TRANSFERMETADATA_H
 #define TRANSFERMETADATA_H
 
+#include <array>
 #include <memory>
 #include <QVariant>
 #include <QPair>
@@ -9,6 +10,7 @@
 
 #include "Preferences/Preferences.h"
 #include "TransferItem.h"
+#include "TransferItemsByState.h"
 
 namespace mega
 {
@@ -41,33 +43,50 @@ struct TransferMetaDataItemId
 
 struct TransferMetaDataItem
 {
-    TransferMetaDataItem(const TransferMetaDataItemId& uid)
+    TransferMetaDataItem(const TransferMetaDataItemId& uid = TransferMetaDataItemId())
         :id(uid), state(TransferData::TRANSFER_ACTIVE), failedTransfer(nullptr){}
 
-    ~TransferMetaDataItem()
-    {
-    }
-
     TransferMetaDataItemId id;
     TransferMetaDataItemId topLevelFolderId;
-    TransferMetaDataItemId folderId;
+    mega::MegaHandle folderHandle = mega::INVALID_HANDLE;
     TransferData::TransferState state;
     std::shared_ptr<mega::MegaTransfer> failedTransfer;
-
-    virtual TransferData::TransferState getState(){return state;}
 };
 
+//Items are stored by value and found by tag; the state is a byte per item plus a counter per state
+//The lists of ids by state are only built when they are asked for
 template <class Type>
-struct TransferMetaDataItemsByState
-{ 
-    int size() const {return pendingTransfers.size() + completedTransfers.size() + failedTransfers.size() + cancelledTransfers.size() + nonExistFailedTransfers.size();}
+class TransferMetaDataItemsByState
+{
+public:
+    enum Bucket
+    {
+        PENDING = 0,
+        COMPLETED,
+        FAILED,
+        NON_EXIST_FAILED,
+        CANCELLED,
+        BUCKETS
+    };
+
+    int size() const {return mItems.size();}
+    int count(Bucket bucket) const {return mItems.count(bucket);}
+    bool contains(int tag, Bucket bucket) const {return mItems.contains(tag, bucket);}
+
+    Type* find(int tag, Bucket bucket) {return mItems.find(tag, bucket);}
+
+    template <typename Func>
+    void forEach(Bucket bucket, Func func) const
+    {
+        mItems.forEach(bucket, func);
+    }
 
-    QMap<TransferMetaDataItemId, std::shared_ptr<Type>> pendingTransfers;
-    QMap<TransferMetaDataItemId, std::shared_ptr<Type>> completedTransfers;
-    QMultiMap<mega::MegaHandle, std::shared_ptr<Type>> completedTransfersByFolderHandle;
-    QMap<TransferMetaDataItemId, std::shared_ptr<Type>> failedTransfers;
-    QMap<TransferMetaDataItemId, std::shared_ptr<Type>> nonExistFailedTransfers;
-    QMap<TransferMetaDataItemId, std::shared_ptr<Type>> cancelledTransfers;
+    //True if func(item) is true for a completed item of the folder
+    template <typename Func>
+    bool anyCompletedInFolder(mega::MegaHandle folderHandle, Func func) const
+    {
+        return mItems.anyInGroup(folderHandle, COMPLETED, func);
+    }
 
     TransferMetaDataItemId getFirstTransferIdByState(TransferData::TransferState state) const
     {
@@ -75,95 +94,32 @@ struct TransferMetaDataItemsByState
         {
             case TransferData::TRANSFER_COMPLETED:
             {
-                if(!completedTransfers.isEmpty())
-                {
-                    return completedTransfers.first()->id;
-                }
-                break;
+                return firstId(COMPLETED);
             }
             case TransferData::TRANSFER_CANCELLED:
             {
-                if(!cancelledTransfers.isEmpty())
-                {
-                    return cancelledTransfers.first()->id;
-                }
-                break;
+                return firstId(CANCELLED);
             }
             case TransferData::TRANSFER_FAILED:
             {
-                if(!failedTransfers.isEmpty())
-                {
-                    return failedTransfers.first()->id;
-                }
-                if(!nonExistFailedTransfers.isEmpty())
-                {
-                    return nonExistFailedTransfers.first()->id;
-                }
-                break;
+                auto id(firstId(FAILED));
+                return id.isValid() ? id : firstId(NON_EXIST_FAILED);
             }
             default:
             {
-                if(!pendingTransfers.isEmpty())
-                {
-                    return pendingTransfers.first()->id;
-                }
-                break;
+                return firstId(PENDING);
             }
         }
-
-        return TransferMetaDataItemId();
     }
+
     QList<TransferMetaDataItemId> getTransferIdsByState(TransferData::TransferState state) const
     {
         QList<TransferMetaDataItemId> ids;
-
-        switch(state)
-        {
-            case TransferData::TRANSFER_COMPLETED:
-            {
-                if(!completedTransfers.isEmpty())
-                {
-                    foreach(auto& item, completedTransfers.keys())
-                    {
-                        ids.append(item);
-                    }
-                }
-                break;
-            }
-            case TransferData::TRANSFER_CANCELLED:
-            {
-                if(!cancelledTransfers.isEmpty())
-                {
-                    foreach(auto& item, cancelledTransfers.keys())
-                    {
-                        ids.append(item);
-                    }
-                }
-                break;
-            }
-            case TransferData::TRANSFER_FAILED:
-            {
-                if(!failedTransfers.isEmpty())
-                {
-                    foreach(auto& item, failedTransfers.keys())
-                    {
-                        ids.append(item);
-                    }
-                }
-                break;
-            }
-            default:
-            {
-                if(!pendingTransfers.isEmpty())
-                {
-                    foreach(auto& item, pendingTransfers.keys())
-                    {
-                        ids.append(item);
-                    }
-                }
-                break;
-            }
-        }
+        auto bucket(bucketOf(state));
+        ids.reserve(count(bucket));
+        forEach(bucket, [&ids](const Type& item){
+            ids.append(item.id);
+        });
 
         return ids;
     }
@@ -180,76 +136,120 @@ struct TransferMetaDataItemsByState
 
 private:
     bool mHasChanged = false;
+    TransferItemsByState<Type, BUCKETS> mItems;
 
     friend class TransferMetaData;
-    void insertItem(TransferData::TransferState state, const std::shared_ptr<Type>& item)
+    static Bucket bucketOf(TransferData::TransferState state)
     {
-        removeItem(item);
-
-        item->state = state;
         switch(state)
         {
             case TransferData::TRANSFER_COMPLETED:
             {
-                completedTransfers.insert(item->id, item);
-                completedTransfersByFolderHandle.insert(item->folderId.handle, item);
-                break;
+                return COMPLETED;
             }
             case TransferData::TRANSFER_CANCELLED:
             {
-                cancelledTransfers.insert(item->id, item);
-                break;
+                return CANCELLED;
             }
             case TransferData::TRANSFER_FAILED:
             {
-                failedTransfers.insert(item->id, item);
-                break;
+                return FAILED;
             }
             default:
             {
-                pendingTransfers.insert(item->id, item);
-                break;
+                return PENDING;
             }
         }
+    }
+
+    TransferMetaDataItemId firstId(Bucket bucket) const
+    {
+        const auto& tags(mItems.tags(bucket));
+        return tags.empty() ? TransferMetaDataItemId() : mItems.find(tags.front())->id;
+    }
+
+    void addPending(const Type& item)
+    {
+        mItems.insert(item.id.tag, PENDING, item);
+    }
+
+    //Adds the item if it is not stored yet
+    void insertItem(TransferData::TransferState state, const Type& item)
+    {
+        auto bucket(bucketOf(state));
+        auto stored(mItems.find(item.id.tag));
+        if(stored)
+        {
+            *stored = item;
+            mItems.setState(item.id.tag, bucket);
+        }
+        else
+        {
+            stored = mItems.insert(item.id.tag, bucket, item);
+        }
+
+        stored->state = state;
+        if(bucket == COMPLETED)
+        {
+            mItems.setGroup(item.id.tag, item.folderHandle);
+        }
+        setHasChanged(true);
+    }
 
+    //Moves an item already stored, e.g. a pending one which has finished
+    void moveItem(TransferData::TransferState state, Type* item)
+    {
+        auto bucket(bucketOf(state));
+        item->state = state;
+        mItems.setState(item->id.tag, bucket);
+        if(bucket == COMPLETED)
+        {
+            mItems.setGroup(item->id.tag, item->folderHandle);
+        }
         setHasChanged(true);
     }
 
-    void removeItem(const std::shared_ptr<Type>& item)
+    void insertNonExistFailed(const Type& item)
     {
-        switch(item->state)
+        auto stored(mItems.insert(item.id.tag, NON_EXIST_FAILED, item));
+        if(stored)
         {
-            case TransferData::TRANSFER_COMPLETED:
-            {
-                completedTransfers.remove(item->id);
-                completedTransfersByFolderHandle.remove(item->folderId.handle, item);
-                break;
-            }
-            case TransferData::TRANSFER_CANCELLED:
-            {
-                cancelledTransfers.remove(item->id);
-                break;
-            }
-            case TransferData::TRANSFER_FAILED:
-            {
-                failedTransfers.remove(item->id);
-                break;
-            }
-            default:
-            {
-                pendingTransfers.remove(item->id);
-                break;
-            }
+            stored->state = TransferData::TRANSFER_FAILED;
         }
     }
+
+    void moveToNonExistFailed(Type* item)
+    {
+        item->state = TransferData::TRANSFER_FAILED;
+        mItems.setState(item->id.tag, NON_EXIST_FAILED);
+    }
+
+    void removeItem(Type* item)
+    {
+        mItems.remove(item->id.tag);
+    }
+
+    //Returns true if a failed item has been removed
+    bool removeFailed(int tag)
+    {
+        auto bucket(mItems.stateOf(tag));
+        return (bucket == FAILED || bucket == NON_EXIST_FAILED) && mItems.remove(tag);
+    }
+
+    void removeAllFailed()
+    {
+        mItems.removeAll(FAILED);
+        mItems.removeAll(NON_EXIST_FAILED);
+    }
 };
 
 struct TransferMetaDataFolderItem : public TransferMetaDataItem
 {
-    TransferMetaDataFolderItem(const TransferMetaDataItemId& id)
+    TransferMetaDataFolderItem(const TransferMetaDataItemId& id = TransferMetaDataItemId())
         : TransferMetaDataItem(id){}
 
-    TransferMetaDataItemsByState<TransferMetaDataItem> files;
+    //Files of the folder; the items themselves are kept in the files of the TransferMetaData
+    int files = 0;
 };
 
 class TransferMetaData
@@ -283,7 +283,7 @@ public:
     int getTotalFiles() const;
     int getFileTransfersOK() const;
     int getFileTransfersFailed() const;
-    void getFileTransferFailedTags(QList<std::shared_ptr<TransferMetaDataItem> > &files, QList<TransferMetaDataItemId>& folders) const;
+    void getFileTransferFailedTags(QList<TransferMetaDataItem>& files, QList<TransferMetaDataItemId>& folders) const;
     QList<TransferMetaDataItemId> getFileFailedTagsFromFolderTag(const TransferMetaDataItemId& folderId) const;
     int getFileTransfersCancelled() const;
     int getTotaTransfersCancelled() const;
@@ -327,7 +327,6 @@ protected:
     TransferMetaDataItemsByState<TransferMetaDataItem> mFiles;
     QMap<TransferMetaDataItemId, std::shared_ptr<TransferMetaDataFolderItem>> mFolders;
     TransferMetaDataItemsByState<TransferMetaDataFolderItem> mEmptyFolders;
-    int getEmptyFolders(const QMap<TransferMetaDataItemId, std::shared_ptr<TransferMetaDataFolderItem> > &folders) const;
 
     int mTransferDirection;
     bool mCreateRootFolder;
@@ -416,14 +415,7 @@ public:
     static bool finishFromFolderTransfer(mega::MegaTransfer* transfer, mega::MegaError* e);
 
     static void retryTransfer(mega::MegaTransfer* transfer, unsigned long long appDataId);
-    static void retryAllPressed()
-    {
-        QMutexLocker lock(&mMutex);
-        foreach(auto& appdata, transferAppData)
-        {
-            appdata->retryAllPressed();
-        }
-    }
+    static void retryAllPressed();
 
     template <typename TYPE = TransferMetaData>
     static std::shared_ptr<TYPE> getAppData(mega::MegaTransfer* transfer)
@@ -447,8 +439,9 @@ public:
     template <typename TYPE = TransferMetaData>
     static std::shared_ptr<TYPE> getAppDataById(unsigned long long appId)
     {
-        QMutexLocker lock(&mMutex);
-        auto data = transferAppData.value(appId);
+        auto& shard(shardOf(appId));
+        QMutexLocker lock(&shard.mutex);
+        auto data = shard.transferAppData.value(appId);
         return std::dynamic_pointer_cast<TYPE>(data);
     }
 
@@ -466,17 +459,7 @@ public:
     template <typename TYPE = TransferMetaData>
     static std::shared_ptr<TYPE> getAppDataByFolderTransferTag(int tag)
     {
-        QMutexLocker lock(&mMutex);
-        TransferMetaDataItemId id(tag, mega::INVALID_HANDLE);
-        foreach(auto& appdata, transferAppData)
-        {
-            if(appdata->isRetriedFolder(id))
-            {
-                return std::dynamic_pointer_cast<TYPE>(appdata);
-            }
-        }
-
-        return nullptr;
+        return std::dynamic_pointer_cast<TYPE>(findAppDataByFolderTransferTag(tag));
     }
 
     static bool addAppData(unsigned long long appId, std::shared_ptr<TransferMetaData> data);
@@ -511,8 +494,30 @@ public:
     }
 
 private:
-    static QHash<unsigned long long, std::shared_ptr<TransferMetaData>> transferAppData;
-    static QMutex mMutex;
+    //The app data is split by id in shards with their own lock, so that the transfers thread
+    //and the UI only wait for each other when they use batches of the same shard
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<unsigned long long, std::shared_ptr<TransferMetaData>> transferAppData;
+        //App data id of the folder transfer tags found before, sharded by tag
+        QHash<int, unsigned long long> appDataIdByFolderTag;
+    };
+    static const int SHARDS = 16;
+
+    static Shard& shardOf(unsigned long long appId)
+    {
+        return mShards[appId % SHARDS];
+    }
+
+    static Shard& shardOfFolderTag(int tag)
+    {
+        return mShards[static_cast<unsigned int>(tag) % SHARDS];
+    }
+
+    static std::shared_ptr<TransferMetaData> findAppDataByFolderTransferTag(int tag);
+
+    static std::array<Shard, SHARDS> mShards;
 };
 
 #endif // TRANSFERMETADATA_H
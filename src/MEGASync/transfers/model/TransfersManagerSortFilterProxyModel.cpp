@@ -19,7 +19,9 @@ TransfersManagerSortFilterProxyModel::TransfersManagerSortFilterProxyModel(QObje
       mNextTransferTypes (mTransferTypes),
       mNextFileTypes (mFileTypes),
       mSortCriterion (SortCriterion::PRIORITY),
-      mThreadPool (ThreadPoolSingleton::getInstance())
+      mThreadPool (ThreadPoolSingleton::getInstance()),
+      mSortFilterIndex (sortKeysComparators()),
+      mFilterFromIndex (false)
 {
     connect(&mFilterWatcher, &QFutureWatcher<void>::finished,
             this, &TransfersManagerSortFilterProxyModel::onModelSortedFiltered);
@@ -62,7 +64,7 @@ void TransfersManagerSortFilterProxyModel::sort(int sortCriterion, Qt::SortOrder
         {
             QSortFilterProxyModel::sort(-1,mSortOrder);
         }
-        QSortFilterProxyModel::sort(0, mSortOrder);
+        sortByRanks();
         finishProcessingInOtherThread();
     });
     mFilterWatcher.setFuture(sorting);
@@ -77,6 +79,10 @@ void TransfersManagerSortFilterProxyModel::setSourceModel(QAbstractItemModel *so
 {
     connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved,
             this, &TransfersManagerSortFilterProxyModel::onRowsAboutToBeRemoved, Qt::DirectConnection);
+    connect(sourceModel, &QAbstractItemModel::modelReset, this, [this]()
+    {
+        mSortFilterIndex.clear();
+    }, Qt::DirectConnection);
 
     QSortFilterProxyModel::setSourceModel(sourceModel);
 }
@@ -84,9 +90,15 @@ void TransfersManagerSortFilterProxyModel::setSourceModel(QAbstractItemModel *so
 void TransfersManagerSortFilterProxyModel::setFilterFixedString(const QString& pattern)
 {
     mFilterText = pattern;
-    refreshFilterFixedString();
+
+    updateFilters();
+    resetAllCounters();
+    emit modelAboutToBeChanged();
+
+    invalidateModelFilter();
 }
 
+//Used when the source model has changed with its signals blocked, so everything is recalculated
 void TransfersManagerSortFilterProxyModel::refreshFilterFixedString()
 {
     updateFilters();
@@ -94,6 +106,8 @@ void TransfersManagerSortFilterProxyModel::refreshFilterFixedString()
     resetAllCounters();
     emit modelAboutToBeChanged();
 
+    //Rows removed while the signals were blocked are still in the index
+    mSortFilterIndex.clear();
     invalidateModel();
 }
 
@@ -103,7 +117,7 @@ void TransfersManagerSortFilterProxyModel::textSearchTypeChanged()
     resetTransfersStateCounters();
     emit modelAboutToBeChanged();
 
-    invalidateModel();
+    invalidateModelFilter();
 }
 
 void TransfersManagerSortFilterProxyModel::invalidateModel()
@@ -123,14 +137,41 @@ void TransfersManagerSortFilterProxyModel::invalidateModel()
     QFuture<void> filtered = QtConcurrent::run([this](){
         startProcessingInOtherThread();
 
+        //Without a sort column the rows are only filtered here (rowCount() builds the mapping again),
+        //so they are sorted once, after their keys are in the index
+        QSortFilterProxyModel::sort(-1,mSortOrder);
         invalidate();
-        invalidateFilter();
+        rowCount();
 
-        if(sortOrder() == mSortOrder)
-        {
-            QSortFilterProxyModel::sort(-1,mSortOrder);
-        }
-        QSortFilterProxyModel::sort(0, mSortOrder);
+        sortByRanks();
+        finishProcessingInOtherThread();
+    });
+    mFilterWatcher.setFuture(filtered);
+}
+
+//Only the filter has changed: the rows already shown keep their order, the rows that are now
+//accepted are inserted in place and the rejected ones are removed, without sorting again
+void TransfersManagerSortFilterProxyModel::invalidateModelFilter()
+{
+    if(!dynamicSortFilter())
+    {
+        invalidateModel();
+        return;
+    }
+
+    auto sourceM = qobject_cast<TransfersModel*>(sourceModel());
+    if(sourceM)
+    {
+        sourceM->pauseModelProcessing(true);
+    }
+
+    emit layoutAboutToBeChanged();
+    QFuture<void> filtered = QtConcurrent::run([this](){
+        startProcessingInOtherThread();
+        //The rows have not changed since they were last filtered, so the index already holds them
+        mFilterFromIndex = true;
+        invalidateFilter();
+        mFilterFromIndex = false;
         finishProcessingInOtherThread();
     });
     mFilterWatcher.setFuture(filtered);
@@ -154,6 +195,36 @@ void TransfersManagerSortFilterProxyModel::blockMutexesAndSignals(bool value)
     blockSignals(value);
 }
 
+//It is called from a QtConcurrent thread, with the source model locked.
+//The index keeps the rows of every criterion in order, so the ranks are read without comparing keys
+void TransfersManagerSortFilterProxyModel::resolveSortRanks()
+{
+    mSortRanks.clear();
+
+    auto sourceM = qobject_cast<TransfersModel*>(sourceModel());
+    if(sourceM && mSortCriterion != SortCriterion::LAST)
+    {
+        std::vector<std::size_t> rankBySlot;
+        mSortFilterIndex.ranks(toInt(mSortCriterion), rankBySlot);
+
+        const auto tags(sourceM->getTransferTags());
+        mSortRanks.reserve(static_cast<std::size_t>(tags.size()));
+        for(auto tag : tags)
+        {
+            auto slot(mSortFilterIndex.slotOf(tag));
+            mSortRanks.push_back(slot != SortFilterIndex::NO_SLOT ? rankBySlot[slot] : SortFilterIndex::NO_SLOT);
+        }
+    }
+}
+
+//A descending sort reads the same ranks backwards
+void TransfersManagerSortFilterProxyModel::sortByRanks()
+{
+    resolveSortRanks();
+    QSortFilterProxyModel::sort(0, mSortOrder);
+    mSortRanks.clear();
+}
+
 void TransfersManagerSortFilterProxyModel::onModelSortedFiltered()
 {
     auto sourceM = qobject_cast<TransfersModel*>(sourceModel());
@@ -248,14 +319,94 @@ void TransfersManagerSortFilterProxyModel::updateFilters()
     mTransferStates = mNextTransferStates;
     mTransferTypes = mNextTransferTypes;
     mFileTypes = mNextFileTypes;
+
+    mSortFilterIndex.setFilter({static_cast<std::uint32_t>(mTransferStates),
+                                static_cast<std::uint32_t>(mTransferTypes),
+                                static_cast<std::uint32_t>(mFileTypes)});
+}
+
+std::array<TransfersManagerSortFilterProxyModel::SortFilterIndex::LessThan, static_cast<std::size_t>(SortCriterion::LAST)>
+TransfersManagerSortFilterProxyModel::sortKeysComparators()
+{
+    std::array<SortFilterIndex::LessThan, static_cast<std::size_t>(SortCriterion::LAST)> comparators;
+
+    comparators[toInt(SortCriterion::PRIORITY)] = [](const TransferSortKeys& left, const TransferSortKeys& right)
+    {
+        return left.priority > right.priority;
+    };
+    comparators[toInt(SortCriterion::TOTAL_SIZE)] = [](const TransferSortKeys& left, const TransferSortKeys& right)
+    {
+        return left.totalSize < right.totalSize;
+    };
+    comparators[toInt(SortCriterion::NAME)] = [](const TransferSortKeys& left, const TransferSortKeys& right)
+    {
+        return QString::compare(left.name, right.name, Qt::CaseInsensitive) < 0;
+    };
+    comparators[toInt(SortCriterion::SPEED)] = [](const TransferSortKeys& left, const TransferSortKeys& right)
+    {
+        return left.speed < right.speed;
+    };
+    //The index keeps the rows in order, so every comparator has to be a strict weak ordering:
+    //finished rows by finished time, then the processing ones by remaining time, then the rest
+    comparators[toInt(SortCriterion::TIME)] = [](const TransferSortKeys& left, const TransferSortKeys& right)
+    {
+        auto group = [](const TransferSortKeys& keys)
+        {
+            return keys.isFinished ? 0 : (keys.isProcessing ? 1 : 2);
+        };
+
+        auto leftGroup(group(left));
+        auto rightGroup(group(right));
+        if(leftGroup != rightGroup)
+        {
+            return leftGroup < rightGroup;
+        }
+        else if(leftGroup == 0)
+        {
+            return left.finishedTime < right.finishedTime;
+        }
+        else if(leftGroup == 1)
+        {
+            return left.remainingTime < right.remainingTime;
+        }
+        return false;
+    };
+
+    return comparators;
+}
+
+//Refreshes the cached keys and flags of the transfer and returns whether the type/state/file type filters accept it
+bool TransfersManagerSortFilterProxyModel::updateSortFilterIndex(const QExplicitlySharedDataPointer<TransferData>& transfer) const
+{
+    TransferSortKeys keys;
+    keys.name = transfer->mFilename;
+    keys.totalSize = transfer->mTotalSize;
+    keys.speed = transfer->mSpeed;
+    keys.priority = transfer->mPriority;
+    keys.remainingTime = transfer->mRemainingTime;
+    keys.finishedTime = transfer->getRawFinishedTime();
+    keys.isProcessing = transfer->isProcessing();
+    keys.isFinished = transfer->isFinished();
+
+    return mSortFilterIndex.update(transfer->mTag, keys,
+                                   {static_cast<std::uint32_t>(transfer->getState()),
+                                    static_cast<std::uint32_t>(transfer->mType),
+                                    static_cast<std::uint32_t>(toInt(transfer->mFileType))});
 }
 
 bool TransfersManagerSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    Q_UNUSED(sourceParent)
+
     bool accept(false);
 
-    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-    const auto d (qvariant_cast<TransferItem>(index.data()).getTransferData());
+    auto sourceM = qobject_cast<TransfersModel*>(sourceModel());
+    if(!sourceM)
+    {
+        return false;
+    }
+
+    const auto d (sourceM->getTransfer(sourceRow));
 
     if(d && d->mTag >= 0)
     {
@@ -264,9 +415,15 @@ bool TransfersManagerSortFilterProxyModel::filterAcceptsRow(int sourceRow, const
             return false;
         }
 
-        accept = (d->getState() & mTransferStates)
-                 && (d->mType & mTransferTypes)
-                 && (toInt(d->mFileType) & mFileTypes);
+        //A filter change reads the rows accepted by the bitsets; a changed row is refreshed first
+        if(mFilterFromIndex && mSortFilterIndex.contains(d->mTag))
+        {
+            accept = mSortFilterIndex.accepts(d->mTag);
+        }
+        else
+        {
+            accept = updateSortFilterIndex(d);
+        }
 
         if(!mFilterText.isEmpty())
         {
@@ -354,45 +511,30 @@ bool TransfersManagerSortFilterProxyModel::filterAcceptsRow(int sourceRow, const
     return accept;
 }
 
+//Rows are always filtered before being sorted, so their keys are already cached in the index
 bool TransfersManagerSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    const auto leftItem (qvariant_cast<TransferItem>(left.data()).getTransferData());
-    const auto rightItem (qvariant_cast<TransferItem>(right.data()).getTransferData());
+    //Full sorts compare the ranks read from the index before sorting, without going to the model
+    auto leftRow(static_cast<std::size_t>(left.row()));
+    auto rightRow(static_cast<std::size_t>(right.row()));
+    if(leftRow < mSortRanks.size() && rightRow < mSortRanks.size())
+    {
+        return mSortRanks[leftRow] < mSortRanks[rightRow];
+    }
+
+    auto sourceM = qobject_cast<TransfersModel*>(sourceModel());
+    if(!sourceM || mSortCriterion == SortCriterion::LAST)
+    {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+
+    //Rows sorted again one by one when they change (dynamic sort)
+    const auto leftItem (sourceM->getTransfer(left.row()));
+    const auto rightItem (sourceM->getTransfer(right.row()));
 
     if(leftItem && rightItem)
     {
-        switch (mSortCriterion)
-        {
-        case SortCriterion::PRIORITY:
-        {
-            return leftItem->mPriority > rightItem->mPriority;
-        }
-        case SortCriterion::TOTAL_SIZE:
-        {
-            return leftItem->mTotalSize < rightItem->mTotalSize;
-        }
-        case SortCriterion::NAME:
-        {
-            return QString::compare(leftItem->mFilename, rightItem->mFilename, Qt::CaseInsensitive) < 0;
-        }
-        case SortCriterion::SPEED:
-        {
-            return leftItem->mSpeed < rightItem->mSpeed;
-        }
-        case SortCriterion::TIME:
-        {
-            if(leftItem->isProcessing() || rightItem->isProcessing())
-            {
-                return leftItem->mRemainingTime < rightItem->mRemainingTime;
-            }
-            else if(leftItem->isFinished() && rightItem->isFinished())
-            {
-                return leftItem->getRawFinishedTime() < rightItem->getRawFinishedTime();
-            }
-        }
-        default:
-            break;
-        }
+        return mSortFilterIndex.lessThan(toInt(mSortCriterion), leftItem->mTag, rightItem->mTag);
     }
 
     return QSortFilterProxyModel::lessThan(left, right);
@@ -440,6 +582,8 @@ bool TransfersManagerSortFilterProxyModel::updateTransfersCounterFromTag(QExplic
         searchRowsRemoved = true;
     }
 
+    mSortFilterIndex.remove(transfer->mTag);
+
     if(!transfer->isSyncTransfer())
     {
        removeNonSyncedTransferFromCounter(transfer->mTag);
@@ -3,6 +3,7 @@
 
 #include "TransferItem.h"
 #include "TransfersSortFilterProxyBaseModel.h"
+#include "TransfersSortFilterIndex.h"
 
 #include <QSortFilterProxyModel>
 #include <QReadWriteLock>
@@ -13,6 +14,19 @@
 class TransferBaseDelegateWidget;
 class TransfersModel;
 
+//Values used to sort the rows, cached so lessThan does not query the source model
+struct TransferSortKeys
+{
+    QString name;
+    unsigned long long totalSize = 0;
+    unsigned long long speed = 0;
+    unsigned long long priority = 0;
+    int64_t remainingTime = 0;
+    int64_t finishedTime = 0;
+    bool isProcessing = false;
+    bool isFinished = false;
+};
+
 class TransfersManagerSortFilterProxyModel : public TransfersSortFilterProxyBaseModel
 {
         Q_OBJECT
@@ -106,10 +120,24 @@ private slots:
         void onModelSortedFiltered();
 
 private:
+        //Filter dimensions: state, type and file type
+        using SortFilterIndex = TransfersSortFilterIndex<TransferTag, TransferSortKeys,
+                                                         static_cast<std::size_t>(SortCriterion::LAST), 3>;
+
         ThreadPool* mThreadPool;
         QFutureWatcher<void> mFilterWatcher;
         QString mFilterText;
         mutable QPointer<QMimeData> mInternalMoveMimeData;
+        mutable SortFilterIndex mSortFilterIndex;
+        //Rank of each source row in the order of the sort criterion, read from the index before sorting
+        std::vector<std::size_t> mSortRanks;
+        //Set while only the filter changes, so the rows are accepted from the index bitsets
+        bool mFilterFromIndex;
+
+        static std::array<SortFilterIndex::LessThan, static_cast<std::size_t>(SortCriterion::LAST)> sortKeysComparators();
+        bool updateSortFilterIndex(const QExplicitlySharedDataPointer<TransferData>& transfer) const;
+        void resolveSortRanks();
+        void sortByRanks();
 
         void removeActiveTransferFromCounter(TransferTag tag) const;
         void removePausedTransferFromCounter(TransferTag tag) const;
@@ -124,6 +152,7 @@ private:
         void blockMutexesAndSignals(bool value);
 
         void invalidateModel();
+        void invalidateModelFilter();
 
         void resetAllCounters();
         void resetTransfersStateCounters();
@@ -31,9 +31,16 @@ const int START_THRESHOLD_THREAD = 50;
 const int FAILED_THRESHOLD_THREAD = 100;
 const int PAUSE_RESUME_THRESHOLD_THREAD = 300;
 const int CLEAR_THRESHOLD_THREAD = 300;
+const int PROGRESS_EVENTS_CAPACITY = 1 << 16;
+const int MAX_PROGRESS_EVENTS = PROGRESS_EVENTS_CAPACITY;
+const uint8_t MAX_PROGRESS_EVENT_RETRIES = 20;
 
 //LISTENER THREAD
-TransferThread::TransferThread() : mMaxTransfersToProcess(MAX_TRANSFERS)
+TransferThread::TransferThread() :
+    mProgressEvents(PROGRESS_EVENTS_CAPACITY),
+    mDeltaUploadBytes(0),
+    mDeltaDownloadBytes(0),
+    mMaxTransfersToProcess(MAX_TRANSFERS)
 {}
 
 TransferThread::TransfersToProcess TransferThread::processTransfers()
@@ -66,11 +73,54 @@ TransferThread::TransfersToProcess TransferThread::processTransfers()
    return transfers;
 }
 
+void TransferThread::takeProgressEvents(QHash<TransferTag, TransferProgress>& progressByTag, int maxEvents)
+{
+    //Coalesce the events by tag, only the most recent one is worth processing
+    mProgressEvents.drain([&progressByTag](const TransferProgress& progress){
+        auto it = progressByTag.find(progress.tag);
+        if(it == progressByTag.end())
+        {
+            progressByTag.insert(progress.tag, progress);
+        }
+        else if(it->notificationNumber < progress.notificationNumber)
+        {
+            *it = progress;
+        }
+    }, static_cast<std::size_t>(maxEvents));
+}
+
+bool TransferThread::mergeProgressEvent(const TransferProgress& progress)
+{
+    QMutexLocker lock(&mCacheMutex);
+
+    for(auto dataMap : {&mTransfersToProcess.startTransfersByTag, &mTransfersToProcess.startSyncTransfersByTag,
+                        &mTransfersToProcess.updateTransfersByTag})
+    {
+        auto it = dataMap->find(progress.tag);
+        if(it != dataMap->end())
+        {
+            if(it.value()->mNotificationNumber < progress.notificationNumber)
+            {
+                it.value()->update(progress);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void TransferThread::clear()
 {
     QMutexLocker lock(&mCacheMutex);
     mTransfersToProcess.clear();
+    mIdentitiesByTag.clear();
     mTransfersCount.clear();
+    mDeltaUploadBytes = 0;
+    mDeltaDownloadBytes = 0;
+
+    //Called from the GUI thread, which is the only consumer of the progress events
+    mProgressEvents.drain([](const TransferProgress&){}, mProgressEvents.capacity());
 }
 
 QList<QExplicitlySharedDataPointer<TransferData>> TransferThread::extractFromCache(QMap<int, QExplicitlySharedDataPointer<TransferData>>& dataMap, int spaceForTransfers)
@@ -107,12 +157,24 @@ QList<QExplicitlySharedDataPointer<TransferData>> TransferThread::extractFromCac
 
 QExplicitlySharedDataPointer<TransferData> TransferThread::createData(MegaTransfer *transfer, MegaError* e)
 {
-    QExplicitlySharedDataPointer<TransferData> d (new TransferData(transfer));
+    auto identity(internIdentity(transfer));
+    QExplicitlySharedDataPointer<TransferData> d (new TransferData(transfer, identity.get()));
     updateFailedTransfer(d, transfer, e);
 
     return d;
 }
 
+std::shared_ptr<const TransferIdentity> TransferThread::internIdentity(MegaTransfer* transfer)
+{
+    auto& identity = mIdentitiesByTag[transfer->getTag()];
+    if(!identity || !identity->matches(transfer))
+    {
+        identity = std::make_shared<const TransferIdentity>(transfer);
+    }
+
+    return identity;
+}
+
 QExplicitlySharedDataPointer<TransferData> TransferThread::checkIfRepeatedAndSubstituteInStartTransfers(QMap<int, QExplicitlySharedDataPointer<TransferData>>& dataMap, MegaTransfer* transfer)
 {
     if(dataMap.contains(transfer->getTag()))
@@ -241,7 +303,8 @@ void TransferThread::onTransferStart(MegaApi *, MegaTransfer *transfer)
             if(!isTemp)
             {
                 QMutexLocker counterLock(&mCountersMutex);
-                auto fileType = Utilities::getFileType(QString::fromStdString(transfer->getFileName()), QString());
+                applyDeltaBytes();
+                auto fileType = Utilities::getFileType(QString::fromStdString(transfer->getFileName()));
                 mTransfersCount.transfersByType[fileType]++;
 
                 if(transfer->getType() == MegaTransfer::TYPE_UPLOAD)
@@ -294,6 +357,43 @@ void TransferThread::onTransferStart(MegaApi *, MegaTransfer *transfer)
 
 }
 
+bool TransferThread::pushProgressEvent(MegaTransfer* transfer)
+{
+    //Only plain progress goes through the lock-free buffer, any other state change needs the cache
+    if(transfer->getState() != MegaTransfer::STATE_ACTIVE)
+    {
+        return false;
+    }
+
+    TransferProgress progress(transfer, MegaSyncApp->getMegaApi()->getCurrentSpeed(transfer->getType()));
+    return mProgressEvents.push(progress);
+}
+
+void TransferThread::addDeltaBytes(MegaTransfer* transfer)
+{
+    //The SDK thread must not wait for the GUI thread reading the counters
+    if(transfer->getType() == MegaTransfer::TYPE_UPLOAD)
+    {
+        mDeltaUploadBytes += transfer->getDeltaSize();
+    }
+    else
+    {
+        mDeltaDownloadBytes += transfer->getDeltaSize();
+    }
+}
+
+void TransferThread::applyDeltaBytes()
+{
+    //Called with mCountersMutex locked
+    auto uploadBytes(mDeltaUploadBytes.exchange(0));
+    mTransfersCount.completedUploadBytes += uploadBytes;
+    mLastTransfersCount.completedUploadBytes += uploadBytes;
+
+    auto downloadBytes(mDeltaDownloadBytes.exchange(0));
+    mTransfersCount.completedDownloadBytes += downloadBytes;
+    mLastTransfersCount.completedDownloadBytes += downloadBytes;
+}
+
 void TransferThread::onTransferUpdate(MegaApi *, MegaTransfer *transfer)
 {
     if (!transfer->isStreamingTransfer()
@@ -306,21 +406,10 @@ void TransferThread::onTransferUpdate(MegaApi *, MegaTransfer *transfer)
             return;
         }
 
-        {
-            QMutexLocker counterLock(&mCountersMutex);
-            if(transfer->getType() == MegaTransfer::TYPE_UPLOAD)
-            {
-                mTransfersCount.completedUploadBytes += transfer->getDeltaSize();
-
-                mLastTransfersCount.completedUploadBytes += transfer->getDeltaSize();
-            }
-            else
-            {
-                mTransfersCount.completedDownloadBytes += transfer->getDeltaSize();
-                mLastTransfersCount.completedDownloadBytes += transfer->getDeltaSize();
-            }
-        }
+        addDeltaBytes(transfer);
 
+        //If the buffer is full, fall back to the cache
+        if(!pushProgressEvent(transfer))
         {
             QMutexLocker cacheLock(&mCacheMutex);
             auto data = onTransferEvent(transfer, nullptr);
@@ -373,7 +462,8 @@ void TransferThread::onTransferFinish(MegaApi* megaApi, MegaTransfer *transfer,
             {
                 {
                     QMutexLocker counterLock(&mCountersMutex);
-                    auto fileType = Utilities::getFileType(QString::fromStdString(transfer->getFileName()), QString());
+                    applyDeltaBytes();
+                    auto fileType = Utilities::getFileType(QString::fromStdString(transfer->getFileName()));
                     if(transfer->getState() == MegaTransfer::STATE_CANCELLED || (transfer->getState() == MegaTransfer::STATE_FAILED
                                                                                  && transfer->isSyncTransfer()))
                     {
@@ -503,6 +593,9 @@ void TransferThread::onTransferFinish(MegaApi* megaApi, MegaTransfer *transfer,
             }
 
             data->mIsTempTransfer = isTemp;
+
+            //No more events for this transfer
+            mIdentitiesByTag.remove(transfer->getTag());
         }
     }
 }
@@ -520,19 +613,7 @@ void TransferThread::onTransferTemporaryError(MegaApi*, MegaTransfer *transfer,
             return;
         }
 
-        {
-            QMutexLocker counterLock(&mCountersMutex);
-            if(transfer->getType() == MegaTransfer::TYPE_UPLOAD)
-            {
-                mTransfersCount.completedUploadBytes += transfer->getDeltaSize();
-                mLastTransfersCount.completedUploadBytes += transfer->getDeltaSize();
-            }
-            else
-            {
-                mTransfersCount.completedDownloadBytes += transfer->getDeltaSize();
-                mLastTransfersCount.completedDownloadBytes += transfer->getDeltaSize();
-            }
-        }
+        addDeltaBytes(transfer);
 
         {
             QMutexLocker cacheLock(&mCacheMutex);
@@ -668,12 +749,14 @@ bool TransferThread::isTempTransfer(mega::MegaTransfer *transfer, bool removeCac
 TransfersCount TransferThread::getTransfersCount()
 {
     QMutexLocker lock(&mCountersMutex);
+    applyDeltaBytes();
     return mTransfersCount;
 }
 
 LastTransfersCount TransferThread::getLastTransfersCount()
 {
     QMutexLocker lock(&mCountersMutex);
+    applyDeltaBytes();
     return mLastTransfersCount;
 }
 
@@ -714,6 +797,7 @@ void TransfersModel::uiUnblocked()
 void TransferThread::resetCompletedUploads(QList<QExplicitlySharedDataPointer<TransferData>> transfersToReset)
 {
     QMutexLocker lock(&mCountersMutex);
+    applyDeltaBytes();
 
     foreach(auto& transfer, transfersToReset)
     {
@@ -768,6 +852,7 @@ void TransferThread::resetCompletedUploads(QList<QExplicitlySharedDataPointer<Tr
 void TransferThread::resetCompletedDownloads(QList<QExplicitlySharedDataPointer<TransferData>> transfersToReset)
 {
     QMutexLocker lock(&mCountersMutex);
+    applyDeltaBytes();
 
     foreach(auto& transfer, transfersToReset)
     {
@@ -945,7 +1030,7 @@ bool TransfersModel::hasChildren(const QModelIndex& parent) const
 {
     if (parent == DEFAULT_IDX)
     {
-        return !mTransfers.empty();
+        return !mTransfers.isEmpty();
     }
     return false;
 }
@@ -1167,6 +1252,8 @@ void TransfersModel::onProcessTransfers()
             mostPriorityTransferMayChanged(false);
         }
     }
+
+    processProgressEvents();
 }
 
 void TransfersModel::processStartTransfers(QList<QExplicitlySharedDataPointer<TransferData>>& transfersToStart)
@@ -1226,7 +1313,7 @@ void TransfersModel::updateTransfer(QExplicitlySharedDataPointer<TransferData> t
     checkActiveTransfer(transfer->mTag, transfer->isActive());
 
     mDataMutex.lockForWrite();
-    mTransfers[row] = transfer;
+    mTransfers.set(row, transfer);
     mDataMutex.unlock();
 }
 
@@ -1239,7 +1326,9 @@ void TransfersModel::processUpdateTransfers()
 
         auto row(getRowByTransferTag(itValue->mTag));
         auto d  = getTransfer(row);
-        if(d && !d->ignoreUpdate(itValue->getState()))
+        //A newer progress event may have already been applied
+        if(d && d->mNotificationNumber <= itValue->mNotificationNumber
+                && !d->ignoreUpdate(itValue->getState()))
         {
             if(!mCompletedTransfersByTag.contains(itValue->mNodeHandle))
             {
@@ -1263,6 +1352,69 @@ void TransfersModel::processUpdateTransfers()
     }
 }
 
+void TransfersModel::processProgressEvents()
+{
+    mTransferEventWorker->takeProgressEvents(mProgressEventsToProcess, MAX_PROGRESS_EVENTS);
+
+    if(mProgressEventsToProcess.isEmpty() || isUiBlockedModeActive() || !mModelMutex.tryLock())
+    {
+        return;
+    }
+
+    bool hasChanged(false);
+
+    for (auto it = mProgressEventsToProcess.begin(); it != mProgressEventsToProcess.end();)
+    {
+        auto tag(it.key());
+        auto row(getRowByTransferTag(tag));
+        if(row < 0)
+        {
+            //The transfer start has not been processed yet: update it while it waits in the cache.
+            //If it is not there, it is on its way to the model
+            if(!mTransferEventWorker->mergeProgressEvent(it.value()))
+            {
+                auto& retries = mProgressEventsRetries[tag];
+                if(++retries < MAX_PROGRESS_EVENT_RETRIES)
+                {
+                    ++it;
+                    continue;
+                }
+
+                //Neither in the model nor in the cache: the transfer is gone, and its finish event carried the final progress
+            }
+        }
+        else
+        {
+            auto d  = getTransfer(row);
+            if(d && !d->isFinished()
+                    && d->mNotificationNumber < it->notificationNumber
+                    && !d->ignoreUpdate(TransferData::convertState(it->state)))
+            {
+                //Written in place: the sorting/filtering threads only read the rows while holding mModelMutex
+                mDataMutex.lockForWrite();
+                d->update(it.value());
+                mDataMutex.unlock();
+
+                checkActiveTransfer(tag, d->isActive());
+                sendDataChanged(row);
+                d->resetStateHasChanged();
+                hasChanged = true;
+            }
+        }
+
+        mProgressEventsRetries.remove(tag);
+        it = mProgressEventsToProcess.erase(it);
+    }
+
+    mModelMutex.unlock();
+
+    if(hasChanged)
+    {
+        modelHasChanged(true);
+        updateTransfersCount();
+    }
+}
+
 void TransfersModel::processFailedTransfers()
 {
     for (auto it = mTransfersToProcess.failedTransfersByTag.begin(); it != mTransfersToProcess.failedTransfersByTag.end();)
@@ -1307,6 +1459,8 @@ void TransfersModel::processCancelTransfers()
     if(mRowsToCancel.size() > 0)
     {
         QModelIndexList indexesToCancel;
+        QList<TransferTag> tagsToCancel;
+        tagsToCancel.reserve(mRowsToCancel.size());
 
         foreach(auto tag, mRowsToCancel)
         {
@@ -1314,6 +1468,7 @@ void TransfersModel::processCancelTransfers()
             if(row >= 0)
             {
                 indexesToCancel.append(index(row,0, DEFAULT_IDX));
+                tagsToCancel.append(tag);
             }
 
             checkActiveTransfer(tag, false);
@@ -1323,20 +1478,14 @@ void TransfersModel::processCancelTransfers()
 
         float cancelledPercentage(indexesToCancel.size()/(rowCount()*1.0));
 
-        //For large amount of transfers, this is quite faster: remove all transfers and recreate the tags by row map
+        //For large amount of transfers, this is quite faster: remove all transfers by tag in one batch
+        //The storage only tombstones the removed rows, so the cost depends on the batch size, not on the model size
         if(indexesToCancel.size() >= QUICK_CANCEL_THRESHOLD
                 || (indexesToCancel.size() >  QUICK_CANCEL_MIN_THRESHOLD && cancelledPercentage > QUICK_CANCEL_PERCENTAGE_THRESHOLD))
         {
-            std::sort(indexesToCancel.begin(), indexesToCancel.end(),[](QModelIndex check1, QModelIndex check2){
-                return check1.row() > check2.row();
-            });
-
-            foreach(auto& index, indexesToCancel)
-            {
-                removeTransfer(index.row());
-            }
-
-            restoreTagsByRow();
+            mDataMutex.lockForWrite();
+            mTransfers.removeKeys(tagsToCancel);
+            mDataMutex.unlock();
         }
         else
         {
@@ -1745,23 +1894,23 @@ void TransfersModel::retryTransfersByAppDataId(const std::shared_ptr<TransferMet
 {
     QModelIndexList fileIndexesToRetry;
 
-    QList<std::shared_ptr<TransferMetaDataItem>> filesToRetry;
+    QList<TransferMetaDataItem> filesToRetry;
     QList<TransferMetaDataItemId> foldersToRetry;
 
     data->getFileTransferFailedTags(filesToRetry, foldersToRetry);
 
     QMultiMap<unsigned long long, QExplicitlySharedDataPointer<TransferData>> failedFilesToRetryOutOfTheModel;
 
-    foreach(auto item, qAsConst(filesToRetry))
+    foreach(auto& item, qAsConst(filesToRetry))
     {
-        auto itemIndex = index(getRowByTransferTag(item->id.tag),0);
+        auto itemIndex = index(getRowByTransferTag(item.id.tag),0);
         if(itemIndex.isValid())
         {
             fileIndexesToRetry.append(itemIndex);
         }
         else
         {
-           failedFilesToRetryOutOfTheModel.insert(data->getAppId(), getTransferByTag(item->failedTransfer->getTag()));
+           failedFilesToRetryOutOfTheModel.insert(data->getAppId(), getTransferByTag(item.failedTransfer->getTag()));
         }
     }
 
@@ -2386,10 +2535,7 @@ QExplicitlySharedDataPointer<TransferData> TransfersModel::getTransfer(int row)
     QExplicitlySharedDataPointer<TransferData> transfer(nullptr);
 
     mDataMutex.lockForRead();
-    if(row >= 0 && mTransfers.size() > row)
-    {
-        transfer = mTransfers.at(row);
-    }
+    transfer = mTransfers.at(row);
     mDataMutex.unlock();
 
     return transfer;
@@ -2405,29 +2551,40 @@ QExplicitlySharedDataPointer<TransferData> TransfersModel::getTransferByTag(int
     return getTransfer(getRowByTransferTag(tag));
 }
 
+//Tags of all the transfers, in row order, with a single walk of the storage
+QVector<TransferTag> TransfersModel::getTransferTags() const
+{
+    QVector<TransferTag> tags;
+
+    mDataMutex.lockForRead();
+    tags.reserve(mTransfers.size());
+    mTransfers.forEach([&tags](int, const QExplicitlySharedDataPointer<TransferData>& transfer){
+        tags.append(transfer ? transfer->mTag : -1);
+    });
+    mDataMutex.unlock();
+
+    return tags;
+}
+
 int TransfersModel::getRowByTransferTag(int tag) const
 {
-    auto result = mTagByOrder.contains(tag) ? mTagByOrder.value(tag).row() : -1;
+    mDataMutex.lockForRead();
+    auto result = mTransfers.rowOf(tag);
+    mDataMutex.unlock();
     return result;
 }
 
 void TransfersModel::addTransfer(QExplicitlySharedDataPointer<TransferData> transfer)
 {
     mDataMutex.lockForWrite();
-    mTransfers.append(transfer);
+    mTransfers.append(transfer->mTag, transfer);
     mDataMutex.unlock();
-
-    mTagByOrder.insert(transfer->mTag, QPersistentModelIndex(index(rowCount(DEFAULT_IDX) - 1,0)));
 }
 
 void TransfersModel::removeTransfer(int row)
 {
     mDataMutex.lockForWrite();
-    if(row >= 0  && row < mTransfers.size())
-    {
-        auto transfer = mTransfers.takeAt(row);
-        mTagByOrder.remove(transfer->mTag);
-    }
+    mTransfers.removeAt(row);
     mDataMutex.unlock();
 }
 
@@ -2448,23 +2605,10 @@ void TransfersModel::sendDataChanged(int row)
     }
 }
 
-void TransfersModel::restoreTagsByRow()
-{
-    mTagByOrder.clear();
-    for(int row = 0; row < rowCount(); ++row)
-    {
-        auto transfer = getTransfer(row);
-        if(transfer)
-        {
-            mTagByOrder.insert(transfer->mTag, QPersistentModelIndex(index(row,0)));
-        }
-    }
-}
-
 QList<QExplicitlySharedDataPointer<TransferData> > TransfersModel::getTransfersToIterate() const
 {
     mDataMutex.lockForRead();
-    auto transfers = mTransfers;
+    auto transfers = mTransfers.values<QList<QExplicitlySharedDataPointer<TransferData>>>();
     mDataMutex.unlock();
     return transfers;
 }
@@ -2763,13 +2907,14 @@ void TransfersModel::resetModel()
     mActiveTransfers.clear();
     mTransferEventWorker->clear();
     mTransfersToProcess.clear();
+    mProgressEventsToProcess.clear();
+    mProgressEventsRetries.clear();
     mTransfersProcessChanged = 0;
     mUpdateMostPriorityTransfer = 0;
     mUiBlockedCounter = 0;
 
     mDataMutex.lockForWrite();
     mTransfers.clear();
-    mTagByOrder.clear();
     mDataMutex.unlock();
 
     endResetModel();
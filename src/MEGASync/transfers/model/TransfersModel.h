@@ -4,7 +4,9 @@
 #include "QTMegaTransferListener.h"
 #include "TransferItem.h"
 #include "TransferMetaData.h"
+#include "TransfersStorage.h"
 #include "TransferRemainingTime.h"
+#include "MpscRingBuffer.h"
 #include "control/Preferences/Preferences.h"
 
 #include <megaapi.h>
@@ -15,9 +17,23 @@
 #include <QFutureWatcher>
 #include <QReadWriteLock>
 
+#include <array>
+#include <atomic>
 #include <set>
 #include <memory>
 
+//Counters indexed by file type, in a flat array instead of a map
+class FileTypeCounters
+{
+public:
+    long long& operator[](Utilities::FileType type) {return mCounts[Utilities::fileTypeIndex(type)];}
+    long long value(Utilities::FileType type) const {return mCounts[Utilities::fileTypeIndex(type)];}
+    void clear() {mCounts.fill(0);}
+
+private:
+    std::array<long long, Utilities::FILE_TYPE_COUNT> mCounts{};
+};
+
 struct TransfersCount
 {
     int totalUploads;
@@ -35,8 +51,8 @@ struct TransfersCount
     long long totalUploadBytes;
     long long totalDownloadBytes;
 
-    QMap<Utilities::FileType, long long> transfersByType;
-    QMap<Utilities::FileType, long long> transfersFinishedByType;
+    FileTypeCounters transfersByType;
+    FileTypeCounters transfersFinishedByType;
 
     TransfersCount():
         totalUploads(0),
@@ -131,6 +147,10 @@ public:
     void setMaxTransfersToProcess(uint16_t max);
 
     TransfersToProcess processTransfers();
+    //Progress updates of active transfers bypass the cache. Only the GUI thread may call it
+    void takeProgressEvents(QHash<TransferTag, TransferProgress>& progressByTag, int maxEvents);
+    //Applies a progress event to the transfer waiting in the cache. Returns false if it is not there
+    bool mergeProgressEvent(const TransferProgress& progress);
     void clear();
     void clearTransfersCount();
 
@@ -141,6 +161,9 @@ public slots:
     void onTransferTemporaryError(mega::MegaApi*,mega::MegaTransfer* transfer,mega::MegaError*);
 
 private:
+    bool pushProgressEvent(mega::MegaTransfer* transfer);
+    void addDeltaBytes(mega::MegaTransfer* transfer);
+    void applyDeltaBytes();
     bool isRetried(mega::MegaTransfer* transfer);
     bool isRetriedFolder(mega::MegaTransfer* transfer);
     bool isCompletedFromFolderRetry(mega::MegaTransfer* transfer);
@@ -150,6 +173,7 @@ private:
                               mega::MegaError* e);
 
     QExplicitlySharedDataPointer<TransferData> createData(mega::MegaTransfer* transfer, mega::MegaError *e);
+    std::shared_ptr<const TransferIdentity> internIdentity(mega::MegaTransfer* transfer);
     QExplicitlySharedDataPointer<TransferData> onTransferEvent(mega::MegaTransfer* transfer, mega::MegaError *e);
     QList<QExplicitlySharedDataPointer<TransferData>> extractFromCache(QMap<int, QExplicitlySharedDataPointer<TransferData>>& dataMap, int spaceForTransfers);
     QExplicitlySharedDataPointer<TransferData> checkIfRepeatedAndRemove(QMap<int, QExplicitlySharedDataPointer<TransferData>>& dataMap, mega::MegaTransfer *transfer);
@@ -178,9 +202,15 @@ private:
 
     cacheTransfers mTransfersToProcess;
     QMutex mCacheMutex;
+    MpscRingBuffer<TransferProgress> mProgressEvents;
+    //Protected by mCacheMutex
+    QHash<TransferTag, std::shared_ptr<const TransferIdentity>> mIdentitiesByTag;
     QMutex mCountersMutex;
     TransfersCount mTransfersCount;
     LastTransfersCount mLastTransfersCount;
+    //Bytes reported by the updates, added to the counters the next time mCountersMutex is taken
+    std::atomic<long long> mDeltaUploadBytes;
+    std::atomic<long long> mDeltaDownloadBytes;
     std::atomic<int16_t> mMaxTransfersToProcess;
 
     QList<int> mRetriedFolder;
@@ -286,6 +316,8 @@ public:
     QExplicitlySharedDataPointer<TransferData> getTransferByTag(int tag);
 
     int getRowByTransferTag(int tag) const;
+    QExplicitlySharedDataPointer<TransferData> getTransfer(int row) const;
+    QVector<TransferTag> getTransferTags() const;
     void sendDataChangedByTag(int tag);
 
     void blockModelSignals(bool state);
@@ -332,6 +364,7 @@ private slots:
     void processUpdateTransfers();
     void processCancelTransfers();
     void processSyncFailedTransfers();
+    void processProgressEvents();
     void cacheCancelTransfersTags();
     void processFailedTransfers();
     void onProcessTransfers();
@@ -343,11 +376,9 @@ private slots:
 
 private:
     void removeRows(QModelIndexList &indexesToRemove);
-    QExplicitlySharedDataPointer<TransferData> getTransfer(int row) const;
     void addTransfer(QExplicitlySharedDataPointer<TransferData>);
     void removeTransfer(int row);
     void sendDataChanged(int row);
-    void restoreTagsByRow();
     QList<QExplicitlySharedDataPointer<TransferData>> getTransfersToIterate() const;
 
     void retryTransfers(const QMultiMap<unsigned long long, QExplicitlySharedDataPointer<TransferData>> &transfersToRetry);
@@ -381,11 +412,13 @@ private:
     TransfersCount mTransfersCount;
     LastTransfersCount mLastTransfersCount;
 
-    QList<QExplicitlySharedDataPointer<TransferData>> mTransfers;
+    TransfersStorage<TransferTag, QExplicitlySharedDataPointer<TransferData>> mTransfers;
     QHash<int,QExplicitlySharedDataPointer<TransferData>> mFailedFoldersByTag;
     QHash<mega::MegaHandle,QPersistentModelIndex> mCompletedTransfersByTag;
 
     TransferThread::TransfersToProcess mTransfersToProcess;
+    QHash<TransferTag, TransferProgress> mProgressEventsToProcess;
+    QHash<TransferTag, uint8_t> mProgressEventsRetries;
     QFutureWatcher<void> mUpdateTransferWatcher;
     QFutureWatcher<void> mClearTransferWatcher;
     QFutureWatcher<QPair<int, int>> mAskForMostPriorityTransfersWatcher;
@@ -397,7 +430,6 @@ private:
     int mUiBlockedByCounter;
     uint8_t  mUiBlockedByCounterSafety;
 
-    QHash<TransferTag, QPersistentModelIndex> mTagByOrder;
     QList<TransferTag> mRowsToCancel;
     QPointer<QWidget> mCancelledFrom;
     bool mSyncsInRowsToCancel;
@@ -0,0 +1,371 @@
+#ifndef TRANSFERSSORTFILTERINDEX_H
+#define TRANSFERSSORTFILTERINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Sort keys and filter membership of the transfers shown by the Transfer Manager.
+//
+// Every row caches one record of sort keys in a slot, so comparing two rows does not go back to the
+// model. For each sort criterion the slots are also kept in order: a row is moved in the orders
+// whose keys changed when it is updated, so sorting only reads the rank of each row from the
+// order, and the reverse order is the same ranks read backwards. The comparators must be strict
+// weak orderings.
+// For each filter dimension (state, type, file type) and each flag bit there is a bitset of the
+// rows that carry it. Changing the filter only combines those bitsets word by word: the accepted
+// rows are the AND of, per dimension, the OR of the bitsets selected by the mask, and accepts()
+// then reads the result of a row without checking its flags again.
+// Rows are refreshed one by one with update(), which moves their bits in O(1).
+template <typename Tag, typename Keys, std::size_t Criteria, std::size_t Dimensions>
+class TransfersSortFilterIndex
+{
+public:
+    using LessThan = std::function<bool(const Keys&, const Keys&)>;
+    using Flags = std::array<std::uint32_t, Dimensions>;
+
+    static constexpr std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+    explicit TransfersSortFilterIndex(const std::array<LessThan, Criteria>& lessThan)
+        : mLessThan(lessThan)
+    {
+        mMasks.fill(~std::uint32_t(0));
+        for(std::size_t criterion = 0; criterion < Criteria; ++criterion)
+        {
+            mOrders[criterion] = Order(SlotLessThan{this, criterion});
+        }
+    }
+
+    TransfersSortFilterIndex(const TransfersSortFilterIndex&) = delete;
+    TransfersSortFilterIndex& operator=(const TransfersSortFilterIndex&) = delete;
+
+    std::size_t size() const
+    {
+        return mSlotByTag.size();
+    }
+
+    bool contains(const Tag& tag) const
+    {
+        return mSlotByTag.find(tag) != mSlotByTag.end();
+    }
+
+    // Adds the row or refreshes its keys and flags. Returns whether the current filter accepts it
+    bool update(const Tag& tag, const Keys& keys, const Flags& flags)
+    {
+        auto it(mSlotByTag.find(tag));
+        std::size_t slot(0);
+        if(it == mSlotByTag.end())
+        {
+            slot = allocateSlot();
+            mSlotByTag.emplace(tag, slot);
+            mKeys[slot] = keys;
+            for(std::size_t criterion = 0; criterion < Criteria; ++criterion)
+            {
+                mPositions[slot][criterion] = mOrders[criterion].insert(slot);
+            }
+            setFlags(slot, flags);
+            setBit(mAlive, slot, true);
+        }
+        else
+        {
+            slot = it->second;
+            updateKeys(slot, keys);
+            if(mFlags[slot] != flags)
+            {
+                clearFlags(slot);
+                setFlags(slot, flags);
+            }
+        }
+
+        auto accepted(matchesFilter(flags));
+        setBit(mAccepted, slot, accepted);
+        return accepted;
+    }
+
+    void remove(const Tag& tag)
+    {
+        auto it(mSlotByTag.find(tag));
+        if(it != mSlotByTag.end())
+        {
+            auto slot(it->second);
+            for(std::size_t criterion = 0; criterion < Criteria; ++criterion)
+            {
+                mOrders[criterion].erase(mPositions[slot][criterion]);
+            }
+            clearFlags(slot);
+            setBit(mAlive, slot, false);
+            setBit(mAccepted, slot, false);
+            mKeys[slot] = Keys();
+            mFreeSlots.push_back(slot);
+            mSlotByTag.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        mSlotByTag.clear();
+        for(auto& order : mOrders)
+        {
+            order.clear();
+        }
+        mPositions.clear();
+        mKeys.clear();
+        mFlags.clear();
+        mFreeSlots.clear();
+        mAlive.clear();
+        mAccepted.clear();
+        for(auto& dimension : mMembers)
+        {
+            for(auto& members : dimension)
+            {
+                members.clear();
+            }
+        }
+    }
+
+    // Recomputes the accepted rows from the flag bitsets, without visiting the rows
+    void setFilter(const Flags& masks)
+    {
+        if(masks == mMasks)
+        {
+            return;
+        }
+
+        mMasks = masks;
+
+        // Only the bitsets of flags in use are combined, and a dimension whose mask selects
+        // every flag in use does not filter anything
+        std::array<std::vector<const std::vector<std::uint64_t>*>, Dimensions> selected;
+        std::array<bool, Dimensions> filters;
+        for(std::size_t dimension = 0; dimension < Dimensions; ++dimension)
+        {
+            filters[dimension] = false;
+            for(std::size_t bit = 0; bit < FLAG_BITS; ++bit)
+            {
+                const auto& members(mMembers[dimension][bit]);
+                if(!members.empty())
+                {
+                    if(mMasks[dimension] & (std::uint32_t(1) << bit))
+                    {
+                        selected[dimension].push_back(&members);
+                    }
+                    else
+                    {
+                        filters[dimension] = true;
+                    }
+                }
+            }
+        }
+
+        for(std::size_t word = 0; word < mAlive.size(); ++word)
+        {
+            auto accepted(mAlive[word]);
+            for(std::size_t dimension = 0; dimension < Dimensions && accepted; ++dimension)
+            {
+                if(filters[dimension])
+                {
+                    std::uint64_t selectedRows(0);
+                    for(auto members : selected[dimension])
+                    {
+                        if(word < members->size())
+                        {
+                            selectedRows |= (*members)[word];
+                        }
+                    }
+                    accepted &= selectedRows;
+                }
+            }
+            mAccepted[word] = accepted;
+        }
+    }
+
+    bool accepts(const Tag& tag) const
+    {
+        auto it(mSlotByTag.find(tag));
+        return it != mSlotByTag.end() && testBit(mAccepted, it->second);
+    }
+
+    // Slot of the row, kept until the row is removed. NO_SLOT for unknown rows
+    std::size_t slotOf(const Tag& tag) const
+    {
+        auto it(mSlotByTag.find(tag));
+        return it != mSlotByTag.end() ? it->second : NO_SLOT;
+    }
+
+    // Compares the cached keys of two rows. Unknown rows sort after the known ones
+    bool lessThan(std::size_t criterion, const Tag& left, const Tag& right) const
+    {
+        return slotLessThan(criterion, slotOf(left), slotOf(right));
+    }
+
+    bool slotLessThan(std::size_t criterion, std::size_t left, std::size_t right) const
+    {
+        if(left == NO_SLOT || right == NO_SLOT)
+        {
+            return left != NO_SLOT && right == NO_SLOT;
+        }
+
+        return mLessThan[criterion](mKeys[left], mKeys[right]);
+    }
+
+    // Rank of every slot in the order of the criterion, walking the order without comparing keys.
+    // Free slots get the rank NO_SLOT, after every row
+    void ranks(std::size_t criterion, std::vector<std::size_t>& rankBySlot) const
+    {
+        rankBySlot.assign(mKeys.size(), NO_SLOT);
+        std::size_t rank(0);
+        for(auto slot : mOrders[criterion])
+        {
+            rankBySlot[slot] = rank++;
+        }
+    }
+
+private:
+    static constexpr std::size_t FLAG_BITS = 32;
+
+    struct SlotLessThan
+    {
+        const TransfersSortFilterIndex* index = nullptr;
+        std::size_t criterion = 0;
+
+        bool operator()(std::size_t left, std::size_t right) const
+        {
+            return index->mLessThan[criterion](index->mKeys[left], index->mKeys[right]);
+        }
+    };
+
+    // Rows with equal keys keep the order in which they got them
+    using Order = std::multiset<std::size_t, SlotLessThan>;
+
+    // Moves the slot only in the orders where the new keys do not compare equal to the old ones
+    void updateKeys(std::size_t slot, const Keys& keys)
+    {
+        std::array<bool, Criteria> moved;
+        for(std::size_t criterion = 0; criterion < Criteria; ++criterion)
+        {
+            const auto& lessThan(mLessThan[criterion]);
+            moved[criterion] = lessThan(mKeys[slot], keys) || lessThan(keys, mKeys[slot]);
+            if(moved[criterion])
+            {
+                mOrders[criterion].erase(mPositions[slot][criterion]);
+            }
+        }
+
+        mKeys[slot] = keys;
+
+        for(std::size_t criterion = 0; criterion < Criteria; ++criterion)
+        {
+            if(moved[criterion])
+            {
+                mPositions[slot][criterion] = mOrders[criterion].insert(slot);
+            }
+        }
+    }
+
+    static bool testBit(const std::vector<std::uint64_t>& bits, std::size_t slot)
+    {
+        return (slot / 64) < bits.size() && (bits[slot / 64] >> (slot % 64)) & 1;
+    }
+
+    static void setBit(std::vector<std::uint64_t>& bits, std::size_t slot, bool value)
+    {
+        if(slot / 64 >= bits.size())
+        {
+            if(!value)
+            {
+                return;
+            }
+            bits.resize(slot / 64 + 1, 0);
+        }
+
+        auto mask(std::uint64_t(1) << (slot % 64));
+        bits[slot / 64] = value ? (bits[slot / 64] | mask) : (bits[slot / 64] & ~mask);
+    }
+
+    std::size_t allocateSlot()
+    {
+        if(!mFreeSlots.empty())
+        {
+            auto slot(mFreeSlots.back());
+            mFreeSlots.pop_back();
+            return slot;
+        }
+
+        mKeys.emplace_back();
+        mFlags.emplace_back();
+        mPositions.emplace_back();
+        auto slot(mKeys.size() - 1);
+        if(slot / 64 >= mAlive.size())
+        {
+            mAlive.push_back(0);
+            mAccepted.push_back(0);
+        }
+        return slot;
+    }
+
+    bool matchesFilter(const Flags& flags) const
+    {
+        for(std::size_t dimension = 0; dimension < Dimensions; ++dimension)
+        {
+            if(!(flags[dimension] & mMasks[dimension]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setFlags(std::size_t slot, const Flags& flags)
+    {
+        mFlags[slot] = flags;
+        forEachFlag(flags, [this, slot](std::size_t dimension, std::size_t bit){
+            setBit(mMembers[dimension][bit], slot, true);
+        });
+    }
+
+    void clearFlags(std::size_t slot)
+    {
+        forEachFlag(mFlags[slot], [this, slot](std::size_t dimension, std::size_t bit){
+            setBit(mMembers[dimension][bit], slot, false);
+        });
+        mFlags[slot] = Flags();
+    }
+
+    template <typename Func>
+    static void forEachFlag(const Flags& flags, Func func)
+    {
+        for(std::size_t dimension = 0; dimension < Dimensions; ++dimension)
+        {
+            for(std::size_t bit = 0; bit < FLAG_BITS; ++bit)
+            {
+                if(flags[dimension] & (std::uint32_t(1) << bit))
+                {
+                    func(dimension, bit);
+                }
+            }
+        }
+    }
+
+    std::array<LessThan, Criteria> mLessThan;
+    Flags mMasks;
+
+    std::unordered_map<Tag, std::size_t> mSlotByTag;
+    std::vector<Keys> mKeys;
+    std::vector<Flags> mFlags;
+    std::array<Order, Criteria> mOrders;
+    std::vector<std::array<typename Order::iterator, Criteria>> mPositions;
+    std::vector<std::size_t> mFreeSlots;
+
+    std::vector<std::uint64_t> mAlive;
+    std::vector<std::uint64_t> mAccepted;
+    std::array<std::array<std::vector<std::uint64_t>, FLAG_BITS>, Dimensions> mMembers;
+};
+
+template <typename Tag, typename Keys, std::size_t Criteria, std::size_t Dimensions>
+constexpr std::size_t TransfersSortFilterIndex<Tag, Keys, Criteria, Dimensions>::NO_SLOT;
+
+#endif // TRANSFERSSORTFILTERINDEX_H
@@ -0,0 +1,408 @@
+#ifndef TRANSFERSSTORAGE_H
+#define TRANSFERSSTORAGE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Backing store for TransfersModel rows.
+//
+// Rows are kept in fixed size chunks. Removing a row only marks its slot as a tombstone and
+// updates the live counters, so removing a batch of rows costs O(batch * log(chunks)) instead of
+// shifting the whole list and rebuilding the tag index. The row of a tag is computed on demand
+// from a Fenwick tree of live rows per chunk plus a bitmap popcount inside the chunk.
+// Tombstones are compacted lazily, once they outnumber the live rows, which keeps the amortized
+// cost per removal constant.
+template <typename Key, typename Value, int ChunkSize = 1024>
+class TransfersStorage
+{
+    static_assert(ChunkSize > 0 && ChunkSize % 64 == 0, "ChunkSize must be a multiple of 64");
+
+public:
+    TransfersStorage() = default;
+
+    TransfersStorage(const TransfersStorage&) = delete;
+    TransfersStorage& operator=(const TransfersStorage&) = delete;
+
+    int size() const
+    {
+        return mSize;
+    }
+
+    bool isEmpty() const
+    {
+        return mSize == 0;
+    }
+
+    bool contains(const Key& key) const
+    {
+        return mSlotByKey.find(key) != mSlotByKey.end();
+    }
+
+    int tombstones() const
+    {
+        return mTombstones;
+    }
+
+    // Appends a new row and returns it, or -1 if the key is already stored
+    int append(const Key& key, const Value& value)
+    {
+        if(contains(key))
+        {
+            return -1;
+        }
+
+        if(mChunks.empty() || mChunks.back()->used == ChunkSize)
+        {
+            appendChunk();
+        }
+
+        auto chunkIndex(static_cast<int>(mChunks.size()) - 1);
+        auto& chunk(*mChunks.back());
+        auto offset(chunk.used++);
+
+        chunk.keys[offset] = key;
+        chunk.values[offset] = value;
+        chunk.setAlive(offset, true);
+        treeAdd(chunkIndex, 1);
+
+        mSlotByKey.emplace(key, toSlot(chunkIndex, offset));
+
+        return mSize++;
+    }
+
+    int rowOf(const Key& key) const
+    {
+        auto it(mSlotByKey.find(key));
+        if(it == mSlotByKey.end())
+        {
+            return -1;
+        }
+
+        auto chunkIndex(chunkOf(it->second));
+        auto offset(offsetOf(it->second));
+
+        return treePrefix(chunkIndex) + mChunks[chunkIndex]->aliveBefore(offset);
+    }
+
+    Value at(int row) const
+    {
+        auto slot(slotOf(row));
+        return slot.first >= 0 ? mChunks[slot.first]->values[slot.second] : Value();
+    }
+
+    bool set(int row, const Value& value)
+    {
+        auto slot(slotOf(row));
+        if(slot.first >= 0)
+        {
+            mChunks[slot.first]->values[slot.second] = value;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool removeAt(int row)
+    {
+        auto slot(slotOf(row));
+        if(slot.first >= 0)
+        {
+            auto& chunk(*mChunks[slot.first]);
+            mSlotByKey.erase(chunk.keys[slot.second]);
+            killSlot(slot.first, slot.second);
+            compactIfNeeded();
+            return true;
+        }
+
+        return false;
+    }
+
+    bool remove(const Key& key)
+    {
+        auto it(mSlotByKey.find(key));
+        if(it != mSlotByKey.end())
+        {
+            auto slot(it->second);
+            mSlotByKey.erase(it);
+            killSlot(chunkOf(slot), offsetOf(slot));
+            compactIfNeeded();
+            return true;
+        }
+
+        return false;
+    }
+
+    // Removes every key in the batch; unknown keys are ignored. Returns the number of removed rows
+    template <typename Container>
+    int removeKeys(const Container& keys)
+    {
+        int removed(0);
+
+        for(const auto& key : keys)
+        {
+            auto it(mSlotByKey.find(key));
+            if(it != mSlotByKey.end())
+            {
+                auto slot(it->second);
+                mSlotByKey.erase(it);
+                killSlot(chunkOf(slot), offsetOf(slot));
+                ++removed;
+            }
+        }
+
+        compactIfNeeded();
+        return removed;
+    }
+
+    // Calls func(row, value) for each live row in order
+    template <typename Func>
+    void forEach(Func func) const
+    {
+        int row(0);
+        for(const auto& chunk : mChunks)
+        {
+            for(int offset = 0; offset < chunk->used; ++offset)
+            {
+                if(chunk->isAlive(offset))
+                {
+                    func(row++, chunk->values[offset]);
+                }
+            }
+        }
+    }
+
+    template <typename Container>
+    Container values() const
+    {
+        Container result;
+        result.reserve(mSize);
+        forEach([&result](int, const Value& value){
+            result.push_back(value);
+        });
+        return result;
+    }
+
+    void clear()
+    {
+        mChunks.clear();
+        mTree.clear();
+        mSlotByKey.clear();
+        mSize = 0;
+        mTombstones = 0;
+    }
+
+    void compact()
+    {
+        if(mTombstones == 0)
+        {
+            return;
+        }
+
+        std::vector<std::unique_ptr<Chunk>> oldChunks;
+        oldChunks.swap(mChunks);
+        mTree.clear();
+        mSlotByKey.clear();
+        mSize = 0;
+        mTombstones = 0;
+
+        for(auto& chunk : oldChunks)
+        {
+            for(int offset = 0; offset < chunk->used; ++offset)
+            {
+                if(chunk->isAlive(offset))
+                {
+                    append(chunk->keys[offset], std::move(chunk->values[offset]));
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int WORD_BITS = 64;
+    static constexpr int WORDS_PER_CHUNK = ChunkSize / WORD_BITS;
+    // Do not compact small stores, the scan would cost more than the tombstones
+    static constexpr int MIN_TOMBSTONES_TO_COMPACT = ChunkSize;
+
+    struct Chunk
+    {
+        std::array<Key, ChunkSize> keys;
+        std::array<Value, ChunkSize> values;
+        std::array<uint64_t, WORDS_PER_CHUNK> alive{};
+        int used = 0;
+
+        bool isAlive(int offset) const
+        {
+            return (alive[offset / WORD_BITS] >> (offset % WORD_BITS)) & 1ULL;
+        }
+
+        void setAlive(int offset, bool state)
+        {
+            auto mask(1ULL << (offset % WORD_BITS));
+            state ? alive[offset / WORD_BITS] |= mask : alive[offset / WORD_BITS] &= ~mask;
+        }
+
+        int aliveBefore(int offset) const
+        {
+            int count(0);
+            auto word(offset / WORD_BITS);
+            for(int index = 0; index < word; ++index)
+            {
+                count += popCount(alive[index]);
+            }
+
+            auto bits(offset % WORD_BITS);
+            if(bits)
+            {
+                count += popCount(alive[word] & ((1ULL << bits) - 1));
+            }
+            return count;
+        }
+
+        // Offset of the nth (0-based) live slot
+        int selectAlive(int nth) const
+        {
+            for(int index = 0; index < WORDS_PER_CHUNK; ++index)
+            {
+                auto count(popCount(alive[index]));
+                if(nth < count)
+                {
+                    auto word(alive[index]);
+                    for(int bit = 0; bit < WORD_BITS; ++bit)
+                    {
+                        if((word >> bit) & 1ULL)
+                        {
+                            if(nth-- == 0)
+                            {
+                                return index * WORD_BITS + bit;
+                            }
+                        }
+                    }
+                }
+                nth -= count;
+            }
+            return -1;
+        }
+    };
+
+    static int popCount(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(value);
+#else
+        int count(0);
+        while(value)
+        {
+            value &= value - 1;
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    static std::size_t toSlot(int chunkIndex, int offset)
+    {
+        return static_cast<std::size_t>(chunkIndex) * ChunkSize + static_cast<std::size_t>(offset);
+    }
+
+    static int chunkOf(std::size_t slot)
+    {
+        return static_cast<int>(slot / ChunkSize);
+    }
+
+    static int offsetOf(std::size_t slot)
+    {
+        return static_cast<int>(slot % ChunkSize);
+    }
+
+    void appendChunk()
+    {
+        mChunks.emplace_back(new Chunk());
+
+        // Fenwick node i (1-based) covers (i - lowbit(i), i]. The new chunk is empty, so the node
+        // only has to hold the live rows of the chunks already covered by its range.
+        auto node(static_cast<int>(mChunks.size()));
+        auto lowBit(node & -node);
+        mTree.push_back(treePrefix(node - 1) - treePrefix(node - lowBit));
+    }
+
+    void killSlot(int chunkIndex, int offset)
+    {
+        auto& chunk(*mChunks[chunkIndex]);
+        chunk.setAlive(offset, false);
+        chunk.values[offset] = Value();
+        treeAdd(chunkIndex, -1);
+        --mSize;
+        ++mTombstones;
+    }
+
+    void compactIfNeeded()
+    {
+        if(mTombstones >= MIN_TOMBSTONES_TO_COMPACT && mTombstones > mSize)
+        {
+            compact();
+        }
+    }
+
+    // Returns (chunk, offset) of a live row, or (-1, -1)
+    std::pair<int, int> slotOf(int row) const
+    {
+        if(row < 0 || row >= mSize)
+        {
+            return std::make_pair(-1, -1);
+        }
+
+        // Fenwick descent: find the first chunk whose prefix of live rows exceeds row
+        int node(0);
+        int remaining(row);
+        auto chunks(static_cast<int>(mTree.size()));
+        int step(1);
+        while(step * 2 <= chunks)
+        {
+            step *= 2;
+        }
+
+        for(; step > 0; step /= 2)
+        {
+            auto next(node + step);
+            if(next <= chunks && mTree[next - 1] <= remaining)
+            {
+                node = next;
+                remaining -= mTree[next - 1];
+            }
+        }
+
+        return std::make_pair(node, mChunks[node]->selectAlive(remaining));
+    }
+
+    void treeAdd(int chunkIndex, int delta)
+    {
+        auto chunks(static_cast<int>(mTree.size()));
+        for(auto node = chunkIndex + 1; node <= chunks; node += node & -node)
+        {
+            mTree[node - 1] += delta;
+        }
+    }
+
+    // Live rows stored in the first "chunks" chunks
+    int treePrefix(int chunks) const
+    {
+        int sum(0);
+        for(auto node = chunks; node > 0; node -= node & -node)
+        {
+            sum += mTree[node - 1];
+        }
+        return sum;
+    }
+
+    std::vector<std::unique_ptr<Chunk>> mChunks;
+    std::vector<int> mTree;
+    std::unordered_map<Key, std::size_t> mSlotByKey;
+    int mSize = 0;
+    int mTombstones = 0;
+};
+
+#endif // TRANSFERSSTORAGE_H
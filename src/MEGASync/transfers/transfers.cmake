@@ -9,7 +9,10 @@ set(DESKTOP_APP_TRANSFERS_HEADERS
     transfers/model/TransfersManagerSortFilterProxyModel.h
     transfers/model/TransfersSortFilterProxyBaseModel.h
     transfers/model/TransfersModel.h
+    transfers/model/TransfersStorage.h
+    transfers/model/TransfersSortFilterIndex.h
     transfers/model/TransferMetaData.h
+    transfers/model/TransferItemsByState.h
     transfers/gui/SomeIssuesOccurredMessage.h
     transfers/gui/InfoDialogTransferDelegateWidget.h
     transfers/gui/InfoDialogTransfersWidget.h
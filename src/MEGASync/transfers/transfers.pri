@@ -37,7 +37,10 @@ HEADERS += $$PWD/model/InfoDialogTransfersProxyModel.h \
            $$PWD/model/TransfersManagerSortFilterProxyModel.h \
            $$PWD/model/TransfersSortFilterProxyBaseModel.h \
            $$PWD/model/TransfersModel.h \
+           $$PWD/model/TransfersStorage.h \
+           $$PWD/model/TransfersSortFilterIndex.h \
            $$PWD/model/TransferMetaData.h \
+           $$PWD/model/TransferItemsByState.h \
            $$PWD/gui/SomeIssuesOccurredMessage.h \
            $$PWD/gui/InfoDialogTransferDelegateWidget.h \
            $$PWD/gui/InfoDialogTransfersWidget.h \
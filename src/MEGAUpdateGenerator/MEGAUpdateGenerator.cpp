@@ -21,6 +21,7 @@ typedef int64_t m_off_t;
 
 #include "mega/crypto/cryptopp.h"
 #include "mega/base64.h"
+#include "../MEGAUpdater/UpdateBlocks.h"
 
 #define KEY_LENGTH 4096
 #define SIGNATURE_LENGTH 512
@@ -108,7 +109,9 @@ void printUsage(const char* appname)
     cerr << "Generate a keypair" << endl;
     cerr << "    " << appname << " -g" << endl;
     cerr << "Sign an update:" << endl;
-    cerr << "    " << appname << " <update folder> <keyfile> --file <contentsfile>" << endl;
+    cerr << "    " << appname << " <update folder> <keyfile> --file <contentsfile> [--blocks]" << endl;
+    cerr << "    --blocks writes a block manifest (<file>.blocks) next to each file for delta updates" << endl;
+    cerr << "             and flags the update info so that updaters request them" << endl;
     cerr << "    e.g:" << endl;
     cerr << "        " << appname << " /tmp/updatefiles /tmp/key.pem --file /megasync/contrib/updater/fileswin.txt" << endl;
 }
@@ -254,6 +257,7 @@ int main(int argc, char *argv[])
     string fileInput;
     bool externalfile = extractargparam(args, "--file", fileInput);
     bool generate = extractarg(args, "-g");
+    bool writeBlockManifests = extractarg(args, "--blocks");
 
     HashSignature signatureGenerator(new Hash());
     AsymmCipher aprivk;
@@ -440,6 +444,17 @@ int main(int argc, char *argv[])
             }
 
 
+            if (writeBlockManifests)
+            {
+                BlockManifest manifest;
+                std::ofstream manifestFile(filePath + ".blocks", std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!manifest.compute(filePath) || !(manifestFile << manifest.serialize()))
+                {
+                    cerr << "Error writing block manifest for file: " << filePath << endl;
+                    return 9;
+                }
+            }
+
             signatureSize = signFile(filePath.data(), &aprivk, signature, sizeof(signature));
             if (!signatureSize)
             {
@@ -499,6 +514,12 @@ int main(int argc, char *argv[])
             cout << signatures[i] << endl;
         }
 
+        if (writeBlockManifests)
+        {
+            //After an empty line, so that updaters that do not know it stop reading before it
+            cout << endl << BlockManifest::UPDATE_INFO_FLAG << endl;
+        }
+
         return 0;
     }
 
@@ -35,7 +35,8 @@ SOURCES += ../MEGASync/mega/src/crypto/cryptopp.cpp \
             ../MEGASync/mega/src/base64.cpp \
             ../MEGASync/mega/src/logging.cpp
 
-SOURCES += MEGAUpdateGenerator.cpp
+SOURCES += MEGAUpdateGenerator.cpp \
+           ../MEGAUpdater/UpdateBlocks.cpp
 
 LIBS += -lcryptopp
 
@@ -48,10 +48,12 @@ TARGET = MEGAupdater
 TEMPLATE = app
 
 HEADERS += UpdateTask.h \
+    UpdateBlocks.h \
     Preferences.h \
     MacUtils.h
 
 SOURCES += MegaUpdater.cpp \
+    UpdateBlocks.cpp \
     UpdateTask.cpp
 
 vcpkg:INCLUDEPATH += $$THIRDPARTY_VCPKG_PATH/include
@@ -107,8 +109,8 @@ win32 {
     }
 
     DEFINES += UNICODE _UNICODE NTDDI_VERSION=0x05010000 _WIN32_WINNT=0x0501
-    vcpkg:LIBS += -lurlmon -lShlwapi -lShell32 -lAdvapi32 -lcryptopp-staticcrt
-    else:LIBS += -lurlmon -lShlwapi -lShell32 -lAdvapi32 -lcryptoppmt
+    vcpkg:LIBS += -lurlmon -lWininet -lShlwapi -lShell32 -lAdvapi32 -lcryptopp-staticcrt
+    else:LIBS += -lurlmon -lWininet -lShlwapi -lShell32 -lAdvapi32 -lcryptoppmt
 
     QMAKE_CXXFLAGS_RELEASE = $$QMAKE_CFLAGS_RELEASE_WITH_DEBUGINFO
     QMAKE_LFLAGS_RELEASE = $$QMAKE_LFLAGS_RELEASE_WITH_DEBUGINFO
@@ -1,9 +1,12 @@
 #ifndef MACUTILS_H
 #define MACUTILS_H
+#include <cstdint>
 #include <iostream>
 
 using namespace std;
 
 bool downloadFileSynchronously(string url, string path);
+// Appends length bytes of url at offset to data, using an HTTP range request
+bool downloadRangeSynchronously(const string& url, uint64_t offset, uint64_t length, string& data);
 
 #endif // MACUTILS_H
@@ -19,3 +19,38 @@ bool downloadFileSynchronously(string url, string path)
     }
     return true;
 }
+
+bool downloadRangeSynchronously(const string& url, uint64_t offset, uint64_t length, string& data)
+{
+    NSString *stringURL = [NSString stringWithCString:url.c_str() encoding:NSUTF8StringEncoding];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:stringURL]
+                                                           cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
+                                                       timeoutInterval:60];
+    NSString *range = [NSString stringWithFormat:@"bytes=%llu-%llu", offset, offset + length - 1];
+    [request setValue:range forHTTPHeaderField:@"Range"];
+
+    __block NSData *received = nil;
+    __block NSInteger status = 0;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSessionDataTask *task = [[NSURLSession sharedSession] dataTaskWithRequest:request
+                                                                 completionHandler:^(NSData *responseData, NSURLResponse *response, NSError *error)
+    {
+        if (!error && [response isKindOfClass:[NSHTTPURLResponse class]])
+        {
+            status = [(NSHTTPURLResponse *)response statusCode];
+            received = [responseData retain];
+        }
+        dispatch_semaphore_signal(done);
+    }];
+    [task resume];
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+
+    // A server ignoring the range answers 200 with the whole file
+    bool result = status == 206 && received && [received length] == length;
+    if (result)
+    {
+        data.append((const char *)[received bytes], [received length]);
+    }
+    [received release];
+    return result;
+}
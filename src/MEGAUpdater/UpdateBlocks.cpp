@@ -0,0 +1,363 @@
+#include "UpdateBlocks.h"
+
+#include <cryptopp/sha.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+using std::string;
+
+namespace
+{
+const char MANIFEST_HEADER[] = "MEGA-BLOCKS 1";
+
+#ifdef _WIN32
+std::wstring toWide(const string& utf8)
+{
+    std::wstring wide(utf8.size() + 1, L'\0');
+    wide.resize(MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), int(utf8.size()), &wide[0], int(wide.size())));
+    return wide;
+}
+
+FILE* openFile(const string& path, const wchar_t* mode)
+{
+    return _wfopen(toWide(path).c_str(), mode);
+}
+
+#define MODE(x) L##x
+
+bool seekFile(FILE* file, uint64_t offset)
+{
+    return !_fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+}
+
+uint64_t fileSize(FILE* file)
+{
+    _fseeki64(file, 0, SEEK_END);
+    return static_cast<uint64_t>(_ftelli64(file));
+}
+
+bool removeFile(const string& path)
+{
+    return !_wremove(toWide(path).c_str());
+}
+
+bool replaceFile(const string& from, const string& to)
+{
+    return MoveFileExW(toWide(from).c_str(), toWide(to).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+#else
+FILE* openFile(const string& path, const char* mode)
+{
+    return fopen(path.c_str(), mode);
+}
+
+#define MODE(x) x
+
+bool seekFile(FILE* file, uint64_t offset)
+{
+    return !fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+}
+
+uint64_t fileSize(FILE* file)
+{
+    fseeko(file, 0, SEEK_END);
+    return static_cast<uint64_t>(ftello(file));
+}
+
+bool removeFile(const string& path)
+{
+    return !remove(path.c_str());
+}
+
+bool replaceFile(const string& from, const string& to)
+{
+    return !rename(from.c_str(), to.c_str());
+}
+#endif
+
+bool readAt(FILE* file, uint64_t offset, char* data, uint64_t length)
+{
+    return seekFile(file, offset) && fread(data, 1, size_t(length), file) == size_t(length);
+}
+
+bool writeAt(FILE* file, uint64_t offset, const char* data, uint64_t length)
+{
+    return seekFile(file, offset) && fwrite(data, 1, size_t(length), file) == size_t(length);
+}
+}
+
+const char BlockManifest::UPDATE_INFO_FLAG[] = "MEGA-BLOCKS";
+
+BlockManifest::BlockManifest()
+    : mFileSize(0),
+      mBlockSize(DEFAULT_BLOCK_SIZE)
+{
+}
+
+bool BlockManifest::compute(const string& path, uint32_t blockSize)
+{
+    if (!blockSize)
+    {
+        return false;
+    }
+
+    FILE* file = openFile(path, MODE("rb"));
+    if (!file)
+    {
+        return false;
+    }
+
+    mFileSize = 0;
+    mBlockSize = blockSize;
+    mHashes.clear();
+
+    string buffer(blockSize, '\0');
+    size_t read;
+    while ((read = fread(&buffer[0], 1, blockSize, file)) > 0)
+    {
+        mHashes.push_back(hashBlock(buffer.data(), read));
+        mFileSize += read;
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+bool BlockManifest::parse(const string& text)
+{
+    std::istringstream input(text);
+    string header;
+    if (!std::getline(input, header))
+    {
+        return false;
+    }
+    if (!header.empty() && header.back() == '\r')
+    {
+        header.pop_back();
+    }
+
+    uint64_t size = 0;
+    uint64_t blockSize = 0;
+    if (header != MANIFEST_HEADER || !(input >> size >> blockSize) || !blockSize || blockSize > UINT32_MAX)
+    {
+        return false;
+    }
+
+    std::vector<string> hashes;
+    string hash;
+    while (input >> hash)
+    {
+        if (hash.size() != CryptoPP::SHA256::DIGESTSIZE * 2)
+        {
+            return false;
+        }
+        hashes.push_back(hash);
+    }
+
+    if (hashes.size() != (size + blockSize - 1) / blockSize)
+    {
+        return false;
+    }
+
+    mFileSize = size;
+    mBlockSize = uint32_t(blockSize);
+    mHashes.swap(hashes);
+    return true;
+}
+
+string BlockManifest::serialize() const
+{
+    std::ostringstream output;
+    output << MANIFEST_HEADER << "\n" << mFileSize << " " << mBlockSize << "\n";
+    for (const auto& hash : mHashes)
+    {
+        output << hash << "\n";
+    }
+    return output.str();
+}
+
+uint64_t BlockManifest::fileSize() const
+{
+    return mFileSize;
+}
+
+uint32_t BlockManifest::blockSize() const
+{
+    return mBlockSize;
+}
+
+size_t BlockManifest::blockCount() const
+{
+    return mHashes.size();
+}
+
+uint64_t BlockManifest::blockLength(size_t block) const
+{
+    uint64_t offset = uint64_t(block) * mBlockSize;
+    return std::min<uint64_t>(mBlockSize, mFileSize - offset);
+}
+
+const string& BlockManifest::blockHash(size_t block) const
+{
+    return mHashes[block];
+}
+
+string BlockManifest::hashBlock(const char* data, size_t size)
+{
+    CryptoPP::SHA256 sha;
+    unsigned char digest[CryptoPP::SHA256::DIGESTSIZE];
+    sha.CalculateDigest(digest, reinterpret_cast<const unsigned char*>(data), size);
+
+    static const char hexchars[] = "0123456789abcdef";
+    string hash;
+    hash.reserve(sizeof(digest) * 2);
+    for (unsigned char value : digest)
+    {
+        hash.push_back(hexchars[value >> 4]);
+        hash.push_back(hexchars[value & 0x0F]);
+    }
+    return hash;
+}
+
+BlockPatcher::BlockPatcher(RangeFetcher fetcher)
+    : mFetcher(std::move(fetcher))
+{
+}
+
+bool BlockPatcher::build(const BlockManifest& manifest, const string& url,
+                         const string& basisPath, const string& dstPath)
+{
+    mStats = Stats();
+    const string part = partPath(dstPath);
+
+    FILE* partFile = openFile(part, MODE("r+b"));
+    uint64_t partSize = partFile ? fileSize(partFile) : 0;
+    if (partFile && partSize > manifest.fileSize())
+    {
+        // Left by the download of another version
+        fclose(partFile);
+        partFile = nullptr;
+        partSize = 0;
+    }
+    if (!partFile)
+    {
+        partFile = openFile(part, MODE("w+b"));
+        if (!partFile)
+        {
+            return false;
+        }
+    }
+
+    // Blocks of the installed file, by hash
+    std::unordered_map<string, uint64_t> basisBlocks;
+    FILE* basisFile = basisPath.empty() ? nullptr : openFile(basisPath, MODE("rb"));
+    string buffer(manifest.blockSize(), '\0');
+    if (basisFile)
+    {
+        uint64_t offset = 0;
+        size_t read;
+        while ((read = fread(&buffer[0], 1, buffer.size(), basisFile)) > 0)
+        {
+            basisBlocks.emplace(BlockManifest::hashBlock(buffer.data(), read), offset);
+            offset += read;
+        }
+    }
+
+    bool ok = true;
+    std::vector<size_t> missingBlocks;
+    for (size_t block = 0; ok && block < manifest.blockCount(); ++block)
+    {
+        const uint64_t offset = uint64_t(block) * manifest.blockSize();
+        const uint64_t length = manifest.blockLength(block);
+
+        if (offset + length <= partSize && readAt(partFile, offset, &buffer[0], length)
+                && BlockManifest::hashBlock(buffer.data(), size_t(length)) == manifest.blockHash(block))
+        {
+            mStats.resumedBytes += length;
+            continue;
+        }
+
+        // The hash is checked again in case the installed file changed while building
+        auto basisBlock = basisBlocks.find(manifest.blockHash(block));
+        if (basisBlock != basisBlocks.end() && readAt(basisFile, basisBlock->second, &buffer[0], length)
+                && BlockManifest::hashBlock(buffer.data(), size_t(length)) == manifest.blockHash(block))
+        {
+            ok = writeAt(partFile, offset, buffer.data(), length);
+            mStats.copiedBytes += length;
+            continue;
+        }
+
+        missingBlocks.push_back(block);
+    }
+
+    if (basisFile)
+    {
+        fclose(basisFile);
+    }
+
+    // Runs of consecutive missing blocks, in requests of up to MAX_RANGE_SIZE
+    size_t first = 0;
+    while (ok && first < missingBlocks.size())
+    {
+        size_t last = first;
+        uint64_t length = manifest.blockLength(missingBlocks[first]);
+        while (last + 1 < missingBlocks.size() && missingBlocks[last + 1] == missingBlocks[last] + 1
+               && length + manifest.blockLength(missingBlocks[last + 1]) <= MAX_RANGE_SIZE)
+        {
+            ++last;
+            length += manifest.blockLength(missingBlocks[last]);
+        }
+
+        const uint64_t offset = uint64_t(missingBlocks[first]) * manifest.blockSize();
+        string data;
+        ok = mFetcher(url, offset, length, data) && data.size() == length;
+        ++mStats.rangeRequests;
+
+        uint64_t dataOffset = 0;
+        for (size_t i = first; ok && i <= last; ++i)
+        {
+            const uint64_t blockLength = manifest.blockLength(missingBlocks[i]);
+            ok = BlockManifest::hashBlock(data.data() + dataOffset, size_t(blockLength)) == manifest.blockHash(missingBlocks[i])
+                 && writeAt(partFile, offset + dataOffset, data.data() + dataOffset, blockLength);
+            dataOffset += blockLength;
+        }
+
+        // What was written is kept if a later range fails
+        ok = !fflush(partFile) && ok;
+        if (ok)
+        {
+            mStats.downloadedBytes += length;
+        }
+        first = last + 1;
+    }
+
+    ok = ok && fileSize(partFile) == manifest.fileSize();
+    ok = !fclose(partFile) && ok;
+    if (!ok)
+    {
+        return false;
+    }
+
+    removeFile(dstPath);
+    return replaceFile(part, dstPath);
+}
+
+const BlockPatcher::Stats& BlockPatcher::stats() const
+{
+    return mStats;
+}
+
+string BlockPatcher::partPath(const string& dstPath)
+{
+    return dstPath + ".part";
+}
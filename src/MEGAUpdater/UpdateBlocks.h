@@ -0,0 +1,87 @@
+#ifndef UPDATEBLOCKS_H
+#define UPDATEBLOCKS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Block manifests let an update download only the parts of a file that changed.
+//
+// A manifest lists the SHA-256 of every fixed size block of a file. To build the new file, each
+// block is taken from the partial download of a previous attempt, from any block of the
+// installed file with the same hash, or downloaded with a range request. Consecutive missing
+// blocks are requested together. Manifests are not signed: the whole file signature is still
+// checked after building it.
+//
+// Text format:
+//   MEGA-BLOCKS 1
+//   <file size> <block size>
+//   <hex SHA-256 of each block, one per line>
+//
+// Update info generated with manifests ends with an empty line and UPDATE_INFO_FLAG after the
+// list of files. Updaters that do not know it stop reading at the empty line, and updaters that
+// do only request manifests when it is there.
+
+class BlockManifest
+{
+public:
+    static const uint32_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+    static const char UPDATE_INFO_FLAG[];
+
+    BlockManifest();
+
+    // Hashes a local file, streaming it
+    bool compute(const std::string& path, uint32_t blockSize = DEFAULT_BLOCK_SIZE);
+    bool parse(const std::string& text);
+    std::string serialize() const;
+
+    uint64_t fileSize() const;
+    uint32_t blockSize() const;
+    size_t blockCount() const;
+    uint64_t blockLength(size_t block) const;
+    const std::string& blockHash(size_t block) const;
+
+    static std::string hashBlock(const char* data, size_t size);
+
+private:
+    uint64_t mFileSize;
+    uint32_t mBlockSize;
+    std::vector<std::string> mHashes;
+};
+
+class BlockPatcher
+{
+public:
+    // Largest range requested at once
+    static const uint64_t MAX_RANGE_SIZE = 8 * 1024 * 1024;
+
+    // Must append exactly length bytes at offset of url to data
+    using RangeFetcher = std::function<bool(const std::string& url, uint64_t offset, uint64_t length, std::string& data)>;
+
+    struct Stats
+    {
+        uint64_t resumedBytes = 0;
+        uint64_t copiedBytes = 0;
+        uint64_t downloadedBytes = 0;
+        unsigned rangeRequests = 0;
+    };
+
+    explicit BlockPatcher(RangeFetcher fetcher);
+
+    // Builds dstPath with the contents described by manifest. Blocks are written to
+    // dstPath + ".part", which survives failures to resume later, and renamed at the end.
+    // basisPath is the installed version of the file; it may not exist
+    bool build(const BlockManifest& manifest, const std::string& url,
+               const std::string& basisPath, const std::string& dstPath);
+
+    const Stats& stats() const;
+
+    static std::string partPath(const std::string& dstPath);
+
+private:
+    RangeFetcher mFetcher;
+    Stats mStats;
+};
+
+#endif // UPDATEBLOCKS_H
@@ -26,8 +26,16 @@
 #endif
 
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#ifdef _WIN32
+#include <wininet.h>
+#endif
 
 #include "UpdateTask.h"
+#include "UpdateBlocks.h"
 #include "Preferences.h"
 #include "MacUtils.h"
 
@@ -264,6 +272,7 @@ int mkdir_p(const char *path)
 UpdateTask::UpdateTask()
 {
     isPublic = false;
+    blockManifests = false;
     string updatePublicKey = UPDATE_PUBLIC_KEY;
     if (getenv("MEGA_UPDATE_PUBLIC_KEY"))
     {
@@ -359,6 +368,18 @@ void UpdateTask::checkForUpdates()
                     return;
                 }
 
+                //Build the file from the changed blocks if the update has block manifests
+                if (blockManifests && downloadFileBlocks(downloadURLs[currentFile], localPaths[currentFile]))
+                {
+                    if (alreadyDownloaded(localPaths[currentFile], fileSignatures[currentFile]))
+                    {
+                        LOG(LOG_LEVEL_INFO, "File built from blocks, signature OK: %s",  localPaths[currentFile].c_str());
+                        currentFile++;
+                        continue;
+                    }
+                    LOG(LOG_LEVEL_WARNING, "Signature of file built from blocks doesn't match: %s",  localPaths[currentFile].c_str());
+                }
+
                 //Delete the file if exists
                 if (fileExist(localFile.c_str()))
                 {
@@ -436,6 +457,95 @@ bool UpdateTask::downloadFile(string url, string dstPath)
     return true;
 }
 
+bool UpdateTask::downloadFileBlocks(string url, string relativePath)
+{
+    string localFile = updateFolder + relativePath;
+    string manifestFile = localFile + ".blocks";
+    if (fileExist(manifestFile.c_str()))
+    {
+        mega_remove(manifestFile.c_str());
+    }
+
+    // The update info says there are manifests. If they are missing anyway, they are not requested again
+    if (!downloadFile(url + ".blocks", manifestFile))
+    {
+        LOG(LOG_LEVEL_WARNING, "No block manifest for %s, the remaining files are downloaded whole", relativePath.c_str());
+        blockManifests = false;
+        return false;
+    }
+
+    string manifestText;
+    FILE *pFile = mega_fopen(manifestFile.c_str(), "rb");
+    if (pFile)
+    {
+        char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        {
+            manifestText.append(buffer, read);
+        }
+        fclose(pFile);
+    }
+    mega_remove(manifestFile.c_str());
+
+    BlockManifest manifest;
+    if (!manifest.parse(manifestText))
+    {
+        LOG(LOG_LEVEL_WARNING, "Invalid block manifest: %s", relativePath.c_str());
+        return false;
+    }
+
+    BlockPatcher patcher([this](const string& rangeUrl, uint64_t offset, uint64_t length, string& data)
+    {
+        return downloadRange(rangeUrl, offset, length, data);
+    });
+    bool result = patcher.build(manifest, url, appFolder + relativePath, localFile);
+    LOG(LOG_LEVEL_INFO, "Blocks of %s: %llu resumed, %llu copied, %llu downloaded in %u requests",
+        relativePath.c_str(), (unsigned long long)patcher.stats().resumedBytes,
+        (unsigned long long)patcher.stats().copiedBytes, (unsigned long long)patcher.stats().downloadedBytes,
+        patcher.stats().rangeRequests);
+    return result;
+}
+
+bool UpdateTask::downloadRange(const string& url, uint64_t offset, uint64_t length, string& data)
+{
+#ifdef _WIN32
+    bool result = false;
+    HINTERNET internet = InternetOpenA(USER_AGENT, INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0);
+    if (!internet)
+    {
+        return false;
+    }
+
+    std::ostringstream header;
+    header << "Range: bytes=" << offset << "-" << (offset + length - 1) << "\r\n";
+    HINTERNET request = InternetOpenUrlA(internet, url.c_str(), header.str().c_str(), DWORD(header.str().size()),
+                                         INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE, 0);
+    if (request)
+    {
+        DWORD status = 0;
+        DWORD statusSize = sizeof(status);
+        if (HttpQueryInfoA(request, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &status, &statusSize, NULL)
+                && status == 206)
+        {
+            char buffer[65536];
+            DWORD read = 0;
+            size_t initialSize = data.size();
+            while (InternetReadFile(request, buffer, sizeof(buffer), &read) && read)
+            {
+                data.append(buffer, read);
+            }
+            result = data.size() - initialSize == length;
+        }
+        InternetCloseHandle(request);
+    }
+    InternetCloseHandle(internet);
+    return result;
+#else
+    return downloadRangeSynchronously(url, offset, length, data);
+#endif
+}
+
 bool UpdateTask::processUpdateFile(FILE *fd)
 {
     LOG(LOG_LEVEL_DEBUG, "Reading update info");
@@ -471,6 +581,9 @@ bool UpdateTask::processUpdateFile(FILE *fd)
     initSignature();
     addToSignature(version.data(), version.length());
 
+    vector<string> urls;
+    vector<string> paths;
+    vector<string> signatures;
     while (true)
     {
         string url = readNextLine(fd);
@@ -498,15 +611,27 @@ bool UpdateTask::processUpdateFile(FILE *fd)
         addToSignature(fileSignature.data(), fileSignature.length());
 
         MEGA_TO_NATIVE_SEPARATORS(localPath);
-        if (alreadyInstalled(localPath, fileSignature))
+        urls.push_back(url);
+        paths.push_back(localPath);
+        signatures.push_back(fileSignature);
+    }
+
+    //Not signed, like the manifests: the files built from blocks are still checked with their signatures
+    blockManifests = readNextLine(fd) == BlockManifest::UPDATE_INFO_FLAG;
+    LOG(LOG_LEVEL_DEBUG, "Block manifests: %s", blockManifests ? "yes" : "no");
+
+    vector<bool> installed = alreadyInstalled(paths, signatures);
+    for (vector<string>::size_type i = 0; i < paths.size(); i++)
+    {
+        if (installed[i])
         {
-            LOG(LOG_LEVEL_INFO, "File already installed: %s",  localPath.c_str());
+            LOG(LOG_LEVEL_INFO, "File already installed: %s",  paths[i].c_str());
             continue;
         }
 
-        downloadURLs.push_back(url);
-        localPaths.push_back(localPath);
-        fileSignatures.push_back(fileSignature);
+        downloadURLs.push_back(urls[i]);
+        localPaths.push_back(paths[i]);
+        fileSignatures.push_back(signatures[i]);
     }
 
     if (!downloadURLs.size())
@@ -780,40 +905,59 @@ bool UpdateTask::alreadyExists(string absolutePath, string fileSignature)
         updatePublicKey = getenv("MEGA_UPDATE_PUBLIC_KEY");
     }
     SignatureChecker tmpHash(updatePublicKey.c_str());
-    char *buffer;
-    long fileLength;
     FILE * pFile = mega_fopen(absolutePath.c_str(), "rb");
     if (pFile == NULL)
     {
         return false;
     }
 
-    //Get size of file and rewind FILE pointer
-    fseek(pFile, 0, SEEK_END);
-    fileLength = ftell(pFile);
-    rewind(pFile);
-
-    buffer = (char *)malloc(fileLength);
-    if (buffer == NULL)
+    //Hash the file in chunks instead of loading it whole
+    std::vector<char> buffer(1024 * 1024);
+    size_t sizeRead;
+    while ((sizeRead = fread(buffer.data(), 1, buffer.size(), pFile)) > 0)
     {
-        fclose(pFile);
-        return false;
+        tmpHash.add(buffer.data(), sizeRead);
     }
 
-    size_t sizeRead = fread(buffer, 1, fileLength, pFile);
-    if (sizeRead != fileLength)
+    bool readError = ferror(pFile) != 0;
+    fclose(pFile);
+    if (readError)
     {
-        fclose(pFile);
         return false;
     }
 
-    tmpHash.add(buffer, sizeRead);
-    fclose(pFile);
-    free(buffer);
-
     return tmpHash.checkSignature(fileSignature.data());
 }
 
+vector<bool> UpdateTask::alreadyInstalled(const vector<string>& relativePaths, const vector<string>& signatures)
+{
+    //Checking signatures is CPU bound, the files are spread over some threads
+    vector<char> installed(relativePaths.size(), 0);
+    std::atomic<size_t> nextFile(0);
+    auto worker = [&]()
+    {
+        for (size_t i = nextFile++; i < relativePaths.size(); i = nextFile++)
+        {
+            installed[i] = alreadyInstalled(relativePaths[i], signatures[i]);
+        }
+    };
+
+    unsigned numThreads = std::min<unsigned>(std::max(1u, std::thread::hardware_concurrency()), 8);
+    numThreads = std::min<unsigned>(numThreads, unsigned(relativePaths.size()));
+    vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return vector<bool>(installed.begin(), installed.end());
+}
+
 string UpdateTask::readNextLine(FILE *fd)
 {
     char line[4096];
@@ -20,6 +20,10 @@
 #include <cryptopp/hmac.h>
 #include <cryptopp/pwdbased.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace
 {
 #if CRYPTOPP_VERSION >= 600 && ((__cplusplus >= 201103L) || (__RPCNDR_H_VERSION__ == 500))
@@ -65,6 +69,8 @@ public:
 
 protected:
     bool downloadFile(std::string url, std::string dstPath);
+    bool downloadFileBlocks(std::string url, std::string relativePath);
+    bool downloadRange(const std::string& url, uint64_t offset, uint64_t length, std::string& data);
     bool processUpdateFile(FILE *fd);
     void processSymLinks(std::string symLinksPath);
     bool processSymLinksFile(FILE *fd);
@@ -75,6 +81,8 @@ protected:
     bool alreadyInstalled(std::string relativePath, std::string fileSignature);
     bool alreadyDownloaded(std::string relativePath, std::string fileSignature);
     bool alreadyExists(std::string absolutePath, std::string fileSignature);
+    std::vector<bool> alreadyInstalled(const std::vector<std::string>& relativePaths,
+                                       const std::vector<std::string>& signatures);
     bool performUpdate();
     void rollbackUpdate(int fileNum);
     void initialCleanup();
@@ -93,6 +101,7 @@ protected:
     std::string updateFolder;
     std::string backupFolder;
     bool isPublic;
+    bool blockManifests;
     SignatureChecker *signatureChecker;
     unsigned int currentFile;
     int updateVersion;
@@ -5,10 +5,43 @@ CONFIG += qt console warn_on depend_includepath
 CONFIG += c++14
 CONFIG += building_tests
 
+DEFINES += CATCH_CONFIG_ENABLE_BENCHMARKING
+
 include(../../src/MEGASync/MEGASync.pro)
 include(../3rdparty/catch/catch.pri)
 include(../3rdparty/trompeloeil/trompeloeil.pri)
 SOURCES += Utilities.test.cpp \
+           control/BinaryLog.Test.cpp \
+           control/FileExtensionTable.Test.cpp \
+           control/FileHashCache.Test.cpp \
+           control/FolderSizeScanner.Test.cpp \
+           control/LogCompressor.Test.cpp \
+           control/MpscRingBuffer.Test.cpp \
+           control/NodeChangeBatch.Test.cpp \
+           control/Preferences/EncryptedSettings.Test.cpp \
+           control/ThreadPool.Test.cpp \
+           control/TransferProgressFeed.Test.cpp \
            control/TransferRemainingTime.Test.cpp \
+           control/WebRequestParser.Test.cpp \
+           transfers/TransferBaseDelegateWidget.Test.cpp \
+           transfers/TransferData.Test.cpp \
+           transfers/TransferItemsByState.Test.cpp \
+           transfers/TransfersSortFilterIndex.Test.cpp \
+           transfers/TransfersStorage.Test.cpp \
+           stalled_issues/StalledIssuesDiff.Test.cpp \
+           stalled_issues/StalledIssuesBatches.Test.cpp \
+           gui/node_selector/NodeSelectorSearchResults.Test.cpp \
+           gui/node_selector/NodeSelectorTree.Test.cpp \
+           syncs/control/MegaIgnoreMatcher.Test.cpp \
+           syncs/control/SyncPathTrie.Test.cpp \
+           MEGAUpdater/UpdateBlocks.Test.cpp \
            ScaleFactorManager.Test.cpp \
            main.cpp
+
+# Block manifests of the updater, built here to be tested with a stand-in server
+SOURCES += ../../src/MEGAUpdater/UpdateBlocks.cpp
+
+unix:!macx {
+    SOURCES += platform/linux/ExtServerProtocol.Test.cpp \
+               platform/linux/OverlayStateCache.Test.cpp
+}
@@ -0,0 +1,187 @@
+#include <catch.hpp>
+#include "../../../src/MEGAUpdater/UpdateBlocks.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+namespace
+{
+const std::string BASIS_PATH("UpdateBlocks.Test.installed");
+const std::string DST_PATH("UpdateBlocks.Test.update");
+const std::string FILE_URL("http://localhost/update/file");
+constexpr uint32_t BLOCK_SIZE = 4096;
+
+void writeFile(const std::string& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string randomData(size_t size, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+    for (auto& c : data)
+    {
+        c = static_cast<char>(random());
+    }
+    return data;
+}
+
+// Stands in for the update server: serves byte ranges of its files
+struct RangeServer
+{
+    std::map<std::string, std::string> files;
+    unsigned requests = 0;
+    uint64_t servedBytes = 0;
+    int failAfterRequests = -1;
+
+    BlockPatcher::RangeFetcher fetcher()
+    {
+        return [this](const std::string& url, uint64_t offset, uint64_t length, std::string& data)
+        {
+            if (failAfterRequests >= 0 && int(requests) >= failAfterRequests)
+            {
+                return false;
+            }
+            ++requests;
+            auto file = files.find(url);
+            if (file == files.end() || offset + length > file->second.size())
+            {
+                return false;
+            }
+            data.append(file->second, size_t(offset), size_t(length));
+            servedBytes += length;
+            return true;
+        };
+    }
+};
+
+BlockManifest manifestOf(const std::string& contents)
+{
+    writeFile(DST_PATH, contents);
+    BlockManifest manifest;
+    REQUIRE(manifest.compute(DST_PATH, BLOCK_SIZE));
+    std::remove(DST_PATH.c_str());
+    return manifest;
+}
+
+void cleanup()
+{
+    std::remove(BASIS_PATH.c_str());
+    std::remove(DST_PATH.c_str());
+    std::remove(BlockPatcher::partPath(DST_PATH).c_str());
+}
+}
+
+TEST_CASE("BlockManifest")
+{
+    const std::string contents(randomData(BLOCK_SIZE * 3 + 100, 1));
+    auto manifest = manifestOf(contents);
+    CHECK(manifest.fileSize() == contents.size());
+    CHECK(manifest.blockCount() == 4);
+    CHECK(manifest.blockLength(3) == 100);
+    CHECK(manifest.blockHash(0) == BlockManifest::hashBlock(contents.data(), BLOCK_SIZE));
+
+    BlockManifest parsed;
+    REQUIRE(parsed.parse(manifest.serialize()));
+    CHECK(parsed.serialize() == manifest.serialize());
+
+    CHECK_FALSE(parsed.parse("MEGA-BLOCKS 1\n10 0\n"));
+    CHECK_FALSE(parsed.parse("MEGA-BLOCKS 1\n8193 4096\n" + manifest.blockHash(0) + "\n"));
+    CHECK_FALSE(parsed.parse("garbage"));
+}
+
+TEST_CASE("BlockPatcher downloads only the changed blocks")
+{
+    cleanup();
+    RangeServer server;
+    BlockPatcher patcher(server.fetcher());
+
+    std::string installed(randomData(BLOCK_SIZE * 64, 2));
+    std::string update(installed);
+    // One changed block, one block moved, and the file grows
+    update.replace(BLOCK_SIZE * 10, BLOCK_SIZE, randomData(BLOCK_SIZE, 3));
+    update.replace(BLOCK_SIZE * 20, BLOCK_SIZE, installed.substr(BLOCK_SIZE * 40, BLOCK_SIZE));
+    update += randomData(BLOCK_SIZE + 10, 4);
+    server.files[FILE_URL] = update;
+    writeFile(BASIS_PATH, installed);
+
+    SECTION("Unchanged and moved blocks are copied from the installed file")
+    {
+        REQUIRE(patcher.build(manifestOf(update), FILE_URL, BASIS_PATH, DST_PATH));
+        CHECK(readFile(DST_PATH) == update);
+        CHECK(patcher.stats().downloadedBytes == BLOCK_SIZE * 2 + 10);
+        CHECK(patcher.stats().rangeRequests == 2);
+        CHECK(patcher.stats().copiedBytes == BLOCK_SIZE * 63);
+    }
+
+    SECTION("Without installed file everything is downloaded in large ranges")
+    {
+        REQUIRE(patcher.build(manifestOf(update), FILE_URL, std::string(), DST_PATH));
+        CHECK(readFile(DST_PATH) == update);
+        CHECK(patcher.stats().downloadedBytes == update.size());
+        CHECK(patcher.stats().rangeRequests == 1);
+    }
+
+    SECTION("A failed download resumes from the blocks already written")
+    {
+        server.failAfterRequests = 1;
+        REQUIRE_FALSE(patcher.build(manifestOf(update), FILE_URL, BASIS_PATH, DST_PATH));
+        CHECK(readFile(DST_PATH).empty());
+
+        server.failAfterRequests = -1;
+        REQUIRE(patcher.build(manifestOf(update), FILE_URL, BASIS_PATH, DST_PATH));
+        CHECK(readFile(DST_PATH) == update);
+        CHECK(patcher.stats().resumedBytes >= BLOCK_SIZE * 11);
+        CHECK(patcher.stats().rangeRequests == 1);
+    }
+
+    SECTION("Corrupted ranges are rejected")
+    {
+        server.files[FILE_URL][BLOCK_SIZE * 10] ^= 1;
+        CHECK_FALSE(patcher.build(manifestOf(update), FILE_URL, BASIS_PATH, DST_PATH));
+    }
+
+    cleanup();
+}
+
+TEST_CASE("BlockPatcher benchmark", "[.][benchmark]")
+{
+    // 64 MB file where 1% of the blocks changed
+    cleanup();
+    constexpr uint32_t blockSize = BlockManifest::DEFAULT_BLOCK_SIZE;
+    std::string installed(randomData(size_t(blockSize) * 256, 5));
+    std::string update(installed);
+    for (size_t block = 7; block < 256; block += 100)
+    {
+        update.replace(block * blockSize, blockSize, randomData(blockSize, unsigned(block)));
+    }
+
+    RangeServer server;
+    server.files[FILE_URL] = update;
+    writeFile(BASIS_PATH, installed);
+    writeFile(DST_PATH, update);
+    BlockManifest manifest;
+    REQUIRE(manifest.compute(DST_PATH, blockSize));
+    std::remove(DST_PATH.c_str());
+
+    BlockPatcher patcher(server.fetcher());
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(patcher.build(manifest, FILE_URL, BASIS_PATH, DST_PATH));
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    WARN("64 MB, 3 changed blocks: downloaded " << patcher.stats().downloadedBytes << " bytes in "
+         << patcher.stats().rangeRequests << " requests instead of " << update.size() << ", built in " << ms << " ms");
+    cleanup();
+}
@@ -0,0 +1,231 @@
+#include <catch.hpp>
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+#ifdef WIN32
+const BinaryLogPath SEGMENT_PATH(L"BinaryLog.Test.blog");
+#else
+const BinaryLogPath SEGMENT_PATH("BinaryLog.Test.blog");
+#endif
+
+void removeSegment()
+{
+#ifdef WIN32
+    _wremove(SEGMENT_PATH.c_str());
+#else
+    std::remove(SEGMENT_PATH.c_str());
+#endif
+}
+
+struct Entry
+{
+    BinaryLog::RecordType type;
+    int level;
+    std::string threadName;
+    std::string message;
+};
+
+std::vector<Entry> readSegment()
+{
+    std::vector<Entry> entries;
+    BinaryLogReader reader;
+    REQUIRE(reader.open(SEGMENT_PATH));
+    reader.forEachEntry([&entries](const BinaryLogEntry& entry)
+    {
+        entries.push_back(Entry{entry.type, entry.level, *entry.threadName, std::string(entry.message, entry.length)});
+    });
+    return entries;
+}
+
+void writeTaken(BinaryLogWriter& writer, BinaryLogSegment& segment)
+{
+    std::vector<char> records;
+    writer.takeRecords(records);
+    REQUIRE(segment.write(records.data(), records.size()) == records.size());
+}
+}
+
+TEST_CASE("Binary log round trip through a segment file")
+{
+    removeSegment();
+    {
+        BinaryLogWriter writer;
+        BinaryLogSegment segment;
+        REQUIRE(segment.open(SEGMENT_PATH, 1024 * 1024, writer.wallClockBaseMicros(), writer.steadyBaseMicros()));
+
+        writer.appendRawLine("start\n", 6);
+        writer.append(2, "main thread", 11);
+        std::thread([&writer]
+        {
+            const char* parts[] = {"other ", "thread"};
+            const std::size_t lengths[] = {6, 6};
+            writer.append(5, parts, lengths, 2);
+        }).join();
+        writer.append(1, "last", 4);
+        writeTaken(writer, segment);
+    }
+
+    auto entries(readSegment());
+    REQUIRE(entries.size() == 4);
+    REQUIRE(entries[0].type == BinaryLog::RAW_LINE);
+    REQUIRE(entries[0].message == "start\n");
+    REQUIRE(entries[1].message == "main thread");
+    REQUIRE(entries[1].level == 2);
+    REQUIRE(entries[2].message == "other thread");
+    REQUIRE(entries[2].level == 5);
+    REQUIRE(entries[3].message == "last");
+    REQUIRE(entries[1].threadName == entries[3].threadName);
+    REQUIRE(entries[1].threadName != entries[2].threadName);
+    REQUIRE_FALSE(entries[2].threadName.empty());
+
+    // A new run appends to the existing segment
+    {
+        BinaryLogWriter writer;
+        BinaryLogSegment segment;
+        REQUIRE(segment.open(SEGMENT_PATH, 1024 * 1024, writer.wallClockBaseMicros(), writer.steadyBaseMicros()));
+        writer.append(3, "second run", 10);
+        writeTaken(writer, segment);
+    }
+
+    entries = readSegment();
+    REQUIRE(entries.size() == 5);
+    REQUIRE(entries[3].message == "last");
+    REQUIRE(entries[4].message == "second run");
+    removeSegment();
+}
+
+TEST_CASE("Binary log segment only takes the records that fit")
+{
+    removeSegment();
+    BinaryLogWriter writer;
+    BinaryLogSegment segment;
+    REQUIRE(segment.open(SEGMENT_PATH, 4096, writer.wallClockBaseMicros(), writer.steadyBaseMicros()));
+
+    const std::string message(100, 'x');
+    for (int i = 0; i < 100; ++i)
+    {
+        writer.append(4, message.data(), message.size());
+    }
+
+    std::vector<char> records;
+    writer.takeRecords(records);
+    auto written(segment.write(records.data(), records.size()));
+    REQUIRE(written > 0);
+    REQUIRE(written < records.size());
+    REQUIRE(segment.used() <= 4096);
+    REQUIRE(segment.write(records.data() + written, records.size() - written) == 0);
+    segment.close();
+
+    auto entries(readSegment());
+    REQUIRE_FALSE(entries.empty());
+    REQUIRE(std::all_of(entries.begin(), entries.end(), [&message](const Entry& entry){ return entry.message == message; }));
+    removeSegment();
+}
+
+TEST_CASE("Binary log versus text log lines with debug logging on", "[.][benchmark]")
+{
+    constexpr int threads(4);
+    constexpr int linesPerThread(200000);
+    static const char message[] = "Transfer (UPLOAD) finished. File: /home/user/Documents/report-2024.pdf size: 1048576";
+
+    // Mirrors the work LoggingThread::log does per line in text mode
+    auto textLine = [](std::string& line)
+    {
+        auto now = std::chrono::system_clock::now();
+        time_t t = std::chrono::system_clock::to_time_t(now);
+        struct tm gmt;
+#ifdef WIN32
+        gmtime_s(&gmt, &t);
+#else
+        gmtime_r(&t, &gmt);
+#endif
+        char timebuf[80];
+        auto micro = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() % 1000000;
+        snprintf(timebuf, sizeof(timebuf), "%02d/%02d-%02d:%02d:%02d.%06d ",
+                 gmt.tm_mon + 1, gmt.tm_mday, gmt.tm_hour, gmt.tm_min, gmt.tm_sec, static_cast<int>(micro));
+        line.clear();
+        line.append(timebuf);
+        line.append("140234 ");
+        line.append("DBG  ");
+        line.append(message);
+        line.push_back('\n');
+    };
+
+    auto run = [&](const char* name, bool binary)
+    {
+        BinaryLogWriter writer;
+        std::mutex textMutex;
+        std::string textBuffer;
+        std::vector<std::vector<std::int64_t>> latencies(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; ++thread)
+        {
+            workers.emplace_back([&, thread]
+            {
+                std::string line;
+                std::vector<char> drained;
+                latencies[thread].reserve(linesPerThread);
+                for (int i = 0; i < linesPerThread; ++i)
+                {
+                    auto before = std::chrono::steady_clock::now();
+                    if (binary)
+                    {
+                        writer.append(5, message, sizeof(message) - 1);
+                    }
+                    else
+                    {
+                        textLine(line);
+                        std::lock_guard<std::mutex> lock(textMutex);
+                        textBuffer.append(line);
+                    }
+                    auto after = std::chrono::steady_clock::now();
+                    latencies[thread].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+
+                    // Stands in for the logging thread emptying the buffers
+                    if (thread == 0 && i % 1000 == 0)
+                    {
+                        if (binary)
+                        {
+                            writer.takeRecords(drained);
+                        }
+                        else
+                        {
+                            std::lock_guard<std::mutex> lock(textMutex);
+                            textBuffer.clear();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<std::int64_t> all;
+        for (auto& threadLatencies : latencies)
+        {
+            all.insert(all.end(), threadLatencies.begin(), threadLatencies.end());
+        }
+        std::sort(all.begin(), all.end());
+        WARN(name << ": " << static_cast<long long>(threads * linesPerThread / seconds) << " lines/s, p50 "
+             << all[all.size() / 2] << " ns, p99 " << all[all.size() * 99 / 100] << " ns");
+    };
+
+    run("Text lines", false);
+    run("Binary records", true);
+}
@@ -0,0 +1,127 @@
+#include <catch.hpp>
+#include "FileExtensionTable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+using Icon = FileExtensionTable::Icon;
+using Kind = FileExtensionTable::Kind;
+
+Icon iconOf(const std::string& fileName)
+{
+    return FileExtensionTable::iconForFileName(fileName.data(), fileName.size());
+}
+
+Icon iconOf(const std::u16string& fileName)
+{
+    return FileExtensionTable::iconForFileName(fileName.data(), fileName.size());
+}
+}
+
+TEST_CASE("FileExtensionTable classifies file names by extension")
+{
+    SECTION("Known extensions")
+    {
+        CHECK(iconOf("song.mp3") == Icon::AUDIO);
+        CHECK(iconOf("movie.webm") == Icon::VIDEO);
+        CHECK(iconOf("archive.tar") == Icon::COMPRESSED);
+        CHECK(iconOf("file.torrent") == Icon::TORRENT);
+        CHECK(iconOf("presentation.numbers") == Icon::NUMBERS);
+        CHECK(iconOf("a.7z") == Icon::COMPRESSED);
+        CHECK(iconOf("Import.folder") == Icon::FOLDER);
+        // Later entries of the old table won over earlier ones
+        CHECK(iconOf("photo.tif") == Icon::RAW);
+        CHECK(iconOf("letter.odt") == Icon::OPENOFFICE);
+        CHECK(iconOf("sheet.ods") == Icon::OPENOFFICE);
+    }
+
+    SECTION("Case, paths and hidden files")
+    {
+        CHECK(iconOf("PHOTO.JPG") == Icon::IMAGE);
+        CHECK(iconOf("Photo.JpEg") == Icon::IMAGE);
+        CHECK(iconOf("dir.pdf/notes.txt") == Icon::TEXT);
+        CHECK(iconOf(".key") == Icon::KEYNOTE);
+        CHECK(iconOf("many.dots.in.name.docx") == Icon::WORD);
+        CHECK(iconOf(u"été.png") == Icon::IMAGE);
+    }
+
+    SECTION("Unknown extensions")
+    {
+        for (const char* name : {"", "noextension", "dir.pdf/file", "trailingdot.", "a.unknown", "a.pdfx",
+                                 "a.torrents", "a.p", "a.jp"})
+        {
+            CAPTURE(name);
+            CHECK(iconOf(name) == Icon::GENERIC);
+        }
+        CHECK(iconOf(u"a.péf") == Icon::GENERIC);
+        CHECK(FileExtensionTable::iconForExtension("pdf", 2) == Icon::GENERIC);
+    }
+
+    SECTION("Icon files and kinds")
+    {
+        CHECK(std::string(FileExtensionTable::iconFileName(Icon::GENERIC)) == "generic.png");
+        CHECK(std::string(FileExtensionTable::iconFileName(Icon::THREE_D)) == "3D.png");
+        CHECK(std::string(FileExtensionTable::iconFileName(Icon::EXPERIENCE_DESIGN)) == "experiencedesign.png");
+        CHECK(std::string(FileExtensionTable::iconFileName(Icon::KEYNOTE)) == "keynote.png");
+
+        CHECK(FileExtensionTable::kind(iconOf("a.wav")) == Kind::AUDIO);
+        CHECK(FileExtensionTable::kind(iconOf("a.mkv")) == Kind::VIDEO);
+        CHECK(FileExtensionTable::kind(iconOf("a.sketch")) == Kind::ARCHIVE);
+        CHECK(FileExtensionTable::kind(iconOf("a.xml")) == Kind::DOCUMENT);
+        CHECK(FileExtensionTable::kind(iconOf("a.svg")) == Kind::IMAGE);
+        CHECK(FileExtensionTable::kind(iconOf("a.bin")) == Kind::OTHER);
+        CHECK(FileExtensionTable::kind(iconOf("a.ttf")) == Kind::OTHER);
+        CHECK(FileExtensionTable::kind(iconOf("a.unknown")) == Kind::OTHER);
+    }
+}
+
+TEST_CASE("FileExtensionTable benchmark", "[.][benchmark]")
+{
+    // The old lookup: suffix copied, lowered and searched in a string hash map
+    const std::unordered_map<std::string, Icon> extensionIcons{
+        {"mp3", Icon::AUDIO}, {"mkv", Icon::VIDEO}, {"jpg", Icon::IMAGE}, {"pdf", Icon::PDF},
+        {"zip", Icon::COMPRESSED}, {"docx", Icon::WORD}, {"txt", Icon::TEXT}, {"bin", Icon::EXECUTABLE}};
+    const std::vector<std::string> names{"Holiday photo 0001.JPG", "report-final.pdf", "song.mp3",
+                                         "backup.zip", "notes.txt", "unknown.bin", "Movie.MKV", "readme"};
+    constexpr int rounds = 200000;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t oldHits = 0;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const auto& name : names)
+        {
+            const auto dot = name.rfind('.');
+            std::string suffix(dot == std::string::npos ? std::string() : name.substr(dot + 1));
+            std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c)
+            {
+                return static_cast<char>(std::tolower(c));
+            });
+            auto it = extensionIcons.find(suffix);
+            oldHits += it != extensionIcons.end() ? 1 : 0;
+        }
+    }
+    const double oldNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                         / (rounds * names.size());
+
+    start = std::chrono::steady_clock::now();
+    std::size_t tableHits = 0;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const auto& name : names)
+        {
+            tableHits += iconOf(name) != Icon::GENERIC ? 1 : 0;
+        }
+    }
+    const double tableNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                           / (rounds * names.size());
+
+    CHECK(oldHits == tableHits);
+    WARN("Per file name: lowered suffix + string hash map " << oldNs << " ns, perfect hash table " << tableNs << " ns");
+}
@@ -0,0 +1,210 @@
+#include <catch.hpp>
+#include "FileHashCache.h"
+
+#ifndef WIN32
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+const std::string FILE_PATH("FileHashCache.Test.file");
+const std::string CACHE_PATH("FileHashCache.Test.cache");
+
+void writeFile(const std::string& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+FileIdentity identityOf(const std::string& path)
+{
+    FileIdentity identity;
+    REQUIRE(FileIdentity::read(path, identity));
+    return identity;
+}
+
+// Stands for the hashing of Utilities::getFileHash: the whole file is read in 8 KB chunks
+std::string readAndHash(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char buffer[8192];
+    std::uint64_t hash = 14695981039346656037ULL;
+    while (file.read(buffer, sizeof(buffer)) || file.gcount())
+    {
+        for (std::streamsize i = 0; i < file.gcount(); ++i)
+        {
+            hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
+        }
+    }
+    return std::to_string(hash);
+}
+}
+
+TEST_CASE("FileHashCache keeps digests while the file is unchanged")
+{
+    writeFile(FILE_PATH, "contents");
+    FileHashCache cache(64);
+    const FileIdentity identity(identityOf(FILE_PATH));
+    std::string value;
+
+    CHECK_FALSE(cache.find(identity, FileHashCache::Digest::SHA256, value));
+    cache.store(identity, FileHashCache::Digest::SHA256, "sha");
+    cache.store(identity, FileHashCache::Digest::CRC, "crc");
+    REQUIRE(cache.find(identity, FileHashCache::Digest::SHA256, value));
+    CHECK(value == "sha");
+    REQUIRE(cache.find(identity, FileHashCache::Digest::CRC, value));
+    CHECK(value == "crc");
+    CHECK(cache.size() == 1);
+
+    SECTION("Rewritten with the same size and modification time")
+    {
+        struct timeval times[2] = {};
+        times[0].tv_sec = times[1].tv_sec = 1600000000;
+        REQUIRE(!utimes(FILE_PATH.c_str(), times));
+        const FileIdentity before(identityOf(FILE_PATH));
+        cache.store(before, FileHashCache::Digest::SHA256, "sha");
+
+        writeFile(FILE_PATH, "CONTENTS");
+        REQUIRE(!utimes(FILE_PATH.c_str(), times));
+        const FileIdentity after(identityOf(FILE_PATH));
+        CHECK(after.size == before.size);
+        CHECK(after.modifiedTime == before.modifiedTime);
+        CHECK_FALSE(cache.find(after, FileHashCache::Digest::SHA256, value));
+    }
+
+    SECTION("Replaced by another version")
+    {
+        writeFile(FILE_PATH, "longer contents");
+        const FileIdentity changed(identityOf(FILE_PATH));
+        CHECK_FALSE(cache.find(changed, FileHashCache::Digest::SHA256, value));
+        cache.store(changed, FileHashCache::Digest::SHA256, "new");
+        CHECK_FALSE(cache.find(identity, FileHashCache::Digest::SHA256, value));
+        CHECK_FALSE(cache.find(changed, FileHashCache::Digest::CRC, value));
+        CHECK(cache.size() == 1);
+    }
+
+    SECTION("Invalid values are not stored")
+    {
+        FileIdentity other(identity);
+        ++other.inode;
+        cache.store(other, FileHashCache::Digest::SHA256, "");
+        cache.store(other, FileHashCache::Digest::SHA256, std::string(FileHashCache::MAX_DIGEST_SIZE + 1, 'x'));
+        CHECK(cache.size() == 1);
+    }
+
+    FileIdentity missing;
+    CHECK_FALSE(FileIdentity::read(FILE_PATH + ".missing", missing));
+    CHECK_FALSE(FileIdentity::read(".", missing));
+    remove(FILE_PATH.c_str());
+}
+
+TEST_CASE("FileHashCache is bounded")
+{
+    FileHashCache cache(16);
+    FileIdentity identity;
+    for (std::uint64_t inode = 1; inode <= 1000; ++inode)
+    {
+        identity.inode = inode;
+        cache.store(identity, FileHashCache::Digest::SHA256, std::to_string(inode));
+    }
+    CHECK(cache.size() <= 16);
+
+    // The most recent entries survive
+    std::string value;
+    REQUIRE(cache.find(identity, FileHashCache::Digest::SHA256, value));
+    CHECK(value == "1000");
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+}
+
+TEST_CASE("FileHashCache persists in its file")
+{
+    remove(CACHE_PATH.c_str());
+    FileIdentity identity;
+    identity.device = 1;
+    identity.inode = 2;
+    std::string value;
+
+    {
+        FileHashCache cache(32);
+        REQUIRE(cache.open(CACHE_PATH));
+        CHECK(cache.isMapped());
+        cache.store(identity, FileHashCache::Digest::CRC, "crc");
+    }
+
+    {
+        FileHashCache cache(32);
+        REQUIRE(cache.open(CACHE_PATH));
+        REQUIRE(cache.find(identity, FileHashCache::Digest::CRC, value));
+        CHECK(value == "crc");
+    }
+
+    SECTION("Another format is discarded")
+    {
+        FileHashCache cache(64);
+        REQUIRE(cache.open(CACHE_PATH));
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("Corrupted slots are ignored")
+    {
+        std::string data;
+        {
+            std::ifstream file(CACHE_PATH, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        const std::size_t pos = data.find("crc");
+        REQUIRE(pos != std::string::npos);
+        data[pos] = 'X';
+        writeFile(CACHE_PATH, data);
+
+        FileHashCache cache(32);
+        REQUIRE(cache.open(CACHE_PATH));
+        CHECK(cache.size() == 0);
+        CHECK_FALSE(cache.find(identity, FileHashCache::Digest::CRC, value));
+    }
+
+    SECTION("Unusable paths keep the table in memory")
+    {
+        FileHashCache cache(32);
+        CHECK_FALSE(cache.open("missing.folder/FileHashCache.cache"));
+        CHECK_FALSE(cache.isMapped());
+        cache.store(identity, FileHashCache::Digest::CRC, "crc");
+        CHECK(cache.find(identity, FileHashCache::Digest::CRC, value));
+    }
+
+    remove(CACHE_PATH.c_str());
+}
+
+TEST_CASE("FileHashCache benchmark", "[.][benchmark]")
+{
+    constexpr int lookups = 100;
+    writeFile(FILE_PATH, std::string(64 * 1024 * 1024, 'x'));
+    FileHashCache cache;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3; ++i)
+    {
+        readAndHash(FILE_PATH);
+    }
+    const double hashMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / 3;
+
+    cache.store(identityOf(FILE_PATH), FileHashCache::Digest::SHA256, readAndHash(FILE_PATH));
+    std::string value;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        REQUIRE(cache.find(identityOf(FILE_PATH), FileHashCache::Digest::SHA256, value));
+    }
+    const double lookupUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / lookups;
+
+    WARN("64 MB file: reading and hashing " << hashMs << " ms, identity check + cached digest " << lookupUs << " us");
+    remove(FILE_PATH.c_str());
+}
+#endif
@@ -0,0 +1,175 @@
+#include <catch.hpp>
+#include "LogCompressor.h"
+
+#include "zlib.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace
+{
+#ifdef WIN32
+const LogCompressorPath FIRST_PATH(L"LogCompressor.Test.1.gz");
+const LogCompressorPath SECOND_PATH(L"LogCompressor.Test.2.gz");
+#else
+const LogCompressorPath FIRST_PATH("LogCompressor.Test.1.gz");
+const LogCompressorPath SECOND_PATH("LogCompressor.Test.2.gz");
+#endif
+
+std::string logText(int lines, int seed)
+{
+    std::string text;
+    for (int line = 0; line < lines; ++line)
+    {
+        text += "10/17-12:00:00.123456 140234 DBG  Transfer " + std::to_string(seed * 100000 + line)
+                + " updated. Speed: " + std::to_string(line % 977) + " KB/s\n";
+    }
+    return text;
+}
+
+std::string readFile(const LogCompressorPath& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string gunzip(const std::string& compressed)
+{
+    std::string output;
+    z_stream stream{};
+    REQUIRE(inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+
+    char buffer[16384];
+    while (stream.avail_in)
+    {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        auto result = inflate(&stream, Z_NO_FLUSH);
+        REQUIRE((result == Z_OK || result == Z_STREAM_END));
+        output.append(buffer, sizeof(buffer) - stream.avail_out);
+        if (result == Z_STREAM_END)
+        {
+            // Next gzip member
+            REQUIRE(inflateReset(&stream) == Z_OK);
+        }
+    }
+    inflateEnd(&stream);
+    return output;
+}
+
+void removeFiles()
+{
+#ifdef WIN32
+    _wremove(FIRST_PATH.c_str());
+    _wremove(SECOND_PATH.c_str());
+#else
+    std::remove(FIRST_PATH.c_str());
+    std::remove(SECOND_PATH.c_str());
+#endif
+}
+}
+
+TEST_CASE("Log compressor writes gzip members that can be concatenated")
+{
+    removeFiles();
+    auto first(logText(5000, 1));
+    auto second(logText(3000, 2));
+
+    {
+        LogCompressor compressor(LogCompressor::DEFAULT_LEVEL, 16 * 1024, 2);
+        bool firstDone(false);
+        bool secondDone(false);
+
+        compressor.open(FIRST_PATH);
+        for (std::size_t offset = 0; offset < first.size(); offset += 1000)
+        {
+            compressor.write(first.data() + offset, std::min<std::size_t>(1000, first.size() - offset));
+        }
+        compressor.finish([&firstDone](bool ok) { firstDone = ok; });
+
+        compressor.open(SECOND_PATH);
+        compressor.write(second.data(), second.size());
+        compressor.finish([&secondDone](bool ok) { secondDone = ok; });
+
+        compressor.waitUntilIdle();
+        REQUIRE(firstDone);
+        REQUIRE(secondDone);
+    }
+
+    auto firstCompressed(readFile(FIRST_PATH));
+    auto secondCompressed(readFile(SECOND_PATH));
+    REQUIRE(firstCompressed.size() < first.size() / 4);
+    REQUIRE(gunzip(firstCompressed) == first);
+    REQUIRE(gunzip(secondCompressed) == second);
+
+    // Joining rotated logs is a byte copy
+    REQUIRE(gunzip(secondCompressed + firstCompressed) == second + first);
+    removeFiles();
+}
+
+TEST_CASE("Log compressor discards the current file")
+{
+    removeFiles();
+    LogCompressor compressor(LogCompressor::DEFAULT_LEVEL, 1024);
+    compressor.open(FIRST_PATH);
+    auto text(logText(100, 3));
+    compressor.write(text.data(), text.size());
+    compressor.discard();
+    compressor.waitUntilIdle();
+
+    std::ifstream file(FIRST_PATH.c_str());
+    REQUIRE_FALSE(file.is_open());
+}
+
+TEST_CASE("Log compression on rotation", "[.][benchmark]")
+{
+    constexpr int lines(150000);
+    auto text(logText(lines, 4));
+
+    // Previous approach: the whole file compressed line by line after rotation
+    removeFiles();
+    auto start = std::chrono::steady_clock::now();
+    {
+#ifdef WIN32
+        auto file = gzopen_w(FIRST_PATH.c_str(), "wb");
+#else
+        auto file = gzopen(FIRST_PATH.c_str(), "wb");
+#endif
+        std::size_t begin(0);
+        while (begin < text.size())
+        {
+            auto end = text.find('\n', begin) + 1;
+            gzputs(file, text.substr(begin, end - begin).c_str());
+            begin = end;
+        }
+        gzclose(file);
+    }
+    auto lineByLine = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    auto lineByLineSize = readFile(FIRST_PATH).size();
+
+    // Streaming: the text is compressed while it is written, rotation waits for the last block only
+    LogCompressor compressor;
+    compressor.open(SECOND_PATH);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset < text.size(); offset += 4096)
+    {
+        compressor.write(text.data() + offset, std::min<std::size_t>(4096, text.size() - offset));
+    }
+    compressor.waitUntilIdle();
+    auto streaming = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    compressor.finish(nullptr);
+    compressor.waitUntilIdle();
+    auto rotation = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    auto streamingSize = readFile(SECOND_PATH).size();
+
+    WARN(text.size() / 1024 << " KB of log text");
+    WARN("Line by line after rotation: " << lineByLine << " ms, " << lineByLineSize / 1024 << " KB");
+    WARN("Streaming: " << streaming << " ms while writing, " << rotation << " ms at rotation, " << streamingSize / 1024 << " KB");
+    removeFiles();
+}
@@ -0,0 +1,139 @@
+#include <catch.hpp>
+#include "MpscRingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+struct ProgressEvent
+{
+    int tag;
+    long long notificationNumber;
+    unsigned long long transferredBytes;
+    unsigned long long speed;
+};
+}
+
+TEST_CASE("MPSC ring buffer keeps FIFO order and rejects pushes when full")
+{
+    MpscRingBuffer<int> ring(5);
+    REQUIRE(ring.capacity() == 8);
+
+    for(int value = 0; value < 8; ++value)
+    {
+        REQUIRE(ring.push(value));
+    }
+    REQUIRE_FALSE(ring.push(8));
+    REQUIRE(ring.dropped() == 1);
+
+    int value(-1);
+    REQUIRE(ring.pop(value));
+    REQUIRE(value == 0);
+    REQUIRE(ring.push(8));
+
+    std::vector<int> drained;
+    REQUIRE(ring.drain([&drained](int item){ drained.push_back(item); }, 100) == 8);
+    REQUIRE(drained == std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8}));
+    REQUIRE_FALSE(ring.pop(value));
+}
+
+TEST_CASE("MPSC ring buffer does not lose events from several producers")
+{
+    constexpr int producers(4);
+    constexpr int eventsPerProducer(100000);
+
+    MpscRingBuffer<ProgressEvent> ring(1024);
+    std::vector<std::thread> threads;
+    for(int producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&ring, producer]{
+            for(long long number = 1; number <= eventsPerProducer;)
+            {
+                if(ring.push(ProgressEvent{producer, number, 0, 0}))
+                {
+                    ++number;
+                }
+            }
+        });
+    }
+
+    // Events of each producer must arrive in order
+    std::vector<long long> lastNumber(producers, 0);
+    int received(0);
+    ProgressEvent event;
+    while(received < producers * eventsPerProducer)
+    {
+        if(ring.pop(event))
+        {
+            REQUIRE(event.notificationNumber == lastNumber[event.tag] + 1);
+            lastNumber[event.tag] = event.notificationNumber;
+            ++received;
+        }
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+TEST_CASE("MPSC ring buffer sustained throughput with 50k active transfers", "[.][benchmark]")
+{
+    constexpr int activeTransfers(50000);
+    constexpr int producers(4);
+    constexpr auto duration(std::chrono::seconds(2));
+
+    MpscRingBuffer<ProgressEvent> ring(1 << 16);
+    std::atomic<bool> done(false);
+    std::atomic<long long> pushed(0);
+
+    std::vector<std::thread> threads;
+    for(int producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&, producer]{
+            long long count(0);
+            for(long long number = 1; !done; ++number)
+            {
+                auto tag(static_cast<int>((number * producers + producer) % activeTransfers));
+                if(ring.push(ProgressEvent{tag, number, static_cast<unsigned long long>(number), 1000}))
+                {
+                    ++count;
+                }
+            }
+            pushed += count;
+        });
+    }
+
+    // Consumer behaves as the GUI timer: drains in batches and coalesces by tag
+    std::unordered_map<int, ProgressEvent> coalesced;
+    coalesced.reserve(activeTransfers);
+    long long consumed(0);
+    auto start(std::chrono::steady_clock::now());
+    while(std::chrono::steady_clock::now() - start < duration)
+    {
+        consumed += static_cast<long long>(ring.drain([&coalesced](const ProgressEvent& event){
+            auto& last = coalesced[event.tag];
+            if(last.notificationNumber < event.notificationNumber)
+            {
+                last = event;
+            }
+        }, ring.capacity()));
+        coalesced.clear();
+    }
+
+    done = true;
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto seconds(std::chrono::duration<double>(duration).count());
+    WARN("Pushed events/sec: " << static_cast<long long>(pushed / seconds)
+         << ", consumed events/sec: " << static_cast<long long>(consumed / seconds)
+         << ", rejected (buffer full): " << ring.dropped());
+    CHECK(consumed > 0);
+}
@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include "NodeChangeBatch.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+constexpr unsigned int MOVED = 1u << NodeChangeBatch::MOVED;
+constexpr unsigned int ATTRIBUTES = 1u << NodeChangeBatch::ATTRIBUTES;
+constexpr unsigned int REMOVED = 1u << NodeChangeBatch::REMOVED;
+}
+
+TEST_CASE("NodeChangeBatch groups the changes by type")
+{
+    NodeChangeBatch batch;
+    CHECK(batch.empty());
+
+    batch.add(30, 1, MOVED | ATTRIBUTES);
+    batch.add(10, 2, MOVED);
+    batch.add(20, 2, REMOVED);
+    batch.add(10, 3, MOVED);
+    batch.add(30, 1, ATTRIBUTES);
+    batch.finish();
+
+    CHECK_FALSE(batch.empty());
+    CHECK(batch.size() == 3);
+    CHECK(batch.handles(NodeChangeBatch::MOVED) == std::vector<NodeChangeBatch::Handle>{10, 30});
+    CHECK(batch.handles(NodeChangeBatch::ATTRIBUTES) == std::vector<NodeChangeBatch::Handle>{30});
+    CHECK(batch.handles(NodeChangeBatch::REMOVED) == std::vector<NodeChangeBatch::Handle>{20});
+    CHECK(batch.handles(NodeChangeBatch::NEW).empty());
+
+    CHECK(batch.contains(NodeChangeBatch::MOVED, 10));
+    CHECK_FALSE(batch.contains(NodeChangeBatch::MOVED, 20));
+
+    // The last move wins
+    CHECK(batch.parentOf(10) == 3);
+    CHECK(batch.parentOf(30) == 1);
+    CHECK(batch.parentOf(20) == NodeChangeBatch::INVALID_HANDLE);
+    CHECK(batch.movedParents() == std::vector<NodeChangeBatch::Handle>{1, 3});
+}
+
+TEST_CASE("NodeChangeBatch benchmark", "[.][benchmark]")
+{
+    // A bulk move of 50k nodes to one folder, with attribute changes, seen by a consumer that
+    // needs the new parent of the moved nodes and keeps 200 rows
+    constexpr NodeChangeBatch::Handle nodes = 50000;
+    constexpr NodeChangeBatch::Handle folder = 1;
+    std::unordered_map<NodeChangeBatch::Handle, bool> isFile{{folder, false}};
+    std::vector<NodeChangeBatch::Handle> rows;
+    for (NodeChangeBatch::Handle row = 0; row < 200; ++row)
+    {
+        rows.push_back(1000000 + row);
+    }
+
+    // One queued signal per node and change, each with a parent lookup and a row lookup
+    auto start = std::chrono::steady_clock::now();
+    std::deque<std::function<void()>> queue;
+    std::size_t perNodeMatches = 0;
+    for (NodeChangeBatch::Handle handle = 10; handle < 10 + nodes; ++handle)
+    {
+        queue.emplace_back([&, handle]()
+        {
+            if (isFile.at(folder))
+            {
+                ++perNodeMatches;
+            }
+            for (auto row : rows)
+            {
+                perNodeMatches += row == handle;
+            }
+        });
+        queue.emplace_back([&, handle]()
+        {
+            for (auto row : rows)
+            {
+                perNodeMatches += row == handle;
+            }
+        });
+    }
+    while (!queue.empty())
+    {
+        queue.front()();
+        queue.pop_front();
+    }
+    const double perNodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // One batch: each distinct parent is looked up once and the rows are matched by binary search
+    start = std::chrono::steady_clock::now();
+    NodeChangeBatch batch;
+    for (NodeChangeBatch::Handle handle = 10 + nodes; handle-- > 10;)
+    {
+        batch.add(handle, folder, MOVED | ATTRIBUTES);
+    }
+    batch.finish();
+    std::size_t batchMatches = 0;
+    for (auto parent : batch.movedParents())
+    {
+        batchMatches += isFile.at(parent) ? 1 : 0;
+    }
+    for (auto row : rows)
+    {
+        batchMatches += batch.contains(NodeChangeBatch::MOVED, row) ? 1 : 0;
+        batchMatches += batch.contains(NodeChangeBatch::ATTRIBUTES, row) ? 1 : 0;
+    }
+    const double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(perNodeMatches == batchMatches);
+    CHECK(batch.size() == nodes);
+    WARN(nodes << " nodes moved: " << 2 * nodes << " per-node callbacks " << perNodeMs << " ms, one batch "
+         << batchMs << " ms");
+}
@@ -0,0 +1,153 @@
+#include <catch.hpp>
+#include "control/Preferences/EncryptedSettings.h"
+#include "platform/Platform.h"
+
+#include <QFile>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace
+{
+const QString SETTINGS_PATH(QString::fromLatin1("EncryptedSettings.Test.cfg"));
+
+std::unique_ptr<EncryptedSettings> createSettings()
+{
+    // The encryption key comes from the platform
+    static bool platformCreated = (Platform::create(), true);
+    (void)platformCreated;
+    QFile::remove(SETTINGS_PATH);
+    QFile::remove(SETTINGS_PATH + QString::fromLatin1(".bak"));
+    return std::unique_ptr<EncryptedSettings>(new EncryptedSettings(SETTINGS_PATH));
+}
+
+// Reads as value() did before values were kept in memory: hashing and decrypting every time
+class UncachedSettings : public EncryptedSettings
+{
+public:
+    using EncryptedSettings::EncryptedSettings;
+
+    QVariant uncachedValue(const QString & key)
+    {
+        return QVariant(decrypt(key, QSettings::value(hash(key), encrypt(key, QString())).toString()));
+    }
+};
+}
+
+TEST_CASE("EncryptedSettings keeps decrypted values in memory")
+{
+    auto settings = createSettings();
+    const QString key(QString::fromLatin1("key"));
+    const QString group(QString::fromLatin1("user@example.com"));
+    QVariant value;
+
+    SECTION("Values are available without locking once read or written")
+    {
+        CHECK_FALSE(settings->cachedValue(key, QVariant(), value));
+        CHECK(settings->value(key, 5).toInt() == 5);
+        REQUIRE(settings->cachedValue(key, 7, value));
+        CHECK(value.toInt() == 7);
+
+        settings->setValue(key, 42);
+        REQUIRE(settings->cachedValue(key, 7, value));
+        CHECK(value.toInt() == 42);
+        CHECK(settings->value(key).toInt() == 42);
+    }
+
+    SECTION("Lock free readers stay in the stable group")
+    {
+        settings->setValue(key, QString::fromLatin1("general"));
+        settings->beginGroup(group);
+        settings->setValue(key, QString::fromLatin1("user"));
+        REQUIRE(settings->cachedValue(key, QVariant(), value));
+        CHECK(value.toString() == QString::fromLatin1("general"));
+
+        settings->markGroupStable();
+        REQUIRE(settings->cachedValue(key, QVariant(), value));
+        CHECK(value.toString() == QString::fromLatin1("user"));
+
+        settings->endGroup();
+        CHECK(settings->value(key).toString() == QString::fromLatin1("general"));
+        REQUIRE(settings->cachedValue(key, QVariant(), value));
+        CHECK(value.toString() == QString::fromLatin1("user"));
+    }
+
+    SECTION("Many values are kept")
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            settings->setValue(key + QString::number(i), i);
+        }
+        for (int i = 0; i < 1000; ++i)
+        {
+            REQUIRE(settings->cachedValue(key + QString::number(i), QVariant(), value));
+            CHECK(value.toInt() == i);
+        }
+        settings->remove(key + QString::number(7));
+        CHECK_FALSE(settings->cachedValue(key + QString::number(8), QVariant(), value));
+        CHECK(settings->value(key + QString::number(8)).toInt() == 8);
+    }
+
+    SECTION("Removed values are read again")
+    {
+        settings->setValue(key, 1);
+        settings->remove(key);
+        CHECK_FALSE(settings->cachedValue(key, QVariant(), value));
+        CHECK(settings->value(key, 3).toInt() == 3);
+    }
+
+    SECTION("Values survive a sync and a new instance")
+    {
+        settings->setValue(key, QString::fromLatin1("stored"));
+        settings->sync();
+        settings.reset(new EncryptedSettings(SETTINGS_PATH));
+        CHECK(settings->value(key).toString() == QString::fromLatin1("stored"));
+    }
+
+    settings.reset();
+    QFile::remove(SETTINGS_PATH);
+    QFile::remove(SETTINGS_PATH + QString::fromLatin1(".bak"));
+}
+
+TEST_CASE("EncryptedSettings getter benchmark", "[.][benchmark]")
+{
+    constexpr int KEYS = 1000;
+    auto settings = createSettings();
+    QStringList keys;
+    for (int i = 0; i < KEYS; ++i)
+    {
+        keys.append(QString::fromLatin1("key%1").arg(i));
+        settings->setValue(keys.last(), i);
+    }
+    settings->sync();
+    auto uncachedSettings = std::unique_ptr<UncachedSettings>(new UncachedSettings(SETTINGS_PATH));
+
+    auto nanosecondsPerRead = [&keys](std::function<void(const QString&)> read)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& key : keys)
+        {
+            read(key);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / keys.size();
+    };
+
+    const double uncachedRead = nanosecondsPerRead([&uncachedSettings](const QString& key) {uncachedSettings->uncachedValue(key);});
+    settings = std::move(uncachedSettings);
+    // The first read of every key hashes, decrypts and stores the value
+    const double firstRead = nanosecondsPerRead([&settings](const QString& key) {settings->value(key);});
+    const double cachedRead = nanosecondsPerRead([&settings](const QString& key) {settings->value(key);});
+    const double lockFreeRead = nanosecondsPerRead([&settings](const QString& key)
+    {
+        QVariant value;
+        settings->cachedValue(key, QVariant(), value);
+    });
+
+    WARN("ns per read: before " << uncachedRead << "; first read " << firstRead << ", cached " << cachedRead
+         << ", lock free " << lockFreeRead);
+
+    settings.reset();
+    QFile::remove(SETTINGS_PATH);
+    QFile::remove(SETTINGS_PATH + QString::fromLatin1(".bak"));
+}
@@ -0,0 +1,203 @@
+#include <catch.hpp>
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// Single FIFO queue behind one mutex, as the pool was before work stealing. Used as benchmark baseline
+class SingleQueueThreadPool
+{
+public:
+    explicit SingleQueueThreadPool(std::size_t threadCount)
+    {
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            mThreads.emplace_back([this]
+            {
+                for (;;)
+                {
+                    std::function<void()> functor;
+                    {
+                        std::unique_lock<std::mutex> lock{mMutex};
+                        mCv.wait(lock, [this]{return mDone || !mFunctors.empty();});
+                        if (mDone && mFunctors.empty())
+                        {
+                            break;
+                        }
+                        functor = std::move(mFunctors.front());
+                        mFunctors.pop();
+                    }
+                    functor();
+                }
+            });
+        }
+    }
+
+    ~SingleQueueThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mMutex};
+            mDone = true;
+        }
+        mCv.notify_all();
+        for (auto& thread : mThreads)
+        {
+            thread.join();
+        }
+    }
+
+    void push(std::function<void()> functor)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mMutex};
+            mFunctors.push(std::move(functor));
+        }
+        mCv.notify_one();
+    }
+
+private:
+    bool mDone = false;
+    std::vector<std::thread> mThreads;
+    std::queue<std::function<void()>> mFunctors;
+    std::condition_variable mCv;
+    std::mutex mMutex;
+};
+
+struct BenchmarkResult
+{
+    double tasksPerSecond;
+    double p50Microseconds;
+    double p99Microseconds;
+};
+
+template <typename PushFunc>
+BenchmarkResult runProducers(int producers, int tasksPerProducer, PushFunc push)
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<long long> latencies(static_cast<std::size_t>(producers * tasksPerProducer));
+    std::atomic<int> pending(producers * tasksPerProducer);
+
+    auto start(Clock::now());
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&, producer]
+        {
+            for (int task = 0; task < tasksPerProducer; ++task)
+            {
+                auto index(static_cast<std::size_t>(producer * tasksPerProducer + task));
+                auto queued(Clock::now());
+                push([&latencies, &pending, index, queued]
+                {
+                    latencies[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - queued).count();
+                    --pending;
+                });
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    while (pending > 0)
+    {
+        std::this_thread::yield();
+    }
+    auto elapsed(std::chrono::duration<double>(Clock::now() - start).count());
+
+    std::sort(latencies.begin(), latencies.end());
+    return BenchmarkResult{latencies.size() / elapsed,
+                           latencies[latencies.size() / 2] / 1000.0,
+                           latencies[latencies.size() * 99 / 100] / 1000.0};
+}
+}
+
+TEST_CASE("Thread pool returns futures of submitted tasks")
+{
+    ThreadPool pool(4);
+
+    std::vector<std::future<int>> futures;
+    for (int value = 0; value < 1000; ++value)
+    {
+        futures.push_back(pool.submit([value]{return value * 2;},
+                                      static_cast<ThreadPool::Priority>(value % static_cast<int>(ThreadPool::Priority::LAST))));
+    }
+
+    for (int value = 0; value < 1000; ++value)
+    {
+        REQUIRE(futures[static_cast<std::size_t>(value)].get() == value * 2);
+    }
+}
+
+TEST_CASE("Thread pool drops tasks cancelled before they start")
+{
+    ThreadPool pool(2);
+    ThreadPool::CancelToken token;
+    token.cancel();
+
+    auto future(pool.submit([]{return true;}, ThreadPool::Priority::BACKGROUND, token));
+    REQUIRE_THROWS_AS(future.get(), std::future_error);
+}
+
+TEST_CASE("Thread pool keeps a worker free for interactive tasks while background tasks run")
+{
+    ThreadPool pool(3);
+    ThreadPool::CancelToken scanToken;
+    std::atomic<int> runningScans(0);
+
+    for (int scan = 0; scan < 10; ++scan)
+    {
+        pool.push([&runningScans]
+        {
+            ++runningScans;
+            while (!ThreadPool::isThreadInterrupted())
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+            --runningScans;
+        }, ThreadPool::Priority::BACKGROUND, scanToken);
+    }
+
+    auto interactive(pool.submit([]{return true;}, ThreadPool::Priority::INTERACTIVE));
+    REQUIRE(interactive.wait_for(5s) == std::future_status::ready);
+    REQUIRE(runningScans <= 2);
+
+    scanToken.cancel();
+}
+
+TEST_CASE("Thread pool throughput and latency against a single queue pool", "[.][benchmark]")
+{
+    constexpr std::size_t threads(5);
+    constexpr int tasksPerProducer(20000);
+
+    for (auto producers : {8, 16, 32})
+    {
+        BenchmarkResult singleQueue;
+        {
+            SingleQueueThreadPool pool(threads);
+            singleQueue = runProducers(producers, tasksPerProducer, [&pool](std::function<void()> task){
+                pool.push(std::move(task));
+            });
+        }
+
+        BenchmarkResult workStealing;
+        {
+            ThreadPool pool(threads);
+            workStealing = runProducers(producers, tasksPerProducer, [&pool](std::function<void()> task){
+                pool.push(std::move(task));
+            });
+        }
+
+        WARN(producers << " producers. Single queue: " << static_cast<long long>(singleQueue.tasksPerSecond)
+             << " tasks/s, p50 " << singleQueue.p50Microseconds << " us, p99 " << singleQueue.p99Microseconds
+             << " us. Work stealing: " << static_cast<long long>(workStealing.tasksPerSecond)
+             << " tasks/s, p50 " << workStealing.p50Microseconds << " us, p99 " << workStealing.p99Microseconds << " us");
+    }
+}
@@ -0,0 +1,143 @@
+#include <catch.hpp>
+#include "TransferProgressFeed.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr int STATE_ACTIVE = 2;
+constexpr int STATE_COMPLETED = 6;
+
+// Stands in for the browser: reads the event stream and keeps the last state of each handle
+struct StreamClient
+{
+    std::vector<std::string> events;
+
+    void read(const std::string& stream)
+    {
+        std::size_t start = 0;
+        std::size_t end;
+        while ((end = stream.find("\n\n", start)) != std::string::npos)
+        {
+            const std::string event(stream.substr(start, end - start));
+            REQUIRE(event.compare(0, 7, "data: [") == 0);
+            REQUIRE(event.back() == ']');
+            events.push_back(event.substr(6));
+            start = end + 2;
+        }
+        CHECK(start == stream.size());
+    }
+};
+
+TransferProgressFeed::Progress progress(long long transferred, long long size, bool finished = false)
+{
+    TransferProgressFeed::Progress result;
+    result.state = finished ? STATE_COMPLETED : STATE_ACTIVE;
+    result.transferred = transferred;
+    result.size = size;
+    result.speed = 10;
+    result.finished = finished;
+    return result;
+}
+}
+
+TEST_CASE("TransferProgressFeed")
+{
+    TransferProgressFeed feed;
+    StreamClient client;
+    auto id = feed.subscribe({{1, "AAA"}, {2, "BBB"}, {1, "AAA"}});
+
+    CHECK(feed.isWatched(1));
+    CHECK_FALSE(feed.isWatched(3));
+    CHECK_FALSE(feed.hasPendingEvents());
+    CHECK(feed.takeEvent(id).empty());
+
+    SECTION("Updates between two events are coalesced")
+    {
+        for (long long transferred = 0; transferred <= 100; ++transferred)
+        {
+            feed.update(1, progress(transferred, 100));
+        }
+        feed.update(3, progress(5, 5));
+
+        CHECK(feed.hasPendingEvents());
+        client.read(feed.takeEvent(id));
+        REQUIRE(client.events.size() == 1);
+        CHECK(client.events[0] == "[{\"h\":\"AAA\",\"s\":2,\"p\":100,\"t\":100,\"v\":10}]");
+        CHECK_FALSE(feed.hasPendingEvents());
+        CHECK(feed.takeEvent(id).empty());
+    }
+
+    SECTION("The stream is done when every transfer finished and was sent")
+    {
+        feed.update(1, progress(100, 100, true));
+        CHECK_FALSE(feed.isDone(id));
+        feed.update(2, progress(50, 50, true));
+        CHECK_FALSE(feed.isDone(id));
+
+        client.read(feed.takeEvent(id));
+        CHECK(client.events[0] == "[{\"h\":\"AAA\",\"s\":6,\"p\":100,\"t\":100,\"v\":10},"
+                                  "{\"h\":\"BBB\",\"s\":6,\"p\":50,\"t\":50,\"v\":10}]");
+        CHECK(feed.isDone(id));
+    }
+
+    SECTION("Late subscribers get the current state and handles are dropped with their last subscriber")
+    {
+        feed.update(2, progress(20, 50));
+        auto other = feed.subscribe({{2, "BBB"}});
+        CHECK(feed.subscriberCount() == 2);
+        client.read(feed.takeEvent(other));
+        CHECK(client.events[0] == "[{\"h\":\"BBB\",\"s\":2,\"p\":20,\"t\":50,\"v\":10}]");
+
+        feed.unsubscribe(id);
+        CHECK_FALSE(feed.isWatched(1));
+        CHECK(feed.isWatched(2));
+        feed.unsubscribe(other);
+        CHECK_FALSE(feed.isWatched(2));
+        CHECK(feed.subscriberCount() == 0);
+        CHECK(feed.takeEvent(id).empty());
+    }
+}
+
+TEST_CASE("TransferProgressFeed benchmark", "[.][benchmark]")
+{
+    // 50 downloads with 20 transfer events per second during 60 seconds. The browser used to poll
+    // each handle every 250 ms; the stream is pushed every 500 ms
+    constexpr int downloads = 50;
+    constexpr int seconds = 60;
+    constexpr int eventsPerSecond = 20;
+    constexpr int pushesPerSecond = 2;
+    constexpr int pollsPerSecond = 4;
+
+    TransferProgressFeed feed;
+    std::vector<std::pair<TransferProgressFeed::Handle, std::string>> handles;
+    for (int i = 0; i < downloads; ++i)
+    {
+        handles.emplace_back(TransferProgressFeed::Handle(i), "H" + std::to_string(i));
+    }
+    auto id = feed.subscribe(handles);
+
+    StreamClient client;
+    std::size_t streamBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < seconds * eventsPerSecond; ++tick)
+    {
+        for (int i = 0; i < downloads; ++i)
+        {
+            feed.update(TransferProgressFeed::Handle(i), progress(tick, seconds * eventsPerSecond));
+        }
+        if ((tick + 1) % (eventsPerSecond / pushesPerSecond) == 0 && feed.hasPendingEvents())
+        {
+            const std::string event(feed.takeEvent(id));
+            streamBytes += event.size();
+            client.read(event);
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    WARN(downloads << " downloads for " << seconds << " s: " << downloads * seconds * pollsPerSecond
+         << " polling requests replaced by 1 stream with " << client.events.size() << " events ("
+         << streamBytes << " bytes, " << downloads * seconds * eventsPerSecond << " updates in " << ms << " ms)");
+}
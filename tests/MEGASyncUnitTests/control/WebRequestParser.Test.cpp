@@ -0,0 +1,247 @@
+#include <catch.hpp>
+#include "WebRequestParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+std::string downloadBody(std::size_t nodes)
+{
+    std::string body("{\"a\":\"d\",\"esid\":\"sessionid\",\"f\":[");
+    for (std::size_t i = 0; i < nodes; ++i)
+    {
+        body += i ? "," : "";
+        body += "{\"t\":0,\"h\":\"H" + std::to_string(i) + "\",\"p\":\"PARENT01\",\"n\":\"bmFtZS50eHQ\","
+                "\"k\":\"0123456789012345678901234567890123456789012\",\"s\":" + std::to_string(i * 1000)
+                + ",\"ts\":1700000000,\"c\":\"crc\"}";
+    }
+    return body + "]}";
+}
+
+std::string postRequest(const std::string& body)
+{
+    return "POST / HTTP/1.1\r\n"
+           "Host: localhost\r\n"
+           "Origin: https://mega.nz\r\n"
+           "content-length: " + std::to_string(body.size()) + "\r\n"
+           "\r\n" + body;
+}
+
+// Delivers data in chunks of the given size
+WebRequestParser::State feed(WebRequestParser& parser, const std::string& data, std::size_t chunkSize)
+{
+    WebRequestParser::State state = parser.state();
+    for (std::size_t pos = 0; pos < data.size(); pos += chunkSize)
+    {
+        state = parser.append(data.data() + pos, std::min(chunkSize, data.size() - pos));
+    }
+    return state;
+}
+
+// The old readClient: the whole buffer was searched and split again after every chunk
+std::size_t splitAfterEveryChunk(const std::string& data, std::size_t chunkSize)
+{
+    std::string buffer;
+    std::size_t bodySize = 0;
+    for (std::size_t pos = 0; pos < data.size(); pos += chunkSize)
+    {
+        buffer.append(data, pos, chunkSize);
+        std::size_t end = buffer.find("\r\n\r\n");
+        if (end != std::string::npos)
+        {
+            std::string body(buffer, end + 4);
+            bodySize = body.size();
+        }
+    }
+    return bodySize;
+}
+}
+
+TEST_CASE("WebRequestParser reads HTTP requests as they arrive")
+{
+    const std::string body(downloadBody(3));
+    const std::string request(postRequest(body));
+
+    SECTION("Byte by byte")
+    {
+        WebRequestParser parser;
+        for (std::size_t i = 0; i + 1 < request.size(); ++i)
+        {
+            REQUIRE(parser.append(&request[i], 1) != WebRequestParser::State::COMPLETE);
+        }
+        REQUIRE(parser.append(&request.back(), 1) == WebRequestParser::State::COMPLETE);
+        CHECK(parser.isPost());
+        CHECK(parser.header("Origin") == "https://mega.nz");
+        CHECK(parser.header("CONTENT-LENGTH") == std::to_string(body.size()));
+        CHECK(parser.header("Missing").empty());
+        CHECK(parser.headerLines().front() == "POST / HTTP/1.1");
+        CHECK(parser.body() == body);
+    }
+
+    SECTION("Several requests on the same connection")
+    {
+        WebRequestParser parser;
+        const std::string second(postRequest("{\"a\":\"v\"}"));
+        REQUIRE(feed(parser, request + second, 7) == WebRequestParser::State::COMPLETE);
+        CHECK(parser.body() == body);
+        parser.reset();
+        REQUIRE(parser.state() == WebRequestParser::State::COMPLETE);
+        CHECK(parser.body() == "{\"a\":\"v\"}");
+        parser.reset();
+        CHECK(parser.state() == WebRequestParser::State::HEADERS);
+    }
+
+    SECTION("Preflight requests have no body")
+    {
+        WebRequestParser parser;
+        CHECK(feed(parser, "OPTIONS / HTTP/1.1\r\nAccess-Control-Request-Method: POST\r\n\r\n", 100)
+              == WebRequestParser::State::COMPLETE);
+        CHECK(parser.isOption());
+        CHECK(parser.body().empty());
+    }
+
+    SECTION("Invalid requests")
+    {
+        WebRequestParser get;
+        CHECK(feed(get, "GET / HTTP/1.1\r\n\r\n", 100) == WebRequestParser::State::FAILED);
+        CHECK(get.error() == WebRequestParser::Error::METHOD_NOT_ALLOWED);
+
+        WebRequestParser missing;
+        CHECK(feed(missing, "POST / HTTP/1.1\r\n\r\n{}", 100) == WebRequestParser::State::FAILED);
+        CHECK(missing.error() == WebRequestParser::Error::MISSING_CONTENT_LENGTH);
+
+        WebRequestParser invalid;
+        CHECK(feed(invalid, "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n{}", 100) == WebRequestParser::State::FAILED);
+        CHECK(invalid.error() == WebRequestParser::Error::INVALID_CONTENT_LENGTH);
+
+        WebRequestParser tooLarge(1024);
+        CHECK(feed(tooLarge, postRequest(downloadBody(100)), 100) == WebRequestParser::State::FAILED);
+        CHECK(tooLarge.error() == WebRequestParser::Error::BODY_TOO_LARGE);
+
+        WebRequestParser endless;
+        CHECK(feed(endless, "POST / HTTP/1.1\r\n" + std::string(WebRequestParser::MAX_HEADERS_SIZE, 'x'), 1000)
+              == WebRequestParser::State::FAILED);
+        CHECK(endless.error() == WebRequestParser::Error::HEADERS_TOO_LARGE);
+    }
+}
+
+TEST_CASE("WebRequest reads the fields of the webclient requests")
+{
+    WebRequest request;
+
+    SECTION("Download request")
+    {
+        const std::string body(downloadBody(2));
+        REQUIRE(request.parse(body.data(), body.size()));
+        CHECK(request.action() == "d");
+        CHECK(request.string("esid") == "sessionid");
+        CHECK(request.string("en").empty());
+        REQUIRE(request.nodes().size() == 2);
+        const WebRequestNode& node = request.nodes()[1];
+        CHECK(node.type == 0);
+        CHECK(node.handle == "H1");
+        CHECK(node.parent == "PARENT01");
+        CHECK(node.name == "bmFtZS50eHQ");
+        CHECK(node.key.size() == 43);
+        CHECK(node.size == 1000);
+        CHECK(node.mtime == 1700000000);
+        CHECK(node.crc == "crc");
+    }
+
+    SECTION("Strings, numbers and lists")
+    {
+        const std::string body("{ \"a\" : \"ds\", \"t\":-2, \"big\":99999999999999999999, \"x\":1.5,"
+                               " \"e\":[\"A\", \"B\\u00e9\\ud83d\\ude00\\n\"], \"mixed\":[\"A\",1],"
+                               " \"o\":{\"h\":\"nested\",\"l\":[null,true,false,{}]}, \"h\":\"top\" }");
+        REQUIRE(request.parse(body.data(), body.size()));
+        CHECK(request.action() == "ds");
+        CHECK(request.number("t") == -2);
+        CHECK(request.number("big", 7) == 7);
+        CHECK(request.number("x", 7) == 7);
+        CHECK(request.number("a", 7) == 7);
+        CHECK(request.stringList("e") == std::vector<std::string>{"A", "B\xC3\xA9\xF0\x9F\x98\x80\n"});
+        CHECK(request.stringList("mixed").empty());
+        CHECK(request.string("h") == "top");
+        CHECK(request.nodes().empty());
+    }
+
+    SECTION("Malformed JSON")
+    {
+        for (const char* body : {"", "[]", "{", "{\"a\":}", "{\"a\":\"v\"", "{\"a\":\"v\"} x", "{\"a\":01}",
+                                 "{\"a\":\"\\x\"}", "{\"a\":\"\\ud83d\"}", "{\"f\":[{\"h\":\"x\"}}", "{\"a\":tru}"})
+        {
+            CAPTURE(body);
+            CHECK_FALSE(request.parse(body, strlen(body)));
+        }
+
+        std::string deep("{\"a\":");
+        deep += std::string(100, '[') + std::string(100, ']') + "}";
+        CHECK_FALSE(request.parse(deep.data(), deep.size()));
+    }
+}
+
+TEST_CASE("WebRequestParser fuzzing")
+{
+    // Mutated requests in random chunks must never crash and the same bytes must always give
+    // the same result, however they are split
+    std::mt19937 random(1234);
+    const std::string valid(postRequest(downloadBody(5)));
+    const char alphabet[] = "{}[]\":,\\u0123456789-.eE \r\ntruefalsenull";
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::string data(valid);
+        const int mutations = 1 + static_cast<int>(random() % 4);
+        for (int i = 0; i < mutations; ++i)
+        {
+            const std::size_t pos = random() % data.size();
+            switch (random() % 3)
+            {
+            case 0: data[pos] = alphabet[random() % (sizeof(alphabet) - 1)]; break;
+            case 1: data.erase(pos, 1 + random() % 8); break;
+            default: data.insert(pos, 1, alphabet[random() % (sizeof(alphabet) - 1)]); break;
+            }
+        }
+
+        WebRequestParser whole;
+        WebRequestParser chunked;
+        const auto wholeState = feed(whole, data, data.size());
+        const auto chunkedState = feed(chunked, data, 1 + random() % 16);
+        REQUIRE(wholeState == chunkedState);
+        if (wholeState == WebRequestParser::State::COMPLETE)
+        {
+            REQUIRE(whole.body() == chunked.body());
+            WebRequest request;
+            request.parse(whole.body().data(), whole.body().size());
+        }
+    }
+}
+
+TEST_CASE("WebRequestParser benchmark", "[.][benchmark]")
+{
+    constexpr std::size_t chunkSize = 64 * 1024;
+    for (std::size_t nodes : {std::size_t(1), std::size_t(1000), std::size_t(100000)})
+    {
+        const std::string data(postRequest(downloadBody(nodes)));
+
+        auto start = std::chrono::steady_clock::now();
+        const std::size_t oldBodySize = splitAfterEveryChunk(data, chunkSize);
+        const double splitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        WebRequestParser parser;
+        REQUIRE(feed(parser, data, chunkSize) == WebRequestParser::State::COMPLETE);
+        WebRequest request;
+        REQUIRE(request.parse(parser.body().data(), parser.body().size()));
+        const double parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        CHECK(oldBodySize == parser.body().size());
+        CHECK(request.nodes().size() == nodes);
+        WARN(nodes << " nodes (" << data.size() << " bytes in 64 KB chunks): splitting after every chunk "
+             << splitMs << " ms, incremental framing + JSON parse " << parseMs << " ms");
+    }
+}
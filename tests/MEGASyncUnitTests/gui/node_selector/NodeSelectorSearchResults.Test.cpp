@@ -0,0 +1,285 @@
+#include <catch.hpp>
+#include "node_selector/model/NodeSelectorSearchResults.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<NodeSelectorSearchResults::Handle> rankedHandles(const NodeSelectorSearchResults& results)
+{
+    std::vector<NodeSelectorSearchResults::Handle> handles;
+    for(auto position : results.rankedOrder())
+    {
+        handles.push_back(results.handle(position));
+    }
+    return handles;
+}
+}
+
+TEST_CASE("NodeSelectorSearchResults ranks the results")
+{
+    using Handles = std::vector<NodeSelectorSearchResults::Handle>;
+    NodeSelectorSearchResults results;
+    results.reset("Holi");
+    results.add(1, "my_holidays_2023.jpg");
+    results.add(2, "Holidays");
+    results.add(3, "photoholic");
+    results.add(4, "HOLI");
+    results.add(5, "holidays.txt");
+    results.add(6, "Bank holiday");
+
+    REQUIRE(results.size() == 6);
+    REQUIRE(std::string(results.name(1)) == "holidays");
+
+    SECTION("Exact names, then prefixes, words and the rest, shorter names first")
+    {
+        REQUIRE(rankedHandles(results) == Handles{4, 2, 5, 6, 1, 3});
+    }
+
+    SECTION("Names not matched here go last")
+    {
+        results.add(7, "h\xc3\xb3li");
+        results.add(8, nullptr);
+        REQUIRE(rankedHandles(results) == Handles{4, 2, 5, 6, 1, 3, 8, 7});
+    }
+
+    SECTION("Very long names keep the search order")
+    {
+        NodeSelectorSearchResults longNames;
+        longNames.reset("a");
+        longNames.add(1, std::string(300, 'a').c_str());
+        longNames.add(2, std::string(400, 'a').c_str());
+        longNames.add(3, std::string(290, 'a').c_str());
+        REQUIRE(rankedHandles(longNames) == Handles{1, 2, 3});
+    }
+
+    SECTION("Empty results")
+    {
+        results.reset("holi");
+        REQUIRE(results.size() == 0);
+        REQUIRE(results.rankedOrder().empty());
+    }
+}
+
+TEST_CASE("NodeSelectorSearchResults refines the results")
+{
+    using Handles = std::vector<NodeSelectorSearchResults::Handle>;
+    NodeSelectorSearchResults results;
+    REQUIRE_FALSE(results.canRefine("holi"));
+
+    results.reset("ho");
+    results.add(1, "Holidays");
+    results.add(2, "photo");
+    results.add(3, "Shoes");
+    results.add(4, "my HOLIDAYS");
+
+    SECTION("Only queries containing the last one are refined")
+    {
+        REQUIRE(results.canRefine("hol"));
+        REQUIRE(results.canRefine("HOL"));
+        REQUIRE(results.canRefine("photo"));
+        REQUIRE(results.canRefine("ho"));
+        REQUIRE_FALSE(results.canRefine("h"));
+        REQUIRE_FALSE(results.canRefine("pic"));
+        REQUIRE_FALSE(results.canRefine(""));
+    }
+
+    SECTION("Wildcards and non ASCII queries are searched again")
+    {
+        REQUIRE_FALSE(results.canRefine("ho*s"));
+        REQUIRE_FALSE(results.canRefine("ho?"));
+        REQUIRE_FALSE(results.canRefine("ho\xc3\xa9"));
+
+        results.reset("h*");
+        REQUIRE_FALSE(results.canRefine("h*o"));
+    }
+
+    SECTION("Invalid results are searched again")
+    {
+        results.invalidate();
+        REQUIRE_FALSE(results.canRefine("hol"));
+        results.reset("ho");
+        REQUIRE(results.canRefine("hol"));
+    }
+
+    SECTION("Refined results keep their order and names")
+    {
+        results.refine("HOLI");
+        REQUIRE(results.size() == 2);
+        REQUIRE(results.handle(0) == 1);
+        REQUIRE(results.handle(1) == 4);
+        REQUIRE(std::string(results.name(0)) == "holidays");
+        REQUIRE(std::string(results.name(1)) == "my holidays");
+        REQUIRE(rankedHandles(results) == Handles{1, 4});
+
+        REQUIRE(results.canRefine("holid"));
+        REQUIRE_FALSE(results.canRefine("ho"));
+        results.refine("xyz");
+        REQUIRE(results.size() == 0);
+    }
+}
+
+namespace
+{
+std::size_t gBytes = 0;
+
+// Counts the bytes allocated for the items
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        gBytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {return true;}
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {return false;}
+};
+
+using String = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+// The attributes a MegaNode copy keeps for the node selector, without the rest of MegaNodePrivate
+struct Node
+{
+    String name;
+    String fingerprint;
+    std::uint64_t handle;
+    std::uint64_t parentHandle;
+    long long size;
+    long long creationTime;
+    long long modificationTime;
+    int type;
+    bool isShared;
+};
+
+// A search item holding its node, without the QObject overhead
+struct Item
+{
+    std::shared_ptr<Node> node;
+    int status = 0;
+};
+
+using Items = std::vector<std::unique_ptr<Item>>;
+
+std::unique_ptr<Item> createItem(const Node& source)
+{
+    gBytes += sizeof(Item);
+    std::unique_ptr<Item> item(new Item());
+    item->node = std::allocate_shared<Node>(CountingAllocator<Node>(), source);
+    return item;
+}
+
+// Stand-in for the SDK search by name: case insensitive, anywhere in the name
+std::vector<int> searchAll(const std::vector<Node>& nodes, const std::string& query)
+{
+    std::vector<int> found;
+    std::string name;
+    for(int position = 0; position < static_cast<int>(nodes.size()); ++position)
+    {
+        name.assign(nodes[position].name.c_str());
+        for(auto& character : name)
+        {
+            character = character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a') : character;
+        }
+        if(name.find(query) != std::string::npos)
+        {
+            found.push_back(position);
+        }
+    }
+    return found;
+}
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TEST_CASE("NodeSelectorSearchResults benchmark", "[.][benchmark]")
+{
+    //An account with a million nodes, a tenth of them matching the first query
+    constexpr int count = 1000000;
+    constexpr int firstChunk = 100;
+    std::vector<Node> nodes;
+    nodes.reserve(count);
+    for(int index = 0; index < count; ++index)
+    {
+        auto name(index % 10 ? "IMG_" + std::to_string(index) + ".jpg"
+                             : "Holidays_" + std::to_string(index / 10 % 1000) + "_" + std::to_string(index) + ".jpg");
+        nodes.push_back(Node{String(name.c_str()), String("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"),
+                             static_cast<std::uint64_t>(index), 0, 1000000, 1700000000, 1700000000, 0, false});
+    }
+
+    //Search, then every item, before the first one is shown
+    gBytes = 0;
+    auto start(std::chrono::steady_clock::now());
+    Items allItems;
+    for(auto position : searchAll(nodes, "holi"))
+    {
+        allItems.push_back(createItem(nodes[position]));
+    }
+    auto allItemsMs(msSince(start));
+    auto allItemsBytes(gBytes);
+    auto matches(allItems.size());
+    allItems.clear();
+
+    //Search and rank, then the first chunk of items
+    gBytes = 0;
+    start = std::chrono::steady_clock::now();
+    NodeSelectorSearchResults results;
+    results.reset("holi");
+    for(auto position : searchAll(nodes, "holi"))
+    {
+        results.add(nodes[position].handle, nodes[position].name.c_str());
+    }
+    auto order(results.rankedOrder());
+    Items firstItems;
+    for(int position = 0; position < firstChunk; ++position)
+    {
+        //Stand-in for the lookup of the node by handle
+        firstItems.push_back(createItem(nodes[static_cast<std::size_t>(results.handle(order[position]))]));
+    }
+    auto firstChunkMs(msSince(start));
+    auto firstChunkBytes(gBytes + results.memoryUsage());
+
+    //The query is extended: the results are filtered instead of searched again
+    firstItems.clear();
+    start = std::chrono::steady_clock::now();
+    REQUIRE(results.canRefine("holidays_12"));
+    results.refine("holidays_12");
+    order = results.rankedOrder();
+    for(int position = 0; position < firstChunk && position < results.size(); ++position)
+    {
+        firstItems.push_back(createItem(nodes[static_cast<std::size_t>(results.handle(order[position]))]));
+    }
+    auto refineMs(msSince(start));
+    auto refined(results.size());
+
+    start = std::chrono::steady_clock::now();
+    auto searchedAgain(searchAll(nodes, "holidays_12").size());
+    auto searchAgainMs(msSince(start));
+
+    CHECK(matches == count / 10);
+    CHECK(refined == static_cast<int>(searchedAgain));
+    WARN(count << " nodes, " << matches << " matches: every item before the first result " << allItemsMs << " ms, "
+         << allItemsBytes / 1024 << " KiB; first " << firstChunk << " ranked results " << firstChunkMs << " ms, "
+         << firstChunkBytes / 1024 << " KiB. Extended query (" << refined << " matches): refined "
+         << refineMs << " ms, searched again " << searchAgainMs << " ms");
+}
@@ -0,0 +1,301 @@
+#include <catch.hpp>
+#include "node_selector/model/NodeSelectorTree.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Id = NodeSelectorTree::Id;
+
+NodeSelectorTree::NodeData folder(NodeSelectorTree::Handle handle, const char* name)
+{
+    return NodeSelectorTree::NodeData{handle, name, 0, 0, 0};
+}
+
+std::vector<std::string> namesOf(const NodeSelectorTree& tree, NodeSelectorTree::Range range)
+{
+    std::vector<std::string> names;
+    for(auto id = range.begin; id < range.end; ++id)
+    {
+        names.push_back(tree.name(id));
+    }
+    return names;
+}
+}
+
+TEST_CASE("NodeSelectorTree keeps the children of the folders")
+{
+    using Names = std::vector<std::string>;
+    NodeSelectorTree tree;
+    auto root(tree.findOrAdd(folder(1, "Cloud drive")));
+    REQUIRE(tree.findOrAdd(folder(1, "Cloud drive")) == root);
+    REQUIRE(tree.find(1) == root);
+    REQUIRE(tree.find(2) == NodeSelectorTree::NO_ID);
+
+    const char* names[] = {"a", "b", "c", "d", "e"};
+    auto children(tree.setChildren(root, 5, [&names](int index)
+    {
+        return NodeSelectorTree::NodeData{static_cast<NodeSelectorTree::Handle>(10 + index), names[index], index * 100,
+                                          1700000000 + index, static_cast<std::uint8_t>(index % 2 ? NodeSelectorTree::IS_FILE : 0)};
+    }));
+
+    SECTION("Children are stored together and found by handle")
+    {
+        REQUIRE(children.end - children.begin == 5);
+        REQUIRE(tree.childCount(root) == 5);
+        REQUIRE(namesOf(tree, children) == Names{"a", "b", "c", "d", "e"});
+        auto child(tree.find(13));
+        REQUIRE(child == children.begin + 3);
+        REQUIRE(tree.parent(child) == root);
+        REQUIRE(tree.handle(child) == 13);
+        REQUIRE(tree.size(child) == 300);
+        REQUIRE(tree.modificationTime(child) == 1700000003);
+        REQUIRE(tree.isFile(child));
+        REQUIRE_FALSE(tree.isFile(tree.find(12)));
+        REQUIRE(tree.rowOf(13) == 3);
+        REQUIRE(tree.rowOf(1) == -1);
+    }
+
+    SECTION("Children are handed out in pages")
+    {
+        REQUIRE(tree.pendingChildren(root) == 5);
+        REQUIRE(namesOf(tree, tree.nextPage(root, 2)) == Names{"a", "b"});
+        REQUIRE(tree.loadedChildren(root) == 2);
+        REQUIRE(namesOf(tree, tree.nextPage(root, 2)) == Names{"c", "d"});
+        REQUIRE(namesOf(tree, tree.nextPage(root, 2)) == Names{"e"});
+        REQUIRE(tree.pendingChildren(root) == 0);
+        auto empty(tree.nextPage(root, 2));
+        REQUIRE(empty.begin == empty.end);
+    }
+
+    SECTION("A page reaches the child to reveal")
+    {
+        REQUIRE(namesOf(tree, tree.nextPage(root, 1, 13)) == Names{"a", "b", "c", "d"});
+        REQUIRE(namesOf(tree, tree.nextPage(root, 1, 11)) == Names{"e"});
+        REQUIRE(namesOf(tree, tree.nextPage(root, 1, 99)).empty());
+    }
+
+    SECTION("Subfolders get their own children")
+    {
+        auto subfolder(tree.find(12));
+        tree.setChildren(subfolder, 2, [](int index)
+        {
+            return folder(static_cast<NodeSelectorTree::Handle>(20 + index), index ? "y" : "x");
+        });
+        REQUIRE(tree.childCount(subfolder) == 2);
+        REQUIRE(tree.parent(tree.find(21)) == subfolder);
+        REQUIRE(tree.rowOf(21) == 1);
+        REQUIRE(tree.find(12) == subfolder);
+    }
+
+    SECTION("A new snapshot of a folder replaces the old one")
+    {
+        auto subfolder(tree.find(12));
+        tree.setChildren(subfolder, 1, [](int){return folder(20, "x");});
+        tree.nextPage(root, 5);
+
+        tree.setChildren(root, 2, [](int index)
+        {
+            return folder(static_cast<NodeSelectorTree::Handle>(index ? 14 : 12), index ? "e" : "c");
+        });
+        REQUIRE(tree.pendingChildren(root) == 2);
+        REQUIRE(tree.find(10) == NodeSelectorTree::NO_ID);
+        REQUIRE(tree.rowOf(14) == 1);
+        //The old subfolder and its children are dead
+        REQUIRE(tree.find(12) != subfolder);
+        REQUIRE(tree.find(20) == NodeSelectorTree::NO_ID);
+        REQUIRE(tree.childCount(tree.find(12)) == 0);
+        REQUIRE(tree.deadNodes() == 5);
+    }
+
+    SECTION("Removed children are dead")
+    {
+        auto subfolder(tree.find(12));
+        tree.setChildren(subfolder, 1, [](int){return folder(20, "x");});
+        REQUIRE(tree.deadNodes() == 0);
+
+        tree.removeChildren(root);
+        REQUIRE(tree.deadNodes() == 5);
+        REQUIRE(tree.childCount(root) == 0);
+        REQUIRE(tree.pendingChildren(root) == 0);
+        REQUIRE(tree.find(1) == root);
+        REQUIRE(tree.find(10) == NodeSelectorTree::NO_ID);
+        REQUIRE(tree.find(20) == NodeSelectorTree::NO_ID);
+        auto empty(tree.nextPage(root, 2));
+        REQUIRE(empty.begin == empty.end);
+    }
+
+    SECTION("Clear")
+    {
+        tree.clear();
+        REQUIRE(tree.size() == 0);
+        REQUIRE(tree.find(1) == NodeSelectorTree::NO_ID);
+    }
+}
+
+TEST_CASE("NodeSelectorTree finds many handles")
+{
+    NodeSelectorTree tree;
+    auto root(tree.findOrAdd(folder(0, "root")));
+    const int count = 20000;
+    tree.setChildren(root, count, [](int index)
+    {
+        //Handles of the same account share their high bits
+        return folder(0xABCD00000000ULL | static_cast<NodeSelectorTree::Handle>(index * 4096), "child");
+    });
+
+    for(int index = 0; index < count; ++index)
+    {
+        REQUIRE(tree.rowOf(0xABCD00000000ULL | static_cast<NodeSelectorTree::Handle>(index * 4096)) == index);
+    }
+    REQUIRE(tree.find(0xABCD00000001ULL) == NodeSelectorTree::NO_ID);
+}
+
+namespace
+{
+std::size_t gBytes = 0;
+
+// Counts the bytes allocated for the items
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        gBytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {return true;}
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {return false;}
+};
+
+using String = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+// The attributes a MegaNode copy keeps for the node selector, without the rest of MegaNodePrivate
+struct Node
+{
+    String name;
+    String fingerprint;
+    std::uint64_t handle;
+    std::uint64_t parentHandle;
+    long long size;
+    long long creationTime;
+    long long modificationTime;
+    int type;
+    bool isShared;
+};
+
+// A model item holding its node and the list of its children, without the QObject overhead
+struct Item
+{
+    virtual ~Item() = default;
+
+    std::shared_ptr<Node> node;
+    Item* parent = nullptr;
+    std::vector<Item*, CountingAllocator<Item*>> children;
+    long long childrenCounter = 0;
+    int status = 0;
+    bool showFiles = true;
+    bool childrenAreInit = false;
+    bool requestingChildren = false;
+};
+
+using Items = std::vector<std::unique_ptr<Item>>;
+
+std::unique_ptr<Item> createItem(const Node& source, Item* parent)
+{
+    gBytes += sizeof(Item);
+    std::unique_ptr<Item> item(new Item());
+    item->node = std::allocate_shared<Node>(CountingAllocator<Node>(), source);
+    item->parent = parent;
+    parent->children.push_back(item.get());
+    return item;
+}
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TEST_CASE("NodeSelectorTree benchmark", "[.][benchmark]")
+{
+    //A folder with 100000 files, shown in a view with room for a few dozen rows
+    constexpr int count = 100000;
+    constexpr int pageSize = 500;
+
+    std::vector<Node> nodeList;
+    for(int index = 0; index < count; ++index)
+    {
+        nodeList.push_back(Node{String(("IMG_2023_holidays_" + std::to_string(index) + ".jpg").c_str()),
+                                String("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"),
+                                0xABCD00000000ULL + static_cast<std::uint64_t>(index), 0xABCD00000000ULL,
+                                1000000, 1700000000, 1700000000, 0, false});
+    }
+    Item folderItem;
+
+    //Every child gets its item and its node copy
+    Items allItems;
+    gBytes = 0;
+    auto start(std::chrono::steady_clock::now());
+    for(auto& node : nodeList)
+    {
+        allItems.push_back(createItem(node, &folderItem));
+    }
+    auto allItemsMs(msSince(start));
+    auto allItemsBytes(gBytes);
+    folderItem.children.clear();
+    allItems.clear();
+
+    //The children go to the tree, only the first page gets its items
+    Items pageItems;
+    gBytes = 0;
+    start = std::chrono::steady_clock::now();
+    NodeSelectorTree tree;
+    auto folderId(tree.findOrAdd(folder(0xABCD00000000ULL, "folder")));
+    tree.setChildren(folderId, count, [&nodeList](int index)
+    {
+        auto& node(nodeList[index]);
+        return NodeSelectorTree::NodeData{node.handle, node.name.c_str(), node.size, node.modificationTime,
+                                          NodeSelectorTree::IS_FILE};
+    });
+    auto page(tree.nextPage(folderId, pageSize));
+    for(auto id = page.begin; id < page.end; ++id)
+    {
+        //Stand-in for the lookup of the node by handle
+        pageItems.push_back(createItem(nodeList[static_cast<std::size_t>(tree.handle(id) - 0xABCD00000000ULL)], &folderItem));
+    }
+    auto firstPageMs(msSince(start));
+    auto firstPageBytes(gBytes + tree.memoryUsage());
+
+    start = std::chrono::steady_clock::now();
+    page = tree.nextPage(folderId, pageSize);
+    for(auto id = page.begin; id < page.end; ++id)
+    {
+        pageItems.push_back(createItem(nodeList[static_cast<std::size_t>(tree.handle(id) - 0xABCD00000000ULL)], &folderItem));
+    }
+    auto nextPageMs(msSince(start));
+
+    CHECK(pageItems.size() == 2 * pageSize);
+    CHECK(tree.pendingChildren(folderId) == count - 2 * pageSize);
+    WARN(count << " children, pages of " << pageSize << ": every item at once " << allItemsMs << " ms, "
+         << allItemsBytes / 1024 << " KiB; tree and first page " << firstPageMs << " ms, " << firstPageBytes / 1024
+         << " KiB (tree " << tree.memoryUsage() / 1024 << " KiB); next page " << nextPageMs
+         << " ms. Items do not count their QObject and MegaNodePrivate overhead");
+}
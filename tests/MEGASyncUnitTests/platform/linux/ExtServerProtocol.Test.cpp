@@ -0,0 +1,173 @@
+#include <catch.hpp>
+#include "linux/ExtServerProtocol.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+std::string batchRequest(unsigned id, const std::vector<std::string>& paths, char force = '0')
+{
+    std::string request("B:" + std::to_string(id));
+    for (const auto& path : paths)
+    {
+        request += ExtServerProtocol::PATH_SEP + path + ExtServerProtocol::FILE_SEP + force;
+    }
+    return request + '\n';
+}
+
+const char* fakeState(const std::string& content)
+{
+    return content.compare(0, 7, "/synced") ? "9" : "0";
+}
+
+bool readLine(int fd, std::string& buffer, std::string& line)
+{
+    for (;;)
+    {
+        auto end = buffer.find('\n');
+        if (end != std::string::npos)
+        {
+            line = buffer.substr(0, end + 1);
+            buffer.erase(0, end + 1);
+            return true;
+        }
+
+        char data[65536];
+        auto count = read(fd, data, sizeof(data));
+        if (count <= 0)
+        {
+            return false;
+        }
+        buffer.append(data, static_cast<size_t>(count));
+    }
+}
+
+// Same reads as ExtServer::onClientData: single requests have no '\n', batches end with it
+void serve(int fd)
+{
+    std::string buffer;
+    char data[65536];
+    for (;;)
+    {
+        auto count = read(fd, data, sizeof(data));
+        if (count <= 0)
+        {
+            return;
+        }
+        buffer.append(data, static_cast<size_t>(count));
+
+        std::string answers;
+        while (!buffer.empty())
+        {
+            if (ExtServerProtocol::isBatchRequest(buffer.data(), buffer.size()))
+            {
+                auto end = buffer.find('\n');
+                if (end == std::string::npos)
+                {
+                    break;
+                }
+                answers += ExtServerProtocol::answerBatchRequest(buffer.data(), end + 1, fakeState);
+                buffer.erase(0, end + 1);
+            }
+            else
+            {
+                answers += fakeState(buffer.substr(2));
+                answers += '\n';
+                buffer.clear();
+            }
+        }
+        if (!answers.empty() && write(fd, answers.data(), answers.size()) != static_cast<ssize_t>(answers.size()))
+        {
+            return;
+        }
+    }
+}
+}
+
+TEST_CASE("Batched path state requests are answered in order")
+{
+    auto request(batchRequest(42, {"/synced/a", "/other/b", "/synced/c"}));
+    REQUIRE(ExtServerProtocol::isBatchRequest(request.data(), request.size()));
+
+    std::vector<std::string> contents;
+    auto answer(ExtServerProtocol::answerBatchRequest(request.data(), request.size(), [&contents](const std::string& content)
+    {
+        contents.push_back(content);
+        return fakeState(content);
+    }));
+
+    REQUIRE(answer == "B:42:0,9,0\n");
+    REQUIRE(contents.size() == 3);
+    REQUIRE(contents[1] == std::string("/other/b") + ExtServerProtocol::FILE_SEP + '0');
+
+    auto empty(batchRequest(7, {}));
+    REQUIRE(ExtServerProtocol::answerBatchRequest(empty.data(), empty.size(), fakeState) == "B:7:\n");
+
+    std::string single("P:/synced/a");
+    REQUIRE_FALSE(ExtServerProtocol::isBatchRequest(single.data(), single.size()));
+}
+
+TEST_CASE("Directory open with single and batched path state requests", "[.][benchmark]")
+{
+    constexpr std::size_t batchSize(256);
+    constexpr std::size_t maxInFlight(4);
+
+    for (std::size_t files : {1000, 10000, 50000})
+    {
+        std::vector<std::string> paths;
+        for (std::size_t file = 0; file < files; ++file)
+        {
+            paths.push_back("/synced/home/user/MEGA/Photos/2024/IMG_" + std::to_string(100000 + file) + ".jpg");
+        }
+
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        std::thread server(serve, fds[1]);
+        std::string buffer;
+        std::string line;
+
+        // One blocking round trip per file, as mega_ext_client_get_path_state
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& path : paths)
+        {
+            auto request("P:" + path + ExtServerProtocol::FILE_SEP + '0');
+            REQUIRE(write(fds[0], request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+            REQUIRE(readLine(fds[0], buffer, line));
+        }
+        auto single = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Batches with several in flight, as mega_ext_client_get_path_states
+        start = std::chrono::steady_clock::now();
+        std::size_t sent(0);
+        std::size_t answered(0);
+        std::size_t inFlight(0);
+        unsigned id(0);
+        while (answered < files)
+        {
+            while (inFlight < maxInFlight && sent < files)
+            {
+                auto count = std::min(batchSize, files - sent);
+                auto request(batchRequest(++id, std::vector<std::string>(paths.begin() + sent, paths.begin() + sent + count)));
+                REQUIRE(write(fds[0], request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+                sent += count;
+                ++inFlight;
+            }
+            REQUIRE(readLine(fds[0], buffer, line));
+            answered += std::min(batchSize, files - answered);
+            --inFlight;
+        }
+        auto batched = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        close(fds[0]);
+        server.join();
+        close(fds[1]);
+
+        WARN(files << " files: single requests " << single << " ms, batched " << batched << " ms");
+    }
+}
@@ -0,0 +1,104 @@
+#include <catch.hpp>
+#include "linux/OverlayStateCache.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_CASE("Overlay states are cached until their path is invalidated")
+{
+    OverlayStateCache cache;
+    int state = -1;
+
+    REQUIRE_FALSE(cache.find("/home/user/MEGA/a.txt", state));
+    cache.insert("/home/user/MEGA/a.txt", 1);
+    cache.insert("/home/user/MEGA/docs", 2);
+    cache.insert("/home/user/MEGA/docs/b.txt", 1);
+    cache.insert("/home/user/MEGA/docs/deep/c.txt", 1);
+    cache.insert("/home/user/MEGA-other/d.txt", 1);
+    cache.insert("/home/user/Other/e.txt", 0);
+    REQUIRE(cache.size() == 6);
+
+    REQUIRE(cache.find("/home/user/MEGA/a.txt", state));
+    REQUIRE(state == 1);
+    REQUIRE(cache.find("/home/user/MEGA/docs/", state));
+    REQUIRE(state == 2);
+    REQUIRE(cache.hits() == 2);
+    REQUIRE(cache.misses() == 1);
+
+    SECTION("A file only drops its own state")
+    {
+        cache.invalidate("/home/user/MEGA/a.txt");
+        REQUIRE_FALSE(cache.find("/home/user/MEGA/a.txt", state));
+        REQUIRE(cache.find("/home/user/MEGA/docs/b.txt", state));
+        REQUIRE(cache.size() == 5);
+    }
+
+    SECTION("A folder drops everything under it")
+    {
+        cache.invalidate("/home/user/MEGA/docs");
+        REQUIRE_FALSE(cache.find("/home/user/MEGA/docs", state));
+        REQUIRE_FALSE(cache.find("/home/user/MEGA/docs/b.txt", state));
+        REQUIRE_FALSE(cache.find("/home/user/MEGA/docs/deep/c.txt", state));
+        REQUIRE(cache.find("/home/user/MEGA/a.txt", state));
+        REQUIRE(cache.size() == 3);
+    }
+
+    SECTION("A sync root does not drop its siblings with the same prefix")
+    {
+        cache.invalidate("/home/user/MEGA");
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find("/home/user/MEGA-other/d.txt", state));
+        REQUIRE(cache.find("/home/user/Other/e.txt", state));
+    }
+
+    SECTION("The root folder drops everything")
+    {
+        cache.invalidate("/");
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.invalidations() == 1);
+    }
+}
+
+TEST_CASE("Overlay state cache is cleared when full")
+{
+    OverlayStateCache cache(2);
+    int state = -1;
+
+    cache.insert("/a/1", 0);
+    cache.insert("/a/1", 1);
+    cache.insert("/a/2", 0);
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.find("/a/1", state));
+    REQUIRE(state == 1);
+
+    cache.insert("/a/3", 0);
+    REQUIRE(cache.size() == 1);
+    REQUIRE(cache.find("/a/3", state));
+}
+
+TEST_CASE("Overlay state lookups of a refreshed folder", "[.][benchmark]")
+{
+    std::vector<std::string> paths;
+    for (int file = 0; file < 10000; ++file)
+    {
+        paths.push_back("/home/user/MEGA/Photos/2024/IMG_" + std::to_string(100000 + file) + ".jpg");
+    }
+
+    OverlayStateCache cache;
+    for (const auto& path : paths)
+    {
+        cache.insert(path, 0);
+    }
+
+    BENCHMARK("Refresh of 10000 cached files")
+    {
+        int state = 0;
+        int synced = 0;
+        for (const auto& path : paths)
+        {
+            synced += cache.find(path, state) && state == 0;
+        }
+        return synced;
+    };
+}
@@ -0,0 +1,288 @@
+#include <catch.hpp>
+#include "StalledIssuesBatches.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Range = StalledIssuesBatches::Range;
+
+std::vector<std::vector<int>> batchesOf(const StalledIssuesBatches& batches)
+{
+    std::vector<std::vector<int>> items;
+    for(int batch = 0; batch < batches.batchCount(); ++batch)
+    {
+        auto range(batches.batch(batch));
+        items.emplace_back(batches.order().begin() + range.begin, batches.order().begin() + range.end);
+    }
+    return items;
+}
+}
+
+TEST_CASE("StalledIssuesBatches groups the issues to solve")
+{
+    using Batches = std::vector<std::vector<int>>;
+
+    SECTION("Small groups share a batch")
+    {
+        StalledIssuesBatches batches({0, 1, 0, 2, 1, 0}, 10);
+        REQUIRE(batchesOf(batches) == Batches{{0, 2, 5, 1, 4, 3}});
+    }
+
+    SECTION("Groups are not split while they fit in a batch")
+    {
+        StalledIssuesBatches batches({0, 1, 0, 2, 1, 0}, 3);
+        REQUIRE(batchesOf(batches) == Batches{{0, 2, 5}, {1, 4, 3}});
+    }
+
+    SECTION("Big groups are split")
+    {
+        StalledIssuesBatches batches({4, 4, 4, 4, 4, 4, 4}, 3);
+        REQUIRE(batchesOf(batches) == Batches{{0, 1, 2}, {3, 4, 5}, {6}});
+
+        StalledIssuesBatches mixed({0, 1, 1, 1, 1, 1, 2}, 3);
+        REQUIRE(batchesOf(mixed) == Batches{{0}, {1, 2, 3}, {4, 5, 6}});
+    }
+
+    SECTION("Empty list")
+    {
+        StalledIssuesBatches batches({}, 3);
+        REQUIRE(batches.batchCount() == 0);
+        REQUIRE(batches.order().empty());
+    }
+
+    SECTION("Random lists")
+    {
+        std::mt19937 random(7);
+        for(int round = 0; round < 200; ++round)
+        {
+            auto groups(static_cast<int>(random() % 20) + 1);
+            auto maxBatchSize(static_cast<int>(random() % 8) + 1);
+            std::vector<int> groupOfItem(random() % 100);
+            for(auto& group : groupOfItem)
+            {
+                group = static_cast<int>(random() % static_cast<unsigned int>(groups));
+            }
+
+            StalledIssuesBatches batches(groupOfItem, maxBatchSize);
+
+            //Every item once, the items of a group together and in order
+            std::vector<int> seen(groupOfItem.size(), 0);
+            std::vector<int> lastOfGroup(static_cast<std::size_t>(groups), -1);
+            std::vector<char> closedGroups(static_cast<std::size_t>(groups), 0);
+            auto previousGroup(-1);
+            for(auto item : batches.order())
+            {
+                ++seen[item];
+                auto group(groupOfItem[item]);
+                if(group != previousGroup && previousGroup >= 0)
+                {
+                    closedGroups[previousGroup] = 1;
+                }
+                REQUIRE_FALSE(closedGroups[group]);
+                REQUIRE(lastOfGroup[group] < item);
+                lastOfGroup[group] = item;
+                previousGroup = group;
+            }
+            REQUIRE(std::all_of(seen.begin(), seen.end(), [](int count){return count == 1;}));
+
+            auto position(0);
+            for(int batch = 0; batch < batches.batchCount(); ++batch)
+            {
+                REQUIRE(batches.batch(batch).begin == position);
+                REQUIRE(batches.batch(batch).end > position);
+                REQUIRE(batches.batch(batch).end - position <= maxBatchSize);
+                position = batches.batch(batch).end;
+            }
+            REQUIRE(position == static_cast<int>(groupOfItem.size()));
+        }
+    }
+}
+
+TEST_CASE("StalledIssuesBatches checks the batches ahead of the solve")
+{
+    ThreadPool pool(2);
+    std::vector<int> groupOfItem;
+    for(int item = 0; item < 100; ++item)
+    {
+        groupOfItem.push_back(item % 7);
+    }
+    StalledIssuesBatches batches(groupOfItem, 8);
+
+    std::unique_ptr<std::atomic<bool>[]> checked(new std::atomic<bool>[groupOfItem.size()]);
+    for(std::size_t item = 0; item < groupOfItem.size(); ++item)
+    {
+        checked[item] = false;
+    }
+    std::atomic<int> checks(0);
+    auto check = [&checked, &checks](int item)
+    {
+        checked[item] = true;
+        ++checks;
+        return item % 5 == 0;
+    };
+
+    SECTION("Every item is checked before it is solved")
+    {
+        std::vector<int> solved;
+        auto allChecked(true);
+        auto result(batches.solve(pool, check, [&](int batch, const std::vector<char>& changed)
+        {
+            auto range(batches.batch(batch));
+            REQUIRE(static_cast<int>(changed.size()) == range.end - range.begin);
+            for(int position = range.begin; position < range.end; ++position)
+            {
+                auto item(batches.order()[position]);
+                allChecked = allChecked && checked[item];
+                if(!changed[position - range.begin])
+                {
+                    solved.push_back(item);
+                }
+            }
+            return true;
+        }));
+
+        REQUIRE(result);
+        REQUIRE(allChecked);
+        REQUIRE(checks == 100);
+        std::vector<int> expected;
+        for(auto item : batches.order())
+        {
+            if(item % 5 != 0)
+            {
+                expected.push_back(item);
+            }
+        }
+        REQUIRE(solved == expected);
+    }
+
+    SECTION("Stopping waits for the running checks")
+    {
+        auto solvedBatches(0);
+        auto result(batches.solve(pool, check, [&solvedBatches](int, const std::vector<char>&)
+        {
+            return ++solvedBatches < 2;
+        }));
+
+        REQUIRE_FALSE(result);
+        REQUIRE(solvedBatches == 2);
+        auto checksWhenStopped(checks.load());
+        REQUIRE(checksWhenStopped < 100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        REQUIRE(checks == checksWhenStopped);
+    }
+}
+
+TEST_CASE("StalledIssuesBatches benchmark", "[.][benchmark]")
+{
+    //Stalls of 60 folders, as left by a conflicting bulk copy
+    constexpr int issues = 2000;
+    constexpr int folders = 60;
+    // Stand-in for the SDK lookups of a check and for the SDK operation of a solve, which wait for
+    // the SDK lock and the SDK thread
+    const auto sdkLookup(std::chrono::microseconds(150));
+    const auto sdkOperation(std::chrono::microseconds(150));
+
+    std::vector<std::string> paths;
+    std::vector<int> groupOfItem;
+    for(int item = 0; item < issues; ++item)
+    {
+        paths.push_back("StalledIssuesBatches.Test.file" + std::to_string(item));
+        std::ofstream(paths.back()) << item;
+        //Stalls come sorted by path, but the issues to solve by row can mix the folders
+        groupOfItem.push_back((item * 7) % folders);
+    }
+
+    auto check = [&paths, sdkLookup](int item)
+    {
+        auto exists(std::ifstream(paths[item]).good());
+        std::this_thread::sleep_for(sdkLookup);
+        return !exists;
+    };
+
+    std::shared_timed_mutex modelMutex;
+    std::chrono::steady_clock::duration writeLocked{};
+    auto lockForWrite = [&modelMutex, &writeLocked](std::function<void()> func)
+    {
+        auto start(std::chrono::steady_clock::now());
+        modelMutex.lock();
+        func();
+        modelMutex.unlock();
+        writeLocked += std::chrono::steady_clock::now() - start;
+    };
+
+    //One issue at a time, checked and solved with the model locked for writing
+    auto solvedOneByOne(0);
+    auto start(std::chrono::steady_clock::now());
+    for(int item = 0; item < issues; ++item)
+    {
+        lockForWrite([&]()
+        {
+            if(!check(item))
+            {
+                std::this_thread::sleep_for(sdkOperation);
+                ++solvedOneByOne;
+            }
+        });
+    }
+    auto oneByOneMs(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    auto oneByOneLockedMs(std::chrono::duration<double, std::milli>(writeLocked).count());
+
+    //Batches probed in the pool, then each issue checked again only if needed and solved with the model
+    //locked for writing
+    ThreadPool pool(4);
+    writeLocked = {};
+    auto solvedInBatches(0);
+    auto rechecked(0);
+    start = std::chrono::steady_clock::now();
+    StalledIssuesBatches batches(groupOfItem, 64);
+    std::set<int> touchedGroups;
+    batches.solve(pool, check, [&](int batch, const std::vector<char>& changed)
+    {
+        auto range(batches.batch(batch));
+        std::set<int> solvedGroups;
+        for(int position = range.begin; position < range.end; ++position)
+        {
+            auto item(batches.order()[position]);
+            lockForWrite([&]()
+            {
+                auto recheck(changed[position - range.begin] || touchedGroups.count(groupOfItem[item]));
+                rechecked += recheck;
+                if(!recheck || !check(item))
+                {
+                    std::this_thread::sleep_for(sdkOperation);
+                    ++solvedInBatches;
+                    solvedGroups.insert(groupOfItem[item]);
+                }
+            });
+        }
+        touchedGroups.insert(solvedGroups.begin(), solvedGroups.end());
+        return true;
+    });
+    auto batchesMs(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    auto batchesLockedMs(std::chrono::duration<double, std::milli>(writeLocked).count());
+
+    for(auto& path : paths)
+    {
+        std::remove(path.c_str());
+    }
+
+    CHECK(solvedOneByOne == issues);
+    CHECK(solvedInBatches == issues);
+    WARN(issues << " issues in " << folders << " folders, " << sdkLookup.count() << " us per check lookup and "
+         << sdkOperation.count() << " us per solve: one by one " << oneByOneMs << " ms ("
+         << oneByOneLockedMs << " ms locked for writing); batches of 64 checked ahead in a pool of 4 "
+         << batchesMs << " ms (" << batchesLockedMs << " ms locked for writing, " << rechecked << " checked again)");
+}
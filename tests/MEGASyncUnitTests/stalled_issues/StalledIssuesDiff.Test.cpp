@@ -0,0 +1,398 @@
+#include <catch.hpp>
+#include "StalledIssuesDiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+using Diff = StalledIssuesDiff<std::string>;
+
+// Applies the diff the way the model does: removals, then insertions taken from the new list
+std::vector<std::string> apply(std::vector<std::string> rows, const std::vector<std::string>& newRows,
+                               const Diff& diff)
+{
+    for(auto& range : diff.removed())
+    {
+        rows.erase(rows.begin() + range.first, rows.begin() + range.last + 1);
+    }
+    for(auto& range : diff.inserted())
+    {
+        rows.insert(rows.begin() + range.first, newRows.begin() + range.first, newRows.begin() + range.last + 1);
+    }
+    return rows;
+}
+
+Diff diffOf(const std::vector<std::string>& oldRows, const std::vector<std::string>& newRows)
+{
+    return Diff(oldRows, newRows, [](const std::string& key) -> const std::string& { return key; });
+}
+}
+
+TEST_CASE("StalledIssuesDiff finds the rows to remove and insert")
+{
+    SECTION("Unchanged list")
+    {
+        std::vector<std::string> rows{"a", "b", "c"};
+        auto diff(diffOf(rows, rows));
+        CHECK_FALSE(diff.hasRowChanges());
+        CHECK(diff.kept().size() == 3);
+    }
+
+    SECTION("Removed and added issues")
+    {
+        std::vector<std::string> oldRows{"a", "b", "c", "d", "e", "f"};
+        std::vector<std::string> newRows{"x", "a", "c", "d", "y", "z", "f"};
+        auto diff(diffOf(oldRows, newRows));
+
+        REQUIRE(diff.removed().size() == 2);
+        CHECK(diff.removed()[0].first == 4);
+        CHECK(diff.removed()[0].last == 4);
+        CHECK(diff.removed()[1].first == 1);
+        CHECK(diff.removed()[1].last == 1);
+
+        REQUIRE(diff.inserted().size() == 2);
+        CHECK(diff.inserted()[0].first == 0);
+        CHECK(diff.inserted()[0].last == 0);
+        CHECK(diff.inserted()[1].first == 4);
+        CHECK(diff.inserted()[1].last == 5);
+
+        CHECK(diff.kept() == std::vector<std::pair<int, int>>{{0, 1}, {2, 2}, {3, 3}, {5, 6}});
+        CHECK(apply(oldRows, newRows, diff) == newRows);
+    }
+
+    SECTION("Issues out of order are inserted again")
+    {
+        // A solved issue moves to the end of the list
+        std::vector<std::string> oldRows{"a", "solved", "b", "c"};
+        std::vector<std::string> newRows{"a", "b", "c", "solved"};
+        auto diff(diffOf(oldRows, newRows));
+
+        REQUIRE(diff.removed().size() == 1);
+        CHECK(diff.removed()[0].first == 1);
+        REQUIRE(diff.inserted().size() == 1);
+        CHECK(diff.inserted()[0].first == 3);
+        CHECK(diff.kept().size() == 3);
+        CHECK(apply(oldRows, newRows, diff) == newRows);
+    }
+
+    SECTION("Repeated keys")
+    {
+        std::vector<std::string> oldRows{"a", "b", "a", "a"};
+        std::vector<std::string> newRows{"b", "a", "a", "c", "a", "a"};
+        auto diff(diffOf(oldRows, newRows));
+        CHECK(apply(oldRows, newRows, diff) == newRows);
+        CHECK(diff.kept().size() == 3);
+    }
+
+    SECTION("Empty lists")
+    {
+        std::vector<std::string> rows{"a", "b"};
+        auto removeAll(diffOf(rows, {}));
+        CHECK(apply(rows, {}, removeAll).empty());
+        auto insertAll(diffOf({}, rows));
+        CHECK(apply({}, rows, insertAll) == rows);
+    }
+
+    SECTION("Random changes")
+    {
+        std::mt19937 random(7);
+        for(int round = 0; round < 200; ++round)
+        {
+            std::vector<std::string> oldRows;
+            for(int row = 0; row < 40; ++row)
+            {
+                oldRows.push_back(std::to_string(random() % 30));
+            }
+            auto newRows(oldRows);
+            for(int change = 0; change < 8; ++change)
+            {
+                auto row(random() % (newRows.size() + 1));
+                switch(random() % 3)
+                {
+                    case 0:
+                        newRows.insert(newRows.begin() + static_cast<long>(row), std::to_string(random() % 40));
+                        break;
+                    case 1:
+                        if(row < newRows.size())
+                        {
+                            newRows.erase(newRows.begin() + static_cast<long>(row));
+                        }
+                        break;
+                    default:
+                        std::swap(newRows[random() % newRows.size()], newRows[random() % newRows.size()]);
+                        break;
+                }
+            }
+
+            auto diff(diffOf(oldRows, newRows));
+            REQUIRE(apply(oldRows, newRows, diff) == newRows);
+            for(auto& kept : diff.kept())
+            {
+                REQUIRE(oldRows[kept.first] == newRows[kept.second]);
+            }
+        }
+    }
+}
+
+namespace
+{
+std::size_t gAllocations = 0;
+
+// Counts the allocations of the issues and of the containers of the model
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        ++gAllocations;
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {return true;}
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {return false;}
+};
+
+using String = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+std::size_t hashOf(const String& text)
+{
+    // FNV-1a
+    std::size_t hash(14695981039346656037ULL);
+    for(auto c : text)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Hashed once, as the keys of the issues
+struct Key
+{
+    Key(int reason, const std::string& localPath, const std::string& cloudPath)
+        : reason(reason),
+          localPath(localPath.data(), localPath.size()),
+          cloudPath(cloudPath.data(), cloudPath.size()),
+          hash(hashOf(this->localPath) ^ (hashOf(this->cloudPath) * 31) ^ static_cast<std::size_t>(reason))
+    {}
+
+    bool operator==(const Key& other) const
+    {
+        return hash == other.hash && reason == other.reason && localPath == other.localPath
+               && cloudPath == other.cloudPath;
+    }
+
+    int reason;
+    String localPath;
+    String cloudPath;
+    std::size_t hash;
+};
+
+struct KeyHash
+{
+    std::size_t operator()(const Key& key) const
+    {
+        return key.hash;
+    }
+};
+
+// What the SDK gives for each stall
+struct Stall
+{
+    int reason;
+    std::string localPath;
+    std::string cloudPath;
+};
+
+// Stand-ins for the file attributes and the local and cloud data filled for each issue
+struct Attributes
+{
+    explicit Attributes(const String& path) : path(path) {}
+    String path;
+    long long size = -1;
+};
+
+struct Issue
+{
+    explicit Issue(const Stall& stall)
+        : key(stall.reason, stall.localPath, stall.cloudPath),
+          localAttributes(std::allocate_shared<Attributes>(CountingAllocator<Attributes>(), key.localPath)),
+          cloudAttributes(std::allocate_shared<Attributes>(CountingAllocator<Attributes>(), key.cloudPath)),
+          fileName(key.localPath.substr(key.localPath.rfind('/') + 1))
+    {}
+
+    Key key;
+    std::shared_ptr<Attributes> localAttributes;
+    std::shared_ptr<Attributes> cloudAttributes;
+    String fileName;
+};
+
+std::shared_ptr<Issue> createIssue(const Stall& stall)
+{
+    return std::allocate_shared<Issue>(CountingAllocator<Issue>(), stall);
+}
+
+using Issues = std::vector<std::shared_ptr<Issue>, CountingAllocator<std::shared_ptr<Issue>>>;
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+using Map = std::unordered_map<Key, Value, Hash, std::equal_to<Key>, CountingAllocator<std::pair<const Key, Value>>>;
+
+std::vector<Stall> stallsOf(int count, int firstId)
+{
+    std::vector<Stall> stalls;
+    for(int id = firstId; id < firstId + count; ++id)
+    {
+        stalls.push_back(Stall{id % 7, "/home/user/MEGA/folder " + std::to_string(id % 97) + "/file "
+                                            + std::to_string(id) + ".txt",
+                               "/MEGA/folder " + std::to_string(id % 97) + "/file " + std::to_string(id) + ".txt"});
+    }
+    return stalls;
+}
+
+struct Refresh
+{
+    double ms = 0;
+    std::size_t allocations = 0;
+};
+
+template <typename Func>
+Refresh measure(Func func)
+{
+    gAllocations = 0;
+    auto start(std::chrono::steady_clock::now());
+    func();
+    Refresh refresh;
+    refresh.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    refresh.allocations = gAllocations;
+    return refresh;
+}
+}
+
+TEST_CASE("StalledIssuesDiff benchmark", "[.][benchmark]")
+{
+    for(int count : {1000, 10000, 50000})
+    {
+        // 1% of the stalls are solved and as many new ones appear
+        auto stalls(stallsOf(count, 0));
+        auto changed(count / 100);
+        auto newStalls(stallsOf(count - changed, changed));
+        auto added(stallsOf(changed, count));
+        newStalls.insert(newStalls.begin() + count / 2, added.begin(), added.end());
+
+        Issues rows;
+        for(auto& stall : stalls)
+        {
+            rows.push_back(createIssue(stall));
+        }
+
+        // Old refresh: every issue is built again and the rows are reset
+        Issues resetRows;
+        Map<const Issue*, int> resetRowByIssue;
+        auto reset(measure([&](){
+            Issues received;
+            for(auto& stall : newStalls)
+            {
+                received.push_back(createIssue(stall));
+            }
+            resetRows = received;
+            for(int row = 0; row < static_cast<int>(resetRows.size()); ++row)
+            {
+                resetRowByIssue.emplace(resetRows[row].get(), row);
+            }
+        }));
+
+        // New refresh: issues with a known key are reused and only the changed rows are updated. The few
+        // vectors of the diff itself are not counted, there is a fixed number of them per refresh
+        struct Known
+        {
+            std::shared_ptr<Issue> issue;
+            int refresh;
+        };
+        Map<Key, Known, KeyHash> knownIssues;
+        for(auto& issue : rows)
+        {
+            knownIssues.emplace(issue->key, Known{issue, 0});
+        }
+        Map<const Issue*, int> rowByIssue;
+        for(int row = 0; row < static_cast<int>(rows.size()); ++row)
+        {
+            rowByIssue.emplace(rows[row].get(), row);
+        }
+        auto incremental(measure([&](){
+            Issues received;
+            received.reserve(newStalls.size());
+            for(auto& stall : newStalls)
+            {
+                Key key(stall.reason, stall.localPath, stall.cloudPath);
+                auto known(knownIssues.find(key));
+                if(known != knownIssues.end())
+                {
+                    known->second.refresh = 1;
+                    received.push_back(known->second.issue);
+                }
+                else
+                {
+                    received.push_back(createIssue(stall));
+                    knownIssues.emplace(std::move(key), Known{received.back(), 1});
+                }
+            }
+            for(auto known = knownIssues.begin(); known != knownIssues.end();)
+            {
+                known = known->second.refresh == 1 ? std::next(known) : knownIssues.erase(known);
+            }
+
+            StalledIssuesDiff<Key, KeyHash> diff(rows, received, [](const std::shared_ptr<Issue>& issue) -> const Key& {
+                return issue->key;
+            });
+            // Rows before the first change keep their number
+            auto firstChangedRow(static_cast<int>(rows.size()));
+            for(auto& range : diff.removed())
+            {
+                for(int row = range.first; row <= range.last; ++row)
+                {
+                    rowByIssue.erase(rows[row].get());
+                }
+                rows.erase(rows.begin() + range.first, rows.begin() + range.last + 1);
+                firstChangedRow = range.first;
+            }
+            for(auto& range : diff.inserted())
+            {
+                rows.insert(rows.begin() + range.first, received.begin() + range.first, received.begin() + range.last + 1);
+                firstChangedRow = std::min(firstChangedRow, range.first);
+            }
+            for(int row = firstChangedRow; row < static_cast<int>(rows.size()); ++row)
+            {
+                rowByIssue[rows[row].get()] = row;
+            }
+        }));
+
+        REQUIRE(rows.size() == resetRows.size());
+        for(std::size_t row = 0; row < rows.size(); ++row)
+        {
+            REQUIRE(rows[row]->key == resetRows[row]->key);
+            REQUIRE(rowByIssue.at(rows[row].get()) == static_cast<int>(row));
+        }
+        REQUIRE(rowByIssue.size() == rows.size());
+
+        WARN(count << " stalls, " << changed << " solved and " << changed << " new: reset "
+             << reset.ms << " ms, " << reset.allocations << " allocations; diff " << incremental.ms << " ms, "
+             << incremental.allocations << " allocations");
+    }
+}
@@ -0,0 +1,227 @@
+#include <catch.hpp>
+#include "syncs/control/MegaIgnoreMatcher.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Entry = MegaIgnoreMatcher::Entry;
+using EntryType = MegaIgnoreMatcher::EntryType;
+
+Entry file(const std::string& path, long long size = 100)
+{
+    return Entry{path, EntryType::FILE, size};
+}
+
+Entry folder(const std::string& path)
+{
+    return Entry{path, EntryType::FOLDER, 0};
+}
+}
+
+TEST_CASE("Glob matching")
+{
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("*.tmp", "a.tmp"));
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("*.tmp", ".tmp"));
+    REQUIRE_FALSE(MegaIgnoreMatcher::matchesGlob("*.tmp", "a.tmpx"));
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("a*b*c", "aXbYbZc"));
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("file?.[ch]", "file1.h"));
+    REQUIRE_FALSE(MegaIgnoreMatcher::matchesGlob("file?.[!ch]", "file1.h"));
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("[a-c]x", "bx"));
+    REQUIRE(MegaIgnoreMatcher::matchesGlob("\\*", "*"));
+    REQUIRE_FALSE(MegaIgnoreMatcher::matchesGlob("\\*", "a"));
+}
+
+TEST_CASE("Compiled .megaignore rules")
+{
+    MegaIgnoreMatcher matcher({
+        "# comment",
+        "#-:disabled",
+        "exclude-larger:1M",
+        "exclude-smaller:10",
+        "-:*.tmp",
+        "-:~*",
+        "-:Thumbs.db",
+        "-d:*cache*",
+        "-N:root-only",
+        "-p:docs/private",
+        "-:report-*-draft.doc",
+        "-r:^[0-9]+\\.log$",
+        "+:keep.tmp",
+        "-G:CaseSensitive",
+        "invalid line"
+    });
+    REQUIRE(matcher.ruleCount() == 12);
+
+    SECTION("Names, extensions and the last matching rule")
+    {
+        REQUIRE(matcher.isExcluded(file("a/b/c.tmp")));
+        REQUIRE(matcher.isExcluded(file("a/B.TMP")));
+        REQUIRE_FALSE(matcher.isExcluded(file("a/keep.tmp")));
+        REQUIRE(matcher.isExcluded(file("~lock.odt")));
+        REQUIRE(matcher.isExcluded(file("x/thumbs.db")));
+        REQUIRE_FALSE(matcher.isExcluded(file("x/thumbs.dbx")));
+        REQUIRE(matcher.isExcluded(file("report-2024-draft.doc")));
+        REQUIRE(matcher.isExcluded(file("logs/2024.log")));
+        REQUIRE_FALSE(matcher.isExcluded(file("logs/app.log")));
+        REQUIRE(matcher.isExcluded(file("CaseSensitive")));
+        REQUIRE_FALSE(matcher.isExcluded(file("casesensitive")));
+        REQUIRE_FALSE(matcher.isExcluded(file("disabled")));
+    }
+
+    SECTION("Targets, scopes and excluded folders")
+    {
+        REQUIRE(matcher.isExcluded(folder("src/.cache")));
+        REQUIRE_FALSE(matcher.isExcluded(file("src/.cache")));
+        REQUIRE(matcher.isExcluded(file("src/.cache/data.bin")));
+        REQUIRE(matcher.isExcluded(file("root-only")));
+        REQUIRE_FALSE(matcher.isExcluded(file("sub/root-only")));
+        REQUIRE(matcher.isExcluded(file("docs/private/notes.txt")));
+        REQUIRE_FALSE(matcher.isExcluded(file("other/docs/private")));
+    }
+
+    SECTION("Sizes only apply to files")
+    {
+        REQUIRE(matcher.isExcluded(file("big.bin", 1024 * 1024 + 1)));
+        REQUIRE_FALSE(matcher.isExcluded(file("limit.bin", 1024 * 1024)));
+        REQUIRE(matcher.isExcluded(file("tiny.bin", 9)));
+        REQUIRE_FALSE(matcher.isExcluded(folder("tiny")));
+    }
+
+    SECTION("Bulk evaluation gives the same results")
+    {
+        std::vector<Entry> entries{file("a.tmp"), file("keep.tmp"), folder("x/cache"), file("x/cache/y"), file("ok.txt")};
+        for (int i = 0; i < 10000; ++i)
+        {
+            entries.push_back(file("many/f" + std::to_string(i) + (i % 2 ? ".tmp" : ".txt")));
+        }
+
+        ThreadPool pool(2);
+        auto results(matcher.evaluate(entries, pool));
+        REQUIRE(results.size() == entries.size());
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            REQUIRE(results[i] == (matcher.isExcluded(entries[i]) ? 1 : 0));
+        }
+        REQUIRE(results[0] == 1);
+        REQUIRE(results[1] == 0);
+        REQUIRE(results[3] == 1);
+        REQUIRE(results[4] == 0);
+    }
+}
+
+TEST_CASE("Preview of .megaignore rules on a 1M path tree", "[.][benchmark]")
+{
+    std::vector<std::string> rules{"exclude-larger:100M", "exclude-smaller:1"};
+    const char* extensions[] = {"tmp", "bak", "swp", "o", "obj", "pyc", "class", "log", "iso", "part", "crdownload", "ds_store"};
+    for (auto extension : extensions)
+    {
+        rules.push_back(std::string("-f:*.") + extension);
+    }
+    const char* names[] = {"Thumbs.db", "desktop.ini", "node_modules", "__pycache__", ".git", ".svn", "build", "dist", "target", ".idea"};
+    for (auto name : names)
+    {
+        rules.push_back(std::string("-:") + name);
+    }
+    for (int i = 0; i < 20; ++i)
+    {
+        rules.push_back("-:*generated" + std::to_string(i) + "*");
+        rules.push_back("-:backup" + std::to_string(i) + "*");
+    }
+    rules.push_back("+:important.log");
+
+    std::vector<MegaIgnoreMatcher::Entry> entries;
+    const char* fileExtensions[] = {"txt", "jpg", "tmp", "cpp", "log", "pdf", "o", "png"};
+    for (int project = 0; entries.size() < 1000000; ++project)
+    {
+        for (int dir = 0; dir < 10; ++dir)
+        {
+            auto folderPath = "Projects/project" + std::to_string(project) + "/" + (dir == 9 ? std::string("build") : "module" + std::to_string(dir));
+            entries.push_back(folder(folderPath));
+            for (int f = 0; f < 100; ++f)
+            {
+                entries.push_back(file(folderPath + "/file" + std::to_string(f) + "." + fileExtensions[f % 8], 1000 + f));
+            }
+        }
+    }
+
+    // Every rule tried in turn on every component, as a loop over the rule list would do
+    auto naive = [&rules](const MegaIgnoreMatcher::Entry& entry)
+    {
+        std::vector<std::string> components;
+        std::size_t start = 0;
+        for (auto separator = entry.path.find('/'); ; separator = entry.path.find('/', start))
+        {
+            components.push_back(entry.path.substr(start, separator - start));
+            if (separator == std::string::npos)
+            {
+                break;
+            }
+            start = separator + 1;
+        }
+
+        for (const auto& component : components)
+        {
+            bool excluded = false;
+            for (const auto& rule : rules)
+            {
+                if (rule[0] == '-' || rule[0] == '+')
+                {
+                    auto pattern = rule.substr(rule.find(':') + 1);
+                    if (MegaIgnoreMatcher::matchesGlob(pattern.c_str(), component.c_str()))
+                    {
+                        excluded = rule[0] == '-';
+                    }
+                }
+            }
+            if (excluded)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto measure = [](const char* name, std::size_t count, std::function<std::size_t()> run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto excluded = run();
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        WARN(name << ": " << count << " paths in " << ms << " ms, " << excluded << " excluded");
+    };
+
+    measure("Rules one by one", entries.size(), [&]()
+    {
+        std::size_t excluded = 0;
+        for (const auto& entry : entries)
+        {
+            excluded += naive(entry);
+        }
+        return excluded;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<MegaIgnoreMatcher> matcher(new MegaIgnoreMatcher(rules));
+    auto compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    WARN("Compile " << rules.size() << " rules: " << compileMs << " ms");
+
+    measure("Compiled, one thread", entries.size(), [&]()
+    {
+        std::size_t excluded = 0;
+        for (const auto& entry : entries)
+        {
+            excluded += matcher->isExcluded(entry);
+        }
+        return excluded;
+    });
+
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    measure("Compiled, evaluate() on the pool", entries.size(), [&]()
+    {
+        auto results(matcher->evaluate(entries, pool));
+        return static_cast<std::size_t>(std::count(results.begin(), results.end(), 1));
+    });
+}
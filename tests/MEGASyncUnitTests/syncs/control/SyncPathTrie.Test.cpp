@@ -0,0 +1,106 @@
+#include <catch.hpp>
+#include "syncs/control/SyncPathTrie.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+TEST_CASE("Sync roots are found for the paths under them")
+{
+    SyncPathTrie trie;
+    trie.insert("/home/user/MEGA", 1);
+    trie.insert("/home/user/Backups/Photos", 2);
+    trie.insert("C:/Users/user/Documents/", 3);
+    REQUIRE(trie.size() == 3);
+
+    REQUIRE(trie.find("/home/user/MEGA/docs/a.txt") == 1);
+    REQUIRE(trie.find("/home/user/MEGA") == 1);
+    REQUIRE(trie.find("/home/user/MEGA-2/a.txt") == SyncPathTrie::INVALID_ID);
+    REQUIRE(trie.find("/home/user/Backups/b.txt") == SyncPathTrie::INVALID_ID);
+    REQUIRE(trie.find("/home/user/Backups/Photos/2024/c.jpg") == 2);
+    REQUIRE(trie.find("C:/Users/user/Documents/d.doc") == 3);
+    REQUIRE(trie.find("/home") == SyncPathTrie::INVALID_ID);
+
+    SECTION("Removing a root keeps the others")
+    {
+        trie.remove(2);
+        REQUIRE(trie.size() == 2);
+        REQUIRE(trie.find("/home/user/Backups/Photos/2024/c.jpg") == SyncPathTrie::INVALID_ID);
+        REQUIRE(trie.find("/home/user/MEGA/docs/a.txt") == 1);
+        trie.remove(2);
+        REQUIRE(trie.size() == 2);
+    }
+
+    SECTION("Nested roots resolve to the deepest one")
+    {
+        trie.insert("/home/user/MEGA/inner", 4);
+        REQUIRE(trie.find("/home/user/MEGA/inner/x") == 4);
+        REQUIRE(trie.find("/home/user/MEGA/x") == 1);
+        trie.remove(1);
+        REQUIRE(trie.find("/home/user/MEGA/inner/x") == 4);
+        REQUIRE(trie.find("/home/user/MEGA/x") == SyncPathTrie::INVALID_ID);
+    }
+
+    SECTION("Inserting a sync again moves its root")
+    {
+        trie.insert("/mnt/MEGA", 1);
+        REQUIRE(trie.size() == 3);
+        REQUIRE(trie.find("/home/user/MEGA/docs/a.txt") == SyncPathTrie::INVALID_ID);
+        REQUIRE(trie.find("/mnt/MEGA/a.txt") == 1);
+    }
+
+    SECTION("Clear")
+    {
+        trie.clear();
+        REQUIRE(trie.size() == 0);
+        REQUIRE(trie.find("/home/user/MEGA/docs/a.txt") == SyncPathTrie::INVALID_ID);
+    }
+}
+
+TEST_CASE("Finding the sync of finished transfers", "[.][benchmark]")
+{
+    for (int syncs : {1, 100, 1000})
+    {
+        SyncPathTrie trie;
+        std::vector<std::string> roots;
+        for (int sync = 0; sync < syncs; ++sync)
+        {
+            roots.push_back("/home/user/Backups/Machine" + std::to_string(sync % 10) + "/Backup" + std::to_string(sync));
+            trie.insert(roots.back(), static_cast<SyncPathTrie::SyncId>(sync));
+        }
+
+        std::vector<std::string> paths;
+        for (int file = 0; file < 10000; ++file)
+        {
+            paths.push_back(roots[static_cast<std::size_t>(file % syncs)] + "/folder" + std::to_string(file % 7) + "/file" + std::to_string(file) + ".jpg");
+        }
+
+        // The loop onTransferFinish used: a prefix check against every root
+        auto start = std::chrono::steady_clock::now();
+        std::size_t found = 0;
+        for (const auto& path : paths)
+        {
+            for (const auto& root : roots)
+            {
+                if (path.compare(0, root.size() + 1, root + '/') == 0)
+                {
+                    ++found;
+                    break;
+                }
+            }
+        }
+        auto linearNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / paths.size();
+        REQUIRE(found == paths.size());
+
+        start = std::chrono::steady_clock::now();
+        found = 0;
+        for (const auto& path : paths)
+        {
+            found += trie.find(path) != SyncPathTrie::INVALID_ID;
+        }
+        auto trieNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / paths.size();
+        REQUIRE(found == paths.size());
+
+        WARN(syncs << " syncs: prefix loop " << linearNs << " ns per path, trie " << trieNs << " ns per path");
+    }
+}
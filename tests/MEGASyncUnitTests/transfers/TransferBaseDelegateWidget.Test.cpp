@@ -0,0 +1,115 @@
+#include <catch.hpp>
+#include "TransferBaseDelegateWidget.h"
+#include "ui_TransferManagerDelegateWidget.h"
+
+#include <QPainter>
+#include <QPixmap>
+
+namespace
+{
+//A hidden row of the Transfer Manager, without the model behind it
+struct Row
+{
+    Row(int width, int index)
+    {
+        ui.setupUi(&widget);
+        widget.resize(width, widget.height());
+        setTexts(index);
+    }
+
+    void setTexts(int index)
+    {
+        ui.lTransferName->setText(QString::fromLatin1("IMG_%1_holidays.jpg").arg(index).repeated(1 + index % 3));
+        ui.lDone->setText(QString::fromLatin1("%1 MB").arg(index * 37 % 1000));
+        ui.lTotal->setText(QString::fromLatin1("of %1 GB").arg(index % 9));
+        ui.bItemSpeed->setText(QString::fromLatin1("%1 MB/s").arg(index % 20));
+        ui.lItemTime->setText(QString::fromLatin1("%1 minutes").arg(index % 60));
+    }
+
+    //The fields painted with the progress, and the name, elided by the layout
+    QVector<QRect> fields() const
+    {
+        QVector<QRect> rects;
+        for(QWidget* field : {static_cast<QWidget*>(ui.pbTransfer), static_cast<QWidget*>(ui.wSize), static_cast<QWidget*>(ui.lDone),
+                              static_cast<QWidget*>(ui.lTotal), static_cast<QWidget*>(ui.bItemSpeed),
+                              static_cast<QWidget*>(ui.lItemTime), static_cast<QWidget*>(ui.lTransferName)})
+        {
+            rects.append(QRect(field->mapTo(&widget, QPoint(0, 0)), field->size()));
+        }
+        return rects;
+    }
+
+    QRegion holes() const
+    {
+        QRegion region(widget.rect());
+        auto rects(fields());
+        for(int index = 0; index < rects.size() - 1; ++index)
+        {
+            region -= rects.at(index);
+        }
+        return region;
+    }
+
+    void render(QPixmap& pixmap, const QRegion& region)
+    {
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        widget.render(&painter, QPoint(0, 0), region);
+    }
+
+    QWidget widget;
+    Ui::TransferManagerDelegateWidget ui;
+};
+}
+
+TEST_CASE("Hidden transfer rows are laid out as a render lays them out")
+{
+    for(int width : {500, 650, 900, 1400})
+    {
+        Row rendered(width, width);
+        Row laidOut(width, width);
+        QPixmap pixmap(rendered.widget.size());
+
+        rendered.render(pixmap, QRegion(rendered.widget.rect()));
+        TransferBaseDelegateWidget::layOutHidden(&laidOut.widget);
+        REQUIRE(laidOut.fields() == rendered.fields());
+
+        //The same widget shows another transfer
+        rendered.setTexts(width + 1);
+        laidOut.setTexts(width + 1);
+        rendered.render(pixmap, QRegion(rendered.widget.rect()));
+        TransferBaseDelegateWidget::layOutHidden(&laidOut.widget);
+        REQUIRE(laidOut.fields() == rendered.fields());
+
+        //The view is resized
+        rendered.widget.resize(width / 2 + 200, rendered.widget.height());
+        laidOut.widget.resize(width / 2 + 200, laidOut.widget.height());
+        rendered.render(pixmap, QRegion(rendered.widget.rect()));
+        TransferBaseDelegateWidget::layOutHidden(&laidOut.widget);
+        REQUIRE(laidOut.fields() == rendered.fields());
+    }
+}
+
+TEST_CASE("Transfer row layer benchmark", "[.][benchmark]")
+{
+    //A cache miss of the delegate: the row shows another transfer before its static layer is painted
+    Row row(900, 0);
+    QPixmap pixmap(row.widget.size());
+    int index(0);
+
+    BENCHMARK("Whole render to lay out the row, then render with holes")
+    {
+        row.setTexts(++index);
+        row.render(pixmap, QRegion(row.widget.rect()));
+        row.render(pixmap, row.holes());
+        return pixmap.width();
+    };
+
+    BENCHMARK("Lay out the hidden row, then render with holes")
+    {
+        row.setTexts(++index);
+        TransferBaseDelegateWidget::layOutHidden(&row.widget);
+        row.render(pixmap, row.holes());
+        return pixmap.width();
+    };
+}
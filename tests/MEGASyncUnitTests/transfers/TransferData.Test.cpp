@@ -0,0 +1,51 @@
+#include <catch.hpp>
+#include "TransferItem.h"
+
+TEST_CASE("Progress updates of a running transfer are written in place")
+{
+    QExplicitlySharedDataPointer<TransferData> data(new TransferData());
+    data->setState(TransferData::TRANSFER_ACTIVE);
+    data->resetStateHasChanged();
+
+    const auto allocationsBefore(TransferData::allocations());
+    const auto inPlaceUpdatesBefore(TransferData::inPlaceUpdates());
+
+    constexpr int updates(1000);
+    TransferProgress progress;
+    progress.tag = 1;
+    progress.state = mega::MegaTransfer::STATE_ACTIVE;
+    progress.totalBytes = updates * 100;
+    progress.speed = 100;
+
+    for(int update = 1; update <= updates; ++update)
+    {
+        progress.notificationNumber = update;
+        progress.transferredBytes = static_cast<unsigned long long>(update) * 100;
+        data->update(progress);
+    }
+
+    REQUIRE(TransferData::allocations() == allocationsBefore);
+    REQUIRE(TransferData::inPlaceUpdates() - inPlaceUpdatesBefore == updates);
+
+    REQUIRE(data->isActive());
+    REQUIRE_FALSE(data->stateHasChanged());
+    REQUIRE(data->mNotificationNumber == updates);
+    REQUIRE(data->mTransferredBytes == progress.totalBytes);
+    REQUIRE(data->mRemainingTime == 0);
+}
+
+TEST_CASE("Progress update keeps the state change information")
+{
+    QExplicitlySharedDataPointer<TransferData> data(new TransferData());
+    data->setState(TransferData::TRANSFER_QUEUED);
+    data->resetStateHasChanged();
+
+    TransferProgress progress;
+    progress.state = mega::MegaTransfer::STATE_ACTIVE;
+    progress.notificationNumber = 1;
+    data->update(progress);
+
+    REQUIRE(data->isActive());
+    REQUIRE(data->getPreviousState() == TransferData::TRANSFER_QUEUED);
+    REQUIRE(data->stateHasChanged());
+}
@@ -0,0 +1,271 @@
+#include <catch.hpp>
+#include "TransferItemsByState.h"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum State
+{
+    PENDING = 0,
+    COMPLETED,
+    FAILED,
+    STATES
+};
+
+struct Item
+{
+    Item() = default;
+    Item(int utag, std::string uname) : tag(utag), name(std::move(uname)) {}
+
+    int tag = 0;
+    std::string name;
+};
+
+using Items = TransferItemsByState<Item, STATES>;
+
+std::vector<int> tagsOf(const Items& items, int state)
+{
+    return items.tags(state);
+}
+}
+
+TEST_CASE("TransferItemsByState moves items between states")
+{
+    Items items;
+    for(int tag = 1; tag <= 5; ++tag)
+    {
+        REQUIRE(items.insert(tag, PENDING, Item(tag, std::to_string(tag))) != nullptr);
+    }
+    REQUIRE(items.insert(3, FAILED, Item()) == nullptr);
+
+    REQUIRE(items.size() == 5);
+    REQUIRE(items.count(PENDING) == 5);
+    REQUIRE(tagsOf(items, PENDING) == std::vector<int>{1, 2, 3, 4, 5});
+
+    REQUIRE(items.setState(4, COMPLETED));
+    REQUIRE(items.setState(2, COMPLETED));
+    REQUIRE(items.setState(5, FAILED));
+    REQUIRE_FALSE(items.setState(6, FAILED));
+
+    REQUIRE(items.count(PENDING) == 2);
+    REQUIRE(items.count(COMPLETED) == 2);
+    REQUIRE(items.count(FAILED) == 1);
+    REQUIRE(tagsOf(items, PENDING) == std::vector<int>{1, 3});
+    REQUIRE(tagsOf(items, COMPLETED) == std::vector<int>{2, 4});
+    REQUIRE(items.stateOf(5) == FAILED);
+    REQUIRE(items.contains(4, COMPLETED));
+    REQUIRE_FALSE(items.contains(4, PENDING));
+    REQUIRE(items.find(4, PENDING) == nullptr);
+    REQUIRE(items.find(4)->name == "4");
+
+    std::vector<std::string> names;
+    items.forEach(COMPLETED, [&names](const Item& item){
+        names.push_back(item.name);
+    });
+    REQUIRE(names == std::vector<std::string>{"2", "4"});
+
+    SECTION("Removed items are gone from every state")
+    {
+        REQUIRE(items.remove(5));
+        REQUIRE_FALSE(items.remove(5));
+        REQUIRE(items.find(5) == nullptr);
+        REQUIRE(items.stateOf(5) == -1);
+        REQUIRE(items.count(FAILED) == 0);
+        REQUIRE(items.size() == 4);
+
+        // A removed tag can be stored again
+        REQUIRE(items.insert(5, PENDING, Item(5, "again")) != nullptr);
+        REQUIRE(items.find(5)->name == "again");
+        REQUIRE(tagsOf(items, PENDING) == std::vector<int>{1, 3, 5});
+
+        REQUIRE(items.removeAll(COMPLETED) == 2);
+        REQUIRE(items.count(COMPLETED) == 0);
+        REQUIRE(items.size() == 3);
+
+        items.compact();
+        REQUIRE(items.size() == 3);
+        REQUIRE(tagsOf(items, PENDING) == std::vector<int>{1, 3, 5});
+        REQUIRE(items.find(5)->name == "again");
+    }
+
+    SECTION("Copies are independent")
+    {
+        Items copy(items);
+        REQUIRE(copy.setState(1, FAILED));
+        REQUIRE(copy.count(FAILED) == 2);
+        REQUIRE(items.count(FAILED) == 1);
+        REQUIRE(tagsOf(items, PENDING) == std::vector<int>{1, 3});
+    }
+
+    SECTION("Clear")
+    {
+        items.clear();
+        REQUIRE(items.isEmpty());
+        REQUIRE(items.count(PENDING) == 0);
+        REQUIRE(tagsOf(items, COMPLETED).empty());
+    }
+}
+
+TEST_CASE("TransferItemsByState finds the items of a group")
+{
+    Items items;
+    for(int tag = 1; tag <= 6; ++tag)
+    {
+        items.insert(tag, COMPLETED, Item(tag, "file" + std::to_string(tag)));
+        items.setGroup(tag, static_cast<Items::Group>(tag % 2));
+    }
+    // An item keeps its first group
+    items.setGroup(2, 1);
+    items.setState(4, FAILED);
+
+    auto named = [](const std::string& name){
+        return [name](const Item& item){
+            return item.name == name;
+        };
+    };
+
+    REQUIRE(items.anyInGroup(0, COMPLETED, named("file2")));
+    REQUIRE(items.anyInGroup(0, COMPLETED, named("file6")));
+    REQUIRE_FALSE(items.anyInGroup(1, COMPLETED, named("file2")));
+    REQUIRE_FALSE(items.anyInGroup(0, COMPLETED, named("file4")));
+    REQUIRE(items.anyInGroup(0, FAILED, named("file4")));
+    REQUIRE_FALSE(items.anyInGroup(7, COMPLETED, named("file1")));
+
+    // Groups survive the compaction of dead slots
+    for(int tag = 100; tag < 3000; ++tag)
+    {
+        items.insert(tag, FAILED, Item(tag, std::string()));
+    }
+    REQUIRE(items.removeAll(FAILED) == 2901);
+    REQUIRE(items.size() == 5);
+    REQUIRE(items.anyInGroup(1, COMPLETED, named("file5")));
+    REQUIRE(items.anyInGroup(0, COMPLETED, named("file6")));
+}
+
+namespace
+{
+std::size_t gAllocatedBytes = 0;
+
+// Counts the bytes requested by the maps of the old layout
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        gAllocatedBytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        gAllocatedBytes -= n * sizeof(T);
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {return true;}
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {return false;}
+};
+
+// Same size as TransferMetaDataItem: three ids with two implicitly shared strings each, a state and
+// the copy of the failed transfer
+struct BenchItem
+{
+    BenchItem() = default;
+    explicit BenchItem(int utag) : tag(utag) {}
+
+    int tag = 0;
+    std::uint64_t folderHandle = 0;
+    void* strings[6] = {};
+    std::uint64_t otherIds[4] = {};
+    int state = 0;
+    std::shared_ptr<void> failedTransfer;
+};
+
+template <typename Key, typename Value>
+using CountedMap = std::map<Key, Value, std::less<Key>, CountingAllocator<std::pair<const Key, Value>>>;
+template <typename Key, typename Value>
+using CountedMultiMap = std::multimap<Key, Value, std::less<Key>, CountingAllocator<std::pair<const Key, Value>>>;
+
+// The old layout: one map per state plus a multimap by folder, all holding shared items
+struct MapsByState
+{
+    CountedMap<int, std::shared_ptr<BenchItem>> byState[5];
+    CountedMultiMap<std::uint64_t, std::shared_ptr<BenchItem>> completedByFolder;
+};
+}
+
+TEST_CASE("TransferItemsByState benchmark", "[.][benchmark]")
+{
+    constexpr int files = 500000;
+    constexpr std::uint64_t folders = 1000;
+    std::mutex mutex;
+
+    gAllocatedBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    double mapsMemory = 0;
+    int mapsCompleted = 0;
+    {
+        MapsByState maps;
+        for(int tag = 1; tag <= files; ++tag)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            maps.byState[0].emplace(tag, std::allocate_shared<BenchItem>(CountingAllocator<BenchItem>(), tag));
+        }
+        for(int tag = 1; tag <= files; ++tag)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = maps.byState[0].find(tag);
+            auto item = it->second;
+            maps.byState[0].erase(it);
+            item->folderHandle = static_cast<std::uint64_t>(tag) % folders;
+            maps.byState[1].emplace(tag, item);
+            maps.completedByFolder.emplace(item->folderHandle, item);
+        }
+        mapsCompleted = static_cast<int>(maps.byState[1].size());
+        mapsMemory = static_cast<double>(gAllocatedBytes);
+    }
+    const double mapsMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    TransferItemsByState<BenchItem, 5> items;
+    for(int tag = 1; tag <= files; ++tag)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.insert(tag, 0, BenchItem(tag));
+    }
+    for(int tag = 1; tag <= files; ++tag)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto item = items.find(tag, 0);
+        item->folderHandle = static_cast<std::uint64_t>(tag) % folders;
+        items.setState(tag, 1);
+        items.setGroup(tag, item->folderHandle);
+    }
+    const double slabMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    const auto completed = items.tags(1).size();
+    const double listMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(static_cast<int>(completed) == mapsCompleted);
+    CHECK(items.anyInGroup(7, 1, [](const BenchItem& item){ return item.tag == 1007; }));
+
+    const double slabMemory = static_cast<double>(items.memoryUsage());
+    WARN(files << " items of " << sizeof(BenchItem) << " bytes, added then completed: maps by state "
+         << mapsMs << " ms, " << mapsMemory / (1 << 20) << " MiB; slab " << slabMs << " ms, "
+         << slabMemory / (1 << 20) << " MiB (including the completed tag list, built in " << listMs << " ms)");
+}
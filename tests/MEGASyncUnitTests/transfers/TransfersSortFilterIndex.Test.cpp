@@ -0,0 +1,283 @@
+#include <catch.hpp>
+#include "TransfersSortFilterIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Keys
+{
+    std::string name;
+    unsigned long long size = 0;
+};
+
+enum Criterion
+{
+    NAME = 0,
+    SIZE,
+    CRITERIA
+};
+
+enum Dimension
+{
+    STATE = 0,
+    TYPE,
+    DIMENSIONS
+};
+
+constexpr std::uint32_t ACTIVE(0x01);
+constexpr std::uint32_t PAUSED(0x02);
+constexpr std::uint32_t COMPLETED(0x04);
+constexpr std::uint32_t UPLOAD(0x01);
+constexpr std::uint32_t DOWNLOAD(0x02);
+constexpr std::uint32_t ALL(~std::uint32_t(0));
+
+using Index = TransfersSortFilterIndex<int, Keys, CRITERIA, DIMENSIONS>;
+
+std::array<Index::LessThan, CRITERIA> comparators()
+{
+    return {[](const Keys& left, const Keys& right){ return left.name < right.name; },
+            [](const Keys& left, const Keys& right){ return left.size < right.size; }};
+}
+
+Index::Flags flagsOf(int tag)
+{
+    static const std::uint32_t states[] = {ACTIVE, PAUSED, COMPLETED};
+    return {states[tag % 3], (tag % 2) ? UPLOAD : DOWNLOAD};
+}
+
+int acceptedCount(const Index& index, int tags)
+{
+    int count(0);
+    for(int tag = 0; tag < tags; ++tag)
+    {
+        count += index.accepts(tag);
+    }
+    return count;
+}
+}
+
+TEST_CASE("Sort filter index combines the filter bitsets")
+{
+    Index index(comparators());
+    for(int tag = 0; tag < 300; ++tag)
+    {
+        REQUIRE(index.update(tag, Keys{std::to_string(tag), static_cast<unsigned long long>(tag)}, flagsOf(tag)));
+    }
+    REQUIRE(acceptedCount(index, 1001) == 300);
+
+    index.setFilter({ACTIVE | PAUSED, UPLOAD});
+    for(int tag = 0; tag < 300; ++tag)
+    {
+        REQUIRE(index.accepts(tag) == ((tag % 3 != 2) && (tag % 2 == 1)));
+    }
+    REQUIRE(acceptedCount(index, 1001) == 100);
+
+    // A row that changes state moves to the new bitset
+    REQUIRE_FALSE(index.accepts(5));
+    REQUIRE(index.update(5, Keys{"5", 5}, {ACTIVE, UPLOAD}));
+    index.setFilter({COMPLETED, ALL});
+    REQUIRE_FALSE(index.accepts(5));
+    REQUIRE(acceptedCount(index, 1001) == 99);
+
+    index.remove(2);
+    REQUIRE_FALSE(index.contains(2));
+    REQUIRE_FALSE(index.accepts(2));
+    REQUIRE(acceptedCount(index, 1001) == 98);
+
+    // Slots of removed rows are reused
+    REQUIRE(index.update(1000, Keys{"1000", 1000}, {COMPLETED, DOWNLOAD}));
+    REQUIRE(index.size() == 300);
+    REQUIRE(acceptedCount(index, 1001) == 99);
+}
+
+TEST_CASE("Sort filter index compares cached keys")
+{
+    Index index(comparators());
+    index.update(1, Keys{"b", 30}, flagsOf(1));
+    index.update(2, Keys{"a", 10}, flagsOf(2));
+
+    REQUIRE(index.lessThan(NAME, 2, 1));
+    REQUIRE_FALSE(index.lessThan(NAME, 1, 2));
+    REQUIRE(index.lessThan(SIZE, 2, 1));
+
+    index.update(2, Keys{"c", 40}, flagsOf(2));
+    REQUIRE(index.lessThan(NAME, 1, 2));
+    REQUIRE(index.lessThan(SIZE, 1, 2));
+
+    // Unknown rows go last
+    REQUIRE(index.lessThan(NAME, 1, 3));
+    REQUIRE_FALSE(index.lessThan(NAME, 3, 1));
+
+    // Slots resolved once compare as their rows
+    auto first(index.slotOf(1));
+    auto second(index.slotOf(2));
+    auto unknown(index.slotOf(3));
+    REQUIRE(unknown == Index::NO_SLOT);
+    REQUIRE(index.slotLessThan(NAME, first, second));
+    REQUIRE_FALSE(index.slotLessThan(NAME, second, first));
+    REQUIRE(index.slotLessThan(SIZE, second, unknown));
+    REQUIRE_FALSE(index.slotLessThan(SIZE, unknown, first));
+
+    // Slots stay until their row is removed
+    index.update(2, Keys{"0", 0}, flagsOf(2));
+    REQUIRE(index.slotOf(2) == second);
+    REQUIRE(index.slotLessThan(NAME, second, first));
+    index.remove(2);
+    REQUIRE(index.slotOf(2) == Index::NO_SLOT);
+}
+
+TEST_CASE("Sort filter index keeps the rows of every criterion in order")
+{
+    Index index(comparators());
+    std::vector<Keys> keys;
+    for(int tag = 0; tag < 200; ++tag)
+    {
+        // Names and sizes in different orders
+        keys.push_back(Keys{std::to_string((tag * 7919) % 200 + 1000), static_cast<unsigned long long>((tag * 31) % 200)});
+        index.update(tag, keys.back(), flagsOf(tag));
+    }
+
+    auto checkOrder = [&index, &keys](Criterion criterion, const std::vector<int>& tags)
+    {
+        auto sortedTags(tags);
+        std::sort(sortedTags.begin(), sortedTags.end(), [&keys, criterion](int left, int right)
+        {
+            return comparators()[criterion](keys[left], keys[right]);
+        });
+
+        std::vector<std::size_t> ranks;
+        index.ranks(criterion, ranks);
+        auto byRank(tags);
+        std::sort(byRank.begin(), byRank.end(), [&index, &ranks](int left, int right)
+        {
+            return ranks[index.slotOf(left)] < ranks[index.slotOf(right)];
+        });
+        REQUIRE(byRank == sortedTags);
+    };
+
+    std::vector<int> tags;
+    for(int tag = 0; tag < 200; ++tag)
+    {
+        tags.push_back(tag);
+    }
+    checkOrder(NAME, tags);
+    checkOrder(SIZE, tags);
+
+    SECTION("Updated rows move")
+    {
+        for(int tag = 0; tag < 200; tag += 3)
+        {
+            keys[tag].size += 1000;
+            index.update(tag, keys[tag], flagsOf(tag));
+        }
+        keys[10].name = "0";
+        index.update(10, keys[10], flagsOf(10));
+        checkOrder(NAME, tags);
+        checkOrder(SIZE, tags);
+    }
+
+    SECTION("Removed rows leave the order and their slots are reused")
+    {
+        for(int tag = 0; tag < 200; tag += 2)
+        {
+            index.remove(tag);
+        }
+        std::vector<int> remaining;
+        for(int tag = 1; tag < 200; tag += 2)
+        {
+            remaining.push_back(tag);
+        }
+
+        std::vector<std::size_t> ranks;
+        index.ranks(SIZE, ranks);
+        REQUIRE(std::count(ranks.begin(), ranks.end(), Index::NO_SLOT) == 100);
+        checkOrder(SIZE, remaining);
+
+        index.update(0, keys[0], flagsOf(0));
+        remaining.push_back(0);
+        checkOrder(NAME, remaining);
+        checkOrder(SIZE, remaining);
+    }
+
+    SECTION("Clear empties the orders")
+    {
+        index.clear();
+        std::vector<std::size_t> ranks;
+        index.ranks(NAME, ranks);
+        REQUIRE(ranks.empty());
+    }
+}
+
+TEST_CASE("Sort filter index filter change with 200k rows", "[.][benchmark]")
+{
+    constexpr int rows(200000);
+
+    Index index(comparators());
+    for(int tag = 0; tag < rows; ++tag)
+    {
+        index.update(tag, Keys{std::to_string(tag), static_cast<unsigned long long>(tag)}, flagsOf(tag));
+    }
+
+    std::vector<Index::Flags> flags;
+    for(int tag = 0; tag < rows; ++tag)
+    {
+        flags.push_back(flagsOf(tag));
+    }
+
+    BENCHMARK("Bitset filter change")
+    {
+        index.setFilter({ACTIVE, DOWNLOAD});
+        index.setFilter({ACTIVE | PAUSED, ALL});
+        return index.accepts(1);
+    };
+
+    BENCHMARK("Per row filter change")
+    {
+        std::size_t accepted(0);
+        for(const auto& rowFlags : flags)
+        {
+            accepted += (rowFlags[STATE] & (ACTIVE | PAUSED)) && (rowFlags[TYPE] & ALL);
+        }
+        return accepted;
+    };
+}
+
+TEST_CASE("Sort filter index criterion change with 200k rows", "[.][benchmark]")
+{
+    constexpr int rows(200000);
+
+    Index index(comparators());
+    std::vector<int> tags;
+    for(int tag = 0; tag < rows; ++tag)
+    {
+        index.update(tag, Keys{std::to_string((tag * 7919) % rows), static_cast<unsigned long long>(tag)}, flagsOf(tag));
+        tags.push_back(tag);
+    }
+
+    BENCHMARK("Ranks from the name order")
+    {
+        std::vector<std::size_t> ranks;
+        index.ranks(NAME, ranks);
+        return ranks.size();
+    };
+
+    BENCHMARK("Sort by the cached names")
+    {
+        auto sortedTags(tags);
+        std::stable_sort(sortedTags.begin(), sortedTags.end(), [&index](int left, int right)
+        {
+            return index.lessThan(NAME, left, right);
+        });
+        return sortedTags.front();
+    };
+
+    BENCHMARK("Update the keys of an active row")
+    {
+        static unsigned long long size(0);
+        return index.update(rows / 2, Keys{"100000", ++size}, flagsOf(rows / 2));
+    };
+}
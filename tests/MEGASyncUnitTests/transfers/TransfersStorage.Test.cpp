@@ -0,0 +1,132 @@
+#include <catch.hpp>
+#include "TransfersStorage.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+using Storage = TransfersStorage<int, std::string, 64>;
+
+void fill(Storage& storage, int rows)
+{
+    for(int tag = 1; tag <= rows; ++tag)
+    {
+        storage.append(tag, std::to_string(tag));
+    }
+}
+}
+
+TEST_CASE("Transfers storage keeps rows in insertion order")
+{
+    Storage storage;
+    fill(storage, 200);
+
+    REQUIRE(storage.size() == 200);
+    REQUIRE(storage.rowOf(1) == 0);
+    REQUIRE(storage.rowOf(200) == 199);
+    REQUIRE(storage.at(99) == "100");
+    REQUIRE(storage.rowOf(201) == -1);
+    REQUIRE(storage.at(200).empty());
+
+    // repeated tags are not inserted again
+    REQUIRE(storage.append(10, "repeated") == -1);
+    REQUIRE(storage.size() == 200);
+}
+
+TEST_CASE("Transfers storage updates rows after removing")
+{
+    Storage storage;
+    fill(storage, 200);
+
+    REQUIRE(storage.removeAt(0));
+    REQUIRE(storage.remove(100));
+    REQUIRE_FALSE(storage.remove(100));
+
+    REQUIRE(storage.size() == 198);
+    REQUIRE(storage.rowOf(2) == 0);
+    REQUIRE(storage.rowOf(99) == 97);
+    REQUIRE(storage.rowOf(101) == 98);
+    REQUIRE(storage.at(98) == "101");
+
+    REQUIRE(storage.set(98, "updated"));
+    REQUIRE(storage.at(storage.rowOf(101)) == "updated");
+}
+
+TEST_CASE("Transfers storage removes batches and compacts tombstones")
+{
+    Storage storage;
+    fill(storage, 1000);
+
+    std::vector<int> evenTags;
+    for(int tag = 2; tag <= 1000; tag += 2)
+    {
+        evenTags.push_back(tag);
+    }
+
+    REQUIRE(storage.removeKeys(evenTags) == 500);
+    REQUIRE(storage.size() == 500);
+
+    for(int row = 0; row < storage.size(); ++row)
+    {
+        auto tag(row * 2 + 1);
+        REQUIRE(storage.rowOf(tag) == row);
+        REQUIRE(storage.at(row) == std::to_string(tag));
+    }
+
+    // Once tombstones outnumber live rows they are compacted away
+    std::vector<int> someOddTags{1, 3, 5, 7, 9, 11, 13, 15, 17, 19};
+    storage.removeKeys(someOddTags);
+    REQUIRE(storage.tombstones() == 0);
+    REQUIRE(storage.rowOf(21) == 0);
+
+    auto values(storage.values<std::vector<std::string>>());
+    REQUIRE(values.size() == 490);
+    REQUIRE(values.back() == "999");
+}
+
+TEST_CASE("Transfers storage batch removal", "[.][benchmark]")
+{
+    for(auto rows : {10000, 100000, 1000000})
+    {
+        // Cancel a batch of 1000 transfers spread all over the model
+        const int batchSize(1000);
+        std::vector<int> batch;
+        for(int index = 0; index < batchSize; ++index)
+        {
+            batch.push_back(1 + index * (rows / batchSize));
+        }
+
+        BENCHMARK_ADVANCED("Remove and add back 1000 rows in " + std::to_string(rows))(Catch::Benchmark::Chronometer meter)
+        {
+            TransfersStorage<int, std::string> storage;
+            for(int tag = 1; tag <= rows; ++tag)
+            {
+                storage.append(tag, std::string());
+            }
+
+            meter.measure([&storage, &batch]{
+                auto removed(storage.removeKeys(batch));
+                for(auto tag : batch)
+                {
+                    storage.append(tag, std::string());
+                }
+                return removed;
+            });
+        };
+
+        BENCHMARK_ADVANCED("Find row by tag in " + std::to_string(rows))(Catch::Benchmark::Chronometer meter)
+        {
+            TransfersStorage<int, std::string> storage;
+            for(int tag = 1; tag <= rows; ++tag)
+            {
+                storage.append(tag, std::string());
+            }
+            storage.removeKeys(batch);
+
+            meter.measure([&storage, rows](int run){
+                return storage.rowOf(1 + (run * 7919) % rows);
+            });
+        };
+    }
+}